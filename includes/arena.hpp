@@ -0,0 +1,368 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "utility/is_monotonic_allocator.hpp"
+#include "utility/is_trivially_destructible.hpp"
+#include "utility/true_type.hpp"
+
+namespace ft
+{
+	// A monotonic arena: memory is bump-allocated from chunks and only given back all at once by reset()
+	// or the destructor, so allocating is a pointer increment and freeing costs nothing per object.
+	// The chunks double in size (up to max_chunk_size), a bigger request gets a chunk of its own.
+	// An arena may start on a buffer of the caller (an array on the stack): as long as it fits, nothing is taken
+	// from the heap at all. Objects made with create() are destroyed by reset(), newest first; those with a
+	// trivial destructor aren't even recorded. An arena is not thread safe: one per thread or per request.
+	class arena
+	{
+	public:
+		enum
+		{
+			default_alignment = 16,			// what operator new guarantees on the usual 64-bit platforms
+			default_chunk_size = 4096,
+			max_chunk_size = 1 << 20
+		};
+
+		explicit arena(size_t first_chunk_size = default_chunk_size)
+			: _cursor(NULL), _end(NULL), _chunks(NULL), _finalizers(NULL)
+			, _buffer(NULL), _buffer_size(0), _next_chunk_size(first_chunk_size), _used(0)
+			{}
+
+		// the buffer is used first and must outlive the arena
+		arena(void* buffer, size_t size, size_t next_chunk_size = default_chunk_size)
+			: _cursor(static_cast<char*>(buffer)), _end(static_cast<char*>(buffer) + size), _chunks(NULL), _finalizers(NULL)
+			, _buffer(static_cast<char*>(buffer)), _buffer_size(size), _next_chunk_size(next_chunk_size), _used(0)
+			{}
+
+		~arena()
+		{
+			release();
+		}
+
+		void* allocate(size_t bytes, size_t alignment = default_alignment)
+		{
+			size_t padding = (alignment - reinterpret_cast<uintptr_t>(_cursor) % alignment) % alignment;
+			if (bytes + padding > static_cast<size_t>(_end - _cursor) || bytes + padding < bytes)
+			{
+				return allocate_from_new_chunk(bytes, alignment);
+			}
+			char* p = _cursor + padding;
+			_cursor = p + bytes;
+			_used += bytes;
+			return p;
+		}
+
+		// new T in the arena, destroyed by reset(); with zero, one or two constructor arguments
+		template <class T>
+		T* create()
+		{
+			void* place = allocate_for<T>();
+			T* object = ::new (place) T();
+			register_finalizer(object);
+			return object;
+		}
+
+		template <class T, class A1>
+		T* create(const A1& a1)
+		{
+			void* place = allocate_for<T>();
+			T* object = ::new (place) T(a1);
+			register_finalizer(object);
+			return object;
+		}
+
+		template <class T, class A1, class A2>
+		T* create(const A1& a1, const A2& a2)
+		{
+			void* place = allocate_for<T>();
+			T* object = ::new (place) T(a1, a2);
+			register_finalizer(object);
+			return object;
+		}
+
+		// destroys the created objects and makes all the memory reusable; the biggest chunk is kept
+		// (the next request likely needs as much), the other ones are freed
+		void reset()
+		{
+			run_finalizers();
+			chunk* kept = _chunks;
+			if (kept != NULL)
+			{
+				free_chunks(kept->next);
+				kept->next = NULL;
+				_cursor = kept->data();
+				_end = _cursor + kept->size;
+			}
+			else
+			{
+				_cursor = _buffer;
+				_end = _buffer + _buffer_size;
+			}
+			_used = 0;
+		}
+
+		// reset() and gives every chunk back to the heap
+		void release()
+		{
+			run_finalizers();
+			free_chunks(_chunks);
+			_chunks = NULL;
+			_cursor = _buffer;
+			_end = _buffer + _buffer_size;
+			_used = 0;
+		}
+
+		// the bytes handed out since the last reset, and the bytes held (chunks and buffer)
+		size_t bytes_used() const
+		{
+			return _used;
+		}
+
+		size_t bytes_reserved() const
+		{
+			size_t total = _buffer_size;
+			for (chunk* c = _chunks; c != NULL; c = c->next)
+			{
+				total += c->size;
+			}
+			return total;
+		}
+
+	private:
+		arena(const arena&);
+		arena& operator=(const arena&);
+
+		// chunks are a header followed by their data, newest (and biggest) first
+		struct chunk
+		{
+			chunk*	next;
+			size_t	size;
+
+			char* data()
+			{
+				return reinterpret_cast<char*>(this) + header_size();
+			}
+
+			static size_t header_size()
+			{
+				return (sizeof(chunk) + default_alignment - 1) / default_alignment * default_alignment;
+			}
+		};
+
+		struct finalizer
+		{
+			finalizer*	next;
+			void		(*destroy)(void*);
+			void*		object;
+		};
+
+		template <class T>
+		struct alignment_of
+		{
+			struct probe { char c; T t; };
+			enum { value = sizeof(probe) - sizeof(T) };
+		};
+
+		template <class T>
+		static void destroy_object(void* object)
+		{
+			static_cast<T*>(object)->~T();
+		}
+
+		template <class T>
+		void* allocate_for()
+		{
+			return allocate(sizeof(T), alignment_of<T>::value);
+		}
+
+		template <class T>
+		void register_finalizer(T* object)
+		{
+			if (ft::is_trivially_destructible<T>::value)
+			{
+				return;
+			}
+			finalizer* f;
+			try
+			{
+				f = static_cast<finalizer*>(allocate(sizeof(finalizer), alignment_of<finalizer>::value));
+			}
+			catch (...)
+			{
+				object->~T();
+				throw;
+			}
+			f->next = _finalizers;
+			f->destroy = &destroy_object<T>;
+			f->object = object;
+			_finalizers = f;
+		}
+
+		void run_finalizers()
+		{
+			while (_finalizers != NULL)
+			{
+				finalizer* f = _finalizers;
+				_finalizers = f->next;
+				f->destroy(f->object);
+			}
+		}
+
+		void* allocate_from_new_chunk(size_t bytes, size_t alignment)
+		{
+			// a chunk of bytes + alignment (plus its header) must not wrap around to a small one
+			if (bytes > static_cast<size_t>(-1) - alignment - chunk::header_size())
+			{
+				throw std::bad_alloc();
+			}
+			size_t size = _next_chunk_size;
+			if (size < bytes + alignment)
+			{
+				size = bytes + alignment;
+			}
+			chunk* c = static_cast<chunk*>(::operator new(chunk::header_size() + size));
+			c->size = size;
+			// the head stays the biggest chunk, the one reset() keeps
+			if (_chunks == NULL || _chunks->size <= size)
+			{
+				c->next = _chunks;
+				_chunks = c;
+			}
+			else
+			{
+				c->next = _chunks->next;
+				_chunks->next = c;
+			}
+			if (_next_chunk_size < max_chunk_size)
+			{
+				_next_chunk_size *= 2;
+			}
+			_cursor = c->data();
+			_end = _cursor + size;
+			return allocate(bytes, alignment);
+		}
+
+		static void free_chunks(chunk* c)
+		{
+			while (c != NULL)
+			{
+				chunk* next = c->next;
+				::operator delete(c);
+				c = next;
+			}
+		}
+
+		char*		_cursor;
+		char*		_end;
+		chunk*		_chunks;
+		finalizer*	_finalizers;
+		char*		_buffer;
+		size_t		_buffer_size;
+		size_t		_next_chunk_size;
+		size_t		_used;
+	};
+
+	// An allocator for the Alloc parameter of every ft container: allocate() takes from an arena, deallocate()
+	// does nothing, the memory comes back when the arena is reset. Rebinds to the node types of map and set.
+	// A default constructed one has no arena and throws std::bad_alloc if it is asked for memory: a container must
+	// be given the arena.
+	// Containers using it must not outlive the arena, nor be used after its reset().
+	template <class T>
+	class arena_allocator
+	{
+	public:
+		typedef T					value_type;
+		typedef T*					pointer;
+		typedef const T*			const_pointer;
+		typedef T&					reference;
+		typedef const T&			const_reference;
+		typedef size_t				size_type;
+		typedef std::ptrdiff_t		difference_type;
+
+		template <class U>
+		struct rebind
+		{
+			typedef arena_allocator<U> other;
+		};
+
+		arena_allocator() : _arena(NULL) {}
+
+		// not explicit: a container can be given the arena directly, ft::vector<int, arena_allocator<int> > v(my_arena)
+		arena_allocator(ft::arena& source) : _arena(&source) {}
+
+		template <class U>
+		arena_allocator(const arena_allocator<U>& other) : _arena(other.source()) {}
+
+		pointer allocate(size_type n, const void* = 0)
+		{
+			if (n > max_size() || _arena == NULL)
+			{
+				throw std::bad_alloc();
+			}
+			return static_cast<pointer>(_arena->allocate(n * sizeof(T), alignment()));
+		}
+
+		void deallocate(pointer, size_type) {}
+
+		void construct(pointer p, const T& value)
+		{
+			::new (static_cast<void*>(p)) T(value);
+		}
+
+		void destroy(pointer p)
+		{
+			p->~T();
+		}
+
+		size_type max_size() const
+		{
+			return static_cast<size_type>(-1) / sizeof(T);
+		}
+
+		pointer address(reference x) const
+		{
+			return &x;
+		}
+
+		const_pointer address(const_reference x) const
+		{
+			return &x;
+		}
+
+		ft::arena* source() const
+		{
+			return _arena;
+		}
+
+	private:
+		static size_t alignment()
+		{
+			struct probe { char c; T t; };
+			return sizeof(probe) - sizeof(T);
+		}
+
+		ft::arena*	_arena;
+	};
+
+	template <class T, class U>
+	bool operator==(const arena_allocator<T>& lhs, const arena_allocator<U>& rhs)
+	{
+		return lhs.source() == rhs.source();
+	}
+
+	template <class T, class U>
+	bool operator!=(const arena_allocator<T>& lhs, const arena_allocator<U>& rhs)
+	{
+		return lhs.source() != rhs.source();
+	}
+
+	template <class T>
+	struct is_monotonic_allocator<arena_allocator<T> > : ft::true_type {};
+}
+
+#endif
@@ -0,0 +1,251 @@
+#ifndef EPOCH_DOMAIN_HPP
+#define EPOCH_DOMAIN_HPP
+
+#if __cplusplus < 201103L
+# error "epoch_domain.hpp requires C++11 (std::atomic, thread_local)"
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <stdint.h>
+#include <stdlib.h>
+#include <vector>
+
+namespace ft
+{
+	// Epoch based reclamation.
+	// Readers pin the current epoch (a guard) while they use shared objects: pinning is a couple of stores to the
+	// reader's own record, readers never wait for anybody. Writers unlink an object and retire() it with the
+	// epoch they saw; the global epoch only advances when every pinned reader has seen the current one,
+	// so an object retired in epoch e can't be reached by anyone once the global epoch is e + 2 and is deleted then.
+	// There is one domain per process: each thread owns one record in it, found through a thread_local pointer.
+	class epoch_domain
+	{
+		struct record;
+
+	public:
+		class guard
+		{
+		public:
+			guard() : _record(epoch_domain::instance().pin()) {}
+			guard(guard&& other) : _record(other._record)
+			{
+				other._record = NULL;
+			}
+			~guard()
+			{
+				if (_record != NULL)
+				{
+					epoch_domain::instance().unpin(_record);
+				}
+			}
+
+		private:
+			guard(const guard&);
+			guard& operator=(const guard&);
+
+			record* _record;
+		};
+
+		static epoch_domain& instance()
+		{
+			static epoch_domain domain;
+			return domain;
+		}
+
+		// the object must already be unreachable for new readers
+		template <typename T>
+		void retire(T* object)
+		{
+			retire(object, &delete_object<T>);
+		}
+
+		void retire(void* object, void (*deleter)(void*))
+		{
+			std::lock_guard<std::mutex> lock(_retired_mutex);
+			retired_object retired = { object, deleter, _epoch.load(std::memory_order_seq_cst) };
+			_retired.push_back(retired);
+		}
+
+		// tries to advance the epoch and deletes what can't be reached anymore; never blocks on readers
+		void reclaim()
+		{
+			try_advance();
+			std::vector<retired_object> ready;
+			{
+				std::lock_guard<std::mutex> lock(_retired_mutex);
+				uint64_t epoch = _epoch.load(std::memory_order_acquire);
+				size_t kept = 0;
+				for (size_t i = 0; i < _retired.size(); ++i)
+				{
+					if (_retired[i].epoch + 2 <= epoch)
+					{
+						ready.push_back(_retired[i]);
+					}
+					else
+					{
+						_retired[kept++] = _retired[i];
+					}
+				}
+				_retired.resize(kept);
+			}
+			for (size_t i = 0; i < ready.size(); ++i)
+			{
+				ready[i].deleter(ready[i].object);
+			}
+		}
+
+		size_t pending() const
+		{
+			std::lock_guard<std::mutex> lock(_retired_mutex);
+			return _retired.size();
+		}
+
+		uint64_t epoch() const
+		{
+			return _epoch.load(std::memory_order_acquire);
+		}
+
+	private:
+		// a record is only written by its owner thread (apart from in_use), it has a cache line of its own
+		struct alignas(64) record
+		{
+			std::atomic<uint64_t>	pinned;		// (epoch << 1) | 1 while pinned, 0 otherwise
+			std::atomic<bool>		in_use;
+			record*					next;
+			unsigned				nesting;
+
+			record() : pinned(0), in_use(true), next(NULL), nesting(0) {}
+		};
+
+		// gives the record back to the domain when its thread exits, another thread can take it over
+		struct record_owner
+		{
+			record* owned;
+
+			record_owner() : owned(NULL) {}
+			~record_owner()
+			{
+				if (owned != NULL)
+				{
+					owned->in_use.store(false, std::memory_order_release);
+				}
+			}
+		};
+
+		struct retired_object
+		{
+			void*		object;
+			void		(*deleter)(void*);
+			uint64_t	epoch;
+		};
+
+		std::atomic<uint64_t>		_epoch;
+		std::atomic<record*>		_records;
+		mutable std::mutex			_retired_mutex;
+		std::vector<retired_object>	_retired;
+
+		epoch_domain() : _epoch(1), _records(NULL) {}
+		epoch_domain(const epoch_domain&);
+		epoch_domain& operator=(const epoch_domain&);
+
+		~epoch_domain()
+		{
+			for (size_t i = 0; i < _retired.size(); ++i)
+			{
+				_retired[i].deleter(_retired[i].object);
+			}
+			record* r = _records.load();
+			while (r != NULL)
+			{
+				record* next = r->next;
+				r->~record();
+				free(r);
+				r = next;
+			}
+		}
+
+		template <typename T>
+		static void delete_object(void* object)
+		{
+			delete static_cast<T*>(object);
+		}
+
+		record* local_record()
+		{
+			static thread_local record_owner owner;
+			if (owner.owned == NULL)
+			{
+				owner.owned = acquire_record();
+			}
+			return owner.owned;
+		}
+
+		// reuses the record of an exited thread or pushes a new one, records are never unlinked
+		record* acquire_record()
+		{
+			for (record* r = _records.load(std::memory_order_acquire); r != NULL; r = r->next)
+			{
+				bool expected = false;
+				if (!r->in_use.load(std::memory_order_relaxed)
+					&& r->in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+				{
+					return r;
+				}
+			}
+			// plain new only aligns to 16 bytes before C++17
+			void* memory = NULL;
+			if (posix_memalign(&memory, alignof(record), sizeof(record)) != 0)
+			{
+				throw std::bad_alloc();
+			}
+			record* r = ::new (memory) record();
+			record* head = _records.load(std::memory_order_relaxed);
+			do
+			{
+				r->next = head;
+			} while (!_records.compare_exchange_weak(head, r, std::memory_order_release, std::memory_order_relaxed));
+			return r;
+		}
+
+		record* pin()
+		{
+			record* r = local_record();
+			if (r->nesting++ == 0)
+			{
+				// the announcement must be visible before the reader loads any shared pointer
+				r->pinned.store((_epoch.load(std::memory_order_relaxed) << 1) | 1, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+			}
+			return r;
+		}
+
+		void unpin(record* r)
+		{
+			if (--r->nesting == 0)
+			{
+				r->pinned.store(0, std::memory_order_release);
+			}
+		}
+
+		// the epoch moves on only if no pinned reader is still in an older one
+		void try_advance()
+		{
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			uint64_t epoch = _epoch.load(std::memory_order_relaxed);
+			for (record* r = _records.load(std::memory_order_acquire); r != NULL; r = r->next)
+			{
+				uint64_t pinned = r->pinned.load(std::memory_order_acquire);
+				if ((pinned & 1) != 0 && (pinned >> 1) != epoch)
+				{
+					return;
+				}
+			}
+			_epoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order_acq_rel);
+		}
+	};
+}
+
+#endif
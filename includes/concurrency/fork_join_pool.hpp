@@ -0,0 +1,387 @@
+#ifndef FORK_JOIN_POOL_HPP
+#define FORK_JOIN_POOL_HPP
+
+#if __cplusplus < 201103L
+# error "fork_join_pool.hpp requires C++11 (std::thread, thread_local)"
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <new>
+#include <stdint.h>
+#include <stdlib.h>
+#include <thread>
+#include <utility>
+
+#include "../vector.hpp"
+#include "../ws_deque.hpp"
+
+namespace ft
+{
+	// Fork-join thread pool on work-stealing deques.
+	// Every worker owns a ws_deque of jobs. fork_join(f, g) called from a job pushes g to the worker's own deque,
+	// runs f and then pops g back to run it too, unless an idle worker has stolen it meanwhile: then the worker
+	// helps (steals and runs other jobs) until g is done. So the deque operations are local and lock free,
+	// the only shared work is stealing, which idle workers do from the oldest (biggest) end of the deques.
+	// Jobs live on the stack of the thread that waits for them, nothing is allocated per fork.
+	//     pool.run([&]() { pool.fork_join([&]() { left(); }, [&]() { right(); }); });
+	// The mutex is only taken to submit a run() from outside the pool and to put idle workers to sleep / wake them.
+	class fork_join_pool
+	{
+	public:
+		explicit fork_join_pool(unsigned threads = std::thread::hardware_concurrency())
+			: _stop(false), _sleeping(0), _wake_ups(0)
+		{
+			if (threads == 0)
+			{
+				threads = 1;
+			}
+			_workers.reserve(threads);
+			for (unsigned i = 0; i < threads; ++i)
+			{
+				_workers.push_back(new_worker(*this, i));
+			}
+			for (unsigned i = 0; i < threads; ++i)
+			{
+				_workers[i]->thread = std::thread(&fork_join_pool::work, this, _workers[i]);
+			}
+		}
+
+		// waits for the workers; no run() may be in progress
+		~fork_join_pool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_stop.store(true, std::memory_order_relaxed);
+				++_wake_ups;
+			}
+			_wake.notify_all();
+			for (size_t i = 0; i < _workers.size(); ++i)
+			{
+				_workers[i]->thread.join();
+			}
+			// only now: until its thread has stopped, a worker may still look at the others' deques
+			for (size_t i = 0; i < _workers.size(); ++i)
+			{
+				delete_worker(_workers[i]);
+			}
+		}
+
+		size_t size() const
+		{
+			return _workers.size();
+		}
+
+		// runs f() on the pool and waits for it (and everything it forked); an exception thrown by f is rethrown here.
+		// Called from a job of this pool, f just runs inline.
+		template <typename F>
+		void run(F&& f)
+		{
+			if (current_worker() != NULL && &current_worker()->pool == this)
+			{
+				f();
+				return;
+			}
+			job_for<F> root(f);
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_submitted.push_back(&root);
+				++_wake_ups;
+			}
+			_wake.notify_one();
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				_finished.wait(lock, [&root]() { return root.done.load(std::memory_order_acquire); });
+			}
+			root.rethrow();
+		}
+
+		// runs f() and g() in parallel, returns when both are done; outside the pool, it is run() of both
+		template <typename F, typename G>
+		void fork_join(F&& f, G&& g)
+		{
+			worker* self = current_worker();
+			if (self == NULL || &self->pool != this)
+			{
+				run([&]() { fork_join(f, g); });
+				return;
+			}
+			job_for<G> forked(g);
+			self->jobs.push(&forked);
+			wake_one();
+			try
+			{
+				f();
+			}
+			catch (...)
+			{
+				join(self, forked);
+				throw;
+			}
+			join(self, forked);
+			forked.rethrow();
+		}
+
+		// jobs taken from another worker's deque since the start
+		size_t steals() const
+		{
+			size_t total = 0;
+			for (size_t i = 0; i < _workers.size(); ++i)
+			{
+				total += _workers[i]->steals.load(std::memory_order_relaxed);
+			}
+			return total;
+		}
+
+	private:
+		fork_join_pool(const fork_join_pool&);
+		fork_join_pool& operator=(const fork_join_pool&);
+
+		struct job
+		{
+			std::atomic<bool>	done;
+			std::exception_ptr	error;
+
+			job() : done(false) {}
+			virtual ~job() {}
+
+			void execute()
+			{
+				try
+				{
+					call();
+				}
+				catch (...)
+				{
+					error = std::current_exception();
+				}
+				done.store(true, std::memory_order_release);
+			}
+
+			void rethrow()
+			{
+				if (error)
+				{
+					std::rethrow_exception(error);
+				}
+			}
+
+		private:
+			virtual void call() = 0;
+		};
+
+		template <typename F>
+		struct job_for : job
+		{
+			F& function;
+
+			explicit job_for(F& f) : function(f) {}
+
+		private:
+			void call()
+			{
+				function();
+			}
+		};
+
+		struct worker
+		{
+			fork_join_pool&			pool;
+			size_t					index;
+			ws_deque<job*>			jobs;
+			std::thread				thread;
+			std::atomic<size_t>		steals;
+			uint32_t				random_state;
+
+			worker(fork_join_pool& p, size_t i) : pool(p), index(i), steals(0), random_state(static_cast<uint32_t>(i) * 2654435761u + 1) {}
+		};
+
+		// the deque's ends have cache lines of their own, which plain new doesn't honour before C++17
+		static worker* new_worker(fork_join_pool& p, size_t i)
+		{
+			void* memory = NULL;
+			if (posix_memalign(&memory, alignof(worker), sizeof(worker)) != 0)
+			{
+				throw std::bad_alloc();
+			}
+			return ::new (memory) worker(p, i);
+		}
+
+		static void delete_worker(worker* w)
+		{
+			w->~worker();
+			free(w);
+		}
+
+		ft::vector<worker*>			_workers;
+		std::atomic<bool>			_stop;
+		std::atomic<int>			_sleeping;
+		uint64_t					_wake_ups; // under _mutex: a sleeping worker waits for it to change
+		ft::vector<job*>			_submitted; // under _mutex: the run() jobs from outside the pool
+		std::mutex					_mutex;
+		std::condition_variable		_wake;
+		std::condition_variable		_finished;
+
+		static worker*& current_worker()
+		{
+			static thread_local worker* current = NULL;
+			return current;
+		}
+
+		void work(worker* self)
+		{
+			current_worker() = self;
+			while (true)
+			{
+				job* next = find_job(self);
+				if (next != NULL)
+				{
+					next->execute();
+					continue;
+				}
+				if (!sleep())
+				{
+					return;
+				}
+			}
+		}
+
+		void execute_submitted(job* root)
+		{
+			root->execute();
+			{
+				// the waiting thread checks done under the mutex, it can't miss the notification
+				std::lock_guard<std::mutex> lock(_mutex);
+			}
+			_finished.notify_all();
+		}
+
+		// own deque first (the newest job, its data is still in the cache), then the others
+		job* find_job(worker* self)
+		{
+			job* found = NULL;
+			if (self->jobs.pop(found))
+			{
+				return found;
+			}
+			return steal(self);
+		}
+
+		// one round over the other deques, starting at a random one so the thieves spread out
+		job* steal(worker* self)
+		{
+			const size_t count = _workers.size();
+			size_t start = next_random(self) % count;
+			job* found = NULL;
+			for (size_t i = 0; i < count; ++i)
+			{
+				worker* victim = _workers[(start + i) % count];
+				if (victim != self && victim->jobs.steal(found))
+				{
+					self->steals.fetch_add(1, std::memory_order_relaxed);
+					return found;
+				}
+			}
+			return NULL;
+		}
+
+		// waits until forked is done, running other jobs meanwhile
+		void join(worker* self, job& forked)
+		{
+			job* next = NULL;
+			// nothing forked after it is left in the deque: if the deque isn't empty, its bottom is our job
+			if (self->jobs.pop(next))
+			{
+				next->execute();
+				return;
+			}
+			while (!forked.done.load(std::memory_order_acquire))
+			{
+				next = steal(self);
+				if (next != NULL)
+				{
+					next->execute();
+				}
+				else
+				{
+					std::this_thread::yield();
+				}
+			}
+		}
+
+		// false when the pool stops
+		bool sleep()
+		{
+			for (int spin = 0; spin < 64; ++spin)
+			{
+				if (_stop.load(std::memory_order_relaxed))
+				{
+					return false;
+				}
+				std::this_thread::yield();
+				if (any_job())
+				{
+					return true;
+				}
+			}
+			std::unique_lock<std::mutex> lock(_mutex);
+			if (!_submitted.empty())
+			{
+				job* root = _submitted.back();
+				_submitted.pop_back();
+				lock.unlock();
+				execute_submitted(root);
+				return true;
+			}
+			uint64_t wake_ups = _wake_ups;
+			_sleeping.fetch_add(1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with the fence of wake_one()
+			// a fork after this check sees _sleeping > 0 and increments _wake_ups under the mutex
+			if (!any_job() && !_stop.load(std::memory_order_relaxed))
+			{
+				_wake.wait(lock, [&]() { return _wake_ups != wake_ups; });
+			}
+			_sleeping.fetch_sub(1, std::memory_order_relaxed);
+			return !_stop.load(std::memory_order_relaxed);
+		}
+
+		bool any_job() const
+		{
+			for (size_t i = 0; i < _workers.size(); ++i)
+			{
+				if (!_workers[i]->jobs.empty())
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void wake_one()
+		{
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (_sleeping.load(std::memory_order_relaxed) > 0)
+			{
+				{
+					std::lock_guard<std::mutex> lock(_mutex);
+					++_wake_ups;
+				}
+				_wake.notify_one();
+			}
+		}
+
+		static uint32_t next_random(worker* self)
+		{
+			uint32_t& state = self->random_state;
+			state ^= state << 13; // xorshift32
+			state ^= state >> 17;
+			state ^= state << 5;
+			return state;
+		}
+	};
+}
+
+#endif
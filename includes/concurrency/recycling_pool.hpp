@@ -0,0 +1,140 @@
+#ifndef RECYCLING_POOL_HPP
+#define RECYCLING_POOL_HPP
+
+#if __cplusplus < 201103L
+# error "recycling_pool.hpp requires C++11"
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+namespace ft
+{
+	// Node memory for lock-free containers.
+	// Freed nodes go to a cache of the freeing thread and are handed out again by that thread without any
+	// synchronization; only a cache that runs empty (or overflows, or belongs to an exiting thread) touches the shared list.
+	// New nodes are allocated by chunks. The memory is type-stable: nodes are never given back to the system,
+	// so a lock-free reader may still load a field of a node that another thread has just recycled
+	// (the version tag of its CAS then fails). Node must have a default constructor and a std::atomic<Node*> next.
+	// All the containers of one node type share the pool.
+	template <typename Node>
+	class recycling_pool
+	{
+		static_assert(alignof(Node) <= alignof(std::max_align_t), "chunks are only aligned for the fundamental types");
+
+	public:
+		static Node* allocate()
+		{
+			local_cache& local = cache();
+			if (local.head == NULL)
+			{
+				refill(local);
+			}
+			Node* node = local.head;
+			local.head = node->next.load(std::memory_order_relaxed);
+			--local.count;
+			return node;
+		}
+
+		static void deallocate(Node* node)
+		{
+			local_cache& local = cache();
+			node->next.store(local.head, std::memory_order_relaxed);
+			local.head = node;
+			if (++local.count > cache_limit)
+			{
+				give_back(local, cache_limit / 2);
+			}
+		}
+
+		// chunks allocated since the start: it stays flat in a steady state
+		static size_t chunks_allocated()
+		{
+			return chunk_counter().load(std::memory_order_relaxed);
+		}
+
+	private:
+		enum { chunk_nodes = 64, cache_limit = 256 };
+
+		struct local_cache
+		{
+			Node*	head;
+			size_t	count;
+
+			local_cache() : head(NULL), count(0) {}
+			~local_cache()
+			{
+				recycling_pool::give_back(*this, count);
+			}
+		};
+
+		static local_cache& cache()
+		{
+			static thread_local local_cache local;
+			return local;
+		}
+
+		// nodes are only pushed to the shared list or taken all at once, so its head needs no version tag
+		static std::atomic<Node*>& shared_head()
+		{
+			static std::atomic<Node*> head(NULL);
+			return head;
+		}
+
+		static std::atomic<size_t>& chunk_counter()
+		{
+			static std::atomic<size_t> counter(0);
+			return counter;
+		}
+
+		static void refill(local_cache& local)
+		{
+			Node* taken = shared_head().exchange(NULL, std::memory_order_acquire);
+			if (taken != NULL)
+			{
+				local.head = taken;
+				for (Node* node = taken; node != NULL; node = node->next.load(std::memory_order_relaxed))
+				{
+					++local.count;
+				}
+				return;
+			}
+			Node* chunk = static_cast<Node*>(::operator new(sizeof(Node) * chunk_nodes));
+			chunk_counter().fetch_add(1, std::memory_order_relaxed);
+			for (size_t i = 0; i < chunk_nodes; ++i)
+			{
+				new (chunk + i) Node();
+				chunk[i].next.store(i + 1 < chunk_nodes ? chunk + i + 1 : NULL, std::memory_order_relaxed);
+			}
+			local.head = chunk;
+			local.count = chunk_nodes;
+		}
+
+		// moves the first count nodes of the cache to the shared list as one chain
+		static void give_back(local_cache& local, size_t count)
+		{
+			if (count == 0 || local.head == NULL)
+			{
+				return;
+			}
+			Node* first = local.head;
+			Node* last = first;
+			size_t moved = 1;
+			for (; moved < count && last->next.load(std::memory_order_relaxed) != NULL; ++moved)
+			{
+				last = last->next.load(std::memory_order_relaxed);
+			}
+			local.head = last->next.load(std::memory_order_relaxed);
+			local.count -= moved;
+			std::atomic<Node*>& head = shared_head();
+			Node* old_head = head.load(std::memory_order_relaxed);
+			do
+			{
+				last->next.store(old_head, std::memory_order_relaxed);
+			} while (!head.compare_exchange_weak(old_head, first, std::memory_order_release, std::memory_order_relaxed));
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,136 @@
+#ifndef RW_SPINLOCK_HPP
+#define RW_SPINLOCK_HPP
+
+#if __cplusplus < 201103L
+# error "rw_spinlock.hpp requires C++11 (std::atomic)"
+#endif
+
+#include <atomic>
+#include <stdint.h>
+#include <thread>
+
+namespace ft
+{
+	// Reader-writer spinlock in one 32-bit word: bit 0 is held by a writer, bit 1 is set by a writer waiting for
+	// the readers to leave, the upper bits count the readers. A waiting writer keeps new readers out, so a steady
+	// stream of readers can't starve it. Meant for short critical sections (one tree operation): the lock is one
+	// atomic instruction when it is free, and a waiter spins a little before yielding its time slice.
+	// Satisfies Lockable and SharedLockable, so std::lock_guard / std::unique_lock work with lock() / unlock().
+	class rw_spinlock
+	{
+	public:
+		rw_spinlock() : _state(0) {}
+
+		void lock()
+		{
+			uint32_t state = _state.load(std::memory_order_relaxed);
+			for (unsigned spins = 0; ; ++spins)
+			{
+				if ((state & ~uint32_t(writer_waiting)) == 0)
+				{
+					// clears writer_waiting: the other waiting writers set it again
+					if (_state.compare_exchange_weak(state, writer, std::memory_order_acquire, std::memory_order_relaxed))
+					{
+						return;
+					}
+					continue;
+				}
+				if ((state & writer_waiting) == 0)
+				{
+					_state.fetch_or(writer_waiting, std::memory_order_relaxed);
+				}
+				backoff(spins);
+				state = _state.load(std::memory_order_relaxed);
+			}
+		}
+
+		bool try_lock()
+		{
+			uint32_t state = _state.load(std::memory_order_relaxed);
+			return (state & ~uint32_t(writer_waiting)) == 0
+				&& _state.compare_exchange_strong(state, writer, std::memory_order_acquire, std::memory_order_relaxed);
+		}
+
+		void unlock()
+		{
+			_state.fetch_sub(writer, std::memory_order_release);
+		}
+
+		void lock_shared()
+		{
+			uint32_t state = _state.load(std::memory_order_relaxed);
+			for (unsigned spins = 0; ; ++spins)
+			{
+				if ((state & (writer | writer_waiting)) == 0)
+				{
+					if (_state.compare_exchange_weak(state, state + reader, std::memory_order_acquire, std::memory_order_relaxed))
+					{
+						return;
+					}
+					continue;
+				}
+				backoff(spins);
+				state = _state.load(std::memory_order_relaxed);
+			}
+		}
+
+		bool try_lock_shared()
+		{
+			uint32_t state = _state.load(std::memory_order_relaxed);
+			return (state & (writer | writer_waiting)) == 0
+				&& _state.compare_exchange_strong(state, state + reader, std::memory_order_acquire, std::memory_order_relaxed);
+		}
+
+		void unlock_shared()
+		{
+			_state.fetch_sub(reader, std::memory_order_release);
+		}
+
+	private:
+		enum { writer = 1, writer_waiting = 2, reader = 4 };
+		enum { spins_before_yield = 64 };
+
+		rw_spinlock(const rw_spinlock&);
+		rw_spinlock& operator=(const rw_spinlock&);
+
+		static void backoff(unsigned spins)
+		{
+			if (spins >= spins_before_yield)
+			{
+				std::this_thread::yield();
+			}
+#if defined(__x86_64__) || defined(__i386__)
+			else
+			{
+				__builtin_ia32_pause();
+			}
+#endif
+		}
+
+		std::atomic<uint32_t>	_state;
+	};
+
+	// RAII shared lock, std::shared_lock is C++14
+	template <class SharedLockable>
+	class shared_lock_guard
+	{
+	public:
+		explicit shared_lock_guard(SharedLockable& lock) : _lock(lock)
+		{
+			_lock.lock_shared();
+		}
+
+		~shared_lock_guard()
+		{
+			_lock.unlock_shared();
+		}
+
+	private:
+		shared_lock_guard(const shared_lock_guard&);
+		shared_lock_guard& operator=(const shared_lock_guard&);
+
+		SharedLockable&	_lock;
+	};
+}
+
+#endif
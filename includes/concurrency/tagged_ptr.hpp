@@ -0,0 +1,49 @@
+#ifndef TAGGED_PTR_HPP
+#define TAGGED_PTR_HPP
+
+#if __cplusplus < 201103L
+# error "tagged_ptr.hpp requires C++11"
+#endif
+
+#include <cassert>
+#include <stdint.h>
+
+namespace ft
+{
+	// A pointer and a version tag packed into one 64-bit word, so both are compared and swapped by a single CAS.
+	// Every successful CAS stores tag + 1: a pointer that was popped and pushed back in between (ABA) doesn't match anymore.
+	// On 64-bit platforms user space addresses fit in 48 bits, the 16 upper bits hold the tag (it wraps after 65536 updates,
+	// a thread would have to sleep exactly that long between its load and its CAS). On 32-bit the tag gets 32 bits.
+	// Addresses above 48 bits (5-level paging with a kernel that hands them out, some pointer tagging schemes) don't fit:
+	// pack() asserts it, release builds would silently lose the upper bits.
+	template <typename T>
+	struct tagged_ptr
+	{
+		static const unsigned	pointer_bits = sizeof(void*) == 8 ? 48 : 32;
+		static const uint64_t	pointer_mask = (uint64_t(1) << pointer_bits) - 1;
+
+		static uint64_t pack(T* pointer, uint64_t tag)
+		{
+			assert((static_cast<uint64_t>(reinterpret_cast<uintptr_t>(pointer)) >> pointer_bits) == 0);
+			return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(pointer)) | (tag << pointer_bits);
+		}
+
+		static T* pointer(uint64_t word)
+		{
+			return reinterpret_cast<T*>(static_cast<uintptr_t>(word & pointer_mask));
+		}
+
+		static uint64_t tag(uint64_t word)
+		{
+			return word >> pointer_bits;
+		}
+
+		// the value to store in place of word
+		static uint64_t next(uint64_t word, T* pointer)
+		{
+			return pack(pointer, tag(word) + 1);
+		}
+	};
+}
+
+#endif
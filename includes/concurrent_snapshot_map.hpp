@@ -0,0 +1,154 @@
+#ifndef CONCURRENT_SNAPSHOT_MAP_HPP
+#define CONCURRENT_SNAPSHOT_MAP_HPP
+
+#if __cplusplus < 201103L
+# error "concurrent_snapshot_map.hpp requires C++11 (std::atomic, std::mutex)"
+#endif
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "map.hpp"
+#include "concurrency/epoch_domain.hpp"
+
+namespace ft
+{
+	// A read-mostly map shared between threads.
+	// The current version is an immutable ft::map published through an atomic pointer. Readers pin the epoch
+	// and use that version without taking any lock: find() never waits, whatever the writers are doing.
+	// Writers are serialized by a mutex, apply their changes to a copy of the current version and publish it;
+	// the old version is retired to the epoch_domain and deleted once no reader can still hold it.
+	// A write copies the whole map, so changes should be batched with update().
+	template < class Key,
+			class T,
+			class Compare = ::std::less<Key>,
+			class Alloc = std::allocator<ft::pair<const Key,T> >
+			>
+	class concurrent_snapshot_map
+	{
+	public:
+		typedef ft::map<Key, T, Compare, Alloc>			map_type;
+		typedef typename map_type::key_type				key_type;
+		typedef typename map_type::mapped_type			mapped_type;
+		typedef typename map_type::value_type			value_type;
+		typedef typename map_type::size_type			size_type;
+
+		// keeps a version alive while it is used: the map must not be accessed after the snapshot is destroyed
+		class snapshot
+		{
+		public:
+			snapshot(snapshot&& other) : _guard(std::move(other._guard)), _map(other._map) {}
+
+			const map_type& operator*() const
+			{
+				return *_map;
+			}
+			const map_type* operator->() const
+			{
+				return _map;
+			}
+
+		private:
+			friend class concurrent_snapshot_map;
+
+			explicit snapshot(const std::atomic<const map_type*>& current)
+				: _guard()
+				, _map(current.load(std::memory_order_acquire))
+				{}
+			snapshot(const snapshot&);
+			snapshot& operator=(const snapshot&);
+
+			epoch_domain::guard	_guard;
+			const map_type*		_map;
+		};
+
+		explicit concurrent_snapshot_map(const Compare& comp = Compare(), const Alloc& alloc = Alloc())
+			: _current(new map_type(comp, alloc))
+			{}
+
+		explicit concurrent_snapshot_map(const map_type& initial)
+			: _current(new map_type(initial))
+			{}
+
+		// no reader may be using the map anymore
+		~concurrent_snapshot_map()
+		{
+			delete _current.load(std::memory_order_relaxed);
+		}
+
+		// READERS (lock-free and wait-free):
+		// all the lookups of one snapshot see the same version
+		snapshot read() const
+		{
+			return snapshot(_current);
+		}
+
+		// copies the mapped value out, so nothing has to stay pinned
+		bool find(const key_type& key, mapped_type& value) const
+		{
+			snapshot version(_current);
+			typename map_type::const_iterator it = version->find(key);
+			if (it == version->end())
+			{
+				return false;
+			}
+			value = it->second;
+			return true;
+		}
+
+		bool contains(const key_type& key) const
+		{
+			snapshot version(_current);
+			return version->find(key) != version->end();
+		}
+
+		size_type size() const
+		{
+			snapshot version(_current);
+			return version->size();
+		}
+
+		// WRITERS:
+		// fn(map_type&) gets a private copy of the current version, all its changes are published at once
+		template <class Function>
+		void update(Function fn)
+		{
+			std::lock_guard<std::mutex> lock(_writer_mutex);
+			const map_type* old_version = _current.load(std::memory_order_relaxed);
+			std::unique_ptr<map_type> new_version(new map_type(*old_version));
+			fn(*new_version);
+			_current.store(new_version.release(), std::memory_order_release);
+			epoch_domain& domain = epoch_domain::instance();
+			domain.retire(const_cast<map_type*>(old_version));
+			domain.reclaim();
+		}
+
+		void insert_or_assign(const key_type& key, const mapped_type& value)
+		{
+			update([&key, &value](map_type& m) { m.insert_or_assign(key, value); });
+		}
+
+		size_type erase(const key_type& key)
+		{
+			size_type erased = 0;
+			update([&key, &erased](map_type& m) { erased = m.erase(key); });
+			return erased;
+		}
+
+		void clear()
+		{
+			update([](map_type& m) { m.clear(); });
+		}
+
+	private:
+		concurrent_snapshot_map(const concurrent_snapshot_map&);
+		concurrent_snapshot_map& operator=(const concurrent_snapshot_map&);
+
+		std::atomic<const map_type*>	_current;
+		std::mutex						_writer_mutex;
+	};
+}
+
+#endif
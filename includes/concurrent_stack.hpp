@@ -0,0 +1,252 @@
+#ifndef CONCURRENT_STACK_HPP
+#define CONCURRENT_STACK_HPP
+
+#if __cplusplus < 201103L
+# error "concurrent_stack.hpp requires C++11 (std::atomic, thread_local)"
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "concurrency/recycling_pool.hpp"
+#include "concurrency/tagged_ptr.hpp"
+
+namespace ft
+{
+    // Lock-free LIFO for many threads (Treiber stack).
+    // The head is a tagged pointer: push and pop are one CAS on it, and the version tag makes a CAS fail when the
+    // head node was popped and reused in between (ABA). When the CAS fails because of contention, the thread tries the
+    // elimination array instead: a push and a pop that meet in a slot exchange the node directly and never touch the head.
+    // Nodes are recycled through per-thread caches (recycling_pool), so a steady state makes no allocations.
+    // top() can't be safe with concurrent pops: try_pop() copies the top out and removes it, size() is approximate.
+    template <class T>
+    class concurrent_stack
+    {
+        struct node;
+
+    public:
+        typedef T           value_type;
+        typedef size_t      size_type;
+        typedef node        node_type; // the nodes come from recycling_pool<node_type>
+
+        concurrent_stack() : _head(0), _size(0) {}
+
+        // no other thread may use the stack anymore
+        ~concurrent_stack()
+        {
+            while (pop())
+            {
+            }
+        }
+
+        bool empty() const
+        {
+            return tagged::pointer(_head.load(std::memory_order_acquire)) == NULL;
+        }
+
+        // exact when no push or pop is in progress
+        size_type size() const
+        {
+            ptrdiff_t size = _size.load(std::memory_order_relaxed);
+            return size < 0 ? 0 : static_cast<size_type>(size);
+        }
+
+        void push(const value_type& val)
+        {
+            node* new_node = node_pool::allocate();
+            try
+            {
+                new (new_node->value()) value_type(val);
+            }
+            catch (...)
+            {
+                node_pool::deallocate(new_node);
+                throw;
+            }
+            uint64_t head = _head.load(std::memory_order_relaxed);
+            while (true)
+            {
+                new_node->next.store(tagged::pointer(head), std::memory_order_relaxed);
+                if (_head.compare_exchange_weak(head, tagged::next(head, new_node), std::memory_order_release, std::memory_order_relaxed))
+                {
+                    _size.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                if (_elimination.try_give(new_node))
+                {
+                    return;
+                }
+                head = _head.load(std::memory_order_relaxed);
+            }
+        }
+
+        // returns false if the stack was empty
+        bool try_pop(value_type& val)
+        {
+            node* top = take();
+            if (top == NULL)
+            {
+                return false;
+            }
+            try
+            {
+                val = std::move(*top->value());
+            }
+            catch (...)
+            {
+                release(top);
+                throw;
+            }
+            release(top);
+            return true;
+        }
+
+        // pops and destroys the top element, false if the stack was empty
+        bool pop()
+        {
+            node* top = take();
+            if (top == NULL)
+            {
+                return false;
+            }
+            release(top);
+            return true;
+        }
+
+    private:
+        concurrent_stack(const concurrent_stack&);
+        concurrent_stack& operator=(const concurrent_stack&);
+
+        struct node
+        {
+            std::atomic<node*>                                                  next; // may be read after the node was recycled
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type          storage;
+
+            node() : next(NULL) {}
+            value_type* value()
+            {
+                return reinterpret_cast<value_type*>(&storage);
+            }
+        };
+
+        typedef ft::tagged_ptr<node>        tagged;
+        typedef ft::recycling_pool<node>    node_pool;
+
+        // A pusher whose CAS failed offers its node in a random slot and spins a little; a popper whose CAS failed
+        // takes the offer of a random slot. Slots are tagged too: the pusher withdraws its offer only if the slot still holds
+        // that same offer, not the same node offered again after a pop recycled it.
+        class elimination_array
+        {
+        public:
+            elimination_array()
+            {
+                for (size_t i = 0; i < slot_count; ++i)
+                {
+                    _slots[i].offer.store(0, std::memory_order_relaxed);
+                }
+            }
+
+            bool try_give(node* offered)
+            {
+                std::atomic<uint64_t>& offer = _slots[random_slot()].offer;
+                uint64_t current = offer.load(std::memory_order_relaxed);
+                if (tagged::pointer(current) != NULL)
+                {
+                    return false;
+                }
+                uint64_t mine = tagged::next(current, offered);
+                if (!offer.compare_exchange_strong(current, mine, std::memory_order_release, std::memory_order_relaxed))
+                {
+                    return false;
+                }
+                for (int spin = 0; spin < spin_count; ++spin)
+                {
+                    if (offer.load(std::memory_order_relaxed) != mine)
+                    {
+                        return true;
+                    }
+                }
+                // withdrawing fails only if a popper took the node in the meantime
+                return !offer.compare_exchange_strong(mine, tagged::next(mine, NULL), std::memory_order_relaxed, std::memory_order_relaxed);
+            }
+
+            node* try_take()
+            {
+                std::atomic<uint64_t>& offer = _slots[random_slot()].offer;
+                uint64_t current = offer.load(std::memory_order_relaxed);
+                node* offered = tagged::pointer(current);
+                if (offered != NULL
+                    && offer.compare_exchange_strong(current, tagged::next(current, NULL), std::memory_order_acquire, std::memory_order_relaxed))
+                {
+                    return offered;
+                }
+                return NULL;
+            }
+
+        private:
+            enum { slot_count = 16, spin_count = 128 };
+
+            struct alignas(64) slot
+            {
+                std::atomic<uint64_t> offer;
+            };
+
+            slot _slots[slot_count];
+
+            static size_t random_slot()
+            {
+                static thread_local uint32_t state = 0;
+                if (state == 0)
+                {
+                    state = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&state)) | 1; // a different seed per thread
+                }
+                state ^= state << 13; // xorshift32
+                state ^= state >> 17;
+                state ^= state << 5;
+                return state % slot_count;
+            }
+        };
+
+        // the head and the size change on every operation: they don't share a cache line with each other or the slots
+        alignas(64) std::atomic<uint64_t>   _head;
+        alignas(64) std::atomic<ptrdiff_t>  _size;
+        elimination_array                   _elimination;
+
+        // unlinks the top node, from the stack or from a pusher in the elimination array
+        node* take()
+        {
+            uint64_t head = _head.load(std::memory_order_acquire);
+            while (true)
+            {
+                node* top = tagged::pointer(head);
+                if (top == NULL)
+                {
+                    return NULL;
+                }
+                node* next = top->next.load(std::memory_order_relaxed);
+                if (_head.compare_exchange_weak(head, tagged::next(head, next), std::memory_order_acquire, std::memory_order_acquire))
+                {
+                    _size.fetch_sub(1, std::memory_order_relaxed);
+                    return top;
+                }
+                node* offered = _elimination.try_take();
+                if (offered != NULL)
+                {
+                    return offered;
+                }
+                head = _head.load(std::memory_order_acquire);
+            }
+        }
+
+        void release(node* old_node)
+        {
+            old_node->value()->~value_type();
+            node_pool::deallocate(old_node);
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,530 @@
+#ifndef FROZEN_MAP_HPP
+#define FROZEN_MAP_HPP
+
+#include <cassert>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "iterator/reverse_iterator.hpp"
+#include "utility/enable_if.hpp"
+#include "utility/ft_swap.hpp"
+#include "utility/is_integral.hpp"
+#include "utility/pair.hpp"
+#include "utility/prefetch.hpp"
+#include "map.hpp"
+#include "set.hpp"
+
+namespace ft
+{
+	// Read-only sets and maps for lookups: the elements are stored in one array in Eytzinger (breadth-first) order.
+	// Slot 1 is the root and the children of slot k are 2k and 2k + 1, so a descent needs no pointer at all. The top
+	// levels of every search are packed in the first few cache lines, which stay in the cache (an ft::set or a
+	// sorted array spreads them over the whole memory). The loop has no branch on the comparison:
+	// k = 2k + (key of k < key). Each step prefetches the 16 (for 4-byte elements) descendants 4 levels down: the
+	// array starts on a cache line, so when the element size divides 64 they share one line, and the misses of the
+	// deep levels overlap. A sorted array gives the same elements
+	// in the same order, only its binary search jumps over the whole array.
+	// Iteration walks the implicit tree in order (index arithmetic, no stack).
+	namespace detail
+	{
+		template <class Key>
+		struct frozen_key_of_key
+		{
+			static const Key& key(const Key& value)
+			{
+				return value;
+			}
+		};
+
+		template <class Value>
+		struct frozen_key_of_pair
+		{
+			static const typename Value::first_type& key(const Value& value)
+			{
+				return value.first;
+			}
+		};
+
+		// in-order moves between the slots 1 .. n of an Eytzinger array; 0 is end()
+		struct eytzinger_order
+		{
+			static size_t first(size_t n)
+			{
+				size_t k = n == 0 ? 0 : 1;
+				while (2 * k <= n && k != 0)
+				{
+					k *= 2;
+				}
+				return k;
+			}
+
+			static size_t next(size_t k, size_t n)
+			{
+				if (2 * k + 1 <= n)
+				{
+					k = 2 * k + 1;
+					while (2 * k <= n)
+					{
+						k *= 2;
+					}
+					return k;
+				}
+				while (k & 1) // up from right children, then once more
+				{
+					k >>= 1;
+				}
+				return k >> 1;
+			}
+
+			static size_t prev(size_t k, size_t n)
+			{
+				if (k == 0)
+				{
+					k = n == 0 ? 0 : 1;
+					while (k != 0 && 2 * k + 1 <= n)
+					{
+						k = 2 * k + 1;
+					}
+					return k;
+				}
+				if (2 * k <= n)
+				{
+					k = 2 * k;
+					while (2 * k + 1 <= n)
+					{
+						k = 2 * k + 1;
+					}
+					return k;
+				}
+				while (k != 0 && (k & 1) == 0) // up from left children, then once more
+				{
+					k >>= 1;
+				}
+				return k >> 1;
+			}
+		};
+
+		template <class Value>
+		class eytzinger_iter
+		{
+		public:
+			typedef std::bidirectional_iterator_tag		iterator_category;
+			typedef Value								value_type;
+			typedef ptrdiff_t							difference_type;
+			typedef const Value*						pointer;
+			typedef const Value&						reference;
+
+			eytzinger_iter() : _slots(NULL), _size(0), _index(0) {}
+			eytzinger_iter(const Value* slots, size_t size, size_t index) : _slots(slots), _size(size), _index(index) {}
+
+			reference operator*() const
+			{
+				assert(_index != 0);
+				return _slots[_index];
+			}
+
+			pointer operator->() const
+			{
+				return &**this;
+			}
+
+			eytzinger_iter& operator++()
+			{
+				_index = eytzinger_order::next(_index, _size);
+				return *this;
+			}
+
+			eytzinger_iter operator++(int)
+			{
+				eytzinger_iter temp = *this;
+				++(*this);
+				return temp;
+			}
+
+			eytzinger_iter& operator--()
+			{
+				_index = eytzinger_order::prev(_index, _size);
+				return *this;
+			}
+
+			eytzinger_iter operator--(int)
+			{
+				eytzinger_iter temp = *this;
+				--(*this);
+				return temp;
+			}
+
+			// the slot in the array, 1 .. size (0 for end())
+			size_t slot() const
+			{
+				return _index;
+			}
+
+			friend
+			bool operator==(const eytzinger_iter& lhs, const eytzinger_iter& rhs)
+			{
+				return lhs._index == rhs._index && lhs._slots == rhs._slots;
+			}
+
+			friend
+			bool operator!=(const eytzinger_iter& lhs, const eytzinger_iter& rhs)
+			{
+				return !(lhs == rhs);
+			}
+
+		private:
+			const Value*	_slots;
+			size_t			_size;
+			size_t			_index;
+		};
+
+		// the storage and the lookups shared by frozen_map and frozen_set
+		template <class Key, class Value, class KeyOf, class Compare, class Alloc>
+		class eytzinger_array
+		{
+		public:
+			typedef Key										key_type;
+			typedef Value									value_type;
+			typedef Compare									key_compare;
+			typedef Alloc									allocator_type;
+			typedef size_t									size_type;
+			typedef ptrdiff_t								difference_type;
+			typedef const value_type&						reference;
+			typedef const value_type&						const_reference;
+			typedef eytzinger_iter<Value>					const_iterator;
+			typedef const_iterator							iterator;
+			typedef ft::reverse_iterator<const_iterator>	const_reverse_iterator;
+			typedef const_reverse_iterator					reverse_iterator;
+
+		private:
+			typedef typename Alloc::template rebind<Value>::other	value_alloc_type;
+			typedef typename Alloc::template rebind<char>::other	byte_alloc_type;
+
+			enum { cache_line = 64 };
+
+			// elements per cache line, rounded down to a power of two: the descendants of slot k that many
+			// levels down are the slots stride * k .. stride * k + stride - 1
+			enum { prefetch_stride = sizeof(Value) <= 4 ? 16 : sizeof(Value) <= 8 ? 8 : sizeof(Value) <= 16 ? 4 : 2 };
+
+		public:
+			explicit eytzinger_array(const Compare& comp = Compare(), const Alloc& alloc = Alloc())
+				: _storage(NULL), _slots(NULL), _size(0), _comp(comp), _alloc(alloc) {}
+
+			eytzinger_array(const eytzinger_array& other)
+				: _storage(NULL), _slots(NULL), _size(0), _comp(other._comp), _alloc(other._alloc)
+			{
+				build(other.begin(), other.size());
+			}
+
+			~eytzinger_array()
+			{
+				destroy();
+			}
+
+			eytzinger_array& operator=(const eytzinger_array& other)
+			{
+				if (this != &other)
+				{
+					eytzinger_array copy(other);
+					swap(copy);
+				}
+				return *this;
+			}
+
+			// ITERATORS:
+			const_iterator begin() const
+			{
+				return make_iterator(eytzinger_order::first(_size));
+			}
+			const_iterator end() const
+			{
+				return make_iterator(0);
+			}
+			const_reverse_iterator rbegin() const
+			{
+				return const_reverse_iterator(end());
+			}
+			const_reverse_iterator rend() const
+			{
+				return const_reverse_iterator(begin());
+			}
+
+			// CAPACITY:
+			size_type size() const
+			{
+				return _size;
+			}
+			bool empty() const
+			{
+				return _size == 0;
+			}
+
+			// LOOKUP:
+			const_iterator lower_bound(const key_type& key) const
+			{
+				size_type k = 1;
+				while (k <= _size)
+				{
+					prefetch_below(k);
+					k = 2 * k + _comp(KeyOf::key(_slots[k]), key);
+				}
+				return make_iterator(last_left_turn(k));
+			}
+
+			const_iterator upper_bound(const key_type& key) const
+			{
+				size_type k = 1;
+				while (k <= _size)
+				{
+					prefetch_below(k);
+					k = 2 * k + !_comp(key, KeyOf::key(_slots[k]));
+				}
+				return make_iterator(last_left_turn(k));
+			}
+
+			ft::pair<const_iterator, const_iterator> equal_range(const key_type& key) const
+			{
+				const_iterator lo = lower_bound(key);
+				if (lo == end() || _comp(key, KeyOf::key(*lo)))
+				{
+					return ft::pair<const_iterator, const_iterator>(lo, lo);
+				}
+				const_iterator hi = lo;
+				return ft::pair<const_iterator, const_iterator>(lo, ++hi);
+			}
+
+			const_iterator find(const key_type& key) const
+			{
+				const_iterator it = lower_bound(key);
+				return it != end() && !_comp(key, KeyOf::key(*it)) ? it : end();
+			}
+
+			size_type count(const key_type& key) const
+			{
+				return find(key) != end();
+			}
+
+			bool contains(const key_type& key) const
+			{
+				return find(key) != end();
+			}
+
+			// OBSERVERS:
+			key_compare key_comp() const
+			{
+				return _comp;
+			}
+
+			allocator_type get_allocator() const
+			{
+				return allocator_type(_alloc);
+			}
+
+			void swap(eytzinger_array& other)
+			{
+				ft::swap(_storage, other._storage);
+				ft::swap(_slots, other._slots);
+				ft::swap(_size, other._size);
+				ft::swap(_comp, other._comp);
+				ft::swap(_alloc, other._alloc);
+			}
+
+		protected:
+			// fills the array from n values in increasing order of their keys, in the order of the slots' in-order walk.
+			// The keys must be strictly increasing: std::invalid_argument otherwise
+			template <class InputIt>
+			void build(InputIt first, size_type n)
+			{
+				if (n == 0)
+				{
+					return;
+				}
+				char* storage = allocate_storage(n);
+				Value* slots = aligned_slots(storage);
+				size_type built = 0;
+				size_type previous = 0;
+				try
+				{
+					for (size_type k = eytzinger_order::first(n); built < n; ++first, ++built)
+					{
+						::new (static_cast<void*>(slots + k)) Value(*first);
+						if (previous != 0 && !_comp(KeyOf::key(slots[previous]), KeyOf::key(slots[k])))
+						{
+							++built;
+							throw std::invalid_argument("frozen_set: the input is not sorted by the comparison without duplicates");
+						}
+						previous = k;
+						k = eytzinger_order::next(k, n);
+					}
+				}
+				catch (...)
+				{
+					destroy_slots(storage, slots, built, n);
+					throw;
+				}
+				_storage = storage;
+				_slots = slots;
+				_size = n;
+			}
+
+		private:
+			const_iterator make_iterator(size_type k) const
+			{
+				return const_iterator(_slots, _size, k);
+			}
+
+			void prefetch_below(size_type k) const
+			{
+				// integer arithmetic: the address may be past the end of the array, the prefetch just misses
+				ft::prefetch(reinterpret_cast<const void*>(reinterpret_cast<uintptr_t>(_slots) + k * prefetch_stride * sizeof(Value)));
+			}
+
+			// the descent ends below a leaf; the answer is the last node where it went left: strip the trailing
+			// right turns (ones) and the left turn itself. 0 if it never went left (end())
+			static size_type last_left_turn(size_type k)
+			{
+				return k >> (__builtin_ctzl(~static_cast<unsigned long>(k)) + 1);
+			}
+
+			// STORAGE: the slots 0 .. n (0 is not used) from a cache line boundary on, so that the blocks prefetch_below()
+			// fetches are whole lines; the allocator only aligns for Value, the bytes are allocated with a line of slack
+			static size_type storage_size(size_type n)
+			{
+				return (n + 1) * sizeof(Value) + cache_line - 1;
+			}
+
+			char* allocate_storage(size_type n)
+			{
+				if (n > (static_cast<size_type>(-1) - cache_line) / sizeof(Value) - 1)
+				{
+					throw std::length_error("frozen_set: too many elements");
+				}
+				byte_alloc_type bytes(_alloc);
+				return bytes.allocate(storage_size(n));
+			}
+
+			static Value* aligned_slots(char* storage)
+			{
+				uintptr_t address = reinterpret_cast<uintptr_t>(storage);
+				return reinterpret_cast<Value*>((address + cache_line - 1) & ~static_cast<uintptr_t>(cache_line - 1));
+			}
+
+			// the first built values of the in-order walk of n slots
+			void destroy_slots(char* storage, Value* slots, size_type built, size_type n)
+			{
+				size_type k = eytzinger_order::first(n);
+				for (size_type i = 0; i < built; ++i, k = eytzinger_order::next(k, n))
+				{
+					_alloc.destroy(slots + k);
+				}
+				byte_alloc_type bytes(_alloc);
+				bytes.deallocate(storage, storage_size(n));
+			}
+
+			void destroy()
+			{
+				if (_slots != NULL)
+				{
+					destroy_slots(_storage, _slots, _size, _size);
+					_storage = NULL;
+					_slots = NULL;
+					_size = 0;
+				}
+			}
+
+			char*				_storage;
+			Value*				_slots;
+			size_type			_size;
+			Compare				_comp;
+			value_alloc_type	_alloc;
+		};
+	}
+
+	// A frozen copy of an ft::set (or of sorted unique keys) for lookups only, see detail::eytzinger_array.
+	// find(), lower_bound(), upper_bound(), equal_range(), count(), contains() and in-order iteration, all const.
+	template <class Key, class Compare = ::std::less<Key>, class Alloc = ::std::allocator<Key> >
+	class frozen_set
+		: public detail::eytzinger_array<Key, Key, detail::frozen_key_of_key<Key>, Compare, Alloc>
+	{
+		typedef detail::eytzinger_array<Key, Key, detail::frozen_key_of_key<Key>, Compare, Alloc> base;
+
+	public:
+		explicit frozen_set(const Compare& comp = Compare(), const Alloc& alloc = Alloc())
+			: base(comp, alloc) {}
+
+		template <class SetAlloc, class Layout>
+		explicit frozen_set(const ft::set<Key, Compare, SetAlloc, Layout>& s, const Alloc& alloc = Alloc())
+			: base(s.key_comp(), alloc)
+		{
+			this->build(s.begin(), s.size());
+		}
+
+		// [first, last) must be sorted by comp without equivalent keys
+		template <class ForwardIt>
+		frozen_set(ForwardIt first, typename ft::enable_if<!ft::is_integral<ForwardIt>::value, ForwardIt>::type last,
+			const Compare& comp = Compare(), const Alloc& alloc = Alloc())
+			: base(comp, alloc)
+		{
+			this->build(first, static_cast<typename base::size_type>(std::distance(first, last)));
+		}
+	};
+
+	// the same for an ft::map; the pairs are stored whole, so big mapped values make the array less dense
+	template <class Key, class T, class Compare = ::std::less<Key>, class Alloc = ::std::allocator<ft::pair<const Key, T> > >
+	class frozen_map
+		: public detail::eytzinger_array<Key, ft::pair<const Key, T>, detail::frozen_key_of_pair<ft::pair<const Key, T> >, Compare, Alloc>
+	{
+		typedef detail::eytzinger_array<Key, ft::pair<const Key, T>, detail::frozen_key_of_pair<ft::pair<const Key, T> >, Compare, Alloc> base;
+
+	public:
+		typedef T	mapped_type;
+
+		explicit frozen_map(const Compare& comp = Compare(), const Alloc& alloc = Alloc())
+			: base(comp, alloc) {}
+
+		template <class MapAlloc, class Layout>
+		explicit frozen_map(const ft::map<Key, T, Compare, MapAlloc, Layout>& m, const Alloc& alloc = Alloc())
+			: base(m.key_comp(), alloc)
+		{
+			this->build(m.begin(), m.size());
+		}
+
+		// [first, last) of pairs sorted by key with comp, without equivalent keys
+		template <class ForwardIt>
+		frozen_map(ForwardIt first, typename ft::enable_if<!ft::is_integral<ForwardIt>::value, ForwardIt>::type last,
+			const Compare& comp = Compare(), const Alloc& alloc = Alloc())
+			: base(comp, alloc)
+		{
+			this->build(first, static_cast<typename base::size_type>(std::distance(first, last)));
+		}
+
+		const mapped_type& at(const Key& key) const
+		{
+			typename base::const_iterator it = this->find(key);
+			if (it == this->end())
+			{
+				throw std::out_of_range("frozen_map::at");
+			}
+			return it->second;
+		}
+	};
+
+	template <class Key, class Compare, class Alloc>
+	void swap(frozen_set<Key, Compare, Alloc>& lhs, frozen_set<Key, Compare, Alloc>& rhs)
+	{
+		lhs.swap(rhs);
+	}
+
+	template <class Key, class T, class Compare, class Alloc>
+	void swap(frozen_map<Key, T, Compare, Alloc>& lhs, frozen_map<Key, T, Compare, Alloc>& rhs)
+	{
+		lhs.swap(rhs);
+	}
+}
+
+#endif
@@ -0,0 +1,324 @@
+#ifndef HUGE_PAGE_ALLOCATOR_HPP
+#define HUGE_PAGE_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <sys/mman.h>
+#include <unistd.h>
+#ifdef __linux__
+# include <sys/syscall.h>
+#endif
+
+namespace ft
+{
+	// Where the memory of a huge_page_allocator goes.
+	// Below threshold, operator new is used (a small vector doesn't get 2 MiB). From it on, the block is an anonymous
+	// mapping of whole 2 MiB pages:
+	// - huge_pages_transparent aligns it on 2 MiB and asks for transparent huge pages (madvise MADV_HUGEPAGE);
+	// - huge_pages_explicit maps it from the reserved hugetlbfs pages (MAP_HUGETLB), and falls back to
+	//   transparent huge pages when none are reserved;
+	// - huge_pages_none keeps the normal pages.
+	// numa places the pages with mbind(): on the nodes of node_mask (bit i is node i), or preferably on them, or
+	// interleaved across them page by page. Without NUMA support (another system, a kernel without it, a sandbox)
+	// the policy is dropped and the memory is used as is.
+	// prefault touches every page at allocation, so the page faults (and the zeroing) are paid there, not on the
+	// first pass over the data.
+	struct huge_page_options
+	{
+		enum page_mode
+		{
+			huge_pages_none,
+			huge_pages_transparent,
+			huge_pages_explicit
+		};
+
+		enum numa_policy
+		{
+			numa_default,
+			numa_bind,
+			numa_preferred,
+			numa_interleave
+		};
+
+		enum { default_threshold = 2 << 20 };
+
+		size_t			threshold;
+		page_mode		pages;
+		numa_policy		numa;
+		unsigned long	node_mask;
+		bool			prefault;
+
+		huge_page_options()
+			: threshold(default_threshold), pages(huge_pages_transparent), numa(numa_default), node_mask(1), prefault(false)
+			{}
+	};
+
+	// what the mappings of all the huge_page_allocators have got so far
+	struct huge_page_stats
+	{
+		size_t	mappings;			// blocks above the threshold
+		size_t	hugetlb_mappings;	// of which from the reserved huge pages
+		size_t	numa_fallbacks;		// placements dropped because mbind() failed
+	};
+
+	namespace detail
+	{
+		class huge_page_mapper
+		{
+		public:
+			enum { huge_page_size = 2 << 20 };
+
+			// the length of the mapping of a block, the same at allocation and deallocation
+			static size_t mapped_length(size_t bytes)
+			{
+				return (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+			}
+
+			static void* map(size_t bytes, const huge_page_options& opts)
+			{
+				size_t length = mapped_length(bytes);
+				void* p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+				if (opts.pages == huge_page_options::huge_pages_explicit)
+				{
+					p = ::mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+					if (p != MAP_FAILED)
+					{
+						count(stats().hugetlb_mappings);
+					}
+				}
+#endif
+				if (p == MAP_FAILED)
+				{
+					p = map_aligned(length, opts.pages != huge_page_options::huge_pages_none);
+				}
+				count(stats().mappings);
+				if (opts.numa != huge_page_options::numa_default && !bind(p, length, opts))
+				{
+					count(stats().numa_fallbacks);
+				}
+				if (opts.prefault)
+				{
+					prefault(p, length);
+				}
+				return p;
+			}
+
+			static void unmap(void* p, size_t bytes)
+			{
+				::munmap(p, mapped_length(bytes));
+			}
+
+			// writes a zero in every page: it is already zero, but it is now allocated, on the nodes of the policy
+			static void prefault(void* p, size_t bytes)
+			{
+				size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+				volatile char* bytes_ptr = static_cast<volatile char*>(p);
+				for (size_t offset = 0; offset < bytes; offset += page)
+				{
+					bytes_ptr[offset] = 0;
+				}
+			}
+
+			static huge_page_stats& stats()
+			{
+				static huge_page_stats s = { 0, 0, 0 };
+				return s;
+			}
+
+			static bool numa_available()
+			{
+#if defined(__linux__) && defined(SYS_get_mempolicy)
+				int mode = 0;
+				return ::syscall(SYS_get_mempolicy, &mode, NULL, 0UL, NULL, 0UL) == 0;
+#else
+				return false;
+#endif
+			}
+
+		private:
+			static void count(size_t& counter)
+			{
+				__sync_fetch_and_add(&counter, 1);
+			}
+
+			// over-maps by one huge page and trims both ends, so the block starts on a huge page boundary
+			// (transparent huge pages are only used for aligned 2 MiB ranges)
+			static void* map_aligned(size_t length, bool transparent)
+			{
+				void* raw = ::mmap(NULL, length + huge_page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+				if (raw == MAP_FAILED)
+				{
+					throw std::bad_alloc();
+				}
+				uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+				uintptr_t aligned = (start + huge_page_size - 1) & ~(uintptr_t(huge_page_size) - 1);
+				if (aligned > start)
+				{
+					::munmap(raw, aligned - start);
+				}
+				uintptr_t tail = aligned + length;
+				uintptr_t raw_end = start + length + huge_page_size;
+				if (raw_end > tail)
+				{
+					::munmap(reinterpret_cast<void*>(tail), raw_end - tail);
+				}
+#ifdef MADV_HUGEPAGE
+				if (transparent)
+				{
+					::madvise(reinterpret_cast<void*>(aligned), length, MADV_HUGEPAGE);
+				}
+#else
+				(void)transparent;
+#endif
+				return reinterpret_cast<void*>(aligned);
+			}
+
+			// the modes of <numaif.h>, without a dependency on libnuma
+			static bool bind(void* p, size_t length, const huge_page_options& opts)
+			{
+#if defined(__linux__) && defined(SYS_mbind)
+				enum { mpol_preferred = 1, mpol_bind = 2, mpol_interleave = 3 };
+				int mode = opts.numa == huge_page_options::numa_bind ? mpol_bind
+					: opts.numa == huge_page_options::numa_preferred ? mpol_preferred : mpol_interleave;
+				unsigned long mask = opts.node_mask;
+				return ::syscall(SYS_mbind, p, length, mode, &mask, sizeof(mask) * 8 + 1, 0U) == 0;
+#else
+				(void)p;
+				(void)length;
+				(void)opts;
+				return false;
+#endif
+			}
+		};
+	}
+
+	// An allocator for big ft::vector buffers (columns of many GB): a buffer of at least the threshold of its options is
+	// mapped on huge pages (far fewer TLB misses on random access), placed on NUMA nodes and optionally prefaulted,
+	// see huge_page_options. Two allocators are equal when they have the same threshold: each can free the other's
+	// blocks.
+	template <class T>
+	class huge_page_allocator
+	{
+	public:
+		typedef T					value_type;
+		typedef T*					pointer;
+		typedef const T*			const_pointer;
+		typedef T&					reference;
+		typedef const T&			const_reference;
+		typedef size_t				size_type;
+		typedef std::ptrdiff_t		difference_type;
+
+		template <class U>
+		struct rebind
+		{
+			typedef huge_page_allocator<U> other;
+		};
+
+		huge_page_allocator() {}
+
+		// not explicit: ft::vector<double, ft::huge_page_allocator<double> > column(opts);
+		huge_page_allocator(const huge_page_options& opts) : _options(opts) {}
+
+		template <class U>
+		huge_page_allocator(const huge_page_allocator<U>& other) : _options(other.options()) {}
+
+		pointer allocate(size_type n, const void* = 0)
+		{
+			if (n > max_size())
+			{
+				throw std::bad_alloc();
+			}
+			if (n == 0 || n * sizeof(T) < _options.threshold)
+			{
+				return static_cast<pointer>(::operator new(n * sizeof(T)));
+			}
+			// rounding up to whole pages and the extra page map_aligned() maps to align the block must not wrap around
+			const size_t page = detail::huge_page_mapper::huge_page_size;
+			if (n * sizeof(T) > static_cast<size_t>(-1) - 2 * page)
+			{
+				throw std::bad_alloc();
+			}
+			return static_cast<pointer>(detail::huge_page_mapper::map(n * sizeof(T), _options));
+		}
+
+		void deallocate(pointer p, size_type n)
+		{
+			if (n == 0 || n * sizeof(T) < _options.threshold)
+			{
+				::operator delete(p);
+			}
+			else
+			{
+				detail::huge_page_mapper::unmap(p, n * sizeof(T));
+			}
+		}
+
+		// touches the pages of [p, p + n) now (a buffer allocated without prefault, about to be read at random)
+		void prefault(pointer p, size_type n) const
+		{
+			detail::huge_page_mapper::prefault(p, n * sizeof(T));
+		}
+
+		void construct(pointer p, const T& value)
+		{
+			::new (static_cast<void*>(p)) T(value);
+		}
+
+		void destroy(pointer p)
+		{
+			p->~T();
+		}
+
+		size_type max_size() const
+		{
+			return static_cast<size_type>(-1) / sizeof(T);
+		}
+
+		pointer address(reference x) const
+		{
+			return &x;
+		}
+
+		const_pointer address(const_reference x) const
+		{
+			return &x;
+		}
+
+		const huge_page_options& options() const
+		{
+			return _options;
+		}
+
+		static huge_page_stats stats()
+		{
+			return detail::huge_page_mapper::stats();
+		}
+
+		// whether the NUMA policies can be applied here at all
+		static bool numa_available()
+		{
+			return detail::huge_page_mapper::numa_available();
+		}
+
+	private:
+		huge_page_options	_options;
+	};
+
+	template <class T, class U>
+	bool operator==(const huge_page_allocator<T>& lhs, const huge_page_allocator<U>& rhs)
+	{
+		return lhs.options().threshold == rhs.options().threshold;
+	}
+
+	template <class T, class U>
+	bool operator!=(const huge_page_allocator<T>& lhs, const huge_page_allocator<U>& rhs)
+	{
+		return !(lhs == rhs);
+	}
+}
+
+#endif
@@ -7,6 +7,7 @@
 #include <iostream>
 
 #include "red_black_tree/rbtree.hpp"
+#include "red_black_tree/index_rbtree.hpp"
 
 #include "iterator/reverse_iterator.hpp"
 
@@ -15,6 +16,7 @@
 #include "utility/pair.hpp"
 #include "utility/is_integral.hpp"
 #include "utility/enable_if.hpp"
+#include "utility/is_transparent.hpp"
 #include "utility/ft_swap.hpp"
 
 namespace ft
@@ -22,7 +24,8 @@ namespace ft
 	template < class Key,                                     		// map::key_type
            class T,                                       			// map::mapped_type
            class Compare = ::std::less<Key>,                     	// map::key_compare
-           class Alloc = std::allocator<ft::pair<const Key,T> >    // map::allocator_type
+           class Alloc = std::allocator<ft::pair<const Key,T> >,   // map::allocator_type
+           class Layout = ft::rbtree_compact_layout                 // node layout (rbtree_threaded_layout for O(1) ++/--, rbtree_index_layout for 32-bit links)
            >
     class map
 	{
@@ -40,7 +43,8 @@ namespace ft
 		typedef typename allocator_type::difference_type	difference_type;
 
 	private:
-		typedef rbtree<value_type, key_compare, allocator_type, rbtree_node_for_map<value_type> > tree_type;
+		typedef typename rbtree_for_layout<Layout, value_type, key_compare, allocator_type,
+			rbtree_node_for_map<value_type, typename Layout::node_base_type> >::type tree_type;
 
 	public:
 		typedef typename tree_type::iterator			iterator;
@@ -113,11 +117,10 @@ namespace ft
 		}
 		
 		// ELEMENT ACCESS:
+		// the key is looked up first: the mapped value is default constructed only if the key is missing
 		mapped_type& operator[](const key_type& k)
 		{
-			pair<key_type, mapped_type> pair = ft::make_pair(k, mapped_type());
-			iterator inserted = insert(pair).first;
-			return inserted->second;;
+			return _tree.try_emplace(k).first->second;
 		}
 
 		// ITERATORS:
@@ -196,6 +199,13 @@ namespace ft
 			return _tree.erase(key);
 		}
 
+		// heterogeneous overloads: only enabled if the comparator has is_transparent
+		template <class K>
+		size_type erase(const K& key, typename ft::enable_if<ft::is_transparent<key_compare>::value, K>::type* = 0)
+		{
+			return _tree.erase(key);
+		}
+
 		void erase(iterator first, iterator last)
 		{
 			_tree.erase(first, last);
@@ -221,6 +231,49 @@ namespace ft
 			_tree.insert(first, last);
 		}
 
+		// try_emplace(): if the key already exists nothing is constructed, otherwise
+		// the mapped value is constructed in place from arg (or default constructed)
+		pair<iterator,bool> try_emplace(const key_type& k)
+		{
+			return _tree.try_emplace(k);
+		}
+
+		template <class Arg>
+		pair<iterator,bool> try_emplace(const key_type& k, const Arg& arg)
+		{
+			return _tree.try_emplace(k, arg);
+		}
+
+		// the hint is ignored, same as for insert() with hint
+		iterator try_emplace(iterator, const key_type& k)
+		{
+			return _tree.try_emplace(k).first;
+		}
+
+		template <class Arg>
+		iterator try_emplace(iterator, const key_type& k, const Arg& arg)
+		{
+			return _tree.try_emplace(k, arg).first;
+		}
+
+		// insert_or_assign(): assigns obj to the mapped value if the key exists, inserts a new element otherwise
+		template <class M>
+		pair<iterator,bool> insert_or_assign(const key_type& k, const M& obj)
+		{
+			pair<iterator,bool> result = _tree.try_emplace(k, obj);
+			if (!result.second)
+			{
+				result.first->second = obj;
+			}
+			return result;
+		}
+
+		template <class M>
+		iterator insert_or_assign(iterator, const key_type& k, const M& obj)
+		{
+			return insert_or_assign(k, obj).first;
+		}
+
 		//LOOKUP:
 		size_type count(const key_type& key) const
 		{
@@ -276,6 +329,152 @@ namespace ft
 			return _tree.upper_bound(key);
 		}
 		
+		// heterogeneous lookup (C++14): with a transparent comparator the lookups accept any type
+		// comparable with the key, e.g. a const char* for std::string keys, without constructing a temporary key
+		template <class K>
+		size_type count(const K& key, typename ft::enable_if<ft::is_transparent<key_compare>::value, K>::type* = 0) const
+		{
+			return _tree.count(key);
+		}
+
+		template <class K>
+		pair<iterator,iterator> equal_range(const K& key, typename ft::enable_if<ft::is_transparent<key_compare>::value, K>::type* = 0)
+		{
+			return _tree.equal_range(key);
+		}
+
+		template <class K>
+		pair<const_iterator,const_iterator> equal_range(const K& key, typename ft::enable_if<ft::is_transparent<key_compare>::value, K>::type* = 0) const
+		{
+			return _tree.equal_range(key);
+		}
+
+		template <class K>
+		iterator find(const K& key, typename ft::enable_if<ft::is_transparent<key_compare>::value, K>::type* = 0)
+		{
+			return _tree.find(key);
+		}
+
+		template <class K>
+		const_iterator find(const K& key, typename ft::enable_if<ft::is_transparent<key_compare>::value, K>::type* = 0) const
+		{
+			return _tree.find(key);
+		}
+
+		template <class K>
+		iterator lower_bound(const K& key, typename ft::enable_if<ft::is_transparent<key_compare>::value, K>::type* = 0)
+		{
+			return _tree.lower_bound(key);
+		}
+
+		template <class K>
+		const_iterator lower_bound(const K& key, typename ft::enable_if<ft::is_transparent<key_compare>::value, K>::type* = 0) const
+		{
+			return _tree.lower_bound(key);
+		}
+
+		template <class K>
+		iterator upper_bound(const K& key, typename ft::enable_if<ft::is_transparent<key_compare>::value, K>::type* = 0)
+		{
+			return _tree.upper_bound(key);
+		}
+
+		template <class K>
+		const_iterator upper_bound(const K& key, typename ft::enable_if<ft::is_transparent<key_compare>::value, K>::type* = 0) const
+		{
+			return _tree.upper_bound(key);
+		}
+
+		// RANGE SCANS:
+		// fn(value) is called for every element with lo <= key < hi in key order, the same elements as
+		// [lower_bound(lo), lower_bound(hi)). The tree is walked with an explicit stack and the upcoming
+		// subtrees are prefetched, which is faster than incrementing an iterator over long ranges.
+		// The map must not be modified by fn (the mapped values can be).
+		enum { range_batch_size = tree_type::range_batch_size };
+
+		template <class Function>
+		Function for_each_range(const key_type& lo, const key_type& hi, Function fn)
+		{
+			return _tree.for_each_range(lo, hi, fn);
+		}
+
+		template <class Function>
+		Function for_each_range(const key_type& lo, const key_type& hi, Function fn) const
+		{
+			return _tree.for_each_range(lo, hi, fn);
+		}
+
+		// the same elements handed to fn(value_type* const* values, size_type count) in batches of at most range_batch_size
+		template <class Function>
+		Function for_each_range_batch(const key_type& lo, const key_type& hi, Function fn)
+		{
+			return _tree.for_each_range_batch(lo, hi, fn);
+		}
+
+		template <class Function>
+		Function for_each_range_batch(const key_type& lo, const key_type& hi, Function fn) const
+		{
+			return _tree.for_each_range_batch(lo, hi, fn);
+		}
+
+		// BATCHED LOOKUPS:
+		// the same results as find() of every key in [first, last) (random access), written to out; the descents of
+		// find_lanes keys at a time are interleaved so their cache misses overlap. ft::parallel::find_many() splits
+		// a batch between threads.
+		enum { find_lanes = tree_type::find_lanes };
+
+		template <class KeyIt, class OutputIt>
+		OutputIt find_many(KeyIt first, KeyIt last, OutputIt out)
+		{
+			return _tree.find_many(first, static_cast<size_type>(last - first), out);
+		}
+
+		template <class KeyIt, class OutputIt>
+		OutputIt find_many(KeyIt first, KeyIt last, OutputIt out) const
+		{
+			return _tree.find_many(first, static_cast<size_type>(last - first), out);
+		}
+
+		// bit i % 64 of bitmap[i / 64] is set if first[i] is in the map; (last - first + 63) / 64 words are written
+		template <class KeyIt>
+		void contains_many(KeyIt first, KeyIt last, uint64_t* bitmap) const
+		{
+			_tree.contains_many(first, static_cast<size_type>(last - first), bitmap);
+		}
+
+		// BULK BUILD:
+		// replaces the contents with [first, last), which must be sorted by key_comp() without equivalent keys, in O(n):
+		// the nodes are carved out of one allocation and linked bottom up into a balanced tree, no comparison is made.
+		// fork(a, b) may run the two halves of the build in parallel (ft::parallel::build() passes a fork_join_pool)
+		template <class RandomIt>
+		void assign_sorted_unique(RandomIt first, RandomIt last)
+		{
+			ft::rbtree_sequential_fork fork;
+			_tree.assign_sorted_unique(first, static_cast<size_type>(last - first), fork);
+		}
+
+		template <class RandomIt, class Fork>
+		void assign_sorted_unique(RandomIt first, RandomIt last, Fork fork)
+		{
+			_tree.assign_sorted_unique(first, static_cast<size_type>(last - first), fork);
+		}
+
+		// COMPACTION:
+		// relocates the nodes into one new allocation in key order and rebalances the tree, so a scan walks the memory
+		// forward again after a long insert/erase churn. compact_step(max_nodes) moves at most max_nodes nodes per call
+		// and returns true once a whole pass is done, for a periodic maintenance slot without a long pause; the index
+		// layout only has compact() (its slab is rebuilt in one go), compact_step() doesn't compile with it.
+		// Iterators and references to the moved elements are invalidated.
+		void compact()
+		{
+			_tree.compact();
+		}
+
+		bool compact_step(size_type max_nodes)
+		{
+			return _tree.compact_step(max_nodes);
+		}
+
 		// OBSERVERS:
 		key_compare key_comp() const
 		{
@@ -297,45 +496,45 @@ namespace ft
 		// }
 	};
 
-	template< class Key, class T, class Compare, class Alloc >
-	void swap( ft::map<Key,T,Compare,Alloc>& lhs, ft::map<Key,T,Compare,Alloc>& rhs )
+	template< class Key, class T, class Compare, class Alloc, class Layout >
+	void swap( ft::map<Key,T,Compare,Alloc,Layout>& lhs, ft::map<Key,T,Compare,Alloc,Layout>& rhs )
 	{
 		lhs.swap(rhs);
 	}
 
    //relational operators (map):
-	template <class Key, class T, class Compare, class Alloc>
-	bool operator==( const map<Key,T,Compare,Alloc>& lhs, const map<Key,T,Compare,Alloc>& rhs )
+	template <class Key, class T, class Compare, class Alloc, class Layout>
+	bool operator==( const map<Key,T,Compare,Alloc,Layout>& lhs, const map<Key,T,Compare,Alloc,Layout>& rhs )
 	{
 		return lhs.size() == rhs.size() && ft::equal(lhs.begin(), lhs.end(), rhs.begin());
 	}
 
-	template <class Key, class T, class Compare, class Alloc>
-	bool operator!=( const map<Key,T,Compare,Alloc>& lhs,const map<Key,T,Compare,Alloc>& rhs )
+	template <class Key, class T, class Compare, class Alloc, class Layout>
+	bool operator!=( const map<Key,T,Compare,Alloc,Layout>& lhs,const map<Key,T,Compare,Alloc,Layout>& rhs )
 	{
         return !(lhs == rhs);
 	}
 
-	template <class Key, class T, class Compare, class Alloc>
-	bool operator<( const map<Key,T,Compare,Alloc>& lhs,const map<Key,T,Compare,Alloc>& rhs )
+	template <class Key, class T, class Compare, class Alloc, class Layout>
+	bool operator<( const map<Key,T,Compare,Alloc,Layout>& lhs,const map<Key,T,Compare,Alloc,Layout>& rhs )
 	{
         return (ft::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end()));
 	}
 
-	template <class Key, class T, class Compare, class Alloc>
-	bool operator<=( const map<Key,T,Compare,Alloc>& lhs,const map<Key,T,Compare,Alloc>& rhs )
+	template <class Key, class T, class Compare, class Alloc, class Layout>
+	bool operator<=( const map<Key,T,Compare,Alloc,Layout>& lhs,const map<Key,T,Compare,Alloc,Layout>& rhs )
 	{
         return !(rhs < lhs);
 	}
 
-	template <class Key, class T, class Compare, class Alloc>
-	bool operator>( const map<Key,T,Compare,Alloc>& lhs,const map<Key,T,Compare,Alloc>& rhs )
+	template <class Key, class T, class Compare, class Alloc, class Layout>
+	bool operator>( const map<Key,T,Compare,Alloc,Layout>& lhs,const map<Key,T,Compare,Alloc,Layout>& rhs )
 	{
         return rhs < lhs;
 	}
 
-	template <class Key, class T, class Compare, class Alloc>
-	bool operator>=( const map<Key,T,Compare,Alloc>& lhs,const map<Key,T,Compare,Alloc>& rhs )
+	template <class Key, class T, class Compare, class Alloc, class Layout>
+	bool operator>=( const map<Key,T,Compare,Alloc,Layout>& lhs,const map<Key,T,Compare,Alloc,Layout>& rhs )
 	{
         return !(lhs < rhs);
 	}
@@ -0,0 +1,302 @@
+#ifndef MAP_SNAPSHOT_HPP
+#define MAP_SNAPSHOT_HPP
+
+#if __cplusplus < 201103L
+# error "map_snapshot.hpp requires C++11 (mapped_vector.hpp)"
+#endif
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+#include "map.hpp"
+#include "mapped_vector.hpp"
+#include "set.hpp"
+
+namespace ft
+{
+	// Binary snapshots of maps and sets with trivially copyable keys (and mapped values).
+	// A snapshot is a mapped_vector file (64-byte header, then the raw array) of the elements in key order:
+	// a set stores its keys, a map stores snapshot_entry { first, second } records.
+	// save_snapshot() writes it in one pass over the tree. load_snapshot() maps the file and hands the array to
+	// assign_sorted_unique(): O(n), no comparison but the check of the order, and the nodes in one arena.
+	// mapped_map / mapped_set serve lookups from the mapped file directly (binary search), nothing is built.
+
+	// ft::pair has a user-provided assignment, so it can't be copied as raw bytes
+	template <class Key, class T>
+	struct snapshot_entry
+	{
+		typedef Key	first_type;
+		typedef T	second_type;
+
+		Key	first;
+		T	second;
+	};
+
+	namespace detail
+	{
+		// the records of a map snapshot seen as the value_type of the map, for assign_sorted_unique()
+		template <class Entry, class Value>
+		class snapshot_values
+		{
+		public:
+			explicit snapshot_values(const Entry* entries) : _entries(entries) {}
+
+			Value operator[](size_t i) const
+			{
+				return Value(_entries[i].first, _entries[i].second);
+			}
+			ptrdiff_t operator-(const snapshot_values& other) const
+			{
+				return _entries - other._entries;
+			}
+
+		private:
+			const Entry*	_entries;
+		};
+
+		template <class Key>
+		struct snapshot_key_of_key
+		{
+			static const Key& key(const Key& value)
+			{
+				return value;
+			}
+		};
+
+		template <class Entry>
+		struct snapshot_key_of_entry
+		{
+			static const typename Entry::first_type& key(const Entry& value)
+			{
+				return value.first;
+			}
+		};
+
+		// the keys must be strictly increasing, or the snapshot was written with another order (or is damaged)
+		template <class Value, class KeyOf, class Compare>
+		void check_snapshot_order(const Value* first, const Value* last, const Compare& comp, const std::string& path)
+		{
+			for (const Value* it = first; it != last && it + 1 != last; ++it)
+			{
+				if (!comp(KeyOf::key(it[0]), KeyOf::key(it[1])))
+				{
+					throw std::runtime_error("map_snapshot: " + path + " is not sorted by the comparison of the container");
+				}
+			}
+		}
+
+		// the lookups shared by mapped_map and mapped_set, over the sorted array of a snapshot
+		template <class Key, class Value, class KeyOf, class Compare>
+		class mapped_sorted_array
+		{
+		public:
+			typedef Key										key_type;
+			typedef Value									value_type;
+			typedef Compare									key_compare;
+			typedef size_t									size_type;
+			typedef ptrdiff_t								difference_type;
+			typedef const value_type&						const_reference;
+			typedef const value_type*						const_pointer;
+			typedef const value_type*						const_iterator;
+			typedef const_iterator							iterator;
+			typedef ft::reverse_iterator<const_iterator>	const_reverse_iterator;
+			typedef const_reverse_iterator					reverse_iterator;
+			typedef mapped_vector<Value>					file_type;
+
+			enum { open_verify = file_type::open_verify };
+
+			// open_verify also checks the checksum and the order of the keys, which reads the whole file
+			explicit mapped_sorted_array(const std::string& path, int mode = 0, const Compare& comp = Compare())
+				: _file(path, (mode & open_verify) | file_type::open_read_only), _comp(comp)
+			{
+				if (mode & open_verify)
+				{
+					check_snapshot_order<Value, KeyOf>(begin(), end(), _comp, path);
+				}
+			}
+
+			size_type size() const
+			{
+				return _file.size();
+			}
+			bool empty() const
+			{
+				return _file.empty();
+			}
+
+			const_iterator begin() const
+			{
+				return _file.begin();
+			}
+			const_iterator end() const
+			{
+				return _file.end();
+			}
+			const_reverse_iterator rbegin() const
+			{
+				return const_reverse_iterator(end());
+			}
+			const_reverse_iterator rend() const
+			{
+				return const_reverse_iterator(begin());
+			}
+
+			const_iterator lower_bound(const key_type& key) const
+			{
+				return std::lower_bound(begin(), end(), key, value_less_key(_comp));
+			}
+			const_iterator upper_bound(const key_type& key) const
+			{
+				return std::upper_bound(begin(), end(), key, key_less_value(_comp));
+			}
+			ft::pair<const_iterator, const_iterator> equal_range(const key_type& key) const
+			{
+				const_iterator lo = lower_bound(key);
+				const_iterator hi = lo != end() && !_comp(key, KeyOf::key(*lo)) ? lo + 1 : lo;
+				return ft::pair<const_iterator, const_iterator>(lo, hi);
+			}
+			const_iterator find(const key_type& key) const
+			{
+				const_iterator it = lower_bound(key);
+				return it != end() && !_comp(key, KeyOf::key(*it)) ? it : end();
+			}
+			size_type count(const key_type& key) const
+			{
+				return find(key) != end();
+			}
+			bool contains(const key_type& key) const
+			{
+				return find(key) != end();
+			}
+
+			key_compare key_comp() const
+			{
+				return _comp;
+			}
+
+			// lookups touch log2(n) scattered pages: advice_random keeps the kernel from reading ahead around them
+			void advise(typename file_type::access_advice advice)
+			{
+				_file.advise(advice);
+			}
+
+		private:
+			// std::lower_bound compares (value, key), std::upper_bound (key, value); two functors, as Key and Value
+			// are the same type in a set
+			struct value_less_key
+			{
+				explicit value_less_key(const Compare& c) : comp(c) {}
+
+				bool operator()(const Value& value, const Key& key) const
+				{
+					return comp(KeyOf::key(value), key);
+				}
+
+				const Compare&	comp;
+			};
+
+			struct key_less_value
+			{
+				explicit key_less_value(const Compare& c) : comp(c) {}
+
+				bool operator()(const Key& key, const Value& value) const
+				{
+					return comp(key, KeyOf::key(value));
+				}
+
+				const Compare&	comp;
+			};
+
+			file_type	_file;
+			Compare		_comp;
+		};
+	}
+
+	// SAVING:
+	template <class Key, class T, class Compare, class Alloc, class Layout>
+	void save_snapshot(const ft::map<Key, T, Compare, Alloc, Layout>& m, const std::string& path)
+	{
+		typedef snapshot_entry<Key, T> entry_type;
+		mapped_vector<entry_type> file(path, mapped_vector<entry_type>::open_create);
+		file.reserve(m.size());
+		for (typename ft::map<Key, T, Compare, Alloc, Layout>::const_iterator it = m.begin(); it != m.end(); ++it)
+		{
+			entry_type entry = { it->first, it->second };
+			file.push_back(entry);
+		}
+		file.close();
+	}
+
+	template <class Key, class Compare, class Alloc, class Layout>
+	void save_snapshot(const ft::set<Key, Compare, Alloc, Layout>& s, const std::string& path)
+	{
+		mapped_vector<Key> file(path, mapped_vector<Key>::open_create);
+		file.reserve(s.size());
+		file.append(s.begin(), s.end());
+		file.close();
+	}
+
+	// LOADING: replaces the contents; mode may add mapped_vector<>::open_verify to check the checksum
+	template <class Key, class T, class Compare, class Alloc, class Layout>
+	void load_snapshot(ft::map<Key, T, Compare, Alloc, Layout>& m, const std::string& path, int mode = 0)
+	{
+		typedef snapshot_entry<Key, T> entry_type;
+		typedef typename ft::map<Key, T, Compare, Alloc, Layout>::value_type value_type;
+		typedef detail::snapshot_values<entry_type, value_type> values_type;
+		mapped_vector<entry_type> file(path, (mode & mapped_vector<entry_type>::open_verify) | mapped_vector<entry_type>::open_read_only);
+		file.advise(mapped_vector<entry_type>::advice_sequential);
+		const mapped_vector<entry_type>& entries = file;
+		detail::check_snapshot_order<entry_type, detail::snapshot_key_of_entry<entry_type> >(entries.begin(), entries.end(), m.key_comp(), path);
+		m.assign_sorted_unique(values_type(entries.begin()), values_type(entries.end()));
+	}
+
+	template <class Key, class Compare, class Alloc, class Layout>
+	void load_snapshot(ft::set<Key, Compare, Alloc, Layout>& s, const std::string& path, int mode = 0)
+	{
+		mapped_vector<Key> file(path, (mode & mapped_vector<Key>::open_verify) | mapped_vector<Key>::open_read_only);
+		file.advise(mapped_vector<Key>::advice_sequential);
+		const mapped_vector<Key>& keys = file;
+		detail::check_snapshot_order<Key, detail::snapshot_key_of_key<Key> >(keys.begin(), keys.end(), s.key_comp(), path);
+		s.assign_sorted_unique(keys.begin(), keys.end());
+	}
+
+	// READ-ONLY VIEWS: find(), lower_bound(), upper_bound(), equal_range(), count() and iteration straight from the
+	// mapped file of a save_snapshot(); the Compare must be the one of the saved container
+	template <class Key, class T, class Compare = ::std::less<Key> >
+	class mapped_map
+		: public detail::mapped_sorted_array<Key, snapshot_entry<Key, T>, detail::snapshot_key_of_entry<snapshot_entry<Key, T> >, Compare>
+	{
+		typedef detail::mapped_sorted_array<Key, snapshot_entry<Key, T>, detail::snapshot_key_of_entry<snapshot_entry<Key, T> >, Compare> base;
+
+	public:
+		typedef T	mapped_type;
+
+		explicit mapped_map(const std::string& path, int mode = 0, const Compare& comp = Compare())
+			: base(path, mode, comp) {}
+
+		const mapped_type& at(const Key& key) const
+		{
+			typename base::const_iterator it = this->find(key);
+			if (it == this->end())
+			{
+				throw std::out_of_range("mapped_map::at");
+			}
+			return it->second;
+		}
+	};
+
+	template <class Key, class Compare = ::std::less<Key> >
+	class mapped_set
+		: public detail::mapped_sorted_array<Key, Key, detail::snapshot_key_of_key<Key>, Compare>
+	{
+		typedef detail::mapped_sorted_array<Key, Key, detail::snapshot_key_of_key<Key>, Compare> base;
+
+	public:
+		explicit mapped_set(const std::string& path, int mode = 0, const Compare& comp = Compare())
+			: base(path, mode, comp) {}
+	};
+}
+
+#endif
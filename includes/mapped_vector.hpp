@@ -0,0 +1,657 @@
+#ifndef MAPPED_VECTOR_HPP
+#define MAPPED_VECTOR_HPP
+
+#if __cplusplus < 201103L
+# error "mapped_vector.hpp requires C++11 (std::is_trivially_copyable, std::system_error)"
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <stddef.h>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "iterator/reverse_iterator.hpp"
+
+namespace ft
+{
+	// A file-backed vector of trivially copyable elements (POSIX mmap).
+	// The file is a 64-byte header (magic, version, element size, count, checksum) followed by the raw elements,
+	// so it holds no pointer and can be copied or moved around. The whole file is mapped shared: opening it is
+	// O(1) whatever its size (the pages are read on first touch), element access is a plain array access,
+	// and writes go to the page cache and reach the file without any serialization.
+	// Appending past the capacity grows the file (doubling) and remaps it, which invalidates iterators and references
+	// like a reallocation of ft::vector. close() (or the destructor) writes the count and the checksum and truncates
+	// the file to its size; until then a crash leaves the header of the last sync().
+	// The elements are stored in the byte order of the machine; a file written with the other order is rejected.
+	// A read-only file is mapped PROT_READ, so writing through it would crash: read it through a const vector
+	// (or a const reference), the non-const accessors assert that the file is writable.
+	template <class T>
+	class mapped_vector
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "mapped_vector elements are copied as raw bytes");
+		static_assert(alignof(T) <= 64, "the elements start 64 bytes into the mapping");
+
+	public:
+		typedef T										value_type;
+		typedef value_type&								reference;
+		typedef const value_type&						const_reference;
+		typedef value_type*								pointer;
+		typedef const value_type*						const_pointer;
+		typedef std::ptrdiff_t							difference_type;
+		typedef size_t									size_type;
+		typedef pointer									iterator;
+		typedef const_pointer							const_iterator;
+		typedef ft::reverse_iterator<iterator>			reverse_iterator;
+		typedef ft::reverse_iterator<const_iterator>	const_reverse_iterator;
+
+		enum open_mode
+		{
+			open_read_only = 0,
+			open_read_write = 1,
+			open_create = 2 | open_read_write,	// creates the file, or empties it
+			open_verify = 4						// checks the checksum of the elements: reads the whole file
+		};
+
+		// madvise() hints, for the whole mapping or a range of elements
+		enum access_advice
+		{
+			advice_normal = MADV_NORMAL,
+			advice_sequential = MADV_SEQUENTIAL,
+			advice_random = MADV_RANDOM,
+			advice_will_need = MADV_WILLNEED,
+			advice_dont_need = MADV_DONTNEED
+		};
+
+		static const uint32_t	format_version = 1;
+
+		mapped_vector() : _fd(-1), _mapping(NULL), _mapping_size(0), _size(0), _capacity(0), _writable(false) {}
+
+		// open_mode flags combined with |
+		explicit mapped_vector(const std::string& path, int mode = open_read_write)
+			: _fd(-1), _mapping(NULL), _mapping_size(0), _size(0), _capacity(0), _writable(false)
+		{
+			open(path, mode);
+		}
+
+		mapped_vector(mapped_vector&& other)
+			: _fd(-1), _mapping(NULL), _mapping_size(0), _size(0), _capacity(0), _writable(false)
+		{
+			swap(other);
+		}
+
+		mapped_vector& operator=(mapped_vector&& other)
+		{
+			if (this != &other)
+			{
+				close();
+				swap(other);
+			}
+			return *this;
+		}
+
+		~mapped_vector()
+		{
+			try
+			{
+				close();
+			}
+			catch (...)
+			{
+				// a destructor can't report it: call close() to see the errors
+			}
+		}
+
+		// FILE:
+		void open(const std::string& path, int mode = open_read_write)
+		{
+			close();
+			_writable = (mode & open_read_write) != 0;
+			int flags = _writable ? O_RDWR : O_RDONLY;
+			if ((mode & open_create) == open_create)
+			{
+				flags |= O_CREAT | O_TRUNC;
+			}
+			_fd = ::open(path.c_str(), flags | O_CLOEXEC, 0644);
+			if (_fd < 0)
+			{
+				throw std::system_error(errno, std::generic_category(), "mapped_vector: open " + path);
+			}
+			try
+			{
+				attach(path, mode);
+			}
+			catch (...)
+			{
+				release();
+				throw;
+			}
+		}
+
+		bool is_open() const
+		{
+			return _fd >= 0;
+		}
+
+		bool writable() const
+		{
+			return _writable;
+		}
+
+		// writes the count and the checksum to the header and flushes the mapping to the file
+		void sync()
+		{
+			if (!is_open() || !_writable)
+			{
+				return;
+			}
+			write_header();
+			if (::msync(_mapping, header_size + _size * sizeof(T), MS_SYNC) != 0)
+			{
+				throw std::system_error(errno, std::generic_category(), "mapped_vector: msync");
+			}
+		}
+
+		// writes the header, gives the unused capacity back to the file system and unmaps
+		void close()
+		{
+			if (!is_open())
+			{
+				return;
+			}
+			if (_writable)
+			{
+				write_header();
+				if (::ftruncate(_fd, static_cast<off_t>(header_size + _size * sizeof(T))) != 0)
+				{
+					int error = errno;
+					release();
+					throw std::system_error(error, std::generic_category(), "mapped_vector: ftruncate");
+				}
+			}
+			release();
+		}
+
+		void advise(access_advice advice)
+		{
+			if (_mapping != NULL && ::madvise(_mapping, _mapping_size, advice) != 0)
+			{
+				throw std::system_error(errno, std::generic_category(), "mapped_vector: madvise");
+			}
+		}
+
+		// the range is widened to whole pages
+		void advise(size_type first, size_type count, access_advice advice)
+		{
+			if (_mapping == NULL || count == 0)
+			{
+				return;
+			}
+			const size_t page = page_size();
+			size_t begin = header_size + first * sizeof(T);
+			size_t end = header_size + (first + count) * sizeof(T);
+			end = end > _mapping_size ? _mapping_size : end;
+			begin -= begin % page;
+			if (begin < end && ::madvise(static_cast<char*>(_mapping) + begin, end - begin, advice) != 0)
+			{
+				throw std::system_error(errno, std::generic_category(), "mapped_vector: madvise");
+			}
+		}
+
+		// of the elements as they are now, and as the header stored it at the last sync() / close()
+		uint64_t checksum() const
+		{
+			return compute_checksum(data(), _size * sizeof(T));
+		}
+
+		uint64_t stored_checksum() const
+		{
+			return _mapping == NULL ? 0 : header_of(_mapping)->checksum;
+		}
+
+		// ELEMENT ACCESS: the non-const ones all go through data()
+		reference at(size_type pos)
+		{
+			if (pos >= _size)
+			{
+				throw std::out_of_range("at()");
+			}
+			return data()[pos];
+		}
+		const_reference at(size_type pos) const
+		{
+			if (pos >= _size)
+			{
+				throw std::out_of_range("at()");
+			}
+			return data()[pos];
+		}
+		reference operator[](size_type pos)
+		{
+			return data()[pos];
+		}
+		const_reference operator[](size_type pos) const
+		{
+			return data()[pos];
+		}
+		reference front()
+		{
+			return data()[0];
+		}
+		const_reference front() const
+		{
+			return data()[0];
+		}
+		reference back()
+		{
+			return data()[_size - 1];
+		}
+		const_reference back() const
+		{
+			return data()[_size - 1];
+		}
+		pointer data()
+		{
+			assert(_writable || _mapping == NULL);
+			return _mapping == NULL ? NULL : reinterpret_cast<pointer>(static_cast<char*>(_mapping) + header_size);
+		}
+		const_pointer data() const
+		{
+			return _mapping == NULL ? NULL : reinterpret_cast<const_pointer>(static_cast<const char*>(_mapping) + header_size);
+		}
+
+		// ITERATORS:
+		iterator begin()
+		{
+			return data();
+		}
+		iterator end()
+		{
+			return data() + _size;
+		}
+		const_iterator begin() const
+		{
+			return data();
+		}
+		const_iterator end() const
+		{
+			return data() + _size;
+		}
+		reverse_iterator rbegin()
+		{
+			return reverse_iterator(end());
+		}
+		const_reverse_iterator rbegin() const
+		{
+			return const_reverse_iterator(end());
+		}
+		reverse_iterator rend()
+		{
+			return reverse_iterator(begin());
+		}
+		const_reverse_iterator rend() const
+		{
+			return const_reverse_iterator(begin());
+		}
+
+		// CAPACITY:
+		size_type size() const
+		{
+			return _size;
+		}
+		bool empty() const
+		{
+			return _size == 0;
+		}
+		size_type capacity() const
+		{
+			return _capacity;
+		}
+		size_type max_size() const
+		{
+			return (static_cast<size_type>(-1) - header_size) / sizeof(T);
+		}
+
+		// grows the file
+		void reserve(size_type new_cap)
+		{
+			if (new_cap > _capacity)
+			{
+				check_writable();
+				if (new_cap > max_size())
+				{
+					throw std::length_error("in reserve()");
+				}
+				remap(new_cap);
+			}
+		}
+
+		// MODIFIERS: all of them check the mode first, a read-only mapping can have spare capacity too
+		// (a file another vector has sync()ed but not closed yet)
+		void push_back(const value_type& value)
+		{
+			check_writable();
+			if (_size == _capacity)
+			{
+				value_type copy(value); // value may live in the mapping that moves
+				grow(_size + 1);
+				data()[_size++] = copy;
+				return;
+			}
+			data()[_size++] = value;
+		}
+
+		void pop_back()
+		{
+			check_writable();
+			--_size;
+		}
+
+		void resize(size_type n, const value_type& value = value_type())
+		{
+			check_writable();
+			if (n > _capacity)
+			{
+				value_type copy(value);
+				grow(n);
+				std::fill(data() + _size, data() + n, copy);
+			}
+			else if (n > _size)
+			{
+				std::fill(data() + _size, data() + n, value);
+			}
+			_size = n;
+		}
+
+		template <class InputIterator>
+		void append(InputIterator first, InputIterator last)
+		{
+			check_writable();
+			for (; first != last; ++first)
+			{
+				push_back(*first);
+			}
+		}
+
+		// one copy of the bytes for contiguous ranges
+		void append(const value_type* first, const value_type* last)
+		{
+			check_writable();
+			const size_type n = static_cast<size_type>(last - first);
+			if (_size + n > _capacity)
+			{
+				if (first >= data() && first < data() + _size) // from this vector, which is about to move
+				{
+					size_type offset = static_cast<size_type>(first - data());
+					grow(_size + n);
+					first = data() + offset;
+				}
+				else
+				{
+					grow(_size + n);
+				}
+			}
+			if (n != 0)
+			{
+				std::memmove(data() + _size, first, n * sizeof(T));
+			}
+			_size += n;
+		}
+
+		template <class InputIterator>
+		void assign(InputIterator first, InputIterator last)
+		{
+			check_writable();
+			clear();
+			append(first, last);
+		}
+
+		// the file keeps its size until close()
+		void clear()
+		{
+			check_writable();
+			_size = 0;
+		}
+
+		void swap(mapped_vector& other)
+		{
+			std::swap(_fd, other._fd);
+			std::swap(_mapping, other._mapping);
+			std::swap(_mapping_size, other._mapping_size);
+			std::swap(_size, other._size);
+			std::swap(_capacity, other._capacity);
+			std::swap(_writable, other._writable);
+		}
+
+	private:
+		mapped_vector(const mapped_vector&);
+		mapped_vector& operator=(const mapped_vector&);
+
+		// 64 bytes, the elements start on a cache line
+		struct header
+		{
+			uint64_t	magic;
+			uint32_t	version;
+			uint32_t	element_size;
+			uint64_t	count;
+			uint64_t	checksum;
+			uint64_t	reserved[4];
+		};
+
+		enum { header_size = 64 };
+		static const uint64_t	magic = 0x31434556504d5446ULL; // "FTMPVEC1" in a little endian file
+
+		static header* header_of(void* mapping)
+		{
+			return static_cast<header*>(mapping);
+		}
+		static const header* header_of(const void* mapping)
+		{
+			return static_cast<const header*>(mapping);
+		}
+
+		static size_t page_size()
+		{
+			return static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+		}
+
+		static uint64_t byte_swap(uint64_t value)
+		{
+			return __builtin_bswap64(value);
+		}
+
+		// 64-bit words mixed four lanes at a time (the lanes are independent so the multiplications overlap),
+		// then the tail bytes; meant to catch truncated or damaged files, not tampering
+		static uint64_t compute_checksum(const void* bytes, size_t length)
+		{
+			const uint64_t prime = 0x9E3779B97F4A7C15ULL;
+			const unsigned char* p = static_cast<const unsigned char*>(bytes);
+			uint64_t lanes[4] = { length, prime, ~length, ~prime };
+			size_t i = 0;
+			for (; i + 32 <= length; i += 32)
+			{
+				for (int lane = 0; lane < 4; ++lane)
+				{
+					uint64_t word;
+					std::memcpy(&word, p + i + lane * 8, 8);
+					lanes[lane] = ((lanes[lane] ^ word) * prime);
+					lanes[lane] ^= lanes[lane] >> 29;
+				}
+			}
+			uint64_t h = lanes[0] ^ (lanes[1] * 3) ^ (lanes[2] * 5) ^ (lanes[3] * 7);
+			for (; i < length; ++i)
+			{
+				h = (h ^ p[i]) * prime;
+			}
+			h ^= h >> 32;
+			return h;
+		}
+
+		void check_writable() const
+		{
+			if (!_writable)
+			{
+				throw std::logic_error("mapped_vector: the file is open read only");
+			}
+		}
+
+		// the mapping of a new or existing file, and its header checks
+		void attach(const std::string& path, int mode)
+		{
+			struct stat info;
+			if (::fstat(_fd, &info) != 0)
+			{
+				throw std::system_error(errno, std::generic_category(), "mapped_vector: stat " + path);
+			}
+			size_t file_size = static_cast<size_t>(info.st_size);
+			if (file_size == 0 && _writable)
+			{
+				if (::ftruncate(_fd, header_size) != 0)
+				{
+					throw std::system_error(errno, std::generic_category(), "mapped_vector: ftruncate " + path);
+				}
+				file_size = header_size;
+				map(file_size);
+				header* h = header_of(_mapping);
+				h->magic = magic;
+				h->version = format_version;
+				h->element_size = sizeof(T);
+				h->count = 0;
+				h->checksum = compute_checksum(NULL, 0);
+				return;
+			}
+			if (file_size < header_size)
+			{
+				throw std::runtime_error("mapped_vector: " + path + " is not a mapped_vector file");
+			}
+			map(file_size);
+			const header* h = header_of(_mapping);
+			if (h->magic != magic)
+			{
+				throw std::runtime_error("mapped_vector: " + path + (h->magic == byte_swap(magic)
+					? " was written with the other byte order" : " is not a mapped_vector file"));
+			}
+			if (h->version != format_version)
+			{
+				throw std::runtime_error("mapped_vector: " + path + " has an unknown format version");
+			}
+			if (h->element_size != sizeof(T))
+			{
+				throw std::runtime_error("mapped_vector: " + path + " holds elements of another size");
+			}
+			_capacity = (file_size - header_size) / sizeof(T);
+			if (h->count > _capacity)
+			{
+				throw std::runtime_error("mapped_vector: " + path + " is truncated");
+			}
+			_size = static_cast<size_type>(h->count);
+			if ((mode & open_verify) && checksum() != h->checksum)
+			{
+				throw std::runtime_error("mapped_vector: " + path + " fails its checksum");
+			}
+		}
+
+		void map(size_t length)
+		{
+			int protection = _writable ? PROT_READ | PROT_WRITE : PROT_READ;
+			void* mapping = ::mmap(NULL, length, protection, MAP_SHARED, _fd, 0);
+			if (mapping == MAP_FAILED)
+			{
+				throw std::system_error(errno, std::generic_category(), "mapped_vector: mmap");
+			}
+			_mapping = mapping;
+			_mapping_size = length;
+		}
+
+		// doubling, as ft::vector; the file grows by whole pages
+		void grow(size_type needed)
+		{
+			size_type new_cap = _capacity * 2;
+			new_cap = new_cap < needed ? needed : new_cap;
+			const size_t page = page_size();
+			size_t bytes = header_size + new_cap * sizeof(T);
+			bytes = (bytes + page - 1) / page * page;
+			remap((bytes - header_size) / sizeof(T));
+		}
+
+		void remap(size_type new_cap)
+		{
+			const size_t length = header_size + new_cap * sizeof(T);
+			if (::ftruncate(_fd, static_cast<off_t>(length)) != 0)
+			{
+				throw std::system_error(errno, std::generic_category(), "mapped_vector: ftruncate");
+			}
+#ifdef __linux__
+			void* mapping = ::mremap(_mapping, _mapping_size, length, MREMAP_MAYMOVE);
+			if (mapping == MAP_FAILED)
+			{
+				throw std::system_error(errno, std::generic_category(), "mapped_vector: mremap");
+			}
+			_mapping = mapping;
+			_mapping_size = length;
+#else
+			::munmap(_mapping, _mapping_size);
+			_mapping = NULL;
+			map(length);
+#endif
+			_capacity = new_cap;
+		}
+
+		void write_header()
+		{
+			header* h = header_of(_mapping);
+			h->count = _size;
+			h->checksum = checksum();
+		}
+
+		void release()
+		{
+			if (_mapping != NULL)
+			{
+				::munmap(_mapping, _mapping_size);
+			}
+			if (_fd >= 0)
+			{
+				::close(_fd);
+			}
+			_fd = -1;
+			_mapping = NULL;
+			_mapping_size = 0;
+			_size = 0;
+			_capacity = 0;
+			_writable = false;
+		}
+
+		int			_fd;
+		void*		_mapping;		// header then elements, NULL when closed
+		size_t		_mapping_size;
+		size_type	_size;
+		size_type	_capacity;		// elements that fit in the file as it is now
+		bool		_writable;
+	};
+
+	template <class T>
+	const uint32_t mapped_vector<T>::format_version;
+
+	template <class T>
+	const uint64_t mapped_vector<T>::magic;
+
+	template <class T>
+	void swap(mapped_vector<T>& x, mapped_vector<T>& y)
+	{
+		x.swap(y);
+	}
+}
+
+#endif
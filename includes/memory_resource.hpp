@@ -0,0 +1,728 @@
+#ifndef MEMORY_RESOURCE_HPP
+#define MEMORY_RESOURCE_HPP
+
+#if __cplusplus < 201103L
+# error "memory_resource.hpp requires C++11 (std::atomic, std::mutex)"
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <stdint.h>
+
+#include "map.hpp"
+#include "set.hpp"
+#include "stack.hpp"
+#include "vector.hpp"
+#include "utility/allocator_propagation.hpp"
+#include "utility/false_type.hpp"
+
+namespace ft
+{
+	// Polymorphic memory resources (std::pmr of C++17, for the ft containers): a container takes a
+	// polymorphic_allocator, which forwards every allocation to a memory_resource chosen at run time.
+	// ft::pmr::vector<int> is one type whether its memory comes from the heap, a monotonic buffer, a pool or an
+	// instrumented resource, so the strategy can change per tenant without the container types changing.
+	// The resource stays with its container: it is not taken over by copy-assignment or swap, and a copy starts
+	// on the default resource (select_on_copy_construction), as in std.
+	class memory_resource
+	{
+	public:
+		enum { max_align = 16 };		// what operator new guarantees on the usual 64-bit platforms
+
+		virtual ~memory_resource() {}
+
+		void* allocate(size_t bytes, size_t alignment = max_align)
+		{
+			return do_allocate(bytes, alignment);
+		}
+
+		void deallocate(void* p, size_t bytes, size_t alignment = max_align)
+		{
+			do_deallocate(p, bytes, alignment);
+		}
+
+		// whether memory allocated from one can be deallocated by the other
+		bool is_equal(const memory_resource& other) const
+		{
+			return do_is_equal(other);
+		}
+
+	private:
+		virtual void* do_allocate(size_t bytes, size_t alignment) = 0;
+		virtual void do_deallocate(void* p, size_t bytes, size_t alignment) = 0;
+		virtual bool do_is_equal(const memory_resource& other) const = 0;
+	};
+
+	inline bool operator==(const memory_resource& lhs, const memory_resource& rhs)
+	{
+		return &lhs == &rhs || lhs.is_equal(rhs);
+	}
+
+	inline bool operator!=(const memory_resource& lhs, const memory_resource& rhs)
+	{
+		return !(lhs == rhs);
+	}
+
+	namespace detail
+	{
+		// operator new and delete; an over-aligned block keeps the pointer operator new returned just before it
+		class new_delete_resource_impl : public memory_resource
+		{
+		private:
+			virtual void* do_allocate(size_t bytes, size_t alignment)
+			{
+				if (alignment <= max_align)
+				{
+					return ::operator new(bytes);
+				}
+				if (bytes > static_cast<size_t>(-1) - alignment - sizeof(void*))
+				{
+					throw std::bad_alloc(); // the padded size would wrap around
+				}
+				char* raw = static_cast<char*>(::operator new(bytes + alignment + sizeof(void*)));
+				uintptr_t aligned = (reinterpret_cast<uintptr_t>(raw) + sizeof(void*) + alignment - 1) & ~(uintptr_t(alignment) - 1);
+				reinterpret_cast<void**>(aligned)[-1] = raw;
+				return reinterpret_cast<void*>(aligned);
+			}
+
+			virtual void do_deallocate(void* p, size_t, size_t alignment)
+			{
+				if (alignment <= max_align)
+				{
+					::operator delete(p);
+				}
+				else if (p != NULL)
+				{
+					::operator delete(static_cast<void**>(p)[-1]);
+				}
+			}
+
+			virtual bool do_is_equal(const memory_resource& other) const
+			{
+				return this == &other;
+			}
+		};
+
+		class null_resource_impl : public memory_resource
+		{
+		private:
+			virtual void* do_allocate(size_t, size_t)
+			{
+				throw std::bad_alloc();
+			}
+
+			virtual void do_deallocate(void*, size_t, size_t) {}
+
+			virtual bool do_is_equal(const memory_resource& other) const
+			{
+				return this == &other;
+			}
+		};
+
+		inline std::atomic<memory_resource*>& default_resource_slot()
+		{
+			static std::atomic<memory_resource*> slot(NULL);
+			return slot;
+		}
+
+		inline size_t align_up(size_t n, size_t alignment)
+		{
+			return (n + alignment - 1) & ~(alignment - 1);
+		}
+	}
+
+	// the heap, through operator new and delete
+	inline memory_resource* new_delete_resource()
+	{
+		static detail::new_delete_resource_impl resource;
+		return &resource;
+	}
+
+	// allocate() always throws std::bad_alloc: as the upstream of a buffer, or as the resource of a container, it
+	// proves that a code path allocates nothing more than what it was given
+	inline memory_resource* null_memory_resource()
+	{
+		static detail::null_resource_impl resource;
+		return &resource;
+	}
+
+	// the resource of default constructed polymorphic_allocators (new_delete_resource() unless set);
+	// set_default_resource(NULL) restores it, the previous one is returned
+	inline memory_resource* get_default_resource()
+	{
+		memory_resource* resource = detail::default_resource_slot().load(std::memory_order_acquire);
+		return resource != NULL ? resource : new_delete_resource();
+	}
+
+	inline memory_resource* set_default_resource(memory_resource* resource)
+	{
+		memory_resource* previous = detail::default_resource_slot().exchange(resource, std::memory_order_acq_rel);
+		return previous != NULL ? previous : new_delete_resource();
+	}
+
+	// POLYMORPHIC ALLOCATOR: the allocator API of the containers over a memory_resource; it rebinds to the node
+	// types of map and set with the same resource
+	template <class T>
+	class polymorphic_allocator
+	{
+	public:
+		typedef T					value_type;
+		typedef T*					pointer;
+		typedef const T*			const_pointer;
+		typedef T&					reference;
+		typedef const T&			const_reference;
+		typedef size_t				size_type;
+		typedef std::ptrdiff_t		difference_type;
+
+		template <class U>
+		struct rebind
+		{
+			typedef polymorphic_allocator<U> other;
+		};
+
+		polymorphic_allocator() : _resource(get_default_resource()) {}
+
+		// not explicit: ft::pmr::vector<int> v(&pool);
+		polymorphic_allocator(memory_resource* resource) : _resource(resource) {}
+
+		template <class U>
+		polymorphic_allocator(const polymorphic_allocator<U>& other) : _resource(other.resource()) {}
+
+		pointer allocate(size_type n, const void* = 0)
+		{
+			if (n > max_size())
+			{
+				throw std::bad_alloc();
+			}
+			return static_cast<pointer>(_resource->allocate(n * sizeof(T), alignof(T)));
+		}
+
+		void deallocate(pointer p, size_type n)
+		{
+			_resource->deallocate(p, n * sizeof(T), alignof(T));
+		}
+
+		void construct(pointer p, const T& value)
+		{
+			::new (static_cast<void*>(p)) T(value);
+		}
+
+		void destroy(pointer p)
+		{
+			p->~T();
+		}
+
+		size_type max_size() const
+		{
+			return static_cast<size_type>(-1) / sizeof(T);
+		}
+
+		pointer address(reference x) const
+		{
+			return &x;
+		}
+
+		const_pointer address(const_reference x) const
+		{
+			return &x;
+		}
+
+		memory_resource* resource() const
+		{
+			return _resource;
+		}
+
+		polymorphic_allocator select_on_container_copy_construction() const
+		{
+			return polymorphic_allocator();
+		}
+
+	private:
+		memory_resource*	_resource;
+	};
+
+	template <class T, class U>
+	bool operator==(const polymorphic_allocator<T>& lhs, const polymorphic_allocator<U>& rhs)
+	{
+		return *lhs.resource() == *rhs.resource();
+	}
+
+	template <class T, class U>
+	bool operator!=(const polymorphic_allocator<T>& lhs, const polymorphic_allocator<U>& rhs)
+	{
+		return !(lhs == rhs);
+	}
+
+	template <class T>
+	struct allocator_propagation<polymorphic_allocator<T> >
+	{
+		typedef ft::false_type	propagate_on_copy_assignment;
+		typedef ft::false_type	propagate_on_swap;
+
+		static polymorphic_allocator<T> select_on_copy_construction(const polymorphic_allocator<T>& alloc)
+		{
+			return alloc.select_on_container_copy_construction();
+		}
+	};
+
+	// MONOTONIC BUFFER: bump allocation from an optional initial buffer, then from buffers of the upstream growing
+	// geometrically; deallocate() does nothing, release() (or the destructor) gives everything back at once.
+	// Not thread safe. With null_memory_resource() as upstream, nothing past the initial buffer can be allocated
+	class monotonic_buffer_resource : public memory_resource
+	{
+	public:
+		enum { default_buffer_size = 1024 };
+
+		explicit monotonic_buffer_resource(memory_resource* upstream = get_default_resource())
+			: _upstream(upstream), _buffers(NULL), _initial(NULL), _initial_size(0)
+			, _cursor(NULL), _end(NULL), _next_size(default_buffer_size)
+			{}
+
+		monotonic_buffer_resource(size_t initial_size, memory_resource* upstream = get_default_resource())
+			: _upstream(upstream), _buffers(NULL), _initial(NULL), _initial_size(0)
+			, _cursor(NULL), _end(NULL), _next_size(initial_size > 0 ? initial_size : 1)
+			{}
+
+		// the buffer is used first and must outlive the resource
+		monotonic_buffer_resource(void* buffer, size_t size, memory_resource* upstream = get_default_resource())
+			: _upstream(upstream), _buffers(NULL), _initial(static_cast<char*>(buffer)), _initial_size(size)
+			, _cursor(static_cast<char*>(buffer)), _end(static_cast<char*>(buffer) + size)
+			, _next_size(size > 0 ? size * 2 : static_cast<size_t>(default_buffer_size))
+			{}
+
+		~monotonic_buffer_resource()
+		{
+			release();
+		}
+
+		// gives the upstream buffers back and starts over on the initial buffer
+		void release()
+		{
+			while (_buffers != NULL)
+			{
+				buffer_header* next = _buffers->next;
+				_upstream->deallocate(_buffers, _buffers->size, max_align);
+				_buffers = next;
+			}
+			_cursor = _initial;
+			_end = _initial + _initial_size;
+		}
+
+		memory_resource* upstream_resource() const
+		{
+			return _upstream;
+		}
+
+	private:
+		monotonic_buffer_resource(const monotonic_buffer_resource&);
+		monotonic_buffer_resource& operator=(const monotonic_buffer_resource&);
+
+		struct buffer_header
+		{
+			buffer_header*	next;
+			size_t			size;		// of the whole buffer, header included
+		};
+
+		virtual void* do_allocate(size_t bytes, size_t alignment)
+		{
+			uintptr_t cursor = reinterpret_cast<uintptr_t>(_cursor);
+			size_t padding = (alignment - cursor % alignment) % alignment;
+			if (_cursor == NULL || bytes > static_cast<size_t>(_end - _cursor) || padding > static_cast<size_t>(_end - _cursor) - bytes)
+			{
+				next_buffer(bytes, alignment);
+				cursor = reinterpret_cast<uintptr_t>(_cursor);
+				padding = (alignment - cursor % alignment) % alignment;
+			}
+			char* p = _cursor + padding;
+			_cursor = p + bytes;
+			return p;
+		}
+
+		virtual void do_deallocate(void*, size_t, size_t) {}
+
+		virtual bool do_is_equal(const memory_resource& other) const
+		{
+			return this == &other;
+		}
+
+		void next_buffer(size_t bytes, size_t alignment)
+		{
+			size_t header = detail::align_up(sizeof(buffer_header), max_align);
+			if (bytes > static_cast<size_t>(-1) - header - alignment)
+			{
+				throw std::bad_alloc(); // no buffer can hold it, and the size below would wrap around
+			}
+			size_t size = _next_size;
+			if (size < header + bytes + alignment)
+			{
+				size = header + bytes + alignment;
+			}
+			buffer_header* b = static_cast<buffer_header*>(_upstream->allocate(size, max_align));
+			b->next = _buffers;
+			b->size = size;
+			_buffers = b;
+			_cursor = reinterpret_cast<char*>(b) + header;
+			_end = reinterpret_cast<char*>(b) + size;
+			_next_size = size * 2;
+		}
+
+		memory_resource*	_upstream;
+		buffer_header*		_buffers;
+		char*				_initial;
+		size_t				_initial_size;
+		char*				_cursor;
+		char*				_end;
+		size_t				_next_size;
+	};
+
+	// how a pool resource is cut: at most max_blocks_per_chunk blocks are taken from the upstream at once, and
+	// blocks bigger than largest_required_pool_block go to the upstream one by one (0 picks the defaults)
+	struct pool_options
+	{
+		size_t	max_blocks_per_chunk;
+		size_t	largest_required_pool_block;
+
+		pool_options() : max_blocks_per_chunk(0), largest_required_pool_block(0) {}
+	};
+
+	// POOLS: one free list per power-of-two block size (8 bytes up to largest_required_pool_block). A pool takes
+	// chunks from the upstream, each twice as many blocks as the last (up to max_blocks_per_chunk), and carves
+	// them lazily; a freed block is reused by the next allocation of its size. Not thread safe
+	class unsynchronized_pool_resource : public memory_resource
+	{
+	public:
+		enum
+		{
+			min_block_size = 8,
+			max_pool_alignment = 64,	// above this, the block comes from the upstream directly
+			default_max_blocks_per_chunk = 1024,
+			default_largest_block = 4096,
+			max_largest_block = 1 << 20
+		};
+
+		explicit unsynchronized_pool_resource(memory_resource* upstream = get_default_resource())
+			: _upstream(upstream), _oversized(NULL)
+		{
+			init(pool_options());
+		}
+
+		unsynchronized_pool_resource(const pool_options& opts, memory_resource* upstream = get_default_resource())
+			: _upstream(upstream), _oversized(NULL)
+		{
+			init(opts);
+		}
+
+		~unsynchronized_pool_resource()
+		{
+			release();
+		}
+
+		// gives every chunk and every oversized block back to the upstream
+		void release()
+		{
+			for (size_t i = 0; i < _pool_count; ++i)
+			{
+				pool& p = _pools[i];
+				while (p.chunks != NULL)
+				{
+					chunk_header* next = p.chunks->next;
+					_upstream->deallocate(p.chunks, p.chunks->size, chunk_alignment(i));
+					p.chunks = next;
+				}
+				p.free_list = NULL;
+				p.cursor = NULL;
+				p.end = NULL;
+				p.next_blocks = 1;
+			}
+			while (_oversized != NULL)
+			{
+				oversized_header* next = _oversized->next;
+				_upstream->deallocate(_oversized, _oversized->size, _oversized->alignment);
+				_oversized = next;
+			}
+		}
+
+		memory_resource* upstream_resource() const
+		{
+			return _upstream;
+		}
+
+		pool_options options() const
+		{
+			return _options;
+		}
+
+	private:
+		unsynchronized_pool_resource(const unsynchronized_pool_resource&);
+		unsynchronized_pool_resource& operator=(const unsynchronized_pool_resource&);
+
+		enum { max_pools = 18 };		// 8 bytes .. 1 MiB
+
+		struct free_block
+		{
+			free_block*	next;
+		};
+
+		struct chunk_header
+		{
+			chunk_header*	next;
+			size_t			size;
+		};
+
+		struct oversized_header
+		{
+			oversized_header*	prev;
+			oversized_header*	next;
+			size_t				size;
+			size_t				alignment;
+		};
+
+		struct pool
+		{
+			free_block*		free_list;
+			char*			cursor;		// the part of the newest chunk not handed out yet
+			char*			end;
+			chunk_header*	chunks;
+			size_t			next_blocks;
+		};
+
+		void init(const pool_options& opts)
+		{
+			_options = opts;
+			if (_options.max_blocks_per_chunk == 0)
+			{
+				_options.max_blocks_per_chunk = default_max_blocks_per_chunk;
+			}
+			if (_options.largest_required_pool_block == 0)
+			{
+				_options.largest_required_pool_block = default_largest_block;
+			}
+			if (_options.largest_required_pool_block > max_largest_block)
+			{
+				_options.largest_required_pool_block = max_largest_block;
+			}
+			_pool_count = 0;
+			while (block_size(_pool_count) < _options.largest_required_pool_block)
+			{
+				++_pool_count;
+			}
+			++_pool_count;
+			_options.largest_required_pool_block = block_size(_pool_count - 1);
+			for (size_t i = 0; i < _pool_count; ++i)
+			{
+				_pools[i].free_list = NULL;
+				_pools[i].cursor = NULL;
+				_pools[i].end = NULL;
+				_pools[i].chunks = NULL;
+				_pools[i].next_blocks = 1;
+			}
+		}
+
+		static size_t block_size(size_t index)
+		{
+			return static_cast<size_t>(min_block_size) << index;
+		}
+
+		// blocks are at multiples of their size from the start of the chunk data
+		static size_t chunk_alignment(size_t index)
+		{
+			size_t size = block_size(index);
+			return size < max_pool_alignment ? (size < max_align ? static_cast<size_t>(max_align) : size) : static_cast<size_t>(max_pool_alignment);
+		}
+
+		size_t pool_index(size_t bytes, size_t alignment) const
+		{
+			size_t needed = bytes > alignment ? bytes : alignment;
+			size_t index = 0;
+			while (block_size(index) < needed)
+			{
+				++index;
+			}
+			return index;
+		}
+
+		virtual void* do_allocate(size_t bytes, size_t alignment)
+		{
+			if (bytes > _options.largest_required_pool_block || alignment > max_pool_alignment)
+			{
+				return allocate_oversized(bytes, alignment);
+			}
+			size_t index = pool_index(bytes, alignment);
+			pool& p = _pools[index];
+			if (p.free_list != NULL)
+			{
+				free_block* block = p.free_list;
+				p.free_list = block->next;
+				return block;
+			}
+			if (p.cursor == p.end)
+			{
+				new_chunk(index);
+			}
+			void* block = p.cursor;
+			p.cursor += block_size(index);
+			return block;
+		}
+
+		virtual void do_deallocate(void* ptr, size_t bytes, size_t alignment)
+		{
+			if (bytes > _options.largest_required_pool_block || alignment > max_pool_alignment)
+			{
+				deallocate_oversized(ptr, alignment);
+				return;
+			}
+			pool& p = _pools[pool_index(bytes, alignment)];
+			free_block* block = static_cast<free_block*>(ptr);
+			block->next = p.free_list;
+			p.free_list = block;
+		}
+
+		virtual bool do_is_equal(const memory_resource& other) const
+		{
+			return this == &other;
+		}
+
+		void new_chunk(size_t index)
+		{
+			pool& p = _pools[index];
+			size_t alignment = chunk_alignment(index);
+			size_t header = detail::align_up(sizeof(chunk_header), alignment);
+			size_t size = header + p.next_blocks * block_size(index);
+			chunk_header* c = static_cast<chunk_header*>(_upstream->allocate(size, alignment));
+			c->next = p.chunks;
+			c->size = size;
+			p.chunks = c;
+			p.cursor = reinterpret_cast<char*>(c) + header;
+			p.end = reinterpret_cast<char*>(c) + size;
+			if (p.next_blocks * 2 <= _options.max_blocks_per_chunk)
+			{
+				p.next_blocks *= 2;
+			}
+		}
+
+		// kept on a list, so that release() can give them back; the header is right before the block
+		static size_t oversized_header_size(size_t alignment)
+		{
+			return detail::align_up(sizeof(oversized_header), alignment < max_align ? static_cast<size_t>(max_align) : alignment);
+		}
+
+		void* allocate_oversized(size_t bytes, size_t alignment)
+		{
+			if (alignment < max_align)
+			{
+				alignment = max_align;
+			}
+			size_t header = oversized_header_size(alignment);
+			if (bytes > static_cast<size_t>(-1) - header)
+			{
+				throw std::bad_alloc();
+			}
+			oversized_header* h = static_cast<oversized_header*>(_upstream->allocate(header + bytes, alignment));
+			h->prev = NULL;
+			h->next = _oversized;
+			h->size = header + bytes;
+			h->alignment = alignment;
+			if (_oversized != NULL)
+			{
+				_oversized->prev = h;
+			}
+			_oversized = h;
+			return reinterpret_cast<char*>(h) + header;
+		}
+
+		void deallocate_oversized(void* ptr, size_t alignment)
+		{
+			oversized_header* h = reinterpret_cast<oversized_header*>(static_cast<char*>(ptr) - oversized_header_size(alignment));
+			if (h->prev != NULL)
+			{
+				h->prev->next = h->next;
+			}
+			else
+			{
+				_oversized = h->next;
+			}
+			if (h->next != NULL)
+			{
+				h->next->prev = h->prev;
+			}
+			_upstream->deallocate(h, h->size, h->alignment);
+		}
+
+		memory_resource*	_upstream;
+		pool_options		_options;
+		size_t				_pool_count;
+		pool				_pools[max_pools];
+		oversized_header*	_oversized;
+	};
+
+	// the same pools behind a mutex, for a resource shared between threads
+	class synchronized_pool_resource : public memory_resource
+	{
+	public:
+		explicit synchronized_pool_resource(memory_resource* upstream = get_default_resource())
+			: _pools(upstream) {}
+
+		synchronized_pool_resource(const pool_options& opts, memory_resource* upstream = get_default_resource())
+			: _pools(opts, upstream) {}
+
+		void release()
+		{
+			std::lock_guard<std::mutex> guard(_mutex);
+			_pools.release();
+		}
+
+		memory_resource* upstream_resource() const
+		{
+			return _pools.upstream_resource();
+		}
+
+		pool_options options() const
+		{
+			return _pools.options();
+		}
+
+	private:
+		virtual void* do_allocate(size_t bytes, size_t alignment)
+		{
+			std::lock_guard<std::mutex> guard(_mutex);
+			return _pools.allocate(bytes, alignment);
+		}
+
+		virtual void do_deallocate(void* p, size_t bytes, size_t alignment)
+		{
+			std::lock_guard<std::mutex> guard(_mutex);
+			_pools.deallocate(p, bytes, alignment);
+		}
+
+		virtual bool do_is_equal(const memory_resource& other) const
+		{
+			return this == &other;
+		}
+
+		std::mutex						_mutex;
+		unsynchronized_pool_resource	_pools;
+	};
+
+	// CONTAINERS: the ft containers on a polymorphic_allocator
+	namespace pmr
+	{
+		using ft::memory_resource;
+		using ft::polymorphic_allocator;
+
+		template <class T>
+		using vector = ft::vector<T, polymorphic_allocator<T> >;
+
+		template <class Key, class T, class Compare = ::std::less<Key> >
+		using map = ft::map<Key, T, Compare, polymorphic_allocator<ft::pair<const Key, T> > >;
+
+		template <class T, class Compare = ::std::less<T> >
+		using set = ft::set<T, Compare, polymorphic_allocator<T> >;
+
+		template <class T>
+		using stack = ft::stack<T, vector<T> >;
+	}
+}
+
+#endif
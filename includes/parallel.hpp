@@ -0,0 +1,756 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#if __cplusplus < 201103L
+# error "parallel.hpp requires C++11 (std::thread)"
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <stdint.h>
+#include <type_traits>
+#include <utility>
+
+#include "concurrency/fork_join_pool.hpp"
+#include "map.hpp"
+#include "set.hpp"
+#include "vector.hpp"
+
+namespace ft
+{
+	// Parallel bulk algorithms over random access ranges (ft::vector iterators), run on a fork_join_pool.
+	// The range is split in halves with fork_join down to leaves of grain_size() elements, each leaf runs the sequential
+	// algorithm; idle workers steal the biggest halves left, so the load balances itself. A range of less than
+	// sequential_threshold elements doesn't touch the pool at all. Every algorithm has an overload that takes the pool
+	// to use; the other ones use default_pool(), which has one worker per hardware thread.
+	// reduce() and inclusive_scan() regroup the operations: op must be associative (not necessarily commutative).
+	namespace parallel
+	{
+		enum { sequential_threshold = 1 << 14, min_grain = 1 << 12, leaves_per_worker = 8 };
+
+		inline fork_join_pool& default_pool()
+		{
+			static fork_join_pool pool;
+			return pool;
+		}
+
+		// enough leaves for stealing to even out the workers, not so many that the forks cost more than the leaves
+		inline ptrdiff_t grain_size(ptrdiff_t n, const fork_join_pool& pool)
+		{
+			ptrdiff_t grain = n / static_cast<ptrdiff_t>(leaves_per_worker * pool.size());
+			return grain < min_grain ? static_cast<ptrdiff_t>(min_grain) : grain;
+		}
+
+		namespace detail
+		{
+			// calls body(lo, hi) on consecutive chunks of at most grain indexes covering [lo, hi)
+			template <typename Body>
+			void split(fork_join_pool& pool, ptrdiff_t lo, ptrdiff_t hi, ptrdiff_t grain, Body& body)
+			{
+				if (hi - lo <= grain)
+				{
+					body(lo, hi);
+					return;
+				}
+				ptrdiff_t mid = lo + (hi - lo) / 2;
+				pool.fork_join([&]() { split(pool, lo, mid, grain, body); }, [&]() { split(pool, mid, hi, grain, body); });
+			}
+
+			template <typename Body>
+			void for_chunks(fork_join_pool& pool, ptrdiff_t n, Body body)
+			{
+				ptrdiff_t grain = grain_size(n, pool);
+				pool.run([&]() { split(pool, 0, n, grain, body); });
+			}
+
+			template <typename RandomIt, typename BinaryOp>
+			typename std::iterator_traits<RandomIt>::value_type
+			reduce_range(fork_join_pool& pool, RandomIt first, ptrdiff_t n, ptrdiff_t grain, BinaryOp& op)
+			{
+				typedef typename std::iterator_traits<RandomIt>::value_type value_type;
+				if (n <= grain)
+				{
+					value_type sum = first[0];
+					for (ptrdiff_t i = 1; i < n; ++i)
+					{
+						sum = op(sum, first[i]);
+					}
+					return sum;
+				}
+				ptrdiff_t half = n / 2;
+				value_type* left = NULL;
+				value_type* right = NULL;
+				// the halves are constructed in place: value_type needs no default constructor
+				typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type left_storage, right_storage;
+				try
+				{
+					pool.fork_join([&]() { left = new (&left_storage) value_type(reduce_range(pool, first, half, grain, op)); },
+						[&]() { right = new (&right_storage) value_type(reduce_range(pool, first + half, n - half, grain, op)); });
+				}
+				catch (...)
+				{
+					if (left != NULL)
+					{
+						left->~value_type();
+					}
+					if (right != NULL)
+					{
+						right->~value_type();
+					}
+					throw;
+				}
+				value_type sum = op(*left, *right);
+				left->~value_type();
+				right->~value_type();
+				return sum;
+			}
+
+			// [0, block), [block, 2 * block), ... [.., n) as the list of their bounds
+			inline ft::vector<size_t> block_bounds(ptrdiff_t n, ptrdiff_t block)
+			{
+				ft::vector<size_t> bounds;
+				for (ptrdiff_t lo = 0; lo < n; lo += block)
+				{
+					bounds.push_back(static_cast<size_t>(lo));
+				}
+				bounds.push_back(static_cast<size_t>(n));
+				return bounds;
+			}
+
+			// Uninitialized storage whose elements are constructed by blocks in parallel. The blocks finished are destroyed
+			// with the buffer, also when another block threw: a fill that throws must destroy what it constructed itself
+			// (as std::uninitialized_copy does).
+			template <typename T>
+			class block_buffer
+			{
+			public:
+				explicit block_buffer(size_t capacity) : _data(_alloc.allocate(capacity)), _capacity(capacity) {}
+
+				~block_buffer()
+				{
+					for (size_t b = 0; b < _done.size(); ++b)
+					{
+						for (size_t i = _bounds[b]; _done[b] && i < _bounds[b + 1]; ++i)
+						{
+							_data[i].~T();
+						}
+					}
+					_alloc.deallocate(_data, _capacity);
+				}
+
+				T* data()
+				{
+					return _data;
+				}
+
+				// fill(lo, hi, data() + bounds[b]) constructs the elements [bounds[b], bounds[b + 1]) of the block b;
+				// lo and hi are the bounds of the block in the source, the same as the output bounds unless given apart
+				template <typename Fill>
+				void fill(fork_join_pool& pool, const ft::vector<size_t>& bounds, Fill fill)
+				{
+					this->fill(pool, bounds, bounds, fill);
+				}
+
+				template <typename Fill>
+				void fill(fork_join_pool& pool, const ft::vector<size_t>& source_bounds, const ft::vector<size_t>& bounds, Fill fill)
+				{
+					_bounds = bounds;
+					_done = ft::vector<char>(bounds.size() - 1, 0);
+					auto body = [&](ptrdiff_t lo, ptrdiff_t hi) {
+						for (ptrdiff_t b = lo; b < hi; ++b)
+						{
+							fill(source_bounds[b], source_bounds[b + 1], _data + _bounds[b]);
+							_done[b] = 1;
+						}
+					};
+					pool.run([&]() { split(pool, 0, static_cast<ptrdiff_t>(_done.size()), 1, body); });
+				}
+
+			private:
+				block_buffer(const block_buffer&);
+				block_buffer& operator=(const block_buffer&);
+
+				std::allocator<T>	_alloc;
+				T*					_data;
+				size_t				_capacity;
+				ft::vector<size_t>	_bounds;
+				ft::vector<char>	_done; // written by different workers, one byte per block
+			};
+
+			// merges [first1, last1) and [first2, last2) into out, the elements are moved; stable: the first range wins the ties
+			template <typename It, typename OutIt, typename Compare>
+			void merge(fork_join_pool& pool, It first1, It last1, It first2, It last2, OutIt out, ptrdiff_t grain, Compare& comp)
+			{
+				ptrdiff_t n1 = last1 - first1;
+				ptrdiff_t n2 = last2 - first2;
+				if (n1 + n2 <= grain)
+				{
+					std::merge(std::make_move_iterator(first1), std::make_move_iterator(last1),
+						std::make_move_iterator(first2), std::make_move_iterator(last2), out, comp);
+					return;
+				}
+				// splits the larger range in the middle and the other one where that middle element goes
+				It mid1;
+				It mid2;
+				if (n1 >= n2)
+				{
+					mid1 = first1 + n1 / 2;
+					mid2 = std::lower_bound(first2, last2, *mid1, comp); // equal elements of the second range go after
+				}
+				else
+				{
+					mid2 = first2 + n2 / 2;
+					mid1 = std::upper_bound(first1, last1, *mid2, comp); // equal elements of the first range go before
+				}
+				OutIt out_mid = out + (mid1 - first1) + (mid2 - first2);
+				pool.fork_join([&]() { merge(pool, first1, mid1, first2, mid2, out, grain, comp); },
+					[&]() { merge(pool, mid1, last1, mid2, last2, out_mid, grain, comp); });
+			}
+
+			// sorts [first, first + n); the result is in that range if in_place, else in [buffer, buffer + n).
+			// The two halves are sorted into the other array and merged back, so every level moves the elements once.
+			template <typename RandomIt, typename BufferIt, typename Compare, typename LeafSort>
+			void merge_sort(fork_join_pool& pool, RandomIt first, BufferIt buffer, ptrdiff_t n, bool in_place,
+				ptrdiff_t grain, Compare& comp, LeafSort& leaf_sort)
+			{
+				if (n <= grain)
+				{
+					leaf_sort(first, first + n, comp);
+					if (!in_place)
+					{
+						std::move(first, first + n, buffer);
+					}
+					return;
+				}
+				ptrdiff_t half = n / 2;
+				pool.fork_join([&]() { merge_sort(pool, first, buffer, half, !in_place, grain, comp, leaf_sort); },
+					[&]() { merge_sort(pool, first + half, buffer + half, n - half, !in_place, grain, comp, leaf_sort); });
+				if (in_place)
+				{
+					merge(pool, buffer, buffer + half, buffer + half, buffer + n, first, grain, comp);
+				}
+				else
+				{
+					merge(pool, first, first + half, first + half, first + n, buffer, grain, comp);
+				}
+			}
+
+			template <typename RandomIt, typename Compare, typename LeafSort>
+			void sort(fork_join_pool& pool, RandomIt first, RandomIt last, Compare comp, LeafSort leaf_sort)
+			{
+				typedef typename std::iterator_traits<RandomIt>::value_type value_type;
+				ptrdiff_t n = last - first;
+				if (n <= sequential_threshold)
+				{
+					leaf_sort(first, last, comp);
+					return;
+				}
+				ptrdiff_t grain = grain_size(n, pool);
+				block_buffer<value_type> buffer(static_cast<size_t>(n)); // only its storage is used, the copy is parallel too
+				buffer.fill(pool, block_bounds(n, grain), [first](size_t lo, size_t hi, value_type* out) {
+					std::uninitialized_copy(first + lo, first + hi, out);
+				});
+				pool.run([&]() { merge_sort(pool, first, buffer.data(), n, true, grain, comp, leaf_sort); });
+			}
+
+			struct std_sort
+			{
+				template <typename RandomIt, typename Compare>
+				void operator()(RandomIt first, RandomIt last, Compare& comp) const
+				{
+					std::sort(first, last, comp);
+				}
+			};
+
+			struct std_stable_sort
+			{
+				template <typename RandomIt, typename Compare>
+				void operator()(RandomIt first, RandomIt last, Compare& comp) const
+				{
+					std::stable_sort(first, last, comp);
+				}
+			};
+		}
+
+		// SORTING:
+		// a parallel merge sort with std::sort leaves; needs a buffer of n elements
+		template <typename RandomIt, typename Compare>
+		void sort(fork_join_pool& pool, RandomIt first, RandomIt last, Compare comp)
+		{
+			detail::sort(pool, first, last, comp, detail::std_sort());
+		}
+
+		template <typename RandomIt, typename Compare>
+		void sort(RandomIt first, RandomIt last, Compare comp)
+		{
+			parallel::sort(default_pool(), first, last, comp);
+		}
+
+		template <typename RandomIt>
+		void sort(RandomIt first, RandomIt last)
+		{
+			parallel::sort(first, last, std::less<typename std::iterator_traits<RandomIt>::value_type>());
+		}
+
+		// the leaves and the merges are both stable
+		template <typename RandomIt, typename Compare>
+		void stable_sort(fork_join_pool& pool, RandomIt first, RandomIt last, Compare comp)
+		{
+			detail::sort(pool, first, last, comp, detail::std_stable_sort());
+		}
+
+		template <typename RandomIt, typename Compare>
+		void stable_sort(RandomIt first, RandomIt last, Compare comp)
+		{
+			parallel::stable_sort(default_pool(), first, last, comp);
+		}
+
+		template <typename RandomIt>
+		void stable_sort(RandomIt first, RandomIt last)
+		{
+			parallel::stable_sort(first, last, std::less<typename std::iterator_traits<RandomIt>::value_type>());
+		}
+
+		// ELEMENT WISE:
+		// calls f on every element, in no particular order
+		template <typename RandomIt, typename Function>
+		void for_each(fork_join_pool& pool, RandomIt first, RandomIt last, Function f)
+		{
+			ptrdiff_t n = last - first;
+			if (n <= sequential_threshold)
+			{
+				std::for_each(first, last, f);
+				return;
+			}
+			detail::for_chunks(pool, n, [&](ptrdiff_t lo, ptrdiff_t hi) { std::for_each(first + lo, first + hi, f); });
+		}
+
+		template <typename RandomIt, typename Function>
+		void for_each(RandomIt first, RandomIt last, Function f)
+		{
+			parallel::for_each(default_pool(), first, last, f);
+		}
+
+		// out[i] = op(first[i]); out may be first. Returns the end of the output
+		template <typename RandomIt, typename OutIt, typename UnaryOp>
+		OutIt transform(fork_join_pool& pool, RandomIt first, RandomIt last, OutIt out, UnaryOp op)
+		{
+			ptrdiff_t n = last - first;
+			if (n <= sequential_threshold)
+			{
+				return std::transform(first, last, out, op);
+			}
+			detail::for_chunks(pool, n, [&](ptrdiff_t lo, ptrdiff_t hi) { std::transform(first + lo, first + hi, out + lo, op); });
+			return out + n;
+		}
+
+		template <typename RandomIt, typename OutIt, typename UnaryOp>
+		OutIt transform(RandomIt first, RandomIt last, OutIt out, UnaryOp op)
+		{
+			return parallel::transform(default_pool(), first, last, out, op);
+		}
+
+		// REDUCTIONS:
+		// op(init, op(first[0], ...)) with the operations grouped in any way
+		template <typename RandomIt, typename T, typename BinaryOp>
+		T reduce(fork_join_pool& pool, RandomIt first, RandomIt last, T init, BinaryOp op)
+		{
+			ptrdiff_t n = last - first;
+			if (n == 0)
+			{
+				return init;
+			}
+			if (n <= sequential_threshold)
+			{
+				return op(init, detail::reduce_range(pool, first, n, n, op));
+			}
+			ptrdiff_t grain = grain_size(n, pool);
+			T sum = init;
+			pool.run([&]() { sum = op(init, detail::reduce_range(pool, first, n, grain, op)); });
+			return sum;
+		}
+
+		template <typename RandomIt, typename T, typename BinaryOp>
+		T reduce(RandomIt first, RandomIt last, T init, BinaryOp op)
+		{
+			return parallel::reduce(default_pool(), first, last, init, op);
+		}
+
+		template <typename RandomIt, typename T>
+		T reduce(RandomIt first, RandomIt last, T init)
+		{
+			return parallel::reduce(first, last, init, std::plus<T>());
+		}
+
+		// out[i] = first[0] op ... op first[i]; out may be first. Returns the end of the output.
+		// Two passes over blocks: the sums of the blocks in parallel, their prefix sums sequentially,
+		// then every block is scanned in parallel starting from the sum of the blocks before it.
+		template <typename RandomIt, typename OutIt, typename BinaryOp>
+		OutIt inclusive_scan(fork_join_pool& pool, RandomIt first, RandomIt last, OutIt out, BinaryOp op)
+		{
+			typedef typename std::iterator_traits<RandomIt>::value_type value_type;
+			ptrdiff_t n = last - first;
+			if (n <= sequential_threshold)
+			{
+				return std::partial_sum(first, last, out, op);
+			}
+			ptrdiff_t block = grain_size(n, pool);
+			ptrdiff_t blocks = (n + block - 1) / block;
+			ft::vector<value_type> sums(static_cast<size_t>(blocks), first[0]);
+			pool.run([&]() {
+				auto block_sum = [&](ptrdiff_t lo, ptrdiff_t hi) {
+					for (ptrdiff_t b = lo; b < hi; ++b)
+					{
+						ptrdiff_t end = std::min(n, (b + 1) * block);
+						sums[b] = detail::reduce_range(pool, first + b * block, end - b * block, n, op);
+					}
+				};
+				detail::split(pool, 0, blocks, 1, block_sum);
+			});
+			for (ptrdiff_t b = 1; b < blocks; ++b)
+			{
+				sums[b] = op(sums[b - 1], sums[b]);
+			}
+			pool.run([&]() {
+				auto block_scan = [&](ptrdiff_t lo, ptrdiff_t hi) {
+					for (ptrdiff_t b = lo; b < hi; ++b)
+					{
+						ptrdiff_t begin = b * block;
+						ptrdiff_t end = std::min(n, begin + block);
+						value_type sum = b == 0 ? first[0] : op(sums[b - 1], first[begin]);
+						out[begin] = sum;
+						for (ptrdiff_t i = begin + 1; i < end; ++i)
+						{
+							sum = op(sum, first[i]);
+							out[i] = sum;
+						}
+					}
+				};
+				detail::split(pool, 0, blocks, 1, block_scan);
+			});
+			return out + n;
+		}
+
+		template <typename RandomIt, typename OutIt, typename BinaryOp>
+		OutIt inclusive_scan(RandomIt first, RandomIt last, OutIt out, BinaryOp op)
+		{
+			return parallel::inclusive_scan(default_pool(), first, last, out, op);
+		}
+
+		template <typename RandomIt, typename OutIt>
+		OutIt inclusive_scan(RandomIt first, RandomIt last, OutIt out)
+		{
+			return parallel::inclusive_scan(first, last, out, std::plus<typename std::iterator_traits<RandomIt>::value_type>());
+		}
+
+		// BULK BUILD:
+		namespace detail
+		{
+			// the key of an input element of build(): elements of a map input are pairs
+			template <typename Container>
+			struct build_key;
+
+			template <class Key, class T, class Compare, class Alloc, class Layout>
+			struct build_key<ft::map<Key, T, Compare, Alloc, Layout> >
+			{
+				template <typename Value>
+				static const typename Value::first_type& get(const Value& value)
+				{
+					return value.first;
+				}
+			};
+
+			template <class T, class Compare, class Alloc, class Layout>
+			struct build_key<ft::set<T, Compare, Alloc, Layout> >
+			{
+				template <typename Value>
+				static const Value& get(const Value& value)
+				{
+					return value;
+				}
+			};
+
+			// the fork of rbtree::assign_sorted_unique(): the halves of the tree are built by different workers
+			struct pool_fork
+			{
+				fork_join_pool* pool;
+
+				template <typename F, typename G>
+				void operator()(F& f, G& g) const
+				{
+					pool->fork_join(f, g);
+				}
+			};
+		}
+
+		// Replaces the contents of an ft::map or ft::set with the unsorted range [first, last), which is sorted in place.
+		// A parallel stable sort by key, a parallel removal of the duplicate keys (the first one is kept, as with insert()),
+		// then assign_sorted_unique(): the nodes are constructed in one arena and the subtrees are linked by different workers.
+		// O(n log n / threads) instead of n insertions of O(log n) with one allocation each.
+		template <class Container, class RandomIt>
+		void build(fork_join_pool& pool, Container& c, RandomIt first, RandomIt last)
+		{
+			typedef typename std::iterator_traits<RandomIt>::value_type	value_type;
+			typedef detail::build_key<Container>						key;
+			typename Container::key_compare comp = c.key_comp();
+			auto by_key = [&comp](const value_type& a, const value_type& b) { return comp(key::get(a), key::get(b)); };
+			// after the sort an element is the first of its key if its predecessor is less
+			auto is_first = [&](RandomIt it) { return it == first || by_key(*(it - 1), *it); };
+			ptrdiff_t n = last - first;
+			if (n <= sequential_threshold)
+			{
+				std::stable_sort(first, last, by_key);
+				RandomIt unique_last = std::unique(first, last, [&by_key](const value_type& a, const value_type& b) { return !by_key(a, b); });
+				c.assign_sorted_unique(first, unique_last);
+				return;
+			}
+			parallel::stable_sort(pool, first, last, by_key);
+			detail::pool_fork fork = { &pool };
+			ptrdiff_t block = grain_size(n, pool);
+			ft::vector<size_t> source_bounds = detail::block_bounds(n, block);
+			ft::vector<size_t> bounds(source_bounds.size(), 0);
+			auto count_kept = [&](ptrdiff_t lo, ptrdiff_t hi) {
+				for (ptrdiff_t b = lo; b < hi; ++b)
+				{
+					size_t kept = 0;
+					for (size_t i = source_bounds[b]; i < source_bounds[b + 1]; ++i)
+					{
+						kept += is_first(first + i);
+					}
+					bounds[b + 1] = kept;
+				}
+			};
+			pool.run([&]() { detail::split(pool, 0, static_cast<ptrdiff_t>(source_bounds.size() - 1), 1, count_kept); });
+			for (size_t b = 1; b < bounds.size(); ++b)
+			{
+				bounds[b] += bounds[b - 1];
+			}
+			if (bounds.back() == static_cast<size_t>(n))
+			{
+				pool.run([&]() { c.assign_sorted_unique(first, last, fork); });
+				return;
+			}
+			detail::block_buffer<value_type> unique(bounds.back());
+			unique.fill(pool, source_bounds, bounds, [&](size_t lo, size_t hi, value_type* out) {
+				value_type* constructed = out;
+				try
+				{
+					for (size_t i = lo; i < hi; ++i)
+					{
+						if (is_first(first + i))
+						{
+							::new (static_cast<void*>(constructed)) value_type(first[i]);
+							++constructed;
+						}
+					}
+				}
+				catch (...)
+				{
+					for (; constructed != out; --constructed)
+					{
+						(constructed - 1)->~value_type();
+					}
+					throw;
+				}
+			});
+			pool.run([&]() { c.assign_sorted_unique(unique.data(), unique.data() + bounds.back(), fork); });
+		}
+
+		template <class Container, class RandomIt>
+		void build(Container& c, RandomIt first, RandomIt last)
+		{
+			parallel::build(default_pool(), c, first, last);
+		}
+
+		// BATCHED LOOKUPS:
+		// the order in which the keys of a batch are looked up: sorted, consecutive lookups walk down almost the same path
+		enum probe_order { probe_auto, probe_as_given, probe_sorted };
+
+		namespace detail
+		{
+			enum { min_probe_grain = 1024 };
+
+			// a chunk of lookups is a multiple of 64 keys, so no two chunks write to the same bitmap word
+			inline ptrdiff_t probe_grain(ptrdiff_t n, const fork_join_pool& pool)
+			{
+				ptrdiff_t grain = n / static_cast<ptrdiff_t>(leaves_per_worker * pool.size());
+				grain = grain < min_probe_grain ? static_cast<ptrdiff_t>(min_probe_grain) : grain;
+				return (grain + 63) / 64 * 64;
+			}
+
+			// probe_auto sorts a batch that is dense (at least 1 key for 16 elements) in a tree too big for the caches:
+			// then most of the nodes a lookup loads were just loaded by the previous one
+			template <class Container>
+			bool sorts_probes(const Container& c, ptrdiff_t n, probe_order order)
+			{
+				if (order != probe_auto)
+				{
+					return order == probe_sorted;
+				}
+				return c.size() >= (size_t(1) << 16) && static_cast<size_t>(n) >= c.size() / 16;
+			}
+
+			// the positions of the keys in sorted order
+			template <class Container, class KeyIt>
+			ft::vector<size_t> sorted_positions(fork_join_pool& pool, const Container& c, KeyIt keys, ptrdiff_t n)
+			{
+				ft::vector<size_t> positions(static_cast<size_t>(n), 0);
+				size_t* data = &positions[0];
+				for_chunks(pool, n, [data](ptrdiff_t lo, ptrdiff_t hi) {
+					for (ptrdiff_t i = lo; i < hi; ++i)
+					{
+						data[i] = static_cast<size_t>(i);
+					}
+				});
+				typename Container::key_compare comp = c.key_comp();
+				parallel::sort(pool, positions.begin(), positions.end(), [&](size_t a, size_t b) { return comp(keys[a], keys[b]); });
+				return positions;
+			}
+
+			// base[positions[i]] seen as the i-th element: the keys in sorted order, or the output slots of their results
+			template <class It>
+			struct permuted_iterator
+			{
+				It				base;
+				const size_t*	positions;
+
+				typename std::iterator_traits<It>::reference operator[](ptrdiff_t i) const
+				{
+					return base[positions[i]];
+				}
+
+				typename std::iterator_traits<It>::reference operator*() const
+				{
+					return base[*positions];
+				}
+
+				permuted_iterator& operator++()
+				{
+					++positions;
+					return *this;
+				}
+
+				permuted_iterator operator+(ptrdiff_t n) const
+				{
+					permuted_iterator moved = { base, positions + n };
+					return moved;
+				}
+
+				ptrdiff_t operator-(const permuted_iterator& other) const
+				{
+					return positions - other.positions;
+				}
+			};
+
+			template <class It>
+			permuted_iterator<It> permute(It base, const size_t* positions)
+			{
+				permuted_iterator<It> permuted = { base, positions };
+				return permuted;
+			}
+
+			// calls body(lo, hi) in parallel on the chunks [0, grain), [grain, 2 * grain), ... of [0, n)
+			template <typename Body>
+			void for_aligned_chunks(fork_join_pool& pool, ptrdiff_t n, ptrdiff_t grain, Body body)
+			{
+				auto blocks = [&](ptrdiff_t lo, ptrdiff_t hi) {
+					for (ptrdiff_t b = lo; b < hi; ++b)
+					{
+						body(b * grain, std::min(n, (b + 1) * grain));
+					}
+				};
+				pool.run([&]() { split(pool, 0, (n + grain - 1) / grain, 1, blocks); });
+			}
+		}
+
+		// out[i] = c.find(first[i]) for the random access range of keys, with the same results as one find() at a time.
+		// Chunks of the batch are looked up by different workers, each with the interleaved descents of c.find_many();
+		// with sorted probes (see probe_order) every worker takes a chunk of the keys in sorted order and the results are
+		// written back to the positions of their keys. out must be random access. Returns the end of the output.
+		template <class Container, class KeyIt, class OutIt>
+		OutIt find_many(fork_join_pool& pool, Container& c, KeyIt first, KeyIt last, OutIt out, probe_order order = probe_auto)
+		{
+			ptrdiff_t n = last - first;
+			if (n <= detail::min_probe_grain)
+			{
+				return c.find_many(first, last, out);
+			}
+			ptrdiff_t grain = detail::probe_grain(n, pool);
+			if (!detail::sorts_probes(c, n, order))
+			{
+				detail::for_aligned_chunks(pool, n, grain, [&](ptrdiff_t lo, ptrdiff_t hi) { c.find_many(first + lo, first + hi, out + lo); });
+				return out + n;
+			}
+			ft::vector<size_t> positions = detail::sorted_positions(pool, c, first, n);
+			const size_t* sorted = &positions[0];
+			detail::for_aligned_chunks(pool, n, grain, [&](ptrdiff_t lo, ptrdiff_t hi) {
+				c.find_many(detail::permute(first, sorted + lo), detail::permute(first, sorted + hi), detail::permute(out, sorted + lo));
+			});
+			return out + n;
+		}
+
+		template <class Container, class KeyIt, class OutIt>
+		OutIt find_many(Container& c, KeyIt first, KeyIt last, OutIt out, probe_order order = probe_auto)
+		{
+			return parallel::find_many(default_pool(), c, first, last, out, order);
+		}
+
+		// bit i % 64 of bitmap[i / 64] is set if first[i] is in c, as c.contains_many() but split between the workers
+		template <class Container, class KeyIt>
+		void contains_many(fork_join_pool& pool, const Container& c, KeyIt first, KeyIt last, uint64_t* bitmap,
+			probe_order order = probe_auto)
+		{
+			ptrdiff_t n = last - first;
+			if (n <= detail::min_probe_grain)
+			{
+				c.contains_many(first, last, bitmap);
+				return;
+			}
+			ptrdiff_t grain = detail::probe_grain(n, pool);
+			if (!detail::sorts_probes(c, n, order))
+			{
+				detail::for_aligned_chunks(pool, n, grain, [&](ptrdiff_t lo, ptrdiff_t hi) {
+					c.contains_many(first + lo, first + hi, bitmap + lo / 64);
+				});
+				return;
+			}
+			// the hits in sorted order land on scattered bits: they go through one byte per key
+			ft::vector<size_t> positions = detail::sorted_positions(pool, c, first, n);
+			const size_t* sorted = &positions[0];
+			ft::vector<char> hits(static_cast<size_t>(n), 0);
+			char* hit = &hits[0];
+			detail::for_aligned_chunks(pool, n, grain, [&](ptrdiff_t lo, ptrdiff_t hi) {
+				ft::vector<uint64_t> words(static_cast<size_t>((hi - lo + 63) / 64), 0);
+				c.contains_many(detail::permute(first, sorted + lo), detail::permute(first, sorted + hi), &words[0]);
+				for (ptrdiff_t i = lo; i < hi; ++i)
+				{
+					hit[sorted[i]] = static_cast<char>((words[(i - lo) / 64] >> ((i - lo) % 64)) & 1);
+				}
+			});
+			detail::for_aligned_chunks(pool, n, grain, [&](ptrdiff_t lo, ptrdiff_t hi) {
+				for (ptrdiff_t word = lo / 64; word * 64 < hi; ++word)
+				{
+					uint64_t bits = 0;
+					for (ptrdiff_t i = word * 64; i < hi && i < (word + 1) * 64; ++i)
+					{
+						bits |= uint64_t(hit[i]) << (i % 64);
+					}
+					bitmap[word] = bits;
+				}
+			});
+		}
+
+		template <class Container, class KeyIt>
+		void contains_many(const Container& c, KeyIt first, KeyIt last, uint64_t* bitmap, probe_order order = probe_auto)
+		{
+			parallel::contains_many(default_pool(), c, first, last, bitmap, order);
+		}
+	}
+}
+
+#endif
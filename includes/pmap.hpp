@@ -0,0 +1,291 @@
+#ifndef PMAP_HPP
+#define PMAP_HPP
+
+#include <functional>
+#include <memory>
+#include <stddef.h>
+
+#include "red_black_tree/prbtree.hpp"
+
+#include "iterator/reverse_iterator.hpp"
+
+#include "utility/lexicographical_compare.hpp"
+#include "utility/equal.hpp"
+#include "utility/pair.hpp"
+#include "utility/is_integral.hpp"
+#include "utility/enable_if.hpp"
+#include "utility/is_transparent.hpp"
+#include "utility/ft_swap.hpp"
+
+namespace ft
+{
+	// Persistent map: a pmap object is an immutable version. insert(), insert_or_assign() and erase() leave it unchanged
+	// and return the new version, which shares all the untouched nodes with this one (O(log n) new nodes per update).
+	// Copies are O(1), so keeping every version of a large map (undo history, readers of old versions) is cheap.
+	// Thread safety: from C++11 on the node counts are atomic, so versions can be copied, read and destroyed on other
+	// threads while new ones are built (one pmap object is not assigned while another thread reads it, as with
+	// shared_ptr). Before C++11 all the versions sharing nodes must stay on one thread.
+	//     ft::pmap<int, int> v1 = v0.insert(ft::make_pair(1, 1));
+	template < class Key,                                     		// pmap::key_type
+           class T,                                       			// pmap::mapped_type
+           class Compare = ::std::less<Key>,                     	// pmap::key_compare
+           class Alloc = std::allocator<ft::pair<const Key,T> >    // pmap::allocator_type
+           >
+    class pmap
+	{
+    public:
+        typedef Key											key_type;
+        typedef T											mapped_type;
+        typedef ft::pair<const key_type,mapped_type>		value_type;
+        typedef Compare										key_compare;
+        typedef Alloc										allocator_type;
+        typedef const value_type&							reference;
+        typedef const value_type&							const_reference;
+		typedef typename allocator_type::const_pointer		pointer;
+		typedef typename allocator_type::const_pointer		const_pointer;
+		typedef typename allocator_type::size_type			size_type;
+		typedef typename allocator_type::difference_type	difference_type;
+
+	private:
+		typedef prbtree<value_type, key_compare, allocator_type, prbtree_node_for_map<value_type> > tree_type;
+
+	public:
+		// a version can't be modified through its iterators
+		typedef typename tree_type::const_iterator			iterator;
+		typedef typename tree_type::const_iterator			const_iterator;
+        typedef ft::reverse_iterator<const_iterator>		reverse_iterator;
+        typedef ft::reverse_iterator<const_iterator>		const_reverse_iterator;
+
+		class value_compare
+		{
+			friend class pmap;
+		protected:
+			Compare comp;
+			value_compare(Compare c) : comp(c) {}
+
+		public:
+			typedef bool result_type;
+  			typedef value_type first_argument_type;
+  			typedef value_type second_argument_type;
+  			bool operator()(const value_type& x, const value_type& y) const {
+				return comp(x.first, y.first);
+			}
+		};
+
+	private:
+		tree_type	_tree;
+
+		explicit pmap(const tree_type& tree) : _tree(tree) {}
+
+	public:
+		// CONSTRUCTORS:
+		explicit pmap(const key_compare& comp = key_compare(),
+					const allocator_type& alloc = allocator_type()) : _tree(comp, alloc) {}
+
+		template <class InputIterator>
+		pmap(InputIterator first, InputIterator last,
+			const key_compare& comp = key_compare(),
+			const allocator_type& alloc = allocator_type(),
+			typename ft::enable_if<!ft::is_integral<InputIterator>::value, InputIterator>::type* = 0) : _tree(comp, alloc)
+		{
+			for (; first != last; ++first)
+			{
+				_tree = _tree.insert(*first);
+			}
+		}
+
+		// O(1): the copy shares the whole tree
+		pmap(const pmap& x) : _tree(x._tree) {}
+
+		~pmap() {}
+
+		pmap& operator=(const pmap& x)
+		{
+			_tree = x._tree;
+			return *this;
+		}
+
+		allocator_type get_allocator() const
+		{
+			return _tree.get_allocator();
+		}
+
+		// ITERATORS:
+		const_iterator begin() const
+		{
+			return _tree.begin();
+		}
+
+		const_iterator end() const
+		{
+			return _tree.end();
+		}
+
+		const_reverse_iterator rbegin() const
+		{
+			return _tree.rbegin();
+		}
+
+		const_reverse_iterator rend() const
+		{
+			return _tree.rend();
+		}
+
+		// CAPACITY:
+		bool empty() const
+		{
+			return _tree.empty();
+		}
+
+		size_type size() const
+		{
+			return _tree.size();
+		}
+
+		size_type max_size() const
+		{
+			return _tree.max_size();
+		}
+
+		// UPDATES (return the new version):
+		// an existing key keeps its value, the same version is returned
+		pmap insert(const value_type& val) const
+		{
+			return pmap(_tree.insert(val));
+		}
+
+		pmap insert_or_assign(const key_type& k, const mapped_type& obj) const
+		{
+			return pmap(_tree.insert_or_assign(value_type(k, obj)));
+		}
+
+		// a missing key returns the same version
+		pmap erase(const key_type& key) const
+		{
+			return pmap(_tree.erase(key));
+		}
+
+		pmap clear() const
+		{
+			return pmap(_tree.key_comp(), _tree.get_allocator());
+		}
+
+		// LOOKUP:
+		size_type count(const key_type& key) const
+		{
+			return _tree.count(key);
+		}
+
+		const_iterator find(const key_type& key) const
+		{
+			return _tree.find(key);
+		}
+
+		const_iterator lower_bound(const key_type& key) const
+		{
+			return _tree.lower_bound(key);
+		}
+
+		const_iterator upper_bound(const key_type& key) const
+		{
+			return _tree.upper_bound(key);
+		}
+
+		pair<const_iterator,const_iterator> equal_range(const key_type& key) const
+		{
+			return _tree.equal_range(key);
+		}
+
+		// heterogeneous lookup with a transparent comparator, as in ft::map
+		template <class K>
+		size_type count(const K& key, typename ft::enable_if<ft::is_transparent<key_compare>::value, K>::type* = 0) const
+		{
+			return _tree.count(key);
+		}
+
+		template <class K>
+		const_iterator find(const K& key, typename ft::enable_if<ft::is_transparent<key_compare>::value, K>::type* = 0) const
+		{
+			return _tree.find(key);
+		}
+
+		template <class K>
+		const_iterator lower_bound(const K& key, typename ft::enable_if<ft::is_transparent<key_compare>::value, K>::type* = 0) const
+		{
+			return _tree.lower_bound(key);
+		}
+
+		template <class K>
+		const_iterator upper_bound(const K& key, typename ft::enable_if<ft::is_transparent<key_compare>::value, K>::type* = 0) const
+		{
+			return _tree.upper_bound(key);
+		}
+
+		// OBSERVERS:
+		key_compare key_comp() const
+		{
+			return _tree.key_comp();
+		}
+
+		value_compare value_comp() const
+		{
+			return value_compare(_tree.key_comp());
+		}
+
+		void swap(pmap& other)
+		{
+			_tree.swap(other._tree);
+		}
+
+		// how many owners share the root: 1 when no other version (or pmap copy) has this exact tree
+		size_type root_use_count() const
+		{
+			return _tree.root_use_count();
+		}
+	};
+
+	template< class Key, class T, class Compare, class Alloc >
+	void swap( ft::pmap<Key,T,Compare,Alloc>& lhs, ft::pmap<Key,T,Compare,Alloc>& rhs )
+	{
+		lhs.swap(rhs);
+	}
+
+	//relational operators (pmap):
+	template <class Key, class T, class Compare, class Alloc>
+	bool operator==( const pmap<Key,T,Compare,Alloc>& lhs, const pmap<Key,T,Compare,Alloc>& rhs )
+	{
+		return lhs.size() == rhs.size() && ft::equal(lhs.begin(), lhs.end(), rhs.begin());
+	}
+
+	template <class Key, class T, class Compare, class Alloc>
+	bool operator!=( const pmap<Key,T,Compare,Alloc>& lhs,const pmap<Key,T,Compare,Alloc>& rhs )
+	{
+		return !(lhs == rhs);
+	}
+
+	template <class Key, class T, class Compare, class Alloc>
+	bool operator<( const pmap<Key,T,Compare,Alloc>& lhs,const pmap<Key,T,Compare,Alloc>& rhs )
+	{
+		return ft::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+	}
+
+	template <class Key, class T, class Compare, class Alloc>
+	bool operator<=( const pmap<Key,T,Compare,Alloc>& lhs,const pmap<Key,T,Compare,Alloc>& rhs )
+	{
+		return !(rhs < lhs);
+	}
+
+	template <class Key, class T, class Compare, class Alloc>
+	bool operator>( const pmap<Key,T,Compare,Alloc>& lhs,const pmap<Key,T,Compare,Alloc>& rhs )
+	{
+		return rhs < lhs;
+	}
+
+	template <class Key, class T, class Compare, class Alloc>
+	bool operator>=( const pmap<Key,T,Compare,Alloc>& lhs,const pmap<Key,T,Compare,Alloc>& rhs )
+	{
+		return !(lhs < rhs);
+	}
+}
+
+#endif
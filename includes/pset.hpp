@@ -0,0 +1,264 @@
+#ifndef PSET_HPP
+#define PSET_HPP
+
+#include <functional>
+#include <memory>
+#include <stddef.h>
+
+#include "red_black_tree/prbtree.hpp"
+
+#include "iterator/reverse_iterator.hpp"
+
+#include "utility/lexicographical_compare.hpp"
+#include "utility/equal.hpp"
+#include "utility/pair.hpp"
+#include "utility/is_integral.hpp"
+#include "utility/enable_if.hpp"
+#include "utility/is_transparent.hpp"
+#include "utility/ft_swap.hpp"
+
+namespace ft
+{
+	// Persistent set: a pset object is an immutable version, insert() and erase() return the new one
+	// (see pmap, also for thread safety: only from C++11 on can versions sharing nodes live on different threads)
+	template < class T,                        // pset::key_type/value_type
+           class Compare = ::std::less<T>,        // pset::key_compare/value_compare
+           class Alloc = ::std::allocator<T>      // pset::allocator_type
+           >
+    class pset
+	{
+    public:
+        typedef T											key_type;
+        typedef T											value_type;
+        typedef Compare										key_compare;
+        typedef Compare										value_compare;
+        typedef Alloc										allocator_type;
+        typedef const value_type&							reference;
+        typedef const value_type&							const_reference;
+		typedef typename allocator_type::const_pointer		pointer;
+		typedef typename allocator_type::const_pointer		const_pointer;
+		typedef typename allocator_type::size_type			size_type;
+		typedef typename allocator_type::difference_type	difference_type;
+
+	private:
+		typedef prbtree<value_type, key_compare, allocator_type, prbtree_node_for_set<value_type> > tree_type;
+
+	public:
+		// a version can't be modified through its iterators
+		typedef typename tree_type::const_iterator			iterator;
+		typedef typename tree_type::const_iterator			const_iterator;
+        typedef ft::reverse_iterator<const_iterator>		reverse_iterator;
+        typedef ft::reverse_iterator<const_iterator>		const_reverse_iterator;
+
+	private:
+		tree_type	_tree;
+
+		explicit pset(const tree_type& tree) : _tree(tree) {}
+
+	public:
+		// CONSTRUCTORS:
+		explicit pset(const key_compare& comp = key_compare(),
+					const allocator_type& alloc = allocator_type()) : _tree(comp, alloc) {}
+
+		template <class InputIterator>
+		pset(InputIterator first, InputIterator last,
+			const key_compare& comp = key_compare(),
+			const allocator_type& alloc = allocator_type(),
+			typename ft::enable_if<!ft::is_integral<InputIterator>::value, InputIterator>::type* = 0) : _tree(comp, alloc)
+		{
+			for (; first != last; ++first)
+			{
+				_tree = _tree.insert(*first);
+			}
+		}
+
+		// O(1): the copy shares the whole tree
+		pset(const pset& x) : _tree(x._tree) {}
+
+		~pset() {}
+
+		pset& operator=(const pset& x)
+		{
+			_tree = x._tree;
+			return *this;
+		}
+
+		allocator_type get_allocator() const
+		{
+			return _tree.get_allocator();
+		}
+
+		// ITERATORS:
+		const_iterator begin() const
+		{
+			return _tree.begin();
+		}
+
+		const_iterator end() const
+		{
+			return _tree.end();
+		}
+
+		const_reverse_iterator rbegin() const
+		{
+			return _tree.rbegin();
+		}
+
+		const_reverse_iterator rend() const
+		{
+			return _tree.rend();
+		}
+
+		// CAPACITY:
+		bool empty() const
+		{
+			return _tree.empty();
+		}
+
+		size_type size() const
+		{
+			return _tree.size();
+		}
+
+		size_type max_size() const
+		{
+			return _tree.max_size();
+		}
+
+		// UPDATES (return the new version):
+		// an existing key returns the same version
+		pset insert(const value_type& val) const
+		{
+			return pset(_tree.insert(val));
+		}
+
+		// a missing key returns the same version
+		pset erase(const key_type& key) const
+		{
+			return pset(_tree.erase(key));
+		}
+
+		pset clear() const
+		{
+			return pset(_tree.key_comp(), _tree.get_allocator());
+		}
+
+		// LOOKUP:
+		size_type count(const key_type& key) const
+		{
+			return _tree.count(key);
+		}
+
+		const_iterator find(const key_type& key) const
+		{
+			return _tree.find(key);
+		}
+
+		const_iterator lower_bound(const key_type& key) const
+		{
+			return _tree.lower_bound(key);
+		}
+
+		const_iterator upper_bound(const key_type& key) const
+		{
+			return _tree.upper_bound(key);
+		}
+
+		pair<const_iterator,const_iterator> equal_range(const key_type& key) const
+		{
+			return _tree.equal_range(key);
+		}
+
+		// heterogeneous lookup with a transparent comparator, as in ft::set
+		template <class K>
+		size_type count(const K& key, typename ft::enable_if<ft::is_transparent<key_compare>::value, K>::type* = 0) const
+		{
+			return _tree.count(key);
+		}
+
+		template <class K>
+		const_iterator find(const K& key, typename ft::enable_if<ft::is_transparent<key_compare>::value, K>::type* = 0) const
+		{
+			return _tree.find(key);
+		}
+
+		template <class K>
+		const_iterator lower_bound(const K& key, typename ft::enable_if<ft::is_transparent<key_compare>::value, K>::type* = 0) const
+		{
+			return _tree.lower_bound(key);
+		}
+
+		template <class K>
+		const_iterator upper_bound(const K& key, typename ft::enable_if<ft::is_transparent<key_compare>::value, K>::type* = 0) const
+		{
+			return _tree.upper_bound(key);
+		}
+
+		// OBSERVERS:
+		key_compare key_comp() const
+		{
+			return _tree.key_comp();
+		}
+
+		value_compare value_comp() const
+		{
+			return key_comp();
+		}
+
+		void swap(pset& other)
+		{
+			_tree.swap(other._tree);
+		}
+
+		// how many owners share the root: 1 when no other version (or pset copy) has this exact tree
+		size_type root_use_count() const
+		{
+			return _tree.root_use_count();
+		}
+	};
+
+	template< class T, class Compare, class Alloc >
+	void swap( ft::pset<T,Compare,Alloc>& lhs, ft::pset<T,Compare,Alloc>& rhs )
+	{
+		lhs.swap(rhs);
+	}
+
+	//relational operators (pset):
+	template <class T, class Compare, class Alloc>
+	bool operator==( const pset<T,Compare,Alloc>& lhs, const pset<T,Compare,Alloc>& rhs )
+	{
+		return lhs.size() == rhs.size() && ft::equal(lhs.begin(), lhs.end(), rhs.begin());
+	}
+
+	template <class T, class Compare, class Alloc>
+	bool operator!=( const pset<T,Compare,Alloc>& lhs,const pset<T,Compare,Alloc>& rhs )
+	{
+		return !(lhs == rhs);
+	}
+
+	template <class T, class Compare, class Alloc>
+	bool operator<( const pset<T,Compare,Alloc>& lhs,const pset<T,Compare,Alloc>& rhs )
+	{
+		return ft::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+	}
+
+	template <class T, class Compare, class Alloc>
+	bool operator<=( const pset<T,Compare,Alloc>& lhs,const pset<T,Compare,Alloc>& rhs )
+	{
+		return !(rhs < lhs);
+	}
+
+	template <class T, class Compare, class Alloc>
+	bool operator>( const pset<T,Compare,Alloc>& lhs,const pset<T,Compare,Alloc>& rhs )
+	{
+		return rhs < lhs;
+	}
+
+	template <class T, class Compare, class Alloc>
+	bool operator>=( const pset<T,Compare,Alloc>& lhs,const pset<T,Compare,Alloc>& rhs )
+	{
+		return !(lhs < rhs);
+	}
+}
+
+#endif
@@ -0,0 +1,1244 @@
+#ifndef INDEX_RBTREE_HPP
+#define INDEX_RBTREE_HPP
+
+#include <new>
+#include <climits>
+#include <iostream>
+#include <stdexcept>
+
+#include "iterator/reverse_iterator.hpp"
+#include "utility/enable_if.hpp"
+#include "utility/is_integral.hpp"
+#include "utility/ft_swap.hpp"
+#include "utility/allocator_propagation.hpp"
+#include "utility/ebo_storage.hpp"
+#include "utility/is_trivially_destructible.hpp"
+#include "utility/prefetch.hpp"
+
+#include "index_rbtree_iterator.hpp"
+#include "rbtree.hpp"
+#include "rbtree_node.hpp"
+
+namespace ft
+{
+	// The red-black tree of map/set with rbtree_index_layout: the same interface and the same algorithms as rbtree,
+	// but the nodes live in the segments of a slab (index_rbtree_slab) and link each other by uint32_t index.
+	// A node of an ft::set<uint32_t> is 16 bytes instead of 32, the nodes inserted together are next to each other
+	// in memory, and a node costs no allocation of its own: a segment is allocated every time the slab doubles.
+	// Freed nodes go on a free list and are reused by the next inserts; the segments are given back by clear().
+	// The tree object is the slab pointer only (8 bytes); the slab header is allocated by the constructor.
+	template <typename T, typename Compare, typename Alloc, typename Node>
+	class index_rbtree
+		: private ft::ebo_storage<Compare>
+		, private ft::ebo_storage<typename Alloc::template rebind<Node>::other>
+	{
+	public:
+		typedef T																	value_type;
+		typedef typename Node::key_type												key_type;
+		typedef Compare																key_compare;
+		typedef Alloc																allocator_type;
+		typedef typename Node::node_base_type										node_base_type;
+		typedef index_rbtree_iter<value_type, Node>									iterator;
+		typedef index_rbtree_iter<const value_type, Node>							const_iterator;
+		typedef ft::reverse_iterator<iterator>										reverse_iterator;
+		typedef ft::reverse_iterator<const_iterator>								const_reverse_iterator;
+		typedef typename allocator_type::size_type									size_type;
+
+	private:
+		typedef typename Alloc::template rebind<Node>::other						node_alloc_type;
+		typedef Node*																node_pointer;
+		typedef index_rbtree_slab<Node>												slab_type;
+		typedef typename Alloc::template rebind<slab_type>::other					slab_alloc_type;
+		typedef typename slab_type::index_type										index_type;
+		typedef ft::ebo_storage<key_compare>										compare_storage;
+		typedef ft::ebo_storage<node_alloc_type>									node_alloc_storage;
+		typedef ft::allocator_propagation<node_alloc_type>							propagation;
+
+		static const index_type	nil = slab_type::nil;
+
+		slab_type*	_slab;
+
+	public:
+		index_rbtree(const key_compare& comp,
+			const allocator_type& alloc)
+			: compare_storage(comp)
+			, node_alloc_storage(node_alloc_type(alloc))
+			, _slab(new_slab())
+			{}
+
+		index_rbtree(const index_rbtree& other)
+			: compare_storage(other.compare())
+			, node_alloc_storage(propagation::select_on_copy_construction(other.node_alloc()))
+			, _slab(new_slab())
+		{
+		}
+
+		~index_rbtree()
+		{
+			clear();
+			delete_slab();
+		}
+
+		index_rbtree& operator=(const index_rbtree& x)
+		{
+			if (this != &x)
+			{
+				clear();
+				if (propagation::propagate_on_copy_assignment::value && !(node_alloc() == x.node_alloc()))
+				{
+					// the slab header goes back to the allocator it came from; the new one is allocated first, so a
+					// throwing allocator leaves this tree as it was (empty)
+					slab_type* slab = new_slab(x.node_alloc());
+					delete_slab();
+					node_alloc() = x.node_alloc();
+					_slab = slab;
+				}
+				insert(x.begin(), x.end());
+			}
+			return *this;
+		}
+
+	private:
+		struct index_iterator_accessor : public iterator
+		{
+			inline index_type get_index() const
+			{
+				return this->_index;
+			}
+		};
+
+		inline index_type get_index(const iterator& it) const
+		{
+			return static_cast<const index_iterator_accessor&>(it).get_index();
+		}
+
+		iterator make_iterator(index_type index) const
+		{
+			return iterator(_slab, index);
+		}
+
+		const_iterator make_const_iterator(index_type index) const
+		{
+			return const_iterator(_slab, index);
+		}
+
+		node_alloc_type& node_alloc()
+		{
+			return node_alloc_storage::get();
+		}
+
+		const node_alloc_type& node_alloc() const
+		{
+			return node_alloc_storage::get();
+		}
+
+		const key_compare& compare() const
+		{
+			return compare_storage::get();
+		}
+
+		template <typename K1, typename K2>
+		bool compare(const K1& lhs, const K2& rhs) const
+		{
+			return compare_storage::get()(lhs, rhs);
+		}
+
+		// the links of node i; never called with nil, which has no node
+		node_pointer at(index_type i) const
+		{
+			return _slab->node(i);
+		}
+
+		const key_type& key_of(index_type i) const
+		{
+			return at(i)->get_key();
+		}
+
+		index_type& left(index_type i) const
+		{
+			return at(i)->_left;
+		}
+
+		index_type& right(index_type i) const
+		{
+			return at(i)->_right;
+		}
+
+		index_type parent(index_type i) const
+		{
+			return at(i)->parent();
+		}
+
+		void set_parent(index_type i, index_type parent_index)
+		{
+			at(i)->set_parent(parent_index);
+		}
+
+		// nil leaves count as black nodes
+		e_color color_of(index_type i) const
+		{
+			return i == nil ? BLACK : at(i)->color();
+		}
+
+		void set_color(index_type i, e_color color)
+		{
+			at(i)->set_color(color);
+		}
+
+		index_type root() const
+		{
+			return _slab->root;
+		}
+
+	public:
+		allocator_type get_allocator() const
+		{
+			return allocator_type(node_alloc());
+		}
+
+		// ITERATORS:
+		iterator begin()
+		{
+			return make_iterator(_slab->next(nil));
+		}
+
+		const_iterator begin() const
+		{
+			return make_const_iterator(_slab->next(nil));
+		}
+
+		iterator end()
+		{
+			return make_iterator(nil);
+		}
+
+		const_iterator end() const
+		{
+			return make_const_iterator(nil);
+		}
+
+		reverse_iterator rbegin()
+		{
+			if (empty())
+			{
+				return rend();
+			}
+			return reverse_iterator(end());
+		}
+
+		const_reverse_iterator rbegin() const
+		{
+			if (empty())
+			{
+				return rend();
+			}
+			return const_reverse_iterator(end());
+		}
+
+		reverse_iterator rend()
+		{
+			return reverse_iterator(begin());
+		}
+
+		const_reverse_iterator rend() const
+		{
+			return const_reverse_iterator(begin());
+		}
+
+		// CAPACITY:
+		bool empty() const
+		{
+			return root() == nil;
+		}
+
+		size_type max_size() const
+		{
+			size_type nodes = node_alloc().max_size();
+			return nodes < size_type(slab_type::max_nodes) ? nodes : size_type(slab_type::max_nodes);
+		}
+
+		size_type size() const
+		{
+			return _slab->size;
+		}
+
+		// MODIFIERS:
+		// the nodes are destroyed without rebalancing (not at all if they need no destructor) and the segments freed
+		void clear()
+		{
+			if (!ft::is_trivially_destructible<Node>::value)
+			{
+				destroy_subtree(root());
+			}
+			for (size_t segment = 0; segment < _slab->segment_count; ++segment)
+			{
+				node_alloc().deallocate(_slab->segments[segment], slab_type::segment_size(segment));
+			}
+			_slab->root = nil;
+			_slab->free_list = nil;
+			_slab->used = 0;
+			_slab->capacity = 0;
+			_slab->size = 0;
+			_slab->segment_count = 0;
+		}
+
+		void erase(iterator position)
+		{
+			index_type index = get_index(position);
+			delete_node_index(index);
+			destroy_node(index);
+			_slab->size--;
+		}
+
+		// K is key_type, or any type comparable with it when the comparator is transparent (checked by map/set)
+		template <typename K>
+		size_type erase(const K& key)
+		{
+			iterator iter = find(key);
+			if (iter == end())
+				return 0;
+			erase(iter);
+			return 1;
+		}
+
+		void erase(iterator first, iterator last)
+		{
+			if (first == begin() && last == end())
+			{
+				clear();
+			}
+			else
+			{
+				iterator iter = first;
+				iterator next = iter;
+				while (iter != last)
+				{
+					next++;
+					erase(iter);
+					iter = next;
+				}
+			}
+		}
+
+		// insert():
+		// single element (1)
+		pair<iterator,bool> insert(const value_type& val)
+		{
+			pair<index_type, bool> position_pair = get_position_for_insertion(Node::get_key_from_value(val));
+			if (position_pair.second != false)
+			{
+				index_type index = take_slot();
+				try
+				{
+					::new (static_cast<void*>(at(index))) Node(NULL, val);
+				}
+				catch (...)
+				{
+					release_slot(index);
+					throw;
+				}
+				return insert_node_at_position(position_pair.first, index);
+			}
+			return pair<iterator, bool>(make_iterator(position_pair.first), false);
+		}
+
+		// try_emplace(): the lookup is done first, the value is constructed (directly inside the node) only if the key is missing
+		pair<iterator,bool> try_emplace(const key_type& key)
+		{
+			pair<index_type, bool> position_pair = get_position_for_insertion(key);
+			if (position_pair.second != false)
+			{
+				index_type index = take_slot();
+				try
+				{
+					::new (static_cast<void*>(at(index))) Node(NULL, key);
+				}
+				catch (...)
+				{
+					release_slot(index);
+					throw;
+				}
+				return insert_node_at_position(position_pair.first, index);
+			}
+			return pair<iterator, bool>(make_iterator(position_pair.first), false);
+		}
+
+		template <class Arg>
+		pair<iterator,bool> try_emplace(const key_type& key, const Arg& arg)
+		{
+			pair<index_type, bool> position_pair = get_position_for_insertion(key);
+			if (position_pair.second != false)
+			{
+				index_type index = take_slot();
+				try
+				{
+					::new (static_cast<void*>(at(index))) Node(NULL, key, arg);
+				}
+				catch (...)
+				{
+					release_slot(index);
+					throw;
+				}
+				return insert_node_at_position(position_pair.first, index);
+			}
+			return pair<iterator, bool>(make_iterator(position_pair.first), false);
+		}
+
+		// with hint (2)
+		iterator insert(iterator, const value_type& val)
+		{
+			return insert(val).first;
+		}
+
+		// range (3)
+		template <class InputIterator>
+		void insert(typename ft::enable_if<!ft::is_integral<InputIterator>::value, InputIterator>::type first, InputIterator last)
+		{
+			for (InputIterator iter = first; iter != last; ++iter)
+			{
+				insert(*iter);
+			}
+		}
+
+		//LOOKUP:
+		template <typename K>
+		size_type count(const K& key) const
+		{
+			if (find(key) == end())
+				return (0);
+			return (1);
+		}
+
+		template <typename K>
+		pair<iterator,iterator> equal_range(const K& key)
+		{
+			return ft::pair<iterator, iterator>(lower_bound(key), upper_bound(key));
+		}
+
+		template <typename K>
+		pair<const_iterator,const_iterator> equal_range(const K& key) const
+		{
+			return ft::pair<const_iterator, const_iterator>(lower_bound(key), upper_bound(key));
+		}
+
+		template <typename K>
+		iterator find(const K& key)
+		{
+			return make_iterator(find_index(key));
+		}
+
+		template <typename K>
+		const_iterator find(const K& key) const
+		{
+			return make_const_iterator(find_index(key));
+		}
+
+		template <typename K>
+		iterator lower_bound(const K& key)
+		{
+			return make_iterator(lower_bound_index(key));
+		}
+
+		template <typename K>
+		const_iterator lower_bound(const K& key) const
+		{
+			return make_const_iterator(lower_bound_index(key));
+		}
+
+		template <typename K>
+		iterator upper_bound(const K& key)
+		{
+			return make_iterator(upper_bound_index(key));
+		}
+
+		template <typename K>
+		const_iterator upper_bound(const K& key) const
+		{
+			return make_const_iterator(upper_bound_index(key));
+		}
+
+		// RANGE SCANS: see rbtree::walk_range()
+		enum { range_batch_size = 64 };
+
+		template <typename K, typename Function>
+		Function for_each_range(const K& lo, const K& hi, Function fn)
+		{
+			range_visitor<value_type, Function> visitor(fn);
+			walk_range(lo, hi, visitor);
+			return fn;
+		}
+
+		template <typename K, typename Function>
+		Function for_each_range(const K& lo, const K& hi, Function fn) const
+		{
+			range_visitor<const value_type, Function> visitor(fn);
+			walk_range(lo, hi, visitor);
+			return fn;
+		}
+
+		template <typename K, typename Function>
+		Function for_each_range_batch(const K& lo, const K& hi, Function fn)
+		{
+			range_batch_visitor<value_type, Function> visitor(fn);
+			walk_range(lo, hi, visitor);
+			visitor.flush();
+			return fn;
+		}
+
+		template <typename K, typename Function>
+		Function for_each_range_batch(const K& lo, const K& hi, Function fn) const
+		{
+			range_batch_visitor<const value_type, Function> visitor(fn);
+			walk_range(lo, hi, visitor);
+			visitor.flush();
+			return fn;
+		}
+
+		// BATCHED LOOKUPS: see rbtree::find_many()
+		enum { find_lanes = 8 };
+
+		template <typename KeyIt, typename OutIt>
+		OutIt find_many(KeyIt keys, size_type count, OutIt out)
+		{
+			index_type found[find_lanes];
+			for (size_type done = 0; done < count; done += find_lanes)
+			{
+				size_type lanes = count - done < size_type(find_lanes) ? count - done : size_type(find_lanes);
+				find_indexes(keys + done, lanes, found);
+				for (size_type i = 0; i < lanes; ++i, ++out)
+				{
+					*out = make_iterator(found[i]);
+				}
+			}
+			return out;
+		}
+
+		template <typename KeyIt, typename OutIt>
+		OutIt find_many(KeyIt keys, size_type count, OutIt out) const
+		{
+			index_type found[find_lanes];
+			for (size_type done = 0; done < count; done += find_lanes)
+			{
+				size_type lanes = count - done < size_type(find_lanes) ? count - done : size_type(find_lanes);
+				find_indexes(keys + done, lanes, found);
+				for (size_type i = 0; i < lanes; ++i, ++out)
+				{
+					*out = make_const_iterator(found[i]);
+				}
+			}
+			return out;
+		}
+
+		template <typename KeyIt>
+		void contains_many(KeyIt keys, size_type count, uint64_t* bitmap) const
+		{
+			index_type found[find_lanes];
+			for (size_type word = 0; word * 64 < count; ++word)
+			{
+				uint64_t bits = 0;
+				for (size_type done = word * 64; done < count && done < (word + 1) * 64; done += find_lanes)
+				{
+					size_type lanes = count - done < size_type(find_lanes) ? count - done : size_type(find_lanes);
+					find_indexes(keys + done, lanes, found);
+					for (size_type i = 0; i < lanes; ++i)
+					{
+						bits |= uint64_t(found[i] != nil) << ((done + i) % 64);
+					}
+				}
+				bitmap[word] = bits;
+			}
+		}
+
+		// BULK BUILD:
+		// Replaces the contents with [first, first + n), sorted with strictly increasing keys: the values go to the
+		// nodes 1 .. n in order and the middle node of every range becomes the root of its subtree, like
+		// rbtree::assign_sorted_unique(). The nodes are built in this thread, the fork is not used (and first is only
+		// incremented, compact() passes the tree's own iterators).
+		template <class RandomIt, class Fork>
+		void assign_sorted_unique(RandomIt first, size_type n, Fork&)
+		{
+			clear();
+			if (n == 0)
+			{
+				return;
+			}
+			if (n > size_type(slab_type::max_nodes))
+			{
+				throw std::length_error("index_rbtree: too many nodes");
+			}
+			while (_slab->capacity < n)
+			{
+				add_segment();
+			}
+			index_type built = 0;
+			try
+			{
+				for (; built < n; ++built, ++first)
+				{
+					::new (static_cast<void*>(at(built + 1))) Node(NULL, *first);
+				}
+			}
+			catch (...)
+			{
+				for (index_type i = 1; i <= built; ++i)
+				{
+					node_alloc().destroy(at(i));
+				}
+				clear();
+				throw;
+			}
+			_slab->used = static_cast<index_type>(n);
+			size_type red_depth = 0; // floor(log2(n)): the depth of the deepest level, the root is at depth 0
+			for (size_type m = n; m > 1; m /= 2)
+			{
+				++red_depth;
+			}
+			_slab->root = link_range(1, static_cast<index_type>(n) + 1, 0, red_depth);
+			set_parent(root(), nil);
+			set_color(root(), BLACK);
+			_slab->size = n;
+		}
+
+		// COMPACTION:
+		// The slab doesn't scatter the nodes over the heap and reuses freed slots first, but after a churn the
+		// neighbours in key order are far apart in it. compact() copies the elements to a new slab at the indexes
+		// 1 .. n in order and rebuilds the tree balanced (see rbtree::compact()); it invalidates all iterators and
+		// references. There is no compact_step(): moving a node to another slot of the same slab would exchange it
+		// with the node already there, so the slab can only be rebuilt in one go, and a bounded step would be a lie.
+		void compact()
+		{
+			index_rbtree fresh(compare(), get_allocator());
+			rbtree_sequential_fork fork;
+			fresh.assign_sorted_unique(begin(), size(), fork);
+			swap_nodes(fresh);
+		}
+
+		// OBSERVERS:
+		key_compare key_comp() const
+		{
+			return compare();
+		}
+
+		// the slabs are exchanged: iterators hold the slab, so they stay valid and follow their elements.
+		// With allocators that don't propagate and differ, the contents are copied like in rbtree::swap()
+		void swap(index_rbtree& other)
+		{
+			swap(other, typename propagation::propagate_on_swap());
+		}
+
+	private:
+		void swap(index_rbtree& other, ft::true_type)
+		{
+			swap_nodes(other);
+		}
+
+		void swap(index_rbtree& other, ft::false_type)
+		{
+			if (node_alloc() == other.node_alloc())
+			{
+				swap_nodes(other);
+				return;
+			}
+			index_rbtree to_this(other.compare(), allocator_type(node_alloc()));
+			to_this.insert(other.begin(), other.end());
+			index_rbtree to_other(compare(), allocator_type(other.node_alloc()));
+			to_other.insert(begin(), end());
+			swap_nodes(to_this);
+			other.swap_nodes(to_other);
+		}
+
+		void swap_nodes(index_rbtree& other)
+		{
+			ft::swap(other._slab, _slab);
+			ft::swap(other.node_alloc(), node_alloc());
+			ft::swap(other.compare_storage::get(), compare_storage::get());
+		}
+
+	public:
+		void tree_print_helper()
+		{
+			if (empty())
+			{
+				std::cout << "The map is empty\n";
+				return;
+			}
+			int n = 1;
+			for (iterator i = begin(); i != end(); ++i, ++n)
+			{
+				index_type index = get_index(i);
+				std::cout << n << ": node " << index << " " << (color_of(index) == BLACK ? "BLACK" : "RED  ")
+					<< " parent " << parent(index) << " left " << left(index) << " right " << right(index)
+					<< (index == root() ? " (root)" : "") << std::endl;
+			}
+			std::cout << "--------------------------------------------------" << std::endl;
+		}
+
+	private:
+		// SLAB:
+		slab_type* new_slab()
+		{
+			return new_slab(node_alloc());
+		}
+
+		static slab_type* new_slab(const node_alloc_type& alloc)
+		{
+			slab_alloc_type slab_alloc(alloc);
+			slab_type* slab = slab_alloc.allocate(1);
+			::new (static_cast<void*>(slab)) slab_type(); // value-initialized: empty, no segment
+			return slab;
+		}
+
+		void delete_slab()
+		{
+			slab_alloc_type(node_alloc()).deallocate(_slab, 1);
+		}
+
+		void add_segment()
+		{
+			size_t segment = _slab->segment_count;
+			size_t count = slab_type::segment_size(segment);
+			if (segment == size_t(slab_type::max_segments))
+			{
+				throw std::length_error("index_rbtree: too many nodes");
+			}
+			_slab->segments[segment] = node_alloc().allocate(count);
+			_slab->segment_count = segment + 1;
+			_slab->capacity += static_cast<index_type>(count);
+		}
+
+		// the index of a slot for a new node: the last freed one, or the next one never used
+		index_type take_slot()
+		{
+			index_type index = _slab->free_list;
+			if (index != nil)
+			{
+				_slab->free_list = left(index);
+				return index;
+			}
+			if (_slab->used == slab_type::max_nodes)
+			{
+				throw std::length_error("index_rbtree: too many nodes");
+			}
+			if (_slab->used == _slab->capacity)
+			{
+				add_segment();
+			}
+			return ++_slab->used;
+		}
+
+		// a free slot holds a bare node base, linked to the next free slot through _left
+		void release_slot(index_type index)
+		{
+			rbtree_index_node_base* slot = ::new (static_cast<void*>(at(index))) rbtree_index_node_base();
+			slot->_left = _slab->free_list;
+			_slab->free_list = index;
+		}
+
+		void destroy_node(index_type index)
+		{
+			node_alloc().destroy(at(index));
+			release_slot(index);
+		}
+
+		// post-order destruction, like rbtree::destroy_subtree()
+		void destroy_subtree(index_type index)
+		{
+			while (index != nil)
+			{
+				destroy_subtree(right(index));
+				index_type next = left(index);
+				node_alloc().destroy(at(index));
+				index = next;
+			}
+		}
+
+		// links the nodes [lo, hi) into a balanced subtree whose root is at the given depth
+		index_type link_range(index_type lo, index_type hi, size_type depth, size_type red_depth)
+		{
+			if (lo == hi)
+			{
+				return nil;
+			}
+			index_type mid = lo + (hi - lo) / 2;
+			index_type left_root = link_range(lo, mid, depth + 1, red_depth);
+			index_type right_root = link_range(mid + 1, hi, depth + 1, red_depth);
+			left(mid) = left_root;
+			right(mid) = right_root;
+			if (left_root != nil)
+			{
+				set_parent(left_root, mid);
+			}
+			if (right_root != nil)
+			{
+				set_parent(right_root, mid);
+			}
+			set_color(mid, depth == red_depth ? RED : BLACK);
+			return mid;
+		}
+
+		// INSERTION:
+		// the existing node of the key and false, or the parent of the new node (nil for an empty tree) and true
+		pair<index_type, bool> get_position_for_insertion(const key_type& key)
+		{
+			index_type position = nil;
+			index_type current = root();
+			while (current != nil)
+			{
+				position = current;
+				if (compare(key, key_of(current)))
+				{
+					current = left(current);
+				}
+				else if (compare(key_of(current), key))
+				{
+					current = right(current);
+				}
+				else
+				{
+					return ft::pair<index_type, bool>(current, false);
+				}
+			}
+			return ft::pair<index_type, bool>(position, true);
+		}
+
+		pair<iterator, bool> insert_node_at_position(index_type position, index_type index)
+		{
+			set_parent(index, position);
+			if (position == nil)
+			{
+				_slab->root = index;
+			}
+			else if (compare(key_of(index), key_of(position)))
+			{
+				left(position) = index;
+			}
+			else
+			{
+				right(position) = index;
+			}
+			_slab->size++;
+			insert_fixup(index);
+			return ft::pair<iterator, bool>(make_iterator(index), true);
+		}
+
+		// the parent of node points to replacement instead
+		void replace_child(index_type node, index_type replacement)
+		{
+			index_type up = parent(node);
+			if (up == nil)
+			{
+				_slab->root = replacement;
+			}
+			else if (node == left(up))
+			{
+				left(up) = replacement;
+			}
+			else
+			{
+				right(up) = replacement;
+			}
+		}
+
+		void rotate_left(index_type node)
+		{
+			index_type subnode = right(node);
+			right(node) = left(subnode);
+			if (left(subnode) != nil)
+			{
+				set_parent(left(subnode), node);
+			}
+			set_parent(subnode, parent(node));
+			replace_child(node, subnode);
+			left(subnode) = node;
+			set_parent(node, subnode);
+		}
+
+		void rotate_right(index_type node)
+		{
+			index_type subnode = left(node);
+			left(node) = right(subnode);
+			if (right(subnode) != nil)
+			{
+				set_parent(right(subnode), node);
+			}
+			set_parent(subnode, parent(node));
+			replace_child(node, subnode);
+			right(subnode) = node;
+			set_parent(node, subnode);
+		}
+
+		// nil is black, so the loop stops at the root
+		void insert_fixup(index_type node)
+		{
+			while (color_of(parent(node)) == RED)
+			{
+				index_type up = parent(node);
+				index_type grandparent = parent(up);
+				if (up == left(grandparent))
+				{
+					index_type uncle = right(grandparent);
+					if (color_of(uncle) == RED)
+					{
+						set_color(up, BLACK);
+						set_color(uncle, BLACK);
+						set_color(grandparent, RED);
+						node = grandparent;
+						continue;
+					}
+					if (node == right(up))
+					{
+						node = up;
+						rotate_left(node);
+					}
+					set_color(parent(node), BLACK);
+					set_color(grandparent, RED);
+					rotate_right(grandparent);
+				}
+				else
+				{
+					index_type uncle = left(grandparent);
+					if (color_of(uncle) == RED)
+					{
+						set_color(up, BLACK);
+						set_color(uncle, BLACK);
+						set_color(grandparent, RED);
+						node = grandparent;
+						continue;
+					}
+					if (node == left(up))
+					{
+						node = up;
+						rotate_right(node);
+					}
+					set_color(parent(node), BLACK);
+					set_color(grandparent, RED);
+					rotate_left(grandparent);
+				}
+			}
+			set_color(root(), BLACK);
+		}
+
+		// DELETION:
+		void transplant(index_type node, index_type replacement)
+		{
+			replace_child(node, replacement);
+			if (replacement != nil)
+			{
+				set_parent(replacement, parent(node));
+			}
+		}
+
+		// unlinks the node; the replacement can be a nil leaf, so its parent is tracked separately
+		void delete_node_index(index_type node)
+		{
+			index_type replacement;
+			index_type replacement_parent;
+			e_color original_color = color_of(node);
+			if (left(node) == nil || right(node) == nil)
+			{
+				replacement = left(node) == nil ? right(node) : left(node);
+				replacement_parent = parent(node);
+				transplant(node, replacement);
+			}
+			else
+			{
+				index_type successor = _slab->minimum(right(node));
+				original_color = color_of(successor);
+				replacement = right(successor);
+				if (parent(successor) == node)
+				{
+					replacement_parent = successor;
+				}
+				else
+				{
+					replacement_parent = parent(successor);
+					transplant(successor, replacement);
+					right(successor) = right(node);
+					set_parent(right(successor), successor);
+				}
+				transplant(node, successor);
+				left(successor) = left(node);
+				set_parent(left(successor), successor);
+				set_color(successor, color_of(node));
+			}
+			if (original_color == BLACK)
+			{
+				delete_fixup(replacement, replacement_parent);
+			}
+		}
+
+		// the sibling of a doubly black node always exists (the black heights of both sides must match)
+		void delete_fixup(index_type node, index_type up)
+		{
+			while (node != root() && color_of(node) == BLACK)
+			{
+				if (node == left(up))
+				{
+					index_type sibling = right(up);
+					if (color_of(sibling) == RED)
+					{
+						set_color(sibling, BLACK);
+						set_color(up, RED);
+						rotate_left(up);
+						sibling = right(up);
+					}
+					if (color_of(left(sibling)) == BLACK && color_of(right(sibling)) == BLACK)
+					{
+						set_color(sibling, RED);
+						node = up;
+						up = parent(up);
+						continue;
+					}
+					if (color_of(right(sibling)) == BLACK)
+					{
+						set_color(left(sibling), BLACK);
+						set_color(sibling, RED);
+						rotate_right(sibling);
+						sibling = right(up);
+					}
+					set_color(sibling, color_of(up));
+					set_color(up, BLACK);
+					set_color(right(sibling), BLACK);
+					rotate_left(up);
+				}
+				else
+				{
+					index_type sibling = left(up);
+					if (color_of(sibling) == RED)
+					{
+						set_color(sibling, BLACK);
+						set_color(up, RED);
+						rotate_right(up);
+						sibling = left(up);
+					}
+					if (color_of(left(sibling)) == BLACK && color_of(right(sibling)) == BLACK)
+					{
+						set_color(sibling, RED);
+						node = up;
+						up = parent(up);
+						continue;
+					}
+					if (color_of(left(sibling)) == BLACK)
+					{
+						set_color(right(sibling), BLACK);
+						set_color(sibling, RED);
+						rotate_left(sibling);
+						sibling = left(up);
+					}
+					set_color(sibling, color_of(up));
+					set_color(up, BLACK);
+					set_color(left(sibling), BLACK);
+					rotate_right(up);
+				}
+				node = root();
+			}
+			if (node != nil)
+			{
+				set_color(node, BLACK);
+			}
+		}
+
+		// LOOKUP:
+		// the first node that is not less than the key, or nil
+		template <typename K>
+		index_type lower_bound_index(const K& key) const
+		{
+			index_type node = root();
+			index_type result = nil;
+			while (node != nil)
+			{
+				if (compare(key_of(node), key))
+				{
+					node = right(node);
+				}
+				else
+				{
+					result = node;
+					node = left(node);
+				}
+			}
+			return result;
+		}
+
+		// the first node that is greater than the key, or nil
+		template <typename K>
+		index_type upper_bound_index(const K& key) const
+		{
+			index_type node = root();
+			index_type result = nil;
+			while (node != nil)
+			{
+				if (compare(key, key_of(node)))
+				{
+					result = node;
+					node = left(node);
+				}
+				else
+				{
+					node = right(node);
+				}
+			}
+			return result;
+		}
+
+		template <typename K>
+		index_type find_index(const K& key) const
+		{
+			index_type node = lower_bound_index(key);
+			if (node != nil && !compare(key, key_of(node)))
+			{
+				return node;
+			}
+			return nil;
+		}
+
+		// find_index() of each of the lanes keys, one level of each descent per round (see rbtree::find_nodes())
+		template <typename KeyIt>
+		void find_indexes(KeyIt keys, size_type lanes, index_type* found) const
+		{
+			index_type node[find_lanes];
+			size_type active = 0;
+			for (size_type i = 0; i < lanes; ++i)
+			{
+				node[i] = root();
+				found[i] = nil;
+				active += (node[i] != nil);
+			}
+			while (active != 0)
+			{
+				active = 0;
+				for (size_type i = 0; i < lanes; ++i)
+				{
+					index_type current = node[i];
+					if (current == nil)
+					{
+						continue;
+					}
+					if (compare(key_of(current), keys[i]))
+					{
+						current = right(current);
+					}
+					else
+					{
+						found[i] = current;
+						current = left(current);
+					}
+					node[i] = current;
+					if (current != nil)
+					{
+						ft::prefetch(at(current));
+						++active;
+					}
+				}
+			}
+			for (size_type i = 0; i < lanes; ++i)
+			{
+				if (found[i] != nil && compare(keys[i], key_of(found[i])))
+				{
+					found[i] = nil;
+				}
+			}
+		}
+
+		// 2^31 nodes at most: the height is below 64
+		enum { max_height = 64 };
+
+		template <typename Value, typename Function>
+		struct range_visitor
+		{
+			Function& fn;
+
+			explicit range_visitor(Function& function) : fn(function) {}
+			void operator()(node_pointer node)
+			{
+				Value& value = node->_value;
+				fn(value);
+			}
+		};
+
+		template <typename Value, typename Function>
+		struct range_batch_visitor
+		{
+			Function&	fn;
+			Value*		batch[range_batch_size];
+			size_type	count;
+
+			explicit range_batch_visitor(Function& function) : fn(function), count(0) {}
+			void operator()(node_pointer node)
+			{
+				batch[count++] = &node->_value;
+				if (count == range_batch_size)
+				{
+					flush();
+				}
+			}
+			void flush()
+			{
+				if (count != 0)
+				{
+					fn(static_cast<Value* const*>(batch), count);
+					count = 0;
+				}
+			}
+		};
+
+		void prefetch_node(index_type index) const
+		{
+			if (index != nil)
+			{
+				ft::prefetch(at(index));
+			}
+		}
+
+		// the in-order walk of rbtree::walk_range(), with a stack of indexes
+		template <typename K, typename Visitor>
+		void walk_range(const K& lo, const K& hi, Visitor& visitor) const
+		{
+			index_type stack[max_height];
+			size_type depth = 0;
+			index_type node = root();
+			while (node != nil)
+			{
+				if (!compare(key_of(node), lo))
+				{
+					prefetch_node(right(node));
+					stack[depth++] = node;
+					node = left(node);
+				}
+				else
+				{
+					node = right(node);
+				}
+			}
+			while (depth != 0)
+			{
+				node = stack[--depth];
+				if (!compare(key_of(node), hi))
+				{
+					return;
+				}
+				if (depth != 0)
+				{
+					prefetch_node(stack[depth - 1]);
+				}
+				visitor(at(node));
+				for (node = right(node); node != nil; node = left(node))
+				{
+					prefetch_node(right(node));
+					stack[depth++] = node;
+				}
+			}
+		}
+	};
+
+	template <typename T, typename Compare, typename Alloc, typename Node>
+	const typename index_rbtree<T, Compare, Alloc, Node>::index_type index_rbtree<T, Compare, Alloc, Node>::nil;
+
+	template <typename T, typename Compare, typename Alloc, typename Node>
+	struct rbtree_for_layout<rbtree_index_layout, T, Compare, Alloc, Node>
+	{
+		typedef index_rbtree<T, Compare, Alloc, Node>	type;
+	};
+}
+
+#endif
@@ -0,0 +1,214 @@
+#ifndef INDEX_RBTREE_ITERATOR_HPP
+#define INDEX_RBTREE_ITERATOR_HPP
+
+#include <cassert>
+#include <climits>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rbtree_node.hpp"
+#include "iterator/iterator_traits.hpp"
+
+namespace ft
+{
+	// The nodes of an index_rbtree. Node i (from 1) is slot i - 1 of a list of segments of 16, 32, 64, ... slots:
+	// growing adds a segment and never moves a node, so references to the elements stay valid like in rbtree.
+	// The slab is allocated once per tree and is exchanged by swap(): iterators hold it, not the tree.
+	template <typename Node>
+	struct index_rbtree_slab
+	{
+		typedef uint32_t	index_type;
+
+		enum
+		{
+			first_segment_shift = 4,
+			first_segment_size = 1 << first_segment_shift,
+			max_segments = 32 - first_segment_shift
+		};
+
+		static const index_type	nil = 0;
+		static const index_type	max_nodes = 0x7fffffff;		// the top bit of a parent index is the color
+
+		index_type	root;
+		index_type	free_list;		// freed slots, linked through _left
+		index_type	used;			// slots handed out at least once: 1 .. used
+		index_type	capacity;
+		size_t		size;
+		size_t		segment_count;
+		Node*		segments[max_segments];
+
+		static size_t segment_size(size_t segment)
+		{
+			return static_cast<size_t>(first_segment_size) << segment;
+		}
+
+		Node* node(index_type i) const
+		{
+			size_t slot = static_cast<size_t>(i) - 1 + first_segment_size;
+			size_t segment = sizeof(unsigned long) * CHAR_BIT - 1 - __builtin_clzl(slot) - first_segment_shift;
+			return segments[segment] + (slot - segment_size(segment));
+		}
+
+		index_type left(index_type i) const
+		{
+			return node(i)->_left;
+		}
+
+		index_type right(index_type i) const
+		{
+			return node(i)->_right;
+		}
+
+		index_type parent(index_type i) const
+		{
+			return node(i)->parent();
+		}
+
+		index_type minimum(index_type i) const
+		{
+			while (left(i) != nil)
+			{
+				i = left(i);
+			}
+			return i;
+		}
+
+		index_type maximum(index_type i) const
+		{
+			while (right(i) != nil)
+			{
+				i = right(i);
+			}
+			return i;
+		}
+
+		// the in-order neighbours; nil is end(), its successor the first node and its predecessor the last one
+		index_type next(index_type i) const
+		{
+			if (i == nil)
+			{
+				return root == nil ? nil : minimum(root);
+			}
+			if (right(i) != nil)
+			{
+				return minimum(right(i));
+			}
+			index_type up = parent(i);
+			while (up != nil && i == right(up))
+			{
+				i = up;
+				up = parent(up);
+			}
+			return up;
+		}
+
+		index_type prev(index_type i) const
+		{
+			if (i == nil)
+			{
+				return root == nil ? nil : maximum(root);
+			}
+			if (left(i) != nil)
+			{
+				return maximum(left(i));
+			}
+			index_type up = parent(i);
+			while (up != nil && i == left(up))
+			{
+				i = up;
+				up = parent(up);
+			}
+			return up;
+		}
+	};
+
+	template <typename Node>
+	const typename index_rbtree_slab<Node>::index_type index_rbtree_slab<Node>::nil;
+
+	template <typename Node>
+	const typename index_rbtree_slab<Node>::index_type index_rbtree_slab<Node>::max_nodes;
+
+	// an iterator is the slab and an index: 8 + 4 bytes, and it stays valid while its node is in the tree
+	template <class Value, typename Node>
+	class index_rbtree_iter
+	{
+	public:
+		typedef index_rbtree_iter<Value, Node>			iterator_type;
+		typedef std::bidirectional_iterator_tag			iterator_category;
+		typedef Value									value_type;
+		typedef ptrdiff_t								difference_type;
+		typedef Value*									pointer;
+		typedef Value&									reference;
+
+	private:
+		typedef index_rbtree_iter<const Value, Node>	const_iterator_type;
+
+	protected:
+		typedef index_rbtree_slab<Node>					slab_type;
+		typedef typename slab_type::index_type			index_type;
+
+		slab_type*	_slab;
+		index_type	_index;
+
+	public:
+		index_rbtree_iter() : _slab(NULL), _index(slab_type::nil) {}
+		index_rbtree_iter(slab_type* slab, index_type index) : _slab(slab), _index(index) {}
+
+		reference operator*() const
+		{
+			assert(_index != slab_type::nil);
+			return _slab->node(_index)->_value;
+		}
+
+		pointer operator->() const
+		{
+			assert(_index != slab_type::nil);
+			return &_slab->node(_index)->_value;
+		}
+
+		operator const_iterator_type() const
+		{
+			return const_iterator_type(_slab, _index);
+		}
+
+		index_rbtree_iter& operator++()
+		{
+			_index = _slab->next(_index);
+			return *this;
+		}
+
+		index_rbtree_iter operator++(int)
+		{
+			index_rbtree_iter temp = *this;
+			++(*this);
+			return temp;
+		}
+
+		index_rbtree_iter& operator--()
+		{
+			_index = _slab->prev(_index);
+			return *this;
+		}
+
+		index_rbtree_iter operator--(int)
+		{
+			index_rbtree_iter temp = *this;
+			--(*this);
+			return temp;
+		}
+
+		friend
+		bool operator==(const iterator_type& lhs, const iterator_type& rhs)
+		{
+			return lhs._index == rhs._index && lhs._slab == rhs._slab;
+		}
+
+		friend
+		bool operator!=(const iterator_type& lhs, const iterator_type& rhs)
+		{
+			return !(lhs == rhs);
+		}
+	};
+}
+
+#endif
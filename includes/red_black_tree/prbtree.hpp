@@ -0,0 +1,677 @@
+#ifndef PRBTREE_HPP
+#define PRBTREE_HPP
+
+#include <new>
+#include <climits>
+
+#include "iterator/reverse_iterator.hpp"
+#include "utility/ebo_storage.hpp"
+#include "utility/ft_swap.hpp"
+#include "utility/pair.hpp"
+
+#include "prbtree_iterator.hpp"
+#include "prbtree_node.hpp"
+
+namespace ft
+{
+	// Persistent red-black tree: a tree object is one version and never changes.
+	// insert()/erase() return a new version that shares every untouched subtree with this one. Only the nodes on the path
+	// from the root to the changed position are copied (plus the siblings that the fixups recolor or rotate),
+	// so an update allocates O(log n) nodes and copying a version is O(1).
+	// The balancing is the same CLRS insert/delete fixup as in rbtree. Without parent pointers the parents
+	// are taken from the copied path, which is kept in an array while the fixup walks up.
+	// A node is only modified when it is a fresh copy made by the current update, never when it is shared.
+	template <typename T, typename Compare, typename Alloc, typename Node>
+	class prbtree
+		: private ft::ebo_storage<Compare>
+		, private ft::ebo_storage<typename Alloc::template rebind<Node>::other>
+	{
+	public:
+		typedef T																value_type;
+		typedef typename Node::key_type 										key_type;
+		typedef Compare 														key_compare;
+		typedef Alloc															allocator_type;
+		typedef prbtree_const_iter<value_type, Node>							const_iterator;
+		typedef ft::reverse_iterator<const_iterator>							const_reverse_iterator;
+		typedef typename allocator_type::size_type								size_type;
+
+	private:
+		typedef typename Alloc::template rebind<Node >::other	node_alloc_type;
+		typedef Node*											node_pointer;
+		typedef prbtree_node_base								node_base;
+		typedef ft::ebo_storage<key_compare>					compare_storage;
+		typedef ft::ebo_storage<node_alloc_type>				node_alloc_storage;
+
+		enum { max_height = 2 * sizeof(size_type) * CHAR_BIT };
+
+		node_base*	_root;
+		size_type	_size;
+
+		// takes over the reference to root
+		prbtree(const key_compare& comp, const node_alloc_type& alloc, node_base* root, size_type size)
+			: compare_storage(comp)
+			, node_alloc_storage(alloc)
+			, _root(root)
+			, _size(size)
+			{}
+
+	public:
+		prbtree(const key_compare& comp, const allocator_type& alloc)
+			: compare_storage(comp)
+			, node_alloc_storage(node_alloc_type(alloc))
+			, _root(NULL)
+			, _size(0)
+			{}
+
+		// versions share their nodes: a copy is a new owner of the root
+		prbtree(const prbtree& other)
+			: compare_storage(other.compare())
+			, node_alloc_storage(other.node_alloc())
+			, _root(acquire(other._root))
+			, _size(other._size)
+			{}
+
+		~prbtree()
+		{
+			release(_root);
+		}
+
+		prbtree& operator=(const prbtree& other)
+		{
+			node_base* root = acquire(other._root); // before the release: other can be a version of this tree
+			release(_root);
+			_root = root;
+			_size = other._size;
+			node_alloc() = other.node_alloc();
+			compare_storage::get() = other.compare();
+			return *this;
+		}
+
+		allocator_type get_allocator() const
+		{
+			return allocator_type(node_alloc());
+		}
+
+		// ITERATORS:
+		const_iterator begin() const
+		{
+			const_iterator it(_root);
+			it.push_leftmost(_root);
+			return it;
+		}
+
+		const_iterator end() const
+		{
+			return const_iterator(_root);
+		}
+
+		const_reverse_iterator rbegin() const
+		{
+			return const_reverse_iterator(end());
+		}
+
+		const_reverse_iterator rend() const
+		{
+			return const_reverse_iterator(begin());
+		}
+
+		// CAPACITY:
+		bool empty() const
+		{
+			return _size == 0;
+		}
+
+		size_type size() const
+		{
+			return _size;
+		}
+
+		size_type max_size() const
+		{
+			return node_alloc().max_size();
+		}
+
+		// UPDATES: this version is never modified, the new one is returned
+		// if the key is already there this version is returned, like insert() doesn't replace the value
+		prbtree insert(const value_type& val) const
+		{
+			return insert_value(val, false);
+		}
+
+		prbtree insert_or_assign(const value_type& val) const
+		{
+			return insert_value(val, true);
+		}
+
+		template <typename K>
+		prbtree erase(const K& key) const
+		{
+			node_base* path[max_height];
+			size_type depth = 0;
+			size_type found_depth = 0;
+			for (node_base* node = _root; node != NULL; )
+			{
+				path[depth++] = node;
+				if (compare(key, key_of(node)))
+				{
+					node = node->_left;
+				}
+				else if (compare(key_of(node), key))
+				{
+					node = node->_right;
+				}
+				else
+				{
+					found_depth = depth;
+					break;
+				}
+			}
+			if (found_depth == 0)
+			{
+				return *this;
+			}
+			node_base* found = path[found_depth - 1];
+			if (found->_left != NULL && found->_right != NULL)
+			{
+				// the successor's value moves into the found node's copy, the successor is removed instead
+				path[depth++] = found->_right;
+				for (node_base* node = found->_right->_left; node != NULL; node = node->_left)
+				{
+					path[depth++] = node;
+				}
+			}
+			node_base* root = copy_path(path, depth, found_depth - 1, &static_cast<node_pointer>(path[depth - 1])->_value);
+
+			node_base* removed = path[depth - 1];
+			node_base* child = removed->_left != NULL ? removed->_left : removed->_right;
+			e_color removed_color = removed->color();
+			--depth;
+			if (depth == 0)
+			{
+				root = child;
+			}
+			else
+			{
+				replace_child(path[depth - 1], removed, child);
+			}
+			removed->_left = NULL; // the child moved to its new parent with the reference
+			removed->_right = NULL;
+			release(removed);
+			if (removed_color == BLACK)
+			{
+				try
+				{
+					delete_fixup(child, path, depth, root);
+				}
+				catch (...)
+				{
+					release(root);
+					throw;
+				}
+			}
+			return prbtree(compare(), node_alloc(), root, _size - 1);
+		}
+
+		// LOOKUP:
+		template <typename K>
+		size_type count(const K& key) const
+		{
+			return find(key) == end() ? 0 : 1;
+		}
+
+		template <typename K>
+		const_iterator find(const K& key) const
+		{
+			const_iterator it = lower_bound(key);
+			if (it != end() && compare(key, Node::get_key_from_value(*it)))
+			{
+				return end();
+			}
+			return it;
+		}
+
+		// the path to the bound is a prefix of the search path, the search path is cut after the last candidate
+		template <typename K>
+		const_iterator lower_bound(const K& key) const
+		{
+			const_iterator it(_root);
+			size_type candidate_depth = 0;
+			for (node_base* node = _root; node != NULL; )
+			{
+				it.push(node);
+				if (!compare(key_of(node), key))
+				{
+					candidate_depth = it._depth;
+					node = node->_left;
+				}
+				else
+				{
+					node = node->_right;
+				}
+			}
+			it._depth = candidate_depth;
+			return it;
+		}
+
+		template <typename K>
+		const_iterator upper_bound(const K& key) const
+		{
+			const_iterator it(_root);
+			size_type candidate_depth = 0;
+			for (node_base* node = _root; node != NULL; )
+			{
+				it.push(node);
+				if (compare(key, key_of(node)))
+				{
+					candidate_depth = it._depth;
+					node = node->_left;
+				}
+				else
+				{
+					node = node->_right;
+				}
+			}
+			it._depth = candidate_depth;
+			return it;
+		}
+
+		template <typename K>
+		pair<const_iterator, const_iterator> equal_range(const K& key) const
+		{
+			return ft::pair<const_iterator, const_iterator>(lower_bound(key), upper_bound(key));
+		}
+
+		// OBSERVERS:
+		key_compare key_comp() const
+		{
+			return compare();
+		}
+
+		void swap(prbtree& other)
+		{
+			ft::swap(_root, other._root);
+			ft::swap(_size, other._size);
+			ft::swap(node_alloc(), other.node_alloc());
+			ft::swap(compare_storage::get(), other.compare_storage::get());
+		}
+
+		// the number of owners of the root, 1 if no other version shares it
+		size_type root_use_count() const
+		{
+			return _root == NULL ? 0 : _root->use_count();
+		}
+
+	private:
+		node_alloc_type& node_alloc()
+		{
+			return node_alloc_storage::get();
+		}
+
+		const node_alloc_type& node_alloc() const
+		{
+			return node_alloc_storage::get();
+		}
+
+		const key_compare& compare() const
+		{
+			return compare_storage::get();
+		}
+
+		template <typename K1, typename K2>
+		bool compare(const K1& lhs, const K2& rhs) const
+		{
+			return compare_storage::get()(lhs, rhs);
+		}
+
+		static const key_type& key_of(const node_base* node)
+		{
+			return static_cast<const Node*>(node)->get_key();
+		}
+
+		static node_base* acquire(node_base* node)
+		{
+			if (node != NULL)
+			{
+				node->acquire();
+			}
+			return node;
+		}
+
+		// drops one reference, the subtrees that lose their last owner are destroyed
+		void release(node_base* node) const
+		{
+			while (node != NULL && node->release())
+			{
+				release(node->_right);
+				node_base* left = node->_left;
+				destroy_node(static_cast<node_pointer>(node));
+				node = left;
+			}
+		}
+
+		node_base* create_node(const value_type& value, e_color color) const
+		{
+			node_alloc_type alloc(node_alloc());
+			node_pointer new_node = alloc.allocate(1);
+			try
+			{
+				new (new_node) Node(value, color);
+			}
+			catch (...)
+			{
+				alloc.deallocate(new_node, 1);
+				throw;
+			}
+			return new_node;
+		}
+
+		void destroy_node(node_pointer node) const
+		{
+			node_alloc_type alloc(node_alloc());
+			node->~Node();
+			alloc.deallocate(node, 1);
+		}
+
+		// a private copy of a shared node: same children (one more owner each) and color
+		node_base* clone(const node_base* node, const value_type* value = NULL) const
+		{
+			node_base* copy = create_node(value != NULL ? *value : static_cast<const Node*>(node)->_value, node->color());
+			copy->_left = acquire(node->_left);
+			copy->_right = acquire(node->_right);
+			return copy;
+		}
+
+		// the parent (a fresh copy) links to old_child through one of its children: it now links to new_child.
+		// The reference of the parent to old_child is moved or dropped by the caller.
+		static void replace_child(node_base* parent, const node_base* old_child, node_base* new_child)
+		{
+			if (parent->_left == old_child)
+			{
+				parent->_left = new_child;
+			}
+			else
+			{
+				parent->_right = new_child;
+			}
+		}
+
+		// the child of a fresh parent is copied so that it can be recolored or rotated
+		node_base* make_fresh(node_base* parent, node_base* child) const
+		{
+			node_base* copy = clone(child);
+			replace_child(parent, child, copy);
+			release(child);
+			return copy;
+		}
+
+		// copies the search path (path[0] is the root) and returns the new root; path[] then holds the copies.
+		// The node at value_depth gets *value instead of its own value (NULL: keep the values)
+		node_base* copy_path(node_base** path, size_type depth, size_type value_depth, const value_type* value) const
+		{
+			for (size_type i = 0; i < depth; ++i)
+			{
+				node_base* copy;
+				try
+				{
+					copy = clone(path[i], i == value_depth ? value : NULL);
+				}
+				catch (...)
+				{
+					if (i != 0)
+					{
+						release(path[0]); // drops the copies made so far
+					}
+					throw;
+				}
+				if (i != 0)
+				{
+					replace_child(path[i - 1], path[i], copy);
+					release(path[i]); // the old parent still owns it, this only drops the copied reference
+				}
+				path[i] = copy;
+			}
+			return path[0];
+		}
+
+		// links new_node under the fresh parent of child in place of child (or makes it the root)
+		static void relink(node_base** path, size_type parent_depth, const node_base* child, node_base* new_node, node_base*& root)
+		{
+			if (parent_depth == 0)
+			{
+				root = new_node;
+			}
+			else
+			{
+				replace_child(path[parent_depth - 1], child, new_node);
+			}
+		}
+
+		prbtree insert_value(const value_type& val, bool assign) const
+		{
+			const key_type& key = Node::get_key_from_value(val);
+			node_base* path[max_height];
+			size_type depth = 0;
+			bool left_child = false;
+			for (node_base* node = _root; node != NULL; )
+			{
+				path[depth++] = node;
+				if (compare(key, key_of(node)))
+				{
+					left_child = true;
+					node = node->_left;
+				}
+				else if (compare(key_of(node), key))
+				{
+					left_child = false;
+					node = node->_right;
+				}
+				else if (!assign)
+				{
+					return *this;
+				}
+				else
+				{
+					node_base* root = copy_path(path, depth, depth - 1, &val);
+					return prbtree(compare(), node_alloc(), root, _size);
+				}
+			}
+			node_base* new_node = create_node(val, RED);
+			node_base* root;
+			try
+			{
+				root = copy_path(path, depth, depth, NULL);
+			}
+			catch (...)
+			{
+				release(new_node);
+				throw;
+			}
+			if (depth == 0)
+			{
+				root = new_node;
+			}
+			else if (left_child)
+			{
+				path[depth - 1]->_left = new_node;
+			}
+			else
+			{
+				path[depth - 1]->_right = new_node;
+			}
+			path[depth++] = new_node;
+			try
+			{
+				insert_fixup(path, depth, root);
+			}
+			catch (...) // a sibling copy failed: the new version is consistent, only unbalanced
+			{
+				release(root);
+				throw;
+			}
+			return prbtree(compare(), node_alloc(), root, _size + 1);
+		}
+
+		// CLRS insert fixup, path[depth - 1] is the new node. All the path nodes are fresh copies,
+		// the uncle is copied before it is recolored.
+		void insert_fixup(node_base** path, size_type depth, node_base*& root) const
+		{
+			size_type i = depth - 1; // the depth of the current node
+			while (i >= 2 && path[i - 1]->color() == RED)
+			{
+				node_base* node = path[i];
+				node_base* parent = path[i - 1];
+				node_base* grandparent = path[i - 2];
+				bool parent_is_left = (parent == grandparent->_left);
+				node_base* uncle = parent_is_left ? grandparent->_right : grandparent->_left;
+				if (node_base::color_of(uncle) == RED)
+				{
+					uncle = make_fresh(grandparent, uncle);
+					uncle->set_color(BLACK);
+					parent->set_color(BLACK);
+					grandparent->set_color(RED);
+					i -= 2;
+					continue;
+				}
+				if (parent_is_left && node == parent->_right)
+				{
+					rotate_left(parent, grandparent);
+					ft::swap(node, parent);
+				}
+				else if (!parent_is_left && node == parent->_left)
+				{
+					rotate_right(parent, grandparent);
+					ft::swap(node, parent);
+				}
+				parent->set_color(BLACK);
+				grandparent->set_color(RED);
+				relink(path, i - 2, grandparent, parent, root);
+				if (parent_is_left)
+				{
+					rotate_right(grandparent, NULL);
+				}
+				else
+				{
+					rotate_left(grandparent, NULL);
+				}
+				break;
+			}
+			root->set_color(BLACK);
+		}
+
+		// the rotations move the subtree links with their references. new_top was a child of node and takes its place
+		// under node's parent, which is linked by the caller (or passed as parent and relinked here).
+		static void rotate_left(node_base* node, node_base* parent)
+		{
+			node_base* subnode = node->_right;
+			node->_right = subnode->_left;
+			subnode->_left = node;
+			if (parent != NULL)
+			{
+				replace_child(parent, node, subnode);
+			}
+		}
+
+		static void rotate_right(node_base* node, node_base* parent)
+		{
+			node_base* subnode = node->_left;
+			node->_left = subnode->_right;
+			subnode->_right = node;
+			if (parent != NULL)
+			{
+				replace_child(parent, node, subnode);
+			}
+		}
+
+		// CLRS delete fixup. node (maybe NULL or shared) took the place of the removed black node,
+		// path[depth - 1] is its parent and every path node is a fresh copy. Siblings are copied before they change.
+		void delete_fixup(node_base* node, node_base** path, size_type depth, node_base*& root) const
+		{
+			while (node != root && node_base::color_of(node) == BLACK)
+			{
+				node_base* parent = path[depth - 1];
+				bool node_is_left = (node == parent->_left);
+				node_base* sibling = node_is_left ? parent->_right : parent->_left;
+				sibling = make_fresh(parent, sibling);
+				if (sibling->color() == RED)
+				{
+					sibling->set_color(BLACK);
+					parent->set_color(RED);
+					relink(path, depth - 1, parent, sibling, root);
+					if (node_is_left)
+					{
+						rotate_left(parent, NULL);
+					}
+					else
+					{
+						rotate_right(parent, NULL);
+					}
+					path[depth - 1] = sibling; // the sibling is now the grandparent of node
+					path[depth++] = parent;
+					sibling = make_fresh(parent, node_is_left ? parent->_right : parent->_left);
+				}
+				if (node_base::color_of(sibling->_left) == BLACK && node_base::color_of(sibling->_right) == BLACK)
+				{
+					sibling->set_color(RED);
+					node = parent;
+					--depth;
+					continue;
+				}
+				node_base* far_nephew = node_is_left ? sibling->_right : sibling->_left;
+				bool far_nephew_is_fresh = false;
+				if (node_base::color_of(far_nephew) == BLACK)
+				{
+					node_base* near_nephew = make_fresh(sibling, node_is_left ? sibling->_left : sibling->_right);
+					near_nephew->set_color(BLACK);
+					sibling->set_color(RED);
+					if (node_is_left)
+					{
+						rotate_right(sibling, parent);
+					}
+					else
+					{
+						rotate_left(sibling, parent);
+					}
+					far_nephew = sibling; // the old sibling, already copied
+					far_nephew_is_fresh = true;
+					sibling = near_nephew;
+				}
+				if (!far_nephew_is_fresh)
+				{
+					far_nephew = make_fresh(sibling, far_nephew);
+				}
+				sibling->set_color(parent->color());
+				parent->set_color(BLACK);
+				far_nephew->set_color(BLACK);
+				relink(path, depth - 1, parent, sibling, root);
+				if (node_is_left)
+				{
+					rotate_left(parent, NULL);
+				}
+				else
+				{
+					rotate_right(parent, NULL);
+				}
+				root->set_color(BLACK); // the root is fresh: the path root or the rotated sibling
+				return;
+			}
+			if (node != NULL && node->color() == RED)
+			{
+				// node may still be shared (the moved child of the removed node)
+				if (depth == 0)
+				{
+					node_base* copy = clone(node);
+					release(node);
+					node = copy;
+					root = copy;
+				}
+				else
+				{
+					node = make_fresh(path[depth - 1], node);
+				}
+				node->set_color(BLACK);
+			}
+		}
+	};
+}
+
+#endif
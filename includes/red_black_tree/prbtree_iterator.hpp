@@ -0,0 +1,175 @@
+#ifndef PRBTREE_ITERATOR_HPP
+#define PRBTREE_ITERATOR_HPP
+
+#include <cassert>
+#include <climits>
+
+#include "prbtree_node.hpp"
+#include "iterator/iterator_traits.hpp"
+
+namespace ft
+{
+	template <typename T, typename Compare, typename Alloc, typename Node>
+	class prbtree;
+
+	// Persistent nodes have no parent pointer, so the iterator keeps the path from the root to its node.
+	// The end() iterator has an empty path; like the rbtree iterator, --end() is the last element.
+	// Versions are immutable: there are only const iterators.
+	template <class Value, typename Node>
+	class prbtree_const_iter
+	{
+	public:
+		typedef prbtree_const_iter<Value, Node>			iterator_type;
+		typedef std::bidirectional_iterator_tag			iterator_category;
+		typedef const Value								value_type;
+		typedef ptrdiff_t								difference_type;
+		typedef const Value*							pointer;
+		typedef const Value&							reference;
+
+	private:
+		typedef const prbtree_node_base* NodeBasePtr;
+
+		// a red-black tree of n nodes is at most 2 * log2(n + 1) high
+		enum { max_height = 2 * sizeof(size_t) * CHAR_BIT };
+
+		template <typename, typename, typename, typename>
+		friend class prbtree;
+
+		NodeBasePtr	_root;
+		size_t		_depth;
+		NodeBasePtr	_path[max_height];
+
+		explicit prbtree_const_iter(NodeBasePtr root) : _root(root), _depth(0) {}
+
+		NodeBasePtr node() const
+		{
+			return _depth == 0 ? NULL : _path[_depth - 1];
+		}
+
+		void push(NodeBasePtr node_ptr)
+		{
+			_path[_depth++] = node_ptr;
+		}
+
+		void push_leftmost(NodeBasePtr node_ptr)
+		{
+			for (; node_ptr != NULL; node_ptr = node_ptr->_left)
+			{
+				push(node_ptr);
+			}
+		}
+
+		void push_rightmost(NodeBasePtr node_ptr)
+		{
+			for (; node_ptr != NULL; node_ptr = node_ptr->_right)
+			{
+				push(node_ptr);
+			}
+		}
+
+	public:
+		prbtree_const_iter() : _root(NULL), _depth(0) {}
+		prbtree_const_iter(const iterator_type& other) : _root(other._root), _depth(other._depth)
+		{
+			for (size_t i = 0; i < _depth; ++i)
+			{
+				_path[i] = other._path[i];
+			}
+		}
+		~prbtree_const_iter() {}
+
+		prbtree_const_iter& operator=(const prbtree_const_iter& other)
+		{
+			_root = other._root;
+			_depth = other._depth;
+			for (size_t i = 0; i < _depth; ++i)
+			{
+				_path[i] = other._path[i];
+			}
+			return *this;
+		}
+
+		reference operator*() const
+		{
+			assert(_depth != 0);
+			return static_cast<const Node*>(node())->_value;
+		}
+		pointer operator->() const
+		{
+			assert(_depth != 0);
+			return &static_cast<const Node*>(node())->_value;
+		}
+
+		//  ARITHMETIC OPERATORS
+		prbtree_const_iter& operator++()
+		{
+			if (_depth == 0) // incrementing a reverse_iterator pointing to rend()
+			{
+				push_leftmost(_root);
+				return *this;
+			}
+			NodeBasePtr node_ptr = node();
+			if (node_ptr->_right != NULL)
+			{
+				push_leftmost(node_ptr->_right);
+				return *this;
+			}
+			// climbing while we come from a right subtree: those parents were visited already
+			NodeBasePtr child;
+			do
+			{
+				child = _path[--_depth];
+			} while (_depth != 0 && _path[_depth - 1]->_right == child);
+			return *this;
+		}
+
+		prbtree_const_iter operator++(int)
+		{
+			prbtree_const_iter temp = *this;
+			++(*this);
+			return temp;
+		}
+
+		prbtree_const_iter& operator--()
+		{
+			if (_depth == 0) // decrementing end()
+			{
+				push_rightmost(_root);
+				return *this;
+			}
+			NodeBasePtr node_ptr = node();
+			if (node_ptr->_left != NULL)
+			{
+				push_rightmost(node_ptr->_left);
+				return *this;
+			}
+			NodeBasePtr child;
+			do
+			{
+				child = _path[--_depth];
+			} while (_depth != 0 && _path[_depth - 1]->_left == child);
+			return *this;
+		}
+
+		prbtree_const_iter operator--(int)
+		{
+			prbtree_const_iter temp = *this;
+			--(*this);
+			return temp;
+		}
+
+		friend
+		bool operator==(const iterator_type& lhs, const iterator_type& rhs)
+		{
+			return lhs.node() == rhs.node();
+		}
+
+		friend
+		bool operator!=(const iterator_type& lhs, const iterator_type& rhs)
+		{
+			return lhs.node() != rhs.node();
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,155 @@
+#ifndef PRBTREE_NODE_HPP
+#define PRBTREE_NODE_HPP
+
+#include <stddef.h>
+#if __cplusplus >= 201103L
+# include <atomic>
+#endif
+
+#include "rbtree_node.hpp"
+
+namespace ft
+{
+	// Node of the persistent (path copying) red-black tree.
+	// A node can be shared by many versions of a tree, so it has no parent pointer (it would have many parents),
+	// and it counts its owners: the parents that link to it, or the versions whose root it is.
+	// The count and the color share one word: bit 0 is the color, the count is stored from bit 1.
+	// From C++11 on the word is atomic, so versions sharing nodes can be copied and destroyed on different threads
+	// (the color only changes on fresh copies no other version sees yet). Before C++11 it is a plain word and
+	// versions sharing nodes must not be created or destroyed concurrently.
+	struct prbtree_node_base
+	{
+#if __cplusplus >= 201103L
+		typedef std::atomic<size_t>	count_word;
+#else
+		typedef size_t				count_word;
+#endif
+
+		prbtree_node_base*	_left;
+		prbtree_node_base*	_right;
+		count_word			_count_and_color;
+
+		static const size_t	color_bit = 1;
+		static const size_t	count_unit = 2;
+
+		explicit prbtree_node_base(e_color color)
+			: _left(NULL)
+			, _right(NULL)
+			, _count_and_color(count_unit | color)
+			{}
+
+#if __cplusplus >= 201103L
+		e_color color() const
+		{
+			return static_cast<e_color>(_count_and_color.load(std::memory_order_relaxed) & color_bit);
+		}
+
+		void set_color(e_color color)
+		{
+			if (color & color_bit)
+			{
+				_count_and_color.fetch_or(color_bit, std::memory_order_relaxed);
+			}
+			else
+			{
+				_count_and_color.fetch_and(~color_bit, std::memory_order_relaxed);
+			}
+		}
+
+		size_t use_count() const
+		{
+			return _count_and_color.load(std::memory_order_relaxed) / count_unit;
+		}
+
+		// a new owner already holds a reference, nothing to order
+		void acquire()
+		{
+			_count_and_color.fetch_add(count_unit, std::memory_order_relaxed);
+		}
+
+		// returns true when the last owner is gone; acq_rel so that the one destroying the node sees
+		// everything the other owners did with it
+		bool release()
+		{
+			return _count_and_color.fetch_sub(count_unit, std::memory_order_acq_rel) < 2 * count_unit;
+		}
+#else
+		e_color color() const
+		{
+			return static_cast<e_color>(_count_and_color & color_bit);
+		}
+
+		void set_color(e_color color)
+		{
+			_count_and_color = (_count_and_color & ~color_bit) | color;
+		}
+
+		size_t use_count() const
+		{
+			return _count_and_color / count_unit;
+		}
+
+		void acquire()
+		{
+			_count_and_color += count_unit;
+		}
+
+		// returns true when the last owner is gone
+		bool release()
+		{
+			_count_and_color -= count_unit;
+			return _count_and_color < count_unit;
+		}
+#endif
+
+		// NULL leaves count as black nodes
+		static e_color color_of(const prbtree_node_base* node)
+		{
+			if (node == NULL)
+			{
+				return BLACK;
+			}
+			return node->color();
+		}
+	};
+
+	template <typename Value>
+	struct prbtree_node_for_map : public prbtree_node_base
+	{
+		Value 	_value;
+		typedef typename Value::first_type key_type;
+
+		prbtree_node_for_map(const Value &value, e_color color)
+			: prbtree_node_base(color), _value(value) {}
+
+		static const key_type& get_key_from_value(const Value& _value)
+		{
+			return _value.first;
+		}
+		const key_type& get_key() const
+		{
+			return _value.first;
+		}
+	};
+
+	template <typename Value>
+	struct prbtree_node_for_set : public prbtree_node_base
+	{
+		Value 	_value;
+		typedef Value key_type;
+
+		prbtree_node_for_set(const Value &value, e_color color)
+			: prbtree_node_base(color), _value(value) {}
+
+		static const key_type& get_key_from_value(const Value& _value)
+		{
+			return _value;
+		}
+		const key_type& get_key() const
+		{
+			return _value;
+		}
+	};
+}
+
+#endif
@@ -1,146 +1,203 @@
 #ifndef RBTREE_HPP
 #define RBTREE_HPP
 
+#include <new>
+#include <climits>
+#include <functional>
+
 #include "iterator/reverse_iterator.hpp"
 #include "utility/enable_if.hpp"
 #include "utility/is_integral.hpp"
 #include "utility/ft_swap.hpp"
+#include "utility/allocator_propagation.hpp"
+#include "utility/ebo_storage.hpp"
+#include "utility/is_monotonic_allocator.hpp"
+#include "utility/is_trivially_destructible.hpp"
+#include "utility/prefetch.hpp"
 
 #include "rbtree_iterator.hpp"
 #include "rbtree_node.hpp"
 
 namespace ft
 {
+	// explanation for rebind:
+	// Now, there are a few syntactic annoyances in this declaration:
+	// Since rebind is a member template of _A and _A is a template argument, the rebind becomes a dependent name.
+	//To indicate that a dependent name is a template, it needs to be prefixed by template.
+	// Without the template keyword the < would be considered to be the less-than operator.
+	// The name other also depends on a template argument, i.e., it is also a dependent name.
+	// To indicate that a dependent name is a type, the typename keyword is needed.
+
+	// The fork of rbtree::assign_sorted_unique() when no thread pool is given: both halves run in this thread
+	struct rbtree_sequential_fork
+	{
+		template <typename F, typename G>
+		void operator()(F& f, G& g) const
+		{
+			f();
+			g();
+		}
+	};
+
+	// The comparator and the node allocator are private bases (ebo_storage) instead of members:
+	// for the usual stateless std::less and std::allocator they take no space.
+	// Only the node allocator is kept, the value allocator is rebuilt from it in get_allocator().
+	// The sentinel is a member of the tree instead of a separately allocated node, and the root
+	// is not stored either: it is the sentinel's parent. An empty tree is 40 bytes (on 64-bit) and allocates nothing.
 	template <typename T, typename Compare, typename Alloc, typename Node>
 	class rbtree
+		: private ft::ebo_storage<Compare>
+		, private ft::ebo_storage<typename Alloc::template rebind<Node>::other>
 	{
 	public:
         typedef T																						value_type;
 		typedef typename Node::key_type 																key_type;
 		typedef Compare 																				key_compare;
 		typedef Alloc																					allocator_type;
-		typedef rbtree_iter<value_type, rbtree_node_base, Node >                   						iterator;
-		typedef rbtree_iter<const value_type, const rbtree_node_base, const Node >						const_iterator;
+		typedef typename Node::node_base_type															node_base_type;
+		typedef rbtree_iter<value_type, node_base_type, Node >                   						iterator;
+		typedef rbtree_iter<const value_type, const node_base_type, const Node >						const_iterator;
 		typedef ft::reverse_iterator<iterator>          												reverse_iterator;
         typedef ft::reverse_iterator<const_iterator>    												const_reverse_iterator;
 		typedef typename allocator_type::size_type														size_type;
 	private:
-		// explanation for rebind: 
-		// Now, there are a few syntactic annoyances in this declaration:
-		// Since rebind is a member template of _A and _A is a template argument, the rebind becomes a dependent name. 
-		//To indicate that a dependent name is a template, it needs to be prefixed by template.
-		// Without the template keyword the < would be considered to be the less-than operator.
-		// The name other also depends on a template argument, i.e., it is also a dependent name.
-		// To indicate that a dependent name is a type, the typename keyword is needed.
 		typedef typename Alloc::template rebind<Node >::other							node_alloc_type;
-		typedef typename Alloc::template rebind<ft::rbtree_node_base>::other			node_base_alloc_type;
 		typedef Node*																	node_pointer;
+		typedef ft::ebo_storage<key_compare>											compare_storage;
+		typedef ft::ebo_storage<node_alloc_type>										node_alloc_storage;
+		typedef rbtree_threading<node_base_type>										threading;
+		typedef ft::allocator_propagation<node_alloc_type>								propagation;
+		struct node_arena;
 
-		allocator_type 			_alloc;
-		node_alloc_type 		_node_alloc;
-		node_base_alloc_type	_node_base_alloc;
+		node_base_type			_sentinel;
 		size_type       		_size;
-		key_compare				_compare;
-		rbtree_node_base*		_sentinel;
-		rbtree_node_base*		_root;
+		node_arena*				_arenas; // the bulk-built nodes, see assign_sorted_unique()
 
 	public:
 		rbtree(const key_compare& comp,
 			const allocator_type& alloc)
-			: _alloc(alloc)
-			, _node_alloc(alloc)
-			, _node_base_alloc(alloc)
+			: compare_storage(comp)
+			, node_alloc_storage(node_alloc_type(alloc))
+			, _sentinel()
 			, _size(0)
-			, _compare(comp)
-			{
-				_sentinel = create_sentinel_node();
-				_root = _sentinel;
-			}
+			, _arenas(NULL)
+			{}
 
 		rbtree(const rbtree& other)
-			: _alloc(other._alloc)
-			, _node_alloc(other._alloc)
-			, _node_base_alloc(other._alloc)
+			: compare_storage(other.compare())
+			, node_alloc_storage(propagation::select_on_copy_construction(other.node_alloc()))
+			, _sentinel()
 			, _size(0)
-			, _compare(other._compare)
+			, _arenas(NULL)
 		{
-			_sentinel = create_sentinel_node();
-			_root = _sentinel;
 		}
 
 		~rbtree()
 		{
 			clear();
-			destroy_sentinel_node();
 		}
 
 		rbtree& operator=(const rbtree& x)
 		{
 			if (this != &x)
 			{
-				if (!empty())
+				clear();
+				if (propagation::propagate_on_copy_assignment::value)
 				{
-					clear();
-					destroy_sentinel_node();
+					node_alloc() = x.node_alloc();
 				}
-				_node_base_alloc = x._node_base_alloc;
-				_node_alloc = x._node_alloc;
-				_sentinel = create_sentinel_node();
-				_root = _sentinel;
 				insert(x.begin(), x.end());
 			}
 			return *this;
 		}
 
 	private:
-		struct rbtree_iterator_accessor : public iterator 
+		struct rbtree_iterator_accessor : public iterator
 		{
 			inline rbtree_node_base* get_node() const
 			{
 				return this->_node_ptr;
 			}
 		};
-	
+
 		inline rbtree_node_base* get_node(const iterator& it) const
 		{
 			return static_cast<const rbtree_iterator_accessor&>(it).get_node();
 		}
 
+		// the tree links are rbtree_node_base pointers, iterators hold the node base of the layout
+		iterator make_iterator(rbtree_node_base* node) const
+		{
+			return iterator(static_cast<node_base_type*>(node));
+		}
+
+		const_iterator make_const_iterator(rbtree_node_base* node) const
+		{
+			return const_iterator(static_cast<const node_base_type*>(node));
+		}
+
+		node_alloc_type& node_alloc()
+		{
+			return node_alloc_storage::get();
+		}
+
+		const node_alloc_type& node_alloc() const
+		{
+			return node_alloc_storage::get();
+		}
+
+		const key_compare& compare() const
+		{
+			return compare_storage::get();
+		}
+
+		template <typename K1, typename K2>
+		bool compare(const K1& lhs, const K2& rhs) const
+		{
+			return compare_storage::get()(lhs, rhs);
+		}
+
+		// the sentinel is a member: end() needs a non-const pointer to it even in const member functions
+		rbtree_node_base* sentinel() const
+		{
+			return const_cast<node_base_type*>(&_sentinel);
+		}
+
+		rbtree_node_base* root() const
+		{
+			return _sentinel.parent();
+		}
+
+		void set_root(rbtree_node_base* node)
+		{
+			_sentinel.set_parent(node);
+		}
+
 	public:
 		allocator_type get_allocator() const
 		{
-			return _alloc;
+			return allocator_type(node_alloc());
 		}
 
 		iterator begin()
 		{
-			if (empty())
-			{
-				return end();
-			}
-			rbtree_node_base *node = rbtree_min(_root);
-			return iterator(node);
+			return make_iterator(threading::first(sentinel()));
 		}
 
 		// ITERATORS:
 		const_iterator begin() const
 		{
-			if (empty())
-			{
-				return const_iterator(_root);
-			}
-			rbtree_node_base *node = rbtree_min(_root);
-			return const_iterator(node);
+			return make_const_iterator(threading::first(sentinel()));
 		}
 
 		iterator end()
 		{
-			return iterator(_sentinel);		
+			return make_iterator(sentinel());
 		}
 
 		const_iterator end() const
 		{
-			return const_iterator(_sentinel);
+			return make_const_iterator(sentinel());
 		}
 
 		reverse_iterator rbegin()
@@ -163,7 +220,7 @@ namespace ft
 
 		reverse_iterator rend()
 		{
-			return reverse_iterator(begin());		
+			return reverse_iterator(begin());
 		}
 
 		const_reverse_iterator rend() const
@@ -174,11 +231,11 @@ namespace ft
 		// CAPACITY:
 		bool empty() const
 		{
-			return (_root == _sentinel);
+			return (root() == NULL);
 		}
 		size_type max_size() const
 		{
-			return _node_alloc.max_size();
+			return node_alloc().max_size();
 		}
 		size_type size() const
 		{
@@ -186,31 +243,41 @@ namespace ft
 		}
 
 		// MODIFIERS:
+		// all nodes are destroyed without rebalancing the tree after each deletion. saves execution time
+		// With a monotonic allocator (arena_allocator) and nodes that need no destructor, there is nothing to do
+		// per node: the tree is dropped as a whole and its memory comes back with the arena.
 		void clear()
 		{
-			iterator start = begin();
-			while (get_node(start) != _sentinel) // pseude_call - inline function
+			if (ft::is_monotonic_allocator<node_alloc_type>::value && ft::is_trivially_destructible<Node>::value)
 			{
-				// need to save the next iterator for the next loop before deleting the node as we're destroying without rebalancing
-				rbtree_node_base* node = get_node(start);
-				start++;
-				delete_node_pointer(node, false);
-				_node_alloc.destroy(static_cast<node_pointer>(node));
-				_node_alloc.deallocate(static_cast<node_pointer>(node), 1);
+				set_arenas(NULL);
 			}
+			else
+			{
+				destroy_subtree(root());
+				delete_empty_arenas();
+			}
+			set_root(NULL);
+			threading::reset(sentinel());
 			_size = 0;
 		}
 
 		void erase(iterator position)
 		{
 			rbtree_node_base* node_ptr = get_node(position);
-			delete_node_pointer(node_ptr,true);
-			_node_alloc.destroy(static_cast<node_pointer>(node_ptr));
-			_node_alloc.deallocate(static_cast<node_pointer>(node_ptr), 1);
+			if (arenas() != NULL)
+			{
+				skip_compaction_cursor(node_ptr);
+			}
+			threading::unlink(node_ptr);
+			delete_node_pointer(node_ptr);
+			destroy_node(static_cast<node_pointer>(node_ptr));
 			_size--;
 		}
 		// can be implemented with found or equal range. Found also calls 2 functions inside it so the complaxity might be equal;
-		size_type erase(const key_type& key)
+		// K is key_type, or any type comparable with it when the comparator is transparent (checked by map/set)
+		template <typename K>
+		size_type erase(const K& key)
 		{
 			iterator iter = find(key);
 			if (iter == end())
@@ -239,19 +306,38 @@ namespace ft
 		}
 
 		// insert():
-		// single element (1)	
+		// single element (1)
 		pair<iterator,bool> insert(const value_type& val)
 		{
 			pair<rbtree_node_base *, bool> position_pair;
-			position_pair = get_position_for_insertion(val);
+			position_pair = get_position_for_insertion(Node::get_key_from_value(val));
 			if (position_pair.second != false) // if the key didn't exist before and the new node has been inserted
 			{
-				pair<rbtree_node_base *, bool> insert_pair;
-				insert_pair = insert_node_at_position(position_pair, val);
-				rbtree_insert_fixup(insert_pair.first);
-				return insert_pair;
+				return insert_node_at_position(position_pair.first, create_node(position_pair.first, val));
+			}
+			return pair<iterator, bool>(make_iterator(position_pair.first), false);
+		}
+
+		// try_emplace(): the lookup is done first, the value is constructed (directly inside the node) only if the key is missing
+		pair<iterator,bool> try_emplace(const key_type& key)
+		{
+			pair<rbtree_node_base *, bool> position_pair = get_position_for_insertion(key);
+			if (position_pair.second != false)
+			{
+				return insert_node_at_position(position_pair.first, create_node_with_key(position_pair.first, key));
 			}
-			return position_pair;
+			return pair<iterator, bool>(make_iterator(position_pair.first), false);
+		}
+
+		template <class Arg>
+		pair<iterator,bool> try_emplace(const key_type& key, const Arg& arg)
+		{
+			pair<rbtree_node_base *, bool> position_pair = get_position_for_insertion(key);
+			if (position_pair.second != false)
+			{
+				return insert_node_at_position(position_pair.first, create_node_with_key(position_pair.first, key, arg));
+			}
+			return pair<iterator, bool>(make_iterator(position_pair.first), false);
 		}
 
 		// with hint (2)
@@ -271,7 +357,10 @@ namespace ft
 		}
 
 		//LOOKUP:
-		size_type count(const key_type& key) const
+		// all lookups are templates on the key type so that map/set can forward heterogeneous keys
+		// when the comparator is transparent (has is_transparent) without building a temporary key_type
+		template <typename K>
+		size_type count(const K& key) const
 		{
 			if (find(key) == end())
 				return (0);
@@ -279,128 +368,321 @@ namespace ft
 		}
 
 		//The range is defined by two iterators,
-		// one pointing to the first element that is not less than key 
-		//and another pointing to the first element greater than key. 
+		// one pointing to the first element that is not less than key
+		//and another pointing to the first element greater than key.
 		//Alternatively, the first iterator may be obtained with lower_bound(), and the second with upper_bound().
-		pair<iterator,iterator> equal_range(const key_type& key)
+		template <typename K>
+		pair<iterator,iterator> equal_range(const K& key)
 		{
 			return ft::pair<iterator, iterator>(lower_bound(key), upper_bound(key));
 		}
 
-		pair<const_iterator,const_iterator> equal_range(const key_type& key) const
+		template <typename K>
+		pair<const_iterator,const_iterator> equal_range(const K& key) const
 		{
 			return ft::pair<const_iterator, const_iterator>(lower_bound(key), upper_bound(key));
 		}
 
-		iterator find(const key_type& key )
+		template <typename K>
+		iterator find(const K& key)
 		{
-			iterator iter = lower_bound(key);
-			if (iter != end() && !_compare(key,	Node::get_key_from_value(*iter)))
-				return iter;
+			rbtree_node_base* node_ptr = lower_bound_node(key);
+			if (node_ptr != sentinel() && !compare(key, static_cast<node_pointer>(node_ptr)->get_key()))
+				return make_iterator(node_ptr);
 			return end();
 		}
 
-		const_iterator find(const key_type& key) const
+		template <typename K>
+		const_iterator find(const K& key) const
 		{
-			const_iterator iter = lower_bound(key);		
-			if (iter != end() && !_compare(key, Node::get_key_from_value(*iter)))
-				return iter;
+			rbtree_node_base* node_ptr = lower_bound_node(key);
+			if (node_ptr != sentinel() && !compare(key, static_cast<node_pointer>(node_ptr)->get_key()))
+				return make_const_iterator(node_ptr);
 			return end();
 		}
-		
+
 		//A similar member function, upper_bound, has the same behavior as lower_bound,
 		// except in the case that the map contains an element with a key equivalent to k:
 		// In this case, lower_bound returns an iterator pointing to that element,
 		// whereas upper_bound returns an iterator pointing to the next element.
-		iterator lower_bound(const key_type& key)
+		template <typename K>
+		iterator lower_bound(const K& key)
+		{
+			return make_iterator(lower_bound_node(key));
+		}
+
+		template <typename K>
+		const_iterator lower_bound(const K& key) const
+		{
+			return make_const_iterator(lower_bound_node(key));
+		}
+
+		// returns the iterator pointing to the element > than the key
+		template <typename K>
+		iterator upper_bound (const K& key)
+		{
+			return make_iterator(upper_bound_node(key));
+		}
+
+		template <typename K>
+		const_iterator upper_bound (const K& key) const
+		{
+			return make_const_iterator(upper_bound_node(key));
+		}
+
+		// RANGE SCANS:
+		// the elements with lo <= key < hi (the same as [lower_bound(lo), lower_bound(hi))) are visited in order
+		// by an in-order walk with an explicit stack instead of iterator increments, see walk_range()
+		enum { range_batch_size = 64 };
+
+		template <typename K, typename Function>
+		Function for_each_range(const K& lo, const K& hi, Function fn)
+		{
+			range_visitor<value_type, Function> visitor(fn);
+			walk_range(lo, hi, visitor);
+			return fn;
+		}
+
+		template <typename K, typename Function>
+		Function for_each_range(const K& lo, const K& hi, Function fn) const
+		{
+			range_visitor<const value_type, Function> visitor(fn);
+			walk_range(lo, hi, visitor);
+			return fn;
+		}
+
+		// fn(values, count) gets arrays of at most range_batch_size value pointers
+		template <typename K, typename Function>
+		Function for_each_range_batch(const K& lo, const K& hi, Function fn)
 		{
-			rbtree_node_base* node_ptr = _root;
-			rbtree_node_base* node_with_lower_value = _sentinel;
-			while (node_ptr != _sentinel)
+			range_batch_visitor<value_type, Function> visitor(fn);
+			walk_range(lo, hi, visitor);
+			visitor.flush();
+			return fn;
+		}
+
+		template <typename K, typename Function>
+		Function for_each_range_batch(const K& lo, const K& hi, Function fn) const
+		{
+			range_batch_visitor<const value_type, Function> visitor(fn);
+			walk_range(lo, hi, visitor);
+			visitor.flush();
+			return fn;
+		}
+
+		// BATCHED LOOKUPS:
+		// The keys are looked up find_lanes at a time with their descents interleaved: every round moves each key one
+		// level down and prefetches the next node, so the cache misses of the different keys overlap instead of each
+		// descent waiting for its own loads. The results are the same as find() of every key. KeyIt is random access.
+		enum { find_lanes = 8 };
+
+		// *out++ = find(keys[i]) for every key, returns the end of the output
+		template <typename KeyIt, typename OutIt>
+		OutIt find_many(KeyIt keys, size_type count, OutIt out)
+		{
+			rbtree_node_base* found[find_lanes];
+			for (size_type done = 0; done < count; done += find_lanes)
 			{
-				if (_compare(static_cast<node_pointer>(node_ptr)->get_key(), key))
+				size_type lanes = count - done < size_type(find_lanes) ? count - done : size_type(find_lanes);
+				find_nodes(keys + done, lanes, found);
+				for (size_type i = 0; i < lanes; ++i, ++out)
 				{
-					node_ptr = node_ptr->_right;
-				}
-				else
-				{
-					node_with_lower_value = node_ptr;
-					node_ptr = node_ptr->_left;
+					*out = make_iterator(found[i] != NULL ? found[i] : sentinel());
 				}
 			}
-			return iterator(node_with_lower_value);
+			return out;
 		}
-		
-		const_iterator lower_bound(const key_type& key) const
+
+		template <typename KeyIt, typename OutIt>
+		OutIt find_many(KeyIt keys, size_type count, OutIt out) const
 		{
-			rbtree_node_base* node_ptr = _root;
-			rbtree_node_base* node_with_lower_value = _sentinel;
-			while (node_ptr != _sentinel)
+			rbtree_node_base* found[find_lanes];
+			for (size_type done = 0; done < count; done += find_lanes)
 			{
-				if (_compare(static_cast<node_pointer>(node_ptr)->get_key(), key))
+				size_type lanes = count - done < size_type(find_lanes) ? count - done : size_type(find_lanes);
+				find_nodes(keys + done, lanes, found);
+				for (size_type i = 0; i < lanes; ++i, ++out)
 				{
-					node_ptr = node_ptr->_right;
+					*out = make_const_iterator(found[i] != NULL ? found[i] : sentinel());
 				}
-				else
+			}
+			return out;
+		}
+
+		// bit i % 64 of bitmap[i / 64] is set if keys[i] is in the tree; the words are overwritten, the unused
+		// high bits of the last one are cleared
+		template <typename KeyIt>
+		void contains_many(KeyIt keys, size_type count, uint64_t* bitmap) const
+		{
+			rbtree_node_base* found[find_lanes];
+			for (size_type word = 0; word * 64 < count; ++word)
+			{
+				uint64_t bits = 0;
+				for (size_type done = word * 64; done < count && done < (word + 1) * 64; done += find_lanes)
 				{
-					node_with_lower_value = node_ptr;
-					node_ptr = node_ptr->_left;
+					size_type lanes = count - done < size_type(find_lanes) ? count - done : size_type(find_lanes);
+					find_nodes(keys + done, lanes, found);
+					for (size_type i = 0; i < lanes; ++i)
+					{
+						bits |= uint64_t(found[i] != NULL) << ((done + i) % 64);
+					}
 				}
+				bitmap[word] = bits;
 			}
-			return const_iterator(node_with_lower_value);
 		}
-		
-		// returns the iterator pointing to the element > than the key
-		iterator upper_bound (const key_type& key)
+
+		// BULK BUILD:
+		// Replaces the contents with [first, first + n), which must be sorted with strictly increasing keys.
+		// The nodes are carved out of one allocation (an arena) and linked bottom up: the middle element of every range
+		// is the root of its subtree, so the tree is balanced and the nodes of the deepest level are the only red ones.
+		// O(n), no comparison, no rotation. fork(a, b) calls the functors a() and b(), maybe in parallel: the two halves
+		// of a big range are constructed and linked independently. rbtree_sequential_fork calls them one after the other.
+		template <class RandomIt, class Fork>
+		void assign_sorted_unique(RandomIt first, size_type n, Fork& fork)
+		{
+			clear();
+			if (n == 0)
+			{
+				return;
+			}
+			node_arena* arena = new_arena(n);
+			try
+			{
+				node_constructor<RandomIt, Fork> construct(arena->nodes, first, 0, n, fork);
+				construct();
+			}
+			catch (...)
+			{
+				delete_arena(arena);
+				throw;
+			}
+			adopt_arena(arena, n, fork);
+		}
+
+		// COMPACTION:
+		// After a long insert/erase churn the nodes are scattered over the heap and an in-order scan touches a new page
+		// at almost every step. compact() copies the elements in order into one new allocation (an arena, like
+		// assign_sorted_unique()), frees the old nodes and links the copies into a balanced tree: a scan then walks
+		// the memory forward. compact_step(max_nodes) relocates at most max_nodes nodes per call, for a maintenance slot
+		// that can't afford a pause: a pass moves the nodes in order into its arena one by one, each copy taking
+		// the place of its original in the tree (no rebalancing), and true is returned when the pass is over; the next
+		// call starts a new pass. Elements inserted during a pass behind its position are left where they are.
+		// Both invalidate the iterators and references to the moved elements.
+		void compact()
 		{
-			rbtree_node_base* node_ptr = _root;
-			rbtree_node_base* larger = _sentinel;
-			while (node_ptr != _sentinel)
+			if (empty())
+			{
+				return;
+			}
+			size_type n = _size;
+			node_arena* arena = new_arena(n);
+			size_type built = 0;
+			try
 			{
-				if (_compare(key, static_cast<node_pointer>(node_ptr)->get_key()))
+				for (iterator it = begin(); built < n; ++it, ++built)
 				{
-					larger = node_ptr;
-					node_ptr = node_ptr->_left;
+					::new (static_cast<void*>(arena->nodes + built)) Node(NULL, *it);
 				}
-				else
-					node_ptr = node_ptr->_right;
 			}
-			return iterator(larger);
+			catch (...)
+			{
+				destroy_range(arena->nodes, 0, built);
+				delete_arena(arena);
+				throw;
+			}
+			clear();
+			rbtree_sequential_fork fork;
+			adopt_arena(arena, n, fork);
 		}
-		
-		const_iterator upper_bound (const key_type& key) const
+
+		bool compact_step(size_type max_nodes)
 		{
-			rbtree_node_base* node_ptr = _root;
-			rbtree_node_base* equal_or_higher = _root;
-			while (node_ptr != _sentinel)
+			node_arena* pass = compaction_pass();
+			if (pass == NULL)
 			{
-				if (_compare(key, static_cast<node_pointer>(node_ptr)->get_key()))
+				if (empty() || max_nodes == 0)
 				{
-					equal_or_higher = node_ptr;
-					node_ptr = node_ptr->_left;
+					return true;
 				}
-				else
-					node_ptr = node_ptr->_right;
+				pass = new_arena(_size);
+				pass->cursor = begin_node();
+				pass->next = arenas();
+				set_arenas(pass);
+			}
+			for (; max_nodes != 0 && pass->cursor != NULL; --max_nodes)
+			{
+				node_pointer original = static_cast<node_pointer>(pass->cursor);
+				node_pointer copy = pass->nodes + pass->used;
+				::new (static_cast<void*>(copy)) Node(NULL, original->_value); // nothing has changed yet if it throws
+				++pass->used;
+				++pass->live;
+				replace_node(original, copy);
+				rbtree_node_base* next = successor(copy);
+				pass->cursor = (next == sentinel() || pass->used == pass->capacity) ? NULL : next;
+				destroy_node(original);
 			}
-			return const_iterator(equal_or_higher);
+			return pass->cursor == NULL;
 		}
-		
+
 		// OBSERVERS:
 		key_compare key_comp() const
 		{
-			return _compare;
+			return compare();
 		}
 
+		// An allocator that doesn't propagate on swap (polymorphic_allocator) stays with its tree: the nodes are
+		// only exchanged when each allocator can free the other's memory, otherwise the contents are copied into
+		// trees on the allocators of the sides they go to (linear time, like std with unequal allocators)
 		void swap(rbtree& other )
 		{
-			ft::swap(other._sentinel, _sentinel);
-            ft::swap(other._root, _root);
+			swap(other, typename propagation::propagate_on_swap());
+		}
+
+	private:
+		void swap(rbtree& other, ft::true_type)
+		{
+			swap_nodes(other);
+		}
+
+		void swap(rbtree& other, ft::false_type)
+		{
+			if (node_alloc() == other.node_alloc())
+			{
+				swap_nodes(other);
+				return;
+			}
+			rbtree to_this(other.compare(), allocator_type(node_alloc()));
+			to_this.insert(other.begin(), other.end());
+			rbtree to_other(compare(), allocator_type(other.node_alloc()));
+			to_other.insert(begin(), end());
+			swap_nodes(to_this);
+			other.swap_nodes(to_other);
+		}
+
+		// the sentinels stay in place (they are members), only the roots are exchanged and relinked
+		// to the sentinel of their new tree, so swap() is still constant time
+		void swap_nodes(rbtree& other)
+		{
+			rbtree_node_base* this_root = root();
+			rbtree_node_base* other_root = other.root();
+			set_root(other_root);
+			if (other_root != NULL)
+			{
+				other_root->set_parent(&_sentinel);
+			}
+			other.set_root(this_root);
+			if (this_root != NULL)
+			{
+				this_root->set_parent(&other._sentinel);
+			}
+			threading::swap_lists(&_sentinel, &other._sentinel);
+			ft::swap(other._arenas, _arenas); // the arenas go with their nodes
             ft::swap(other._size, _size);
-            ft::swap(other._alloc, _alloc);
-            ft::swap(other._node_alloc, _node_alloc);
-            ft::swap(other._compare, _compare);
+            ft::swap(other.node_alloc(), node_alloc());
+            ft::swap(other.compare_storage::get(), compare_storage::get());
 		}
 
+	public:
 		void tree_print_helper()
 		{
 			if (empty())
@@ -413,42 +695,43 @@ namespace ft
 			int n = 1;
 			for (iterator i = f_it; i != itEnd; ++i, ++n)
 			{
+				rbtree_node_base* node = get_node(i);
 				std::string col = "RED  ";
-				if (get_node(i)->_color == 0)
+				if (node->color() == BLACK)
 				{
 					col = "BLACK";
 				}
 				std::cout << n << ":           	  -----|" << i->first << " " << col ;
-				if (get_node(i)->_parent == _sentinel)
+				if (node->parent() == sentinel())
 				{
 					std::cout << " (parent -  sentinel)|-----   " ;
 				}
 				else
 				{
-					std::cout << " (parent - " << (get_node(i)->_parent)->_key << ")|-----  ";
+					std::cout << " (parent - " << static_cast<node_pointer>(node->parent())->get_key() << ")|-----  ";
 				}
 
-				if (get_node(i) == _root)
+				if (node == root())
 				{
 					std::cout << "THIS IS THE ROOT";
 				}
 
 				std::cout << std::endl;
-				if (get_node(i)->_left == _sentinel)
+				if (node->_left == NULL)
 				{
-					std::cout << "  left - sentinel|\n" ;
+					std::cout << "  left - NULL|\n" ;
 				}
 				else
 				{
-					std::cout << "  left - " << (get_node(i)->_left)->_key<<  "|\n";
+					std::cout << "  left - " << static_cast<node_pointer>(node->_left)->get_key() <<  "|\n";
 				}
-				if (get_node(i)->_right == _sentinel)
+				if (node->_right == NULL)
 				{
-					std::cout << "  right-  sentinel|\n" ;
+					std::cout << "  right-  NULL|\n" ;
 				}
 				else
 				{
-					std::cout << "  right - " << (get_node(i)->_right)->_key << "|\n";
+					std::cout << "  right - " << static_cast<node_pointer>(node->_right)->get_key() << "|\n";
 				}
 
 				std::cout << std::endl;
@@ -457,33 +740,414 @@ namespace ft
 		}
 
 	private:
-		node_pointer create_node(rbtree_node_base* parent_ptr, rbtree_node_base* child_ptr, const value_type& value)
+		// the node is constructed in place with placement new: constructing a temporary Node and passing it to
+		// _node_alloc.construct() would copy the whole value a second time
+		node_pointer create_node(rbtree_node_base* parent_ptr, const value_type& value)
 		{
-			node_pointer new_node = _node_alloc.allocate(1); // allocates a block of storage with a size large enough to contain n elements of member type value_type (an alias of the allocator's template parameter), and returns a pointer to the first element.
-			Node node(parent_ptr, child_ptr, value);
-			_node_alloc.construct(new_node, node);
+			node_pointer new_node = node_alloc().allocate(1); // allocates a block of storage with a size large enough to contain n elements of member type value_type (an alias of the allocator's template parameter), and returns a pointer to the first element.
+			try
+			{
+				::new (static_cast<void*>(new_node)) Node(parent_ptr, value);
+			}
+			catch (...)
+			{
+				node_alloc().deallocate(new_node, 1);
+				throw;
+			}
 			return new_node;
 		}
 
-		pair<rbtree_node_base*, bool> get_position_for_insertion(const value_type& value)
+		// map only: the mapped value is default constructed inside the node
+		node_pointer create_node_with_key(rbtree_node_base* parent_ptr, const key_type& key)
+		{
+			node_pointer new_node = node_alloc().allocate(1);
+			try
+			{
+				::new (static_cast<void*>(new_node)) Node(parent_ptr, key);
+			}
+			catch (...)
+			{
+				node_alloc().deallocate(new_node, 1);
+				throw;
+			}
+			return new_node;
+		}
+
+		// map only: the mapped value is constructed from arg inside the node
+		template <class Arg>
+		node_pointer create_node_with_key(rbtree_node_base* parent_ptr, const key_type& key, const Arg& arg)
+		{
+			node_pointer new_node = node_alloc().allocate(1);
+			try
+			{
+				::new (static_cast<void*>(new_node)) Node(parent_ptr, key, arg);
+			}
+			catch (...)
+			{
+				node_alloc().deallocate(new_node, 1);
+				throw;
+			}
+			return new_node;
+		}
+
+		void destroy_node(node_pointer node)
+		{
+			node_alloc().destroy(node);
+			if (arenas() != NULL && release_arena_node(node))
+			{
+				return;
+			}
+			node_alloc().deallocate(node, 1);
+		}
+
+		// Nodes of assign_sorted_unique() come from one allocation of n nodes, it is given back with its last node.
+		// The arenas of a tree are a list, trees that never had a bulk build pay one word and a NULL check in destroy_node().
+		struct node_arena
+		{
+			node_arena*			next;
+			node_pointer		nodes;
+			size_type			capacity;
+			size_type			live;
+			size_type			used;		// nodes handed out, the first ones
+			rbtree_node_base*	cursor;		// the next node to move while compact_step() fills the arena
+		};
+
+		typedef typename Alloc::template rebind<node_arena>::other	arena_alloc_type;
+
+		node_arena* arenas() const
+		{
+			return _arenas;
+		}
+
+		void set_arenas(node_arena* arena)
+		{
+			_arenas = arena;
+		}
+
+		node_arena* new_arena(size_type capacity)
+		{
+			arena_alloc_type arena_alloc(node_alloc());
+			node_arena* arena = arena_alloc.allocate(1);
+			try
+			{
+				arena->nodes = node_alloc().allocate(capacity);
+			}
+			catch (...)
+			{
+				arena_alloc.deallocate(arena, 1);
+				throw;
+			}
+			arena->next = NULL;
+			arena->capacity = capacity;
+			arena->live = 0;
+			arena->used = 0;
+			arena->cursor = NULL;
+			return arena;
+		}
+
+		void delete_arena(node_arena* arena)
+		{
+			node_alloc().deallocate(arena->nodes, arena->capacity);
+			arena_alloc_type(node_alloc()).deallocate(arena, 1);
+		}
+
+		// the arenas are freed with their last node; a pass of compact_step() whose first copy threw has none
+		void delete_empty_arenas()
+		{
+			while (arenas() != NULL)
+			{
+				node_arena* next = arenas()->next;
+				delete_arena(arenas());
+				set_arenas(next);
+			}
+		}
+
+		// true if the (destroyed) node belongs to an arena
+		bool release_arena_node(node_pointer node)
+		{
+			std::less<node_pointer> before;
+			node_arena* previous = NULL;
+			for (node_arena* arena = arenas(); arena != NULL; previous = arena, arena = arena->next)
+			{
+				if (!before(node, arena->nodes) && before(node, arena->nodes + arena->capacity))
+				{
+					if (--arena->live == 0)
+					{
+						if (previous == NULL)
+						{
+							set_arenas(arena->next);
+						}
+						else
+						{
+							previous->next = arena->next;
+						}
+						delete_arena(arena);
+					}
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// the arena of assign_sorted_unique() or compact() holds the n nodes of the new contents, constructed in order
+		template <class Fork>
+		void adopt_arena(node_arena* arena, size_type n, Fork& fork)
+		{
+			arena->live = n;
+			arena->used = n;
+			arena->next = arenas();
+			set_arenas(arena);
+			size_type red_depth = 0; // floor(log2(n)): the depth of the deepest level, the root is at depth 0
+			for (size_type m = n; m > 1; m /= 2)
+			{
+				++red_depth;
+			}
+			try
+			{
+				subtree_linker<Fork> link(arena->nodes, 0, n, 0, red_depth, fork);
+				link();
+				set_root(link.root);
+			}
+			catch (...)
+			{
+				// the nodes are destroyed by index, their links don't matter
+				for (size_type i = 0; i < n; ++i)
+				{
+					destroy_node(arena->nodes + i);
+				}
+				throw;
+			}
+			root()->set_parent(sentinel());
+			root()->set_color(BLACK);
+			for (size_type i = 0; i < n; ++i)
+			{
+				threading::link(arena->nodes + i, sentinel(), true); // appended at the end of the list
+			}
+			_size = n;
+		}
+
+		rbtree_node_base* begin_node() const
+		{
+			return threading::first(sentinel());
+		}
+
+		rbtree_node_base* successor(rbtree_node_base* node) const
+		{
+			return get_node(++make_iterator(node));
+		}
+
+		// the pass of compact_step() in progress: the arena whose cursor is set
+		node_arena* compaction_pass() const
+		{
+			for (node_arena* arena = arenas(); arena != NULL; arena = arena->next)
+			{
+				if (arena->cursor != NULL)
+				{
+					return arena;
+				}
+			}
+			return NULL;
+		}
+
+		// the next node of the pass is about to be erased: the pass goes on from its successor
+		void skip_compaction_cursor(rbtree_node_base* node)
+		{
+			node_arena* pass = compaction_pass();
+			if (pass != NULL && pass->cursor == node)
+			{
+				rbtree_node_base* next = successor(node);
+				pass->cursor = next == sentinel() ? NULL : next;
+			}
+		}
+
+		// copy takes the place of original: same parent, children, color and in-order neighbours
+		void replace_node(rbtree_node_base* original, rbtree_node_base* copy)
+		{
+			copy->set_parent(original->parent());
+			copy->set_color(original->color());
+			copy->_left = original->_left;
+			copy->_right = original->_right;
+			if (copy->_left != NULL)
+			{
+				copy->_left->set_parent(copy);
+			}
+			if (copy->_right != NULL)
+			{
+				copy->_right->set_parent(copy);
+			}
+			if (original->parent() == sentinel())
+			{
+				set_root(copy);
+			}
+			else if (original->parent()->_left == original)
+			{
+				original->parent()->_left = copy;
+			}
+			else
+			{
+				original->parent()->_right = copy;
+			}
+			threading::replace(original, copy);
+		}
+
+
+		enum { bulk_grain = 4096 }; // ranges of the bulk build that aren't split anymore
+
+		// constructs the nodes [lo, hi) from the values with the same indexes; if it throws, nothing is left constructed
+		template <class RandomIt, class Fork>
+		struct node_constructor
+		{
+			node_pointer	nodes;
+			RandomIt		values;
+			size_type		lo;
+			size_type		hi;
+			Fork&			fork;
+			bool			done;
+
+			node_constructor(node_pointer n, RandomIt v, size_type l, size_type h, Fork& f)
+				: nodes(n), values(v), lo(l), hi(h), fork(f), done(false) {}
+
+			void operator()()
+			{
+				if (hi - lo <= bulk_grain)
+				{
+					size_type i = lo;
+					try
+					{
+						for (; i < hi; ++i)
+						{
+							::new (static_cast<void*>(nodes + i)) Node(NULL, values[i]);
+						}
+					}
+					catch (...)
+					{
+						destroy_range(nodes, lo, i);
+						throw;
+					}
+					done = true;
+					return;
+				}
+				size_type mid = lo + (hi - lo) / 2;
+				node_constructor left(nodes, values, lo, mid, fork);
+				node_constructor right(nodes, values, mid, hi, fork);
+				try
+				{
+					fork(left, right);
+				}
+				catch (...)
+				{
+					if (left.done)
+					{
+						destroy_range(nodes, lo, mid);
+					}
+					if (right.done)
+					{
+						destroy_range(nodes, mid, hi);
+					}
+					throw;
+				}
+				done = true;
+			}
+		};
+
+		static void destroy_range(node_pointer nodes, size_type lo, size_type hi)
+		{
+			for (; lo < hi; ++lo)
+			{
+				(nodes + lo)->~Node();
+			}
+		}
+
+		// links the nodes [lo, hi) into a balanced subtree whose root is at the given depth
+		template <class Fork>
+		struct subtree_linker
+		{
+			node_pointer		nodes;
+			size_type			lo;
+			size_type			hi;
+			size_type			depth;
+			size_type			red_depth;
+			Fork&				fork;
+			rbtree_node_base*	root;
+
+			subtree_linker(node_pointer n, size_type l, size_type h, size_type d, size_type red, Fork& f)
+				: nodes(n), lo(l), hi(h), depth(d), red_depth(red), fork(f), root(NULL) {}
+
+			void operator()()
+			{
+				if (hi - lo <= bulk_grain)
+				{
+					root = link_range(nodes, lo, hi, depth, red_depth);
+					return;
+				}
+				size_type mid = lo + (hi - lo) / 2;
+				subtree_linker left(nodes, lo, mid, depth + 1, red_depth, fork);
+				subtree_linker right(nodes, mid + 1, hi, depth + 1, red_depth, fork);
+				fork(left, right);
+				root = attach(nodes + mid, left.root, right.root, depth, red_depth);
+			}
+		};
+
+		static rbtree_node_base* link_range(node_pointer nodes, size_type lo, size_type hi, size_type depth, size_type red_depth)
+		{
+			if (lo == hi)
+			{
+				return NULL;
+			}
+			size_type mid = lo + (hi - lo) / 2;
+			rbtree_node_base* left = link_range(nodes, lo, mid, depth + 1, red_depth);
+			rbtree_node_base* right = link_range(nodes, mid + 1, hi, depth + 1, red_depth);
+			return attach(nodes + mid, left, right, depth, red_depth);
+		}
+
+		static rbtree_node_base* attach(rbtree_node_base* node, rbtree_node_base* left, rbtree_node_base* right,
+			size_type depth, size_type red_depth)
+		{
+			node->_left = left;
+			node->_right = right;
+			if (left != NULL)
+			{
+				left->set_parent(node);
+			}
+			if (right != NULL)
+			{
+				right->set_parent(node);
+			}
+			node->set_color(depth == red_depth ? RED : BLACK);
+			return node;
+		}
+
+		// post-order destruction: the right subtree is destroyed recursively and the left one in the loop,
+		// so no iterator increments (and no rebalancing) are needed
+		void destroy_subtree(rbtree_node_base* node)
+		{
+			while (node != NULL)
+			{
+				destroy_subtree(node->_right);
+				rbtree_node_base* left = node->_left;
+				destroy_node(static_cast<node_pointer>(node));
+				node = left;
+			}
+		}
+
+		pair<rbtree_node_base*, bool> get_position_for_insertion(const key_type& key)
 		{
 			bool isUniqueKey = true;
-			rbtree_node_base* position = _sentinel;
-			rbtree_node_base* current = _root;
-			const key_type key = Node::get_key_from_value(value);
-			while(current != _sentinel)
+			rbtree_node_base* position = sentinel();
+			rbtree_node_base* current = root();
+			while(current != NULL)
 			{
 				position = current;
-				if (!_compare(key, static_cast<node_pointer>(current)->get_key()) // analogue of if (key == static_cast<node_pointer>(current)->get_key())
-					&& !_compare(static_cast<node_pointer>(current)->get_key(), key))
+				if (!compare(key, static_cast<node_pointer>(current)->get_key()) // analogue of if (key == static_cast<node_pointer>(current)->get_key())
+					&& !compare(static_cast<node_pointer>(current)->get_key(), key))
 				{
 					isUniqueKey = false;
 					return ft::pair<rbtree_node_base*, bool>(current, isUniqueKey); // returning the current node and the bool that the node is existing (that is not unique)
 				}
-				if (_compare(key, static_cast<node_pointer>(current)->get_key())) // _compare is std::less
+				if (compare(key, static_cast<node_pointer>(current)->get_key())) // compare is std::less
 				{
 					current = current->_left;
-				} 
+				}
 				else{
 					current = current->_right;
 				}
@@ -491,45 +1155,42 @@ namespace ft
 			return ft::pair<rbtree_node_base *, bool>(position, isUniqueKey);
 		}
 
-		pair<rbtree_node_base*, bool> insert_node_at_position(ft::pair<rbtree_node_base *, bool> position_pair,
-														const value_type& value)
+		// links the freshly created node under position and rebalances the tree
+		pair<iterator, bool> insert_node_at_position(rbtree_node_base *position, node_pointer new_node)
 		{
-			rbtree_node_base *position = position_pair.first;
-			rbtree_node_base *new_node = create_node(position, _sentinel, value);
-			const key_type key = Node::get_key_from_value(value);
-			if (position == _sentinel)
+			bool left_child = false;
+			if (position == sentinel())
 			{
-				_root = new_node;
-				_root->_parent = _sentinel;
-				_root->_color = BLACK;
-				_sentinel->_parent = _root;
+				set_root(new_node); // new_node's parent already points to the sentinel
 			}
-			else if (_compare(key, static_cast<node_pointer>(position)->get_key()))
+			else if (compare(new_node->get_key(), static_cast<node_pointer>(position)->get_key()))
 			{
 				position->_left = new_node;
+				left_child = true;
 			}
 			else
 			{
 				position->_right = new_node;
 			}
+			threading::link(new_node, position, left_child); // in-order neighbours are known before the rotations
 			_size++;
-			return ft::pair<rbtree_node_base *, bool>(new_node, position_pair.second);
+			rbtree_insert_fixup(new_node);
+			return ft::pair<iterator, bool>(make_iterator(new_node), true);
 		}
 
 		void assign_subnode_to_new_parent(rbtree_node_base* node, rbtree_node_base* subnode)
 		{
-			if (node->_parent == _sentinel)
+			if (node->parent() == sentinel())
 			{
-				_root = subnode;
-				_sentinel->_parent = _root;
+				set_root(subnode);
 			}
-			else if (node == node->_parent->_left)
+			else if (node == node->parent()->_left)
 			{
-				node->_parent->_left = subnode; // left child of the node's parent points to the subnode now
+				node->parent()->_left = subnode; // left child of the node's parent points to the subnode now
 			}
 			else
 			{
-				node->_parent->_right = subnode; // or the right child of the node's parent points to the subnode now
+				node->parent()->_right = subnode; // or the right child of the node's parent points to the subnode now
 			}
 		}
 
@@ -540,223 +1201,194 @@ namespace ft
 		{
 			rbtree_node_base* subnode = node->_right;
 			node->_right = subnode->_left;
-			if (subnode->_left != _sentinel)
+			if (subnode->_left != NULL)
 			{
-				subnode->_left->_parent = node; //linking left child of the subnode to the node
+				subnode->_left->set_parent(node); //linking left child of the subnode to the node
 			}
-			subnode->_parent = node->_parent; //linking node's parent to the subnode
+			subnode->set_parent(node->parent()); //linking node's parent to the subnode
 			assign_subnode_to_new_parent(node, subnode);
 			subnode->_left = node;
-			node->_parent = subnode;
+			node->set_parent(subnode);
 		}
 
 		void rotate_right(rbtree_node_base* node)
 		{
 			rbtree_node_base* subnode = node->_left;
 			node->_left = subnode->_right;
-			if (subnode->_right != _sentinel)
+			if (subnode->_right != NULL)
 			{
-				subnode->_right->_parent = node; //linking left child of the subnode to the node
+				subnode->_right->set_parent(node); //linking left child of the subnode to the node
 			}
-			subnode->_parent = node->_parent; //linking node's parent to the subnode
+			subnode->set_parent(node->parent()); //linking node's parent to the subnode
 			assign_subnode_to_new_parent(node, subnode);
 			subnode->_right = node;
-			node->_parent = subnode;
+			node->set_parent(subnode);
 		}
 
 		rbtree_node_base* recolor_grandparent_and_children(rbtree_node_base* grandparent)
 		{
-			grandparent->_left->_color = BLACK;
-			grandparent->_right->_color = BLACK;
-			grandparent->_color = RED;
+			grandparent->_left->set_color(BLACK);
+			grandparent->_right->set_color(BLACK);
+			grandparent->set_color(RED);
 			return grandparent;
 		}
 
 		void swap_colors(rbtree_node_base* node, rbtree_node_base* parent)
 		{
-			node->_color = BLACK;
-			parent->_color = RED;
+			node->set_color(BLACK);
+			parent->set_color(RED);
 		}
 
-		void rbtree_insert_fixup_right(rbtree_node_base* node, rbtree_node_base* grandparent)
+		// both fixup helpers return the node from which the fixup continues (the grandparent after recoloring)
+		rbtree_node_base* rbtree_insert_fixup_right(rbtree_node_base* node, rbtree_node_base* grandparent)
 		{
 			rbtree_node_base* uncle = grandparent->_left;
-			if (uncle->_color == RED)
+			if (rbtree_node_base::color_of(uncle) == RED)
 			{
-				node = recolor_grandparent_and_children(grandparent);
+				return recolor_grandparent_and_children(grandparent);
 			}
-			else 
+			if (node == node->parent()->_left)
 			{
-				if (node == node->_parent->_left)
-				{
-					node = node->_parent;
-					rotate_right(node);
-				}
-				swap_colors(node->_parent, node->_parent->_parent);
-				rotate_left(node->_parent->_parent);
+				node = node->parent();
+				rotate_right(node);
 			}
+			swap_colors(node->parent(), node->parent()->parent());
+			rotate_left(node->parent()->parent());
+			return node;
 		}
 
-		void rbtree_insert_fixup_left(rbtree_node_base* node, rbtree_node_base* grandparent)
+		rbtree_node_base* rbtree_insert_fixup_left(rbtree_node_base* node, rbtree_node_base* grandparent)
 		{
 			rbtree_node_base *uncle = grandparent->_right;
-			if (uncle->_color == RED)
+			if (rbtree_node_base::color_of(uncle) == RED)
 			{
-				node = recolor_grandparent_and_children(grandparent);
+				return recolor_grandparent_and_children(grandparent);
 			}
-			else 
+			if (node == node->parent()->_right)
 			{
-				if (node == node->_parent->_right)
-				{
-					node = node->_parent;
-					rotate_left(node);
-				}
-					swap_colors(node->_parent, node->_parent->_parent);
-				rotate_right(node->_parent->_parent);
+				node = node->parent();
+				rotate_left(node);
 			}
+			swap_colors(node->parent(), node->parent()->parent());
+			rotate_right(node->parent()->parent());
+			return node;
 		}
 
+		// the sentinel is black, so the loop stops at the root
 		void rbtree_insert_fixup(rbtree_node_base* node)
 		{
-			while (node->_parent->_color == RED)
+			while (node->parent()->color() == RED)
 			{
-				rbtree_node_base* grandparent = node->_parent->_parent;
-				if (node->_parent == grandparent->_left)
+				rbtree_node_base* grandparent = node->parent()->parent();
+				if (node->parent() == grandparent->_left)
 				{
-					rbtree_insert_fixup_left(node, grandparent);
+					node = rbtree_insert_fixup_left(node, grandparent);
 				}
 				else
 				{
-					rbtree_insert_fixup_right(node, grandparent);
+					node = rbtree_insert_fixup_right(node, grandparent);
 				}
 			}
-			_root->_color = BLACK;
-		}
-
-		pair<rbtree_node_base*, rbtree_node_base*> delete_node_with_null_child(rbtree_node_base* node_to_delete)
-		{
-			rbtree_node_base* replacement;
-			if (node_to_delete->_left == _sentinel)
-			{
-				replacement = node_to_delete->_right;
-				rb_transplant(node_to_delete, replacement);
-			}
-			else
-			{
-				replacement = node_to_delete->_left;
-				rb_transplant(node_to_delete, replacement);
-			}
-			rbtree_node_base* replacement_parent = node_to_delete->_parent;
-			return ft::make_pair(replacement, replacement_parent);
-		}
-
-		pair<rbtree_node_base*, rbtree_node_base*>  delete_node_with_two_children(rbtree_node_base* node_to_delete, rbtree_node_base* successor)
-		{
-			rbtree_node_base *replacement;
-			replacement = successor->_right;
-			rbtree_node_base* replacement_parent = successor->_parent;
-			if (successor->_parent == node_to_delete)
-			{
-				if (replacement != _sentinel)
-					replacement->_parent = successor;
-				replacement_parent = successor;
-			}
-			else
-			{
-				rb_transplant(successor, replacement);
-				successor->_right = node_to_delete->_right;
-				successor->_right->_parent = successor;
-			}
-			rb_transplant(node_to_delete, successor);
-			successor->_left = node_to_delete->_left;
-			successor->_left->_parent = successor;
-			successor->_color = node_to_delete->_color;
-			return ft::make_pair(replacement, replacement_parent);
+			root()->set_color(BLACK);
 		}
 
 	// replaces pointer of the node to delete with the pointer to the replacing node
 		void rb_transplant(rbtree_node_base* node, rbtree_node_base* replacement)
 		{
-			if (node->_parent == _sentinel)
+			if (node->parent() == sentinel())
 			{
-				_root = replacement;
-				_sentinel->_parent = _root;
+				set_root(replacement);
 			}
-			else if (node == node->_parent->_left)
+			else if (node == node->parent()->_left)
 			{
-				node->_parent->_left = replacement;
+				node->parent()->_left = replacement;
 			}
 			else
 			{
-				node->_parent->_right = replacement;
+				node->parent()->_right = replacement;
 			}
-			if (replacement != _sentinel)
+			if (replacement != NULL)
 			{
-				replacement->_parent = node->_parent;
+				replacement->set_parent(node->parent());
 			}
 		}
 
 	// replacing pair will hold the pointer to the replacing node and its parent
-	// (parent is needed for the case the replacement is sentinel and its parent pointing to the root)
-			void delete_node_pointer(rbtree_node_base* node_to_delete, bool fixup) // bool fixup(true) marks when the functtion is called not from clear()
+	// (the parent is needed as the replacement can be a NULL leaf)
+		void delete_node_pointer(rbtree_node_base* node_to_delete)
+		{
+			rbtree_node_base* replacement;
+			rbtree_node_base* replacement_parent;
+			e_color original_color = node_to_delete->color();
+			if (node_to_delete->_left == NULL || node_to_delete->_right == NULL)
 			{
-				pair<rbtree_node_base*, rbtree_node_base*> replacing_pair;
-				int original_color = node_to_delete->_color;
-				if (node_to_delete->_left == _sentinel
-					|| node_to_delete->_right == _sentinel)
+				replacement = (node_to_delete->_left == NULL) ? node_to_delete->_right : node_to_delete->_left;
+				replacement_parent = node_to_delete->parent();
+				rb_transplant(node_to_delete, replacement);
+			}
+			else
+			{
+				rbtree_node_base* successor = rbtree_min(node_to_delete->_right);
+				original_color = successor->color();
+				replacement = successor->_right;
+				if (successor->parent() == node_to_delete)
 				{
-					replacing_pair = delete_node_with_null_child(node_to_delete);
+					replacement_parent = successor;
 				}
 				else
 				{
-					rbtree_node_base* successor;
-					successor = rbtree_min(node_to_delete->_right); 
-					original_color = successor->_color;
-					replacing_pair = delete_node_with_two_children(node_to_delete, successor);
-				}
-				if (fixup && original_color == BLACK)
-				{
-					rbtree_delete_fixup(replacing_pair);
+					replacement_parent = successor->parent();
+					rb_transplant(successor, replacement);
+					successor->_right = node_to_delete->_right;
+					successor->_right->set_parent(successor);
 				}
+				rb_transplant(node_to_delete, successor);
+				successor->_left = node_to_delete->_left;
+				successor->_left->set_parent(successor);
+				successor->set_color(node_to_delete->color());
 			}
+			if (original_color == BLACK)
+			{
+				rbtree_delete_fixup(ft::make_pair(replacement, replacement_parent));
+			}
+		}
 
+		// the sibling of a doubly black node always exists (the black heights of both sides must match)
 		pair<rbtree_node_base*, rbtree_node_base*> rbtree_delete_fixup_right(pair<rbtree_node_base*, rbtree_node_base*> replacing_pair)
 		{
 			rbtree_node_base* node = replacing_pair.first;
 			rbtree_node_base* parent = replacing_pair.second;
 			rbtree_node_base* sibling;
 			sibling = parent->_left;
-			if (sibling->_color == RED)
+			if (sibling->color() == RED)
 			{
 				swap_colors(sibling, parent);
 				rotate_right(parent);
 				sibling = parent->_left;
 			}
-			if (sibling == _sentinel)
-				return make_pair(_sentinel, _sentinel);
-			if (sibling->_left->_color == BLACK 
-			&& sibling->_right->_color == BLACK)
+			if (rbtree_node_base::color_of(sibling->_left) == BLACK
+			&& rbtree_node_base::color_of(sibling->_right) == BLACK)
 			{
-				sibling->_color = RED;
+				sibling->set_color(RED);
 				node = parent;
-				parent = parent->_parent;
+				parent = parent->parent();
 			}
 			else
 			{
-				if (sibling->_left->_color == BLACK)
+				if (rbtree_node_base::color_of(sibling->_left) == BLACK)
 				{
 					swap_colors(sibling->_right, sibling);
 					rotate_left(sibling);
 					sibling = parent->_left;
 				}
-				sibling->_color = parent->_color;
-				parent->_color = BLACK;
-				sibling->_right->_color = BLACK;
+				sibling->set_color(parent->color());
+				parent->set_color(BLACK);
+				sibling->_left->set_color(BLACK);
 				rotate_right(parent);
-				node = _root;
-				parent = _root->_parent;
+				node = root();
+				parent = sentinel();
 			}
-			return make_pair(node, parent);
+			return ft::make_pair(node, parent);
 		}
 
 		pair<rbtree_node_base*, rbtree_node_base*> rbtree_delete_fixup_left(pair<rbtree_node_base*, rbtree_node_base*> replacing_pair)
@@ -765,47 +1397,43 @@ namespace ft
 			rbtree_node_base *parent = replacing_pair.second;
 			rbtree_node_base *sibling;
 			sibling = parent->_right;
-			if (sibling->_color == RED)
+			if (sibling->color() == RED)
 			{
 				swap_colors(sibling, parent);
 				rotate_left(parent);
 				sibling = parent->_right;
 			}
-			if (sibling->_left->_color == BLACK 
-			&& sibling->_right->_color == BLACK)
+			if (rbtree_node_base::color_of(sibling->_left) == BLACK
+			&& rbtree_node_base::color_of(sibling->_right) == BLACK)
 			{
-				sibling->_color = RED;
+				sibling->set_color(RED);
 				node = parent;
-				parent = parent->_parent;
+				parent = parent->parent();
 			}
-			else 
+			else
 			{
-				if (sibling->_right->_color == BLACK)
+				if (rbtree_node_base::color_of(sibling->_right) == BLACK)
 				{
 					swap_colors(sibling->_left, sibling);
 					rotate_right(sibling);
 					sibling = parent->_right;
 				}
-				sibling->_color = parent->_color;
-				parent->_color = BLACK;
-				sibling->_right->_color = BLACK;
+				sibling->set_color(parent->color());
+				parent->set_color(BLACK);
+				sibling->_right->set_color(BLACK);
 				rotate_left(parent);
-				node = _root;
-				parent = _root->_parent;
+				node = root();
+				parent = sentinel();
 			}
-			return make_pair(node, parent);
+			return ft::make_pair(node, parent);
 		}
 
-		// replacing_pair.first  == the node
+		// replacing_pair.first  == the node (can be a NULL leaf)
 		// replacing_pair.second == node's parent
 		void rbtree_delete_fixup(pair<rbtree_node_base*, rbtree_node_base*> replacing_pair)
 		{
-			while (replacing_pair.first != _root && replacing_pair.first->_color == BLACK)
+			while (replacing_pair.first != root() && rbtree_node_base::color_of(replacing_pair.first) == BLACK)
 			{
-				if (replacing_pair.second == _sentinel || (replacing_pair.second->_left == _sentinel && replacing_pair.second->_right == _sentinel))
-				{
-					break;
-				}
 				if (replacing_pair.first == replacing_pair.second->_left)
 				{
 					replacing_pair = rbtree_delete_fixup_left(replacing_pair);
@@ -815,30 +1443,201 @@ namespace ft
 					replacing_pair = rbtree_delete_fixup_right(replacing_pair);
 				}
 			}
-			replacing_pair.first->_color = BLACK;
+			if (replacing_pair.first != NULL)
+			{
+				replacing_pair.first->set_color(BLACK);
+			}
 		}
 
-		rbtree_node_base* rbtree_min(rbtree_node_base* node) const
+		// returns the first node that is not less than the key, or the sentinel
+		template <typename K>
+		rbtree_node_base* lower_bound_node(const K& key) const
 		{
-			while (node->_left != _sentinel) // iterating until the left is pointing to the NIL that is the sentinel node
+			rbtree_node_base* node_ptr = root();
+			rbtree_node_base* node_with_lower_value = sentinel();
+			while (node_ptr != NULL)
 			{
-				node = node->_left;
+				if (compare(static_cast<node_pointer>(node_ptr)->get_key(), key))
+				{
+					node_ptr = node_ptr->_right;
+				}
+				else
+				{
+					node_with_lower_value = node_ptr;
+					node_ptr = node_ptr->_left;
+				}
 			}
-			return node;
+			return node_with_lower_value;
 		}
 
-		rbtree_node_base* create_sentinel_node()
+		// the node of each of the lanes keys (at most find_lanes), NULL for the missing ones: lower_bound_node() of
+		// every key, one level of each descent per round
+		template <typename KeyIt>
+		void find_nodes(KeyIt keys, size_type lanes, rbtree_node_base** found) const
 		{
-			rbtree_node_base* null_base_node = _node_base_alloc.allocate(1);
-			_node_base_alloc.construct(null_base_node);
-			return null_base_node;
+			rbtree_node_base* node[find_lanes];
+			size_type active = 0;
+			for (size_type i = 0; i < lanes; ++i)
+			{
+				node[i] = root();
+				found[i] = sentinel();
+				active += (node[i] != NULL);
+			}
+			while (active != 0)
+			{
+				active = 0;
+				for (size_type i = 0; i < lanes; ++i)
+				{
+					rbtree_node_base* current = node[i];
+					if (current == NULL)
+					{
+						continue;
+					}
+					if (compare(static_cast<node_pointer>(current)->get_key(), keys[i]))
+					{
+						current = current->_right;
+					}
+					else
+					{
+						found[i] = current;
+						current = current->_left;
+					}
+					node[i] = current;
+					if (current != NULL)
+					{
+						ft::prefetch(current);
+						++active;
+					}
+				}
+			}
+			for (size_type i = 0; i < lanes; ++i)
+			{
+				if (found[i] == sentinel() || compare(keys[i], static_cast<node_pointer>(found[i])->get_key()))
+				{
+					found[i] = NULL;
+				}
+			}
 		}
 
-		void destroy_sentinel_node()
+		// returns the first node that is greater than the key, or the sentinel
+		template <typename K>
+		rbtree_node_base* upper_bound_node(const K& key) const
 		{
-			_node_base_alloc.destroy(_sentinel);
-			_node_base_alloc.deallocate(_sentinel, 1);
+			rbtree_node_base* node_ptr = root();
+			rbtree_node_base* larger = sentinel();
+			while (node_ptr != NULL)
+			{
+				if (compare(key, static_cast<node_pointer>(node_ptr)->get_key()))
+				{
+					larger = node_ptr;
+					node_ptr = node_ptr->_left;
+				}
+				else
+					node_ptr = node_ptr->_right;
+			}
+			return larger;
+		}
+
+		// a red-black tree of n nodes is at most 2 * log2(n + 1) high, so this bounds the walk stack for any size_type
+		enum { max_height = 2 * sizeof(size_type) * CHAR_BIT };
+
+		template <typename Value, typename Function>
+		struct range_visitor
+		{
+			Function& fn;
+
+			explicit range_visitor(Function& function) : fn(function) {}
+			void operator()(rbtree_node_base* node)
+			{
+				Value& value = static_cast<node_pointer>(node)->_value;
+				fn(value);
+			}
+		};
+
+		template <typename Value, typename Function>
+		struct range_batch_visitor
+		{
+			Function&	fn;
+			Value*		batch[range_batch_size];
+			size_type	count;
+
+			explicit range_batch_visitor(Function& function) : fn(function), count(0) {}
+			void operator()(rbtree_node_base* node)
+			{
+				batch[count++] = &static_cast<node_pointer>(node)->_value;
+				if (count == range_batch_size)
+				{
+					flush();
+				}
+			}
+			void flush()
+			{
+				if (count != 0)
+				{
+					fn(static_cast<Value* const*>(batch), count);
+					count = 0;
+				}
+			}
+		};
+
+		// The stack holds the nodes whose left part is done: the top is the next node in order.
+		// Following the iterator, each step would be a dependent load (climbing parents or descending a right spine)
+		// that can only start when the previous one has finished. Here the right child of a node is prefetched
+		// when the node is pushed, long before the walk reaches it, so several subtrees are being loaded at once.
+		template <typename K, typename Visitor>
+		void walk_range(const K& lo, const K& hi, Visitor& visitor) const
+		{
+			rbtree_node_base* stack[max_height];
+			size_type depth = 0;
+			rbtree_node_base* node = root();
+			while (node != NULL) // the path to lower_bound(lo): keeps the nodes that are not less than lo
+			{
+				if (!compare(static_cast<node_pointer>(node)->get_key(), lo))
+				{
+					ft::prefetch(node->_right);
+					stack[depth++] = node;
+					node = node->_left;
+				}
+				else
+				{
+					node = node->_right;
+				}
+			}
+			while (depth != 0)
+			{
+				node = stack[--depth];
+				if (!compare(static_cast<node_pointer>(node)->get_key(), hi))
+				{
+					return;
+				}
+				if (depth != 0)
+				{
+					ft::prefetch(stack[depth - 1]);
+				}
+				visitor(node);
+				for (node = node->_right; node != NULL; node = node->_left) // the left spine of the right subtree
+				{
+					ft::prefetch(node->_right);
+					stack[depth++] = node;
+				}
+			}
 		}
+
+		rbtree_node_base* rbtree_min(rbtree_node_base* node) const
+		{
+			while (node->_left != NULL) // iterating until the left is pointing to the NULL leaf
+			{
+				node = node->_left;
+			}
+			return node;
+		}
+	};
+
+	// the tree of map/set for a node layout: rbtree, or index_rbtree for rbtree_index_layout (index_rbtree.hpp)
+	template <typename Layout, typename T, typename Compare, typename Alloc, typename Node>
+	struct rbtree_for_layout
+	{
+		typedef rbtree<T, Compare, Alloc, Node>	type;
 	};
 }
 
@@ -1,8 +1,11 @@
 #ifndef RBTREE_ITERATOR_HPP
 #define RBTREE_ITERATOR_HPP
 
+#include <cassert>
+
 #include "rbtree_node.hpp"
 #include "iterator/iterator_traits.hpp"
+#include "utility/remove_cv.hpp"
 
 namespace ft
 {
@@ -28,7 +31,7 @@ namespace ft
 
 		bool isSentinel(NodeBasePtr node_ptr) const
 		{
-			return (node_ptr->_left == NULL && node_ptr->_right == NULL);
+			return node_ptr->is_sentinel();
 		}
 
 	public:
@@ -74,48 +77,59 @@ namespace ft
 		}
 
 	private:
+		typedef rbtree_threading<typename ft::remove_const<NodeBase>::type> threading;
+
+		// tree links are stored as rbtree_node_base pointers, they are cast back to the node base of this iterator
+		static NodeBasePtr _left_of(NodeBasePtr node_ptr)
+		{
+			return static_cast<NodeBasePtr>(node_ptr->_left);
+		}
+		static NodeBasePtr _right_of(NodeBasePtr node_ptr)
+		{
+			return static_cast<NodeBasePtr>(node_ptr->_right);
+		}
+		static NodeBasePtr _parent_of(NodeBasePtr node_ptr)
+		{
+			return static_cast<NodeBasePtr>(node_ptr->parent());
+		}
+
 		NodeBasePtr _move_down_right(NodeBasePtr node_ptr)
 		{
-			if (!isSentinel(node_ptr->_right))
+			node_ptr = _right_of(node_ptr);
+			while (node_ptr->_left != NULL)
 			{
-				node_ptr = node_ptr->_right;
-				while (!isSentinel(node_ptr->_left))
-				{
-					node_ptr = node_ptr->_left;
-				}
+				node_ptr = _left_of(node_ptr);
 			}
 			return node_ptr;
 		}
 		NodeBasePtr _move_down_left(NodeBasePtr node_ptr)
 		{
-			if (!isSentinel(node_ptr->_left))
+			node_ptr = _left_of(node_ptr);
+			while (node_ptr->_right != NULL)
 			{
-				node_ptr = node_ptr->_left;
-				while (!isSentinel(node_ptr->_right))
-				{
-					node_ptr = node_ptr->_right;
-				}
+				node_ptr = _right_of(node_ptr);
 			}
 			return node_ptr;
 		}
 
 
+		// the sentinel (parent of the root) has NULL children, so climbing from the rightmost node stops at it
 		NodeBasePtr _move_up_left(NodeBasePtr node_ptr)
 		{
-			while (node_ptr == node_ptr->_parent->_left) // means that we have already visited that parent node before and need to move up again
+			while (node_ptr == node_ptr->parent()->_left) // means that we have already visited that parent node before and need to move up again
 			{
-				node_ptr = node_ptr->_parent; // returning to the visited parent
+				node_ptr = _parent_of(node_ptr); // returning to the visited parent
 			}
-			node_ptr = node_ptr->_parent; // moving up to the non-visited parent
+			node_ptr = _parent_of(node_ptr); // moving up to the non-visited parent
 			return node_ptr;
 		}
 		NodeBasePtr _move_up_right(NodeBasePtr node_ptr)
 		{
-			while (node_ptr == node_ptr->_parent->_right) // means that we have already visited that parent node before and need to move up again
+			while (node_ptr == node_ptr->parent()->_right) // means that we have already visited that parent node before and need to move up again
 			{
-				node_ptr = node_ptr->_parent; // returning to the visited parent
+				node_ptr = _parent_of(node_ptr); // returning to the visited parent
 			}
-			node_ptr = node_ptr->_parent; // moving up to the non-visited parent
+			node_ptr = _parent_of(node_ptr); // moving up to the non-visited parent
 			return node_ptr;
 		}
 
@@ -123,18 +137,24 @@ namespace ft
  		//  ARITHMETIC OPERATORS
 		rbtree_iter& operator++()
 		{
+			// threaded nodes know their successor, the sentinel's successor is the first node
+			if (threading::threaded)
+			{
+				_node_ptr = threading::next(_node_ptr);
+				return *this;
+			}
 			// if we're incrementing a reverse_iterator pointing to rend():
 			if (isSentinel(_node_ptr))
 			{
-				rbtree_node_base *node = _node_ptr->_parent; // sentinel's parent is always pointing to the root
-				while (!isSentinel(node->_left)) // iterating until the right is not pointing to the NIL that is the sentinel node
+				NodeBasePtr node = _parent_of(_node_ptr); // sentinel's parent is always pointing to the root
+				while (node->_left != NULL) // iterating until the left is pointing to the NULL leaf
 				{
-					node = node->_left;
+					node = _left_of(node);
 				}
 				_node_ptr = node;
 				return *this;
 			}
-			if (!isSentinel(_node_ptr->_right))
+			if (_node_ptr->_right != NULL)
 			{
 				_node_ptr = _move_down_right(_node_ptr);
 			}
@@ -154,18 +174,23 @@ namespace ft
 
 		rbtree_iter& operator--()
 		{
+			if (threading::threaded)
+			{
+				_node_ptr = threading::prev(_node_ptr);
+				return *this;
+			}
 			// if we're decrementing an iterator pointing to end():
 			if (isSentinel(_node_ptr))
 			{
-				rbtree_node_base *node = _node_ptr->_parent; // sentinel's parent is always pointing to the root
-				while (!isSentinel(node->_right)) // iterating until the right is not pointing to the NIL that is the sentinel node
+				NodeBasePtr node = _parent_of(_node_ptr); // sentinel's parent is always pointing to the root
+				while (node->_right != NULL) // iterating until the right is pointing to the NULL leaf
 				{
-					node = node->_right;
+					node = _right_of(node);
 				}
 				_node_ptr = node;
 				return *this;
 			}
-			if (!isSentinel(_node_ptr->_left))
+			if (_node_ptr->_left != NULL)
 			{
 				_node_ptr = _move_down_left(_node_ptr);
 			}
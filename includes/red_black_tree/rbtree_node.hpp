@@ -1,39 +1,302 @@
 #ifndef RBTREE_NODE_HPP
 #define RBTREE_NODE_HPP
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include "utility/pair.hpp"
 
 enum color_t { BLACK, RED };
 typedef enum color_t e_color;
 
-namespace ft 
+namespace ft
 {
 
+	// Compact node layout: the color doesn't get its own (padded) field, it is packed into the lowest bit
+	// of the parent pointer. Nodes are always at least pointer aligned, so the two lowest bits
+	// of any node address are zero and can be reused:
+	// bit 0 - the color of the node
+	// bit 1 - marks the sentinel node (the only node without a value)
+	// The base node is 3 words (24 bytes on 64-bit) instead of 4.
+	// Leaves have NULL children, the sentinel is only reachable as the parent of the root.
 	struct rbtree_node_base
 	{
-		rbtree_node_base*		_parent;
+		uintptr_t				_parent_and_color;
 		rbtree_node_base*		_left;
 		rbtree_node_base*		_right;
-		e_color 				_color;
-
-		rbtree_node_base() : _parent(NULL), _left(NULL), _right(NULL), _color(BLACK){}
-		rbtree_node_base(rbtree_node_base* parent_ptr, rbtree_node_base* child_ptr)
-			: _parent(parent_ptr)
-			, _left(child_ptr)
-			, _right(child_ptr)
-			, _color(RED)
+
+		static const uintptr_t	color_bit = 1;
+		static const uintptr_t	sentinel_bit = 2;
+		static const uintptr_t	flags_mask = color_bit | sentinel_bit;
+
+		// the default constructor is used for the sentinel only
+		rbtree_node_base() : _parent_and_color(sentinel_bit | BLACK), _left(NULL), _right(NULL) {}
+		explicit rbtree_node_base(rbtree_node_base* parent_ptr)
+			: _parent_and_color(reinterpret_cast<uintptr_t>(parent_ptr) | RED)
+			, _left(NULL)
+			, _right(NULL)
 			{}
+
+		rbtree_node_base* parent() const
+		{
+			return reinterpret_cast<rbtree_node_base*>(_parent_and_color & ~flags_mask);
+		}
+
+		void set_parent(rbtree_node_base* parent_ptr)
+		{
+			_parent_and_color = reinterpret_cast<uintptr_t>(parent_ptr) | (_parent_and_color & flags_mask);
+		}
+
+		e_color color() const
+		{
+			return static_cast<e_color>(_parent_and_color & color_bit);
+		}
+
+		void set_color(e_color color)
+		{
+			_parent_and_color = (_parent_and_color & ~color_bit) | color;
+		}
+
+		bool is_sentinel() const
+		{
+			return (_parent_and_color & sentinel_bit) != 0;
+		}
+
+		// NULL leaves count as black nodes
+		static e_color color_of(const rbtree_node_base* node)
+		{
+			if (node == NULL)
+			{
+				return BLACK;
+			}
+			return node->color();
+		}
+	};
+
+	// Threaded node layout: on top of the tree links every node keeps its in-order successor and predecessor.
+	// The nodes form a circular doubly linked list through the sentinel (sentinel->_next is the first node,
+	// sentinel->_prev is the last one), so ++/-- on an iterator is a single load in the worst case
+	// instead of climbing parents, and begin() is O(1). Costs 2 more pointers per node.
+	struct rbtree_threaded_node_base : public rbtree_node_base
+	{
+		rbtree_threaded_node_base*	_next;
+		rbtree_threaded_node_base*	_prev;
+
+		// the sentinel of an empty tree is a list pointing to itself
+		rbtree_threaded_node_base() : rbtree_node_base(), _next(this), _prev(this) {}
+		explicit rbtree_threaded_node_base(rbtree_node_base* parent_ptr)
+			: rbtree_node_base(parent_ptr)
+			, _next(NULL)
+			, _prev(NULL)
+			{}
+	};
+
+	// Index-linked node layout: the links are 32-bit indexes of nodes in the slab of their tree (index_rbtree)
+	// instead of pointers, 0 being the NULL leaf and the parent of the root. The color is the top bit of the parent
+	// index, so a tree holds at most 2^31 - 1 nodes. The base node is 12 bytes instead of 24: an
+	// ft::set<uint32_t> node is 16 bytes instead of 32.
+	struct rbtree_index_node_base
+	{
+		uint32_t				_parent_and_color;
+		uint32_t				_left;
+		uint32_t				_right;
+
+		static const uint32_t	color_bit = 0x80000000u;
+
+		rbtree_index_node_base() : _parent_and_color(0), _left(0), _right(0) {}
+		// the nodes are built like those of rbtree, the parent is linked by the tree afterwards
+		explicit rbtree_index_node_base(rbtree_node_base*) : _parent_and_color(color_bit), _left(0), _right(0) {}
+
+		uint32_t parent() const
+		{
+			return _parent_and_color & ~color_bit;
+		}
+
+		void set_parent(uint32_t parent_index)
+		{
+			_parent_and_color = parent_index | (_parent_and_color & color_bit);
+		}
+
+		e_color color() const
+		{
+			return (_parent_and_color & color_bit) != 0 ? RED : BLACK;
+		}
+
+		void set_color(e_color color)
+		{
+			_parent_and_color = (_parent_and_color & ~color_bit) | (color == RED ? color_bit : 0);
+		}
+	};
+
+	// Layouts select the node base of map/set (their last template parameter)
+	struct rbtree_compact_layout
+	{
+		typedef rbtree_node_base			node_base_type;
+	};
+
+	struct rbtree_threaded_layout
+	{
+		typedef rbtree_threaded_node_base	node_base_type;
+	};
+
+	// the nodes in a slab, linked by index: selects index_rbtree instead of rbtree
+	struct rbtree_index_layout
+	{
+		typedef rbtree_index_node_base		node_base_type;
+	};
+
+	// Maintenance of the successor links, called by rbtree on every structural change.
+	// Without threading everything is a no-op: iterators climb the tree and begin() descends to the leftmost node.
+	template <typename NodeBase>
+	struct rbtree_threading
+	{
+		static const bool threaded = false;
+
+		// never called: iterators of non-threaded trees move along the tree links
+		template <typename NodePtr>
+		static NodePtr next(NodePtr node)
+		{
+			return node;
+		}
+
+		template <typename NodePtr>
+		static NodePtr prev(NodePtr node)
+		{
+			return node;
+		}
+
+		static rbtree_node_base* first(rbtree_node_base* sentinel)
+		{
+			rbtree_node_base* node = sentinel->parent();
+			if (node == NULL)
+			{
+				return sentinel;
+			}
+			while (node->_left != NULL)
+			{
+				node = node->_left;
+			}
+			return node;
+		}
+
+		static void link(rbtree_node_base*, rbtree_node_base*, bool) {}
+		static void unlink(rbtree_node_base*) {}
+		static void replace(rbtree_node_base*, rbtree_node_base*) {}
+		static void reset(rbtree_node_base*) {}
+		static void swap_lists(rbtree_node_base*, rbtree_node_base*) {}
+	};
+
+	template <>
+	struct rbtree_threading<rbtree_threaded_node_base>
+	{
+		typedef rbtree_threaded_node_base	threaded_node;
+
+		static const bool threaded = true;
+
+		template <typename NodePtr>
+		static NodePtr next(NodePtr node)
+		{
+			return node->_next;
+		}
+
+		template <typename NodePtr>
+		static NodePtr prev(NodePtr node)
+		{
+			return node->_prev;
+		}
+
+		static rbtree_node_base* first(rbtree_node_base* sentinel)
+		{
+			return static_cast<threaded_node*>(sentinel)->_next;
+		}
+
+		// the node was just attached as a child of position: its in-order neighbours are position
+		// and position's predecessor (left child) or successor (right child). In an empty tree position is the sentinel.
+		static void link(rbtree_node_base* node, rbtree_node_base* position, bool left_child)
+		{
+			threaded_node* new_node = static_cast<threaded_node*>(node);
+			threaded_node* successor = static_cast<threaded_node*>(position);
+			if (!position->is_sentinel() && !left_child)
+			{
+				successor = successor->_next;
+			}
+			threaded_node* predecessor = successor->_prev;
+			new_node->_next = successor;
+			new_node->_prev = predecessor;
+			predecessor->_next = new_node;
+			successor->_prev = new_node;
+		}
+
+		static void unlink(rbtree_node_base* node)
+		{
+			threaded_node* old_node = static_cast<threaded_node*>(node);
+			old_node->_prev->_next = old_node->_next;
+			old_node->_next->_prev = old_node->_prev;
+		}
+
+		// copy takes the place of node in the list (compaction)
+		static void replace(rbtree_node_base* node, rbtree_node_base* copy)
+		{
+			threaded_node* old_node = static_cast<threaded_node*>(node);
+			threaded_node* new_node = static_cast<threaded_node*>(copy);
+			new_node->_next = old_node->_next;
+			new_node->_prev = old_node->_prev;
+			new_node->_prev->_next = new_node;
+			new_node->_next->_prev = new_node;
+		}
+
+		static void reset(rbtree_node_base* sentinel)
+		{
+			threaded_node* sentinel_node = static_cast<threaded_node*>(sentinel);
+			sentinel_node->_next = sentinel_node;
+			sentinel_node->_prev = sentinel_node;
+		}
+
+		// the sentinels stay in their trees, the lists are exchanged and their ends relinked
+		static void swap_lists(rbtree_node_base* lhs, rbtree_node_base* rhs)
+		{
+			threaded_node* lhs_sentinel = static_cast<threaded_node*>(lhs);
+			threaded_node* rhs_sentinel = static_cast<threaded_node*>(rhs);
+			threaded_node* lhs_first = lhs_sentinel->_next;
+			threaded_node* lhs_last = lhs_sentinel->_prev;
+			relink(lhs_sentinel, rhs_sentinel, rhs_sentinel->_next, rhs_sentinel->_prev);
+			relink(rhs_sentinel, lhs_sentinel, lhs_first, lhs_last);
+		}
+
+	private:
+		static void relink(threaded_node* sentinel, threaded_node* old_sentinel, threaded_node* first, threaded_node* last)
+		{
+			if (first == old_sentinel)
+			{
+				reset(sentinel);
+				return;
+			}
+			sentinel->_next = first;
+			sentinel->_prev = last;
+			first->_prev = sentinel;
+			last->_next = sentinel;
+		}
 	};
 
 	//Here, we pass the derived class Node<Val> as a template argument to its own base (Node_base).
 	// That allows Node_base to use Node<Val> in its interfaces without even knowing its real name!
-	template <typename Value>
-	struct rbtree_node_for_map : public rbtree_node_base
+	template <typename Value, typename NodeBase = rbtree_node_base>
+	struct rbtree_node_for_map : public NodeBase
 	{
 		Value 	_value;
+		typedef NodeBase node_base_type;
 		typedef typename Value::first_type key_type;
-		explicit rbtree_node_for_map(rbtree_node_base *parent_ptr, rbtree_node_base* child_ptr, const Value &value)
-			: rbtree_node_base(parent_ptr, child_ptr), _value(value) {}
+		typedef typename Value::second_type mapped_type;
+		explicit rbtree_node_for_map(rbtree_node_base *parent_ptr, const Value &value)
+			: NodeBase(parent_ptr), _value(value) {}
+
+		// used by try_emplace() and operator[]: the pair is built directly in the node, no temporary pair is copied
+		rbtree_node_for_map(rbtree_node_base *parent_ptr, const key_type &key)
+			: NodeBase(parent_ptr), _value(key, ft::pair_key_only_tag()) {}
+
+		template <typename Arg>
+		rbtree_node_for_map(rbtree_node_base *parent_ptr, const key_type &key, const Arg &arg)
+			: NodeBase(parent_ptr), _value(key, arg) {}
 
 		static const key_type& get_key_from_value(const Value& _value) // it will be accessible in rbtree as well for insert() for example
 		{
@@ -45,14 +308,15 @@ namespace ft
 		}
 	};
 
-	template <typename Value>
-	struct rbtree_node_for_set : public rbtree_node_base
+	template <typename Value, typename NodeBase = rbtree_node_base>
+	struct rbtree_node_for_set : public NodeBase
 	{
 		Value 	_value;
+		typedef NodeBase node_base_type;
 		typedef Value key_type;
 
-		explicit rbtree_node_for_set(rbtree_node_base *parent_ptr, rbtree_node_base *child_ptr, const Value &value)
-			: rbtree_node_base(parent_ptr, child_ptr), _value(value) {}
+		explicit rbtree_node_for_set(rbtree_node_base *parent_ptr, const Value &value)
+			: NodeBase(parent_ptr), _value(value) {}
 
 		static const key_type& get_key_from_value(const Value& _value) // it will be accessible in rbtree as well for insert() for example
 		{
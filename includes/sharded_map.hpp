@@ -0,0 +1,394 @@
+#ifndef SHARDED_MAP_HPP
+#define SHARDED_MAP_HPP
+
+#if __cplusplus < 201103L
+# error "sharded_map.hpp requires C++11 (std::atomic, alignas)"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "map.hpp"
+#include "concurrency/rw_spinlock.hpp"
+
+namespace ft
+{
+	// A map for mixed read-write workloads shared between threads.
+	// The keys are hashed to Shards independent ft::map, each behind its own rw_spinlock: a find() takes the shard's
+	// lock shared, insert() and erase() take it exclusive, so threads working on different shards never wait
+	// for each other and readers of one shard run together. Every shard sits on its own cache lines.
+	// size() adds up per-shard counters without locking anything. read() locks all the shards shared and gives an
+	// ordered view of the whole map (a k-way merge of the shards): a consistent state, writers wait while it lives.
+	// Operations on one key are linearizable; size() while writers are running is only a recent value.
+	template < class Key,
+			class T,
+			size_t Shards = 16,
+			class Compare = ::std::less<Key>,
+			class Hash = ::std::hash<Key>,
+			class Alloc = std::allocator<ft::pair<const Key,T> >
+			>
+	class sharded_map
+	{
+		static_assert(Shards > 0, "a sharded_map needs at least one shard");
+
+	public:
+		typedef ft::map<Key, T, Compare, Alloc>			map_type;
+		typedef typename map_type::key_type				key_type;
+		typedef typename map_type::mapped_type			mapped_type;
+		typedef typename map_type::value_type			value_type;
+		typedef typename map_type::size_type			size_type;
+		typedef Compare									key_compare;
+		typedef Hash									hasher;
+
+		static const size_type	shard_count = Shards;
+
+		// all the shards in key order; the shards stay locked shared until the view is destroyed,
+		// so the thread holding it must not write to the map (nor read it but through the view)
+		class ordered_view
+		{
+		public:
+			class const_iterator
+			{
+			public:
+				typedef std::forward_iterator_tag	iterator_category;
+				typedef typename sharded_map::value_type	value_type;
+				typedef ptrdiff_t					difference_type;
+				typedef const value_type*			pointer;
+				typedef const value_type&			reference;
+
+				const_iterator() : _owner(NULL), _heap_size(0) {}
+
+				reference operator*() const
+				{
+					return *_pos[_heap[0]];
+				}
+				pointer operator->() const
+				{
+					return &*_pos[_heap[0]];
+				}
+
+				// the smallest key is at the top of the heap; the next one of its shard goes back in
+				const_iterator& operator++()
+				{
+					later by_key(this);
+					std::pop_heap(_heap, _heap + _heap_size, by_key);
+					size_type shard = _heap[_heap_size - 1];
+					if (++_pos[shard] == _owner->_shards[shard].map.end())
+					{
+						--_heap_size;
+					}
+					else
+					{
+						std::push_heap(_heap, _heap + _heap_size, by_key);
+					}
+					return *this;
+				}
+				const_iterator operator++(int)
+				{
+					const_iterator old(*this);
+					++*this;
+					return old;
+				}
+
+				// a key is in one shard only, so the current element tells the position
+				bool operator==(const const_iterator& other) const
+				{
+					return _heap_size == other._heap_size && (_heap_size == 0 || &**this == &*other);
+				}
+				bool operator!=(const const_iterator& other) const
+				{
+					return !(*this == other);
+				}
+
+			private:
+				friend class ordered_view;
+
+				typedef typename map_type::const_iterator	shard_iterator;
+
+				// heap order: the shard with the greatest current key sinks
+				struct later
+				{
+					explicit later(const const_iterator* it) : it(it) {}
+
+					bool operator()(size_type a, size_type b) const
+					{
+						return it->_owner->_comp(it->_pos[b]->first, it->_pos[a]->first);
+					}
+
+					const const_iterator*	it;
+				};
+
+				explicit const_iterator(const sharded_map* owner) : _owner(owner), _heap_size(0)
+				{
+					for (size_type shard = 0; shard < Shards; ++shard)
+					{
+						_pos[shard] = owner->_shards[shard].map.begin();
+						if (_pos[shard] != owner->_shards[shard].map.end())
+						{
+							_heap[_heap_size++] = shard;
+						}
+					}
+					std::make_heap(_heap, _heap + _heap_size, later(this));
+				}
+
+				const sharded_map*	_owner;
+				shard_iterator		_pos[Shards];
+				size_type			_heap[Shards];
+				size_type			_heap_size;
+			};
+
+			typedef const_iterator	iterator;
+
+			ordered_view(ordered_view&& other) : _owner(other._owner)
+			{
+				other._owner = NULL;
+			}
+
+			~ordered_view()
+			{
+				if (_owner != NULL)
+				{
+					for (size_type shard = Shards; shard-- > 0; )
+					{
+						_owner->_shards[shard].lock.unlock_shared();
+					}
+				}
+			}
+
+			const_iterator begin() const
+			{
+				return const_iterator(_owner);
+			}
+			const_iterator end() const
+			{
+				return const_iterator();
+			}
+
+			// exact, the counters can't move while the view lives
+			size_type size() const
+			{
+				return _owner->size();
+			}
+
+		private:
+			friend class sharded_map;
+
+			// always in shard order, and writers hold one shard at a time: two views can't deadlock
+			explicit ordered_view(const sharded_map* owner) : _owner(owner)
+			{
+				for (size_type shard = 0; shard < Shards; ++shard)
+				{
+					_owner->_shards[shard].lock.lock_shared();
+				}
+			}
+			ordered_view(const ordered_view&);
+			ordered_view& operator=(const ordered_view&);
+
+			const sharded_map*	_owner;
+		};
+
+		typedef typename ordered_view::const_iterator	const_iterator;
+
+		explicit sharded_map(const Compare& comp = Compare(), const Hash& hash = Hash(), const Alloc& alloc = Alloc())
+			: _comp(comp), _hash(hash)
+		{
+			for (size_type shard = 0; shard < Shards; ++shard)
+			{
+				_shards[shard].map = map_type(comp, alloc);
+			}
+		}
+
+		// plain new only aligns to 16 bytes before C++17, the shards need their cache lines
+		static void* operator new(std::size_t size)
+		{
+			void* memory = NULL;
+			if (posix_memalign(&memory, alignof(sharded_map), size) != 0)
+			{
+				throw std::bad_alloc();
+			}
+			return memory;
+		}
+
+		static void operator delete(void* memory)
+		{
+			free(memory);
+		}
+
+		static void* operator new(std::size_t, void* place)
+		{
+			return place;
+		}
+
+		static void operator delete(void*, void*) {}
+
+		// READERS (the shard is locked shared):
+		// copies the mapped value out, so no lock has to be kept
+		bool find(const key_type& key, mapped_type& value) const
+		{
+			const shard_type& shard = shard_for(key);
+			shared_lock_guard<rw_spinlock> lock(shard.lock);
+			typename map_type::const_iterator it = shard.map.find(key);
+			if (it == shard.map.end())
+			{
+				return false;
+			}
+			value = it->second;
+			return true;
+		}
+
+		bool contains(const key_type& key) const
+		{
+			const shard_type& shard = shard_for(key);
+			shared_lock_guard<rw_spinlock> lock(shard.lock);
+			return shard.map.find(key) != shard.map.end();
+		}
+
+		// WRITERS (the shard is locked exclusive):
+		// false if the key was already there, the map is then unchanged
+		bool insert(const value_type& value)
+		{
+			shard_type& shard = shard_for(value.first);
+			std::lock_guard<rw_spinlock> lock(shard.lock);
+			bool inserted = shard.map.insert(value).second;
+			shard.count.store(shard.map.size(), std::memory_order_relaxed);
+			return inserted;
+		}
+
+		// true if the key was inserted, false if its value was assigned
+		bool insert_or_assign(const key_type& key, const mapped_type& value)
+		{
+			shard_type& shard = shard_for(key);
+			std::lock_guard<rw_spinlock> lock(shard.lock);
+			bool inserted = shard.map.insert_or_assign(key, value).second;
+			shard.count.store(shard.map.size(), std::memory_order_relaxed);
+			return inserted;
+		}
+
+		// fn(mapped_type&) runs under the shard's lock, to read-modify-write a value in place; false if the key is missing
+		template <class Function>
+		bool update(const key_type& key, Function fn)
+		{
+			shard_type& shard = shard_for(key);
+			std::lock_guard<rw_spinlock> lock(shard.lock);
+			typename map_type::iterator it = shard.map.find(key);
+			if (it == shard.map.end())
+			{
+				return false;
+			}
+			fn(it->second);
+			return true;
+		}
+
+		size_type erase(const key_type& key)
+		{
+			shard_type& shard = shard_for(key);
+			std::lock_guard<rw_spinlock> lock(shard.lock);
+			size_type erased = shard.map.erase(key);
+			shard.count.store(shard.map.size(), std::memory_order_relaxed);
+			return erased;
+		}
+
+		// one shard at a time: concurrent inserts into the shards already cleared stay
+		void clear()
+		{
+			for (size_type shard = 0; shard < Shards; ++shard)
+			{
+				std::lock_guard<rw_spinlock> lock(_shards[shard].lock);
+				_shards[shard].map.clear();
+				_shards[shard].count.store(0, std::memory_order_relaxed);
+			}
+		}
+
+		// WHOLE MAP:
+		size_type size() const
+		{
+			size_type total = 0;
+			for (size_type shard = 0; shard < Shards; ++shard)
+			{
+				total += _shards[shard].count.load(std::memory_order_relaxed);
+			}
+			return total;
+		}
+
+		bool empty() const
+		{
+			return size() == 0;
+		}
+
+		ordered_view read() const
+		{
+			return ordered_view(this);
+		}
+
+		// fn(const value_type&) for every element in key order, on a consistent state
+		template <class Function>
+		void for_each(Function fn) const
+		{
+			ordered_view view = read();
+			for (const_iterator it = view.begin(); it != view.end(); ++it)
+			{
+				fn(*it);
+			}
+		}
+
+		size_type shard_of(const key_type& key) const
+		{
+			// std::hash of an integer is often the identity: the multiplication spreads the low bits up
+			uint64_t h = static_cast<uint64_t>(_hash(key)) * 0x9E3779B97F4A7C15ULL;
+			return static_cast<size_type>((h >> 32) % Shards);
+		}
+
+		size_type shard_size(size_type shard) const
+		{
+			return _shards[shard].count.load(std::memory_order_relaxed);
+		}
+
+		key_compare key_comp() const
+		{
+			return _comp;
+		}
+
+		hasher hash_function() const
+		{
+			return _hash;
+		}
+
+	private:
+		sharded_map(const sharded_map&);
+		sharded_map& operator=(const sharded_map&);
+
+		struct alignas(64) shard_type
+		{
+			shard_type() : count(0) {}
+
+			mutable rw_spinlock		lock;
+			std::atomic<size_type>	count; // map.size(), readable without the lock
+			map_type				map;
+		};
+
+		shard_type& shard_for(const key_type& key)
+		{
+			return _shards[shard_of(key)];
+		}
+		const shard_type& shard_for(const key_type& key) const
+		{
+			return _shards[shard_of(key)];
+		}
+
+		Compare		_comp;
+		Hash		_hash;
+		shard_type	_shards[Shards];
+	};
+
+	template <class Key, class T, size_t Shards, class Compare, class Hash, class Alloc>
+	const typename sharded_map<Key, T, Shards, Compare, Hash, Alloc>::size_type sharded_map<Key, T, Shards, Compare, Hash, Alloc>::shard_count;
+}
+
+#endif
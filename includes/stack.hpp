@@ -5,6 +5,30 @@
 
 namespace ft 
 {
+    namespace detail
+    {
+        template <class T>
+        struct void_type
+        {
+            typedef void type;
+        };
+
+        // the container's allocator_type, or a placeholder for containers without an allocator (static_vector),
+        // so that declaring the allocator constructor below doesn't fail for them
+        template <class Container, class Enable = void>
+        struct container_allocator
+        {
+            struct none {};
+            typedef none type;
+        };
+
+        template <class Container>
+        struct container_allocator<Container, typename void_type<typename Container::allocator_type>::type>
+        {
+            typedef typename Container::allocator_type type;
+        };
+    }
+
     template <class T, class Container = ft::vector<T> >
     class  stack 
     {
@@ -16,6 +40,8 @@ namespace ft
         container_type c;
     public:
         explicit stack (const container_type& ctnr = container_type()) : c(ctnr) {} 
+        // an empty stack on this allocator (a pmr::stack on a memory resource)
+        explicit stack (const typename detail::container_allocator<container_type>::type& alloc) : c(alloc) {}
         stack( const stack& other ) : c(other.c){}
         ~stack() {}
 
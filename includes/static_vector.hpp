@@ -0,0 +1,457 @@
+#ifndef STATIC_VECTOR_HPP
+#define STATIC_VECTOR_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+
+#include "iterator/iterator_traits.hpp"
+#include "iterator/reverse_iterator.hpp"
+
+#include "utility/constexpr.hpp"
+#include "utility/enable_if.hpp"
+#include "utility/equal.hpp"
+#include "utility/is_integral.hpp"
+#include "utility/is_trivial.hpp"
+#include "utility/lexicographical_compare.hpp"
+
+namespace ft
+{
+	namespace detail
+	{
+		// Trivial elements live in a plain array: there is no constructor or destructor to run, so the vector is a
+		// literal type (constexpr before C++20 requires the array to be zeroed on construction) and trivially copyable.
+		template <class T, size_t N, bool Trivial = ft::is_trivial<T>::value>
+		struct static_vector_storage
+		{
+			T		elements[N ? N : 1];
+			size_t	size;
+
+			FT_CONSTEXPR static_vector_storage() : elements(), size(0) {}
+
+			FT_CONSTEXPR14 T* data() { return elements; }
+			FT_CONSTEXPR const T* data() const { return elements; }
+			FT_CONSTEXPR14 void construct(size_t i, const T& val) { elements[i] = val; }
+			FT_CONSTEXPR14 void destroy(size_t) {}
+		};
+
+		// other elements are constructed in raw bytes aligned for T, and copied and destroyed one by one
+		template <class T, size_t N>
+		struct static_vector_storage<T, N, false>
+		{
+			unsigned char	bytes[(N ? N : 1) * sizeof(T)] __attribute__((aligned(__alignof__(T))));
+			size_t			size;
+
+			static_vector_storage() : size(0) {}
+
+			static_vector_storage(const static_vector_storage& other) : size(0)
+			{
+				try
+				{
+					for (; size != other.size; ++size)
+					{
+						construct(size, other.data()[size]);
+					}
+				}
+				catch (...)
+				{
+					destroy_all();
+					throw;
+				}
+			}
+
+			static_vector_storage& operator=(const static_vector_storage& other)
+			{
+				if (this == &other)
+				{
+					return *this;
+				}
+				size_t common = size < other.size ? size : other.size;
+				for (size_t i = 0; i < common; ++i)
+				{
+					data()[i] = other.data()[i];
+				}
+				for (; size < other.size; ++size)
+				{
+					construct(size, other.data()[size]);
+				}
+				while (size > other.size)
+				{
+					destroy(--size);
+				}
+				return *this;
+			}
+
+			~static_vector_storage() { destroy_all(); }
+
+			T* data() { return reinterpret_cast<T*>(bytes); }
+			const T* data() const { return reinterpret_cast<const T*>(bytes); }
+			void construct(size_t i, const T& val) { ::new (static_cast<void*>(data() + i)) T(val); }
+			void destroy(size_t i) { data()[i].~T(); }
+
+			void destroy_all()
+			{
+				while (size != 0)
+				{
+					destroy(--size);
+				}
+			}
+		};
+	}
+
+	// A vector with its N elements inline: no allocator, no heap, and a capacity fixed at compile time.
+	// Growing past N throws std::length_error. For trivial T, construction, element access and the modifiers are
+	// constexpr in C++14 (the observers in C++11); the relational operators use ft::equal and are not.
+	template <class T, size_t N>
+	class static_vector
+	{
+	public:
+		typedef T											value_type;
+		typedef value_type&									reference;
+		typedef const value_type&							const_reference;
+		typedef value_type*									pointer;
+		typedef const value_type*							const_pointer;
+		typedef pointer										iterator;
+		typedef const_pointer								const_iterator;
+		typedef ft::reverse_iterator<iterator>				reverse_iterator;
+		typedef ft::reverse_iterator<const_iterator>		const_reverse_iterator;
+		typedef std::ptrdiff_t								difference_type;
+		typedef size_t										size_type;
+
+	private:
+		detail::static_vector_storage<T, N>	_storage;
+
+	public:
+		// copy, assignment and destruction are the storage's
+		FT_CONSTEXPR static_vector() : _storage() {}
+
+		FT_CONSTEXPR14 explicit static_vector(size_type n, const value_type& val = value_type()) : _storage()
+		{
+			assign(n, val);
+		}
+
+		template <class InputIterator>
+		FT_CONSTEXPR14 static_vector(InputIterator first, InputIterator last,
+			typename ft::enable_if<!ft::is_integral<InputIterator>::value, InputIterator>::type* = 0) : _storage()
+		{
+			assign(first, last);
+		}
+
+		// ELEMENT ACCESS:
+		FT_CONSTEXPR14 reference at(size_type pos)
+		{
+			if (pos >= size())
+			{
+				throw std::out_of_range("at()");
+			}
+			return data()[pos];
+		}
+
+		FT_CONSTEXPR const_reference at(size_type pos) const
+		{
+			return pos < size() ? data()[pos] : (throw std::out_of_range("at()"), data()[0]);
+		}
+
+		FT_CONSTEXPR14 reference operator[](size_type pos) { return data()[pos]; }
+		FT_CONSTEXPR const_reference operator[](size_type pos) const { return data()[pos]; }
+		FT_CONSTEXPR14 reference front() { return data()[0]; }
+		FT_CONSTEXPR const_reference front() const { return data()[0]; }
+		FT_CONSTEXPR14 reference back() { return data()[size() - 1]; }
+		FT_CONSTEXPR const_reference back() const { return data()[size() - 1]; }
+		FT_CONSTEXPR14 pointer data() { return _storage.data(); }
+		FT_CONSTEXPR const_pointer data() const { return _storage.data(); }
+
+		// ITERATORS:
+		FT_CONSTEXPR14 iterator begin() { return data(); }
+		FT_CONSTEXPR14 iterator end() { return data() + size(); }
+		FT_CONSTEXPR const_iterator begin() const { return data(); }
+		FT_CONSTEXPR const_iterator end() const { return data() + size(); }
+		reverse_iterator rbegin() { return reverse_iterator(end()); }
+		const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+		reverse_iterator rend() { return reverse_iterator(begin()); }
+		const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+		// CAPACITY:
+		FT_CONSTEXPR bool empty() const { return _storage.size == 0; }
+		FT_CONSTEXPR size_type size() const { return _storage.size; }
+		FT_CONSTEXPR size_type capacity() const { return N; }
+		FT_CONSTEXPR size_type max_size() const { return N; }
+
+		// nothing to allocate: only checks that new_cap fits
+		FT_CONSTEXPR14 void reserve(size_type new_cap)
+		{
+			check_room(new_cap, 0, "in reserve()");
+		}
+
+		// MODIFIERS:
+		// the range modifiers check the capacity before changing anything: a range that doesn't fit throws
+		// length_error and leaves the vector as it was
+		template <class InputIterator>
+		FT_CONSTEXPR14 void assign(InputIterator first, InputIterator last,
+			typename ft::enable_if<!ft::is_integral<InputIterator>::value, InputIterator>::type* = 0)
+		{
+			assign_range(first, last, typename ft::iterator_traits<InputIterator>::iterator_category());
+		}
+
+		FT_CONSTEXPR14 void assign(size_type n, const value_type& val)
+		{
+			check_room(n, 0, "in assign()");
+			clear();
+			resize(n, val);
+		}
+
+		FT_CONSTEXPR14 void clear()
+		{
+			while (_storage.size != 0)
+			{
+				_storage.destroy(--_storage.size);
+			}
+		}
+
+		FT_CONSTEXPR14 void push_back(const value_type& val)
+		{
+			check_room(size(), 1, "in push_back()");
+			_storage.construct(_storage.size, val);
+			++_storage.size;
+		}
+
+		FT_CONSTEXPR14 void pop_back()
+		{
+			_storage.destroy(--_storage.size);
+		}
+
+		FT_CONSTEXPR14 void resize(size_type n, value_type val = value_type())
+		{
+			check_room(n, 0, "in resize()");
+			while (_storage.size < n)
+			{
+				_storage.construct(_storage.size, val);
+				++_storage.size;
+			}
+			while (_storage.size > n)
+			{
+				_storage.destroy(--_storage.size);
+			}
+		}
+
+		FT_CONSTEXPR14 iterator insert(iterator position, const value_type& val)
+		{
+			size_type offset = position - begin();
+			insert(position, 1, val);
+			return begin() + offset;
+		}
+
+		// the elements after position move up by n: the last n into slots past the end, which are constructed,
+		// the others by assignment; then the n slots from position get val
+		FT_CONSTEXPR14 void insert(iterator position, size_type n, const value_type& val)
+		{
+			check_room(size(), n, "in insert()");
+			const value_type copy(val); // val may be one of the elements that move
+			size_type pos = position - begin();
+			size_type old_size = size();
+			for (size_type i = old_size; i-- > pos; )
+			{
+				if (i + n >= old_size)
+				{
+					_storage.construct(i + n, data()[i]);
+				}
+				else
+				{
+					data()[i + n] = data()[i];
+				}
+			}
+			for (size_type i = pos; i < pos + n; ++i)
+			{
+				if (i < old_size)
+				{
+					data()[i] = copy;
+				}
+				else
+				{
+					_storage.construct(i, copy);
+				}
+			}
+			_storage.size = old_size + n;
+		}
+
+		template <class InputIterator>
+		FT_CONSTEXPR14 void insert(iterator position,
+			typename ft::enable_if<!ft::is_integral<InputIterator>::value, InputIterator>::type first, InputIterator last)
+		{
+			insert_range(position, first, last, typename ft::iterator_traits<InputIterator>::iterator_category());
+		}
+
+		FT_CONSTEXPR14 iterator erase(iterator position)
+		{
+			return erase(position, position + 1);
+		}
+
+		FT_CONSTEXPR14 iterator erase(iterator first, iterator last)
+		{
+			if (first == last)
+			{
+				return first;
+			}
+			iterator it_end = end();
+			for (iterator it = last; it != it_end; ++it)
+			{
+				*(it - (last - first)) = *it;
+			}
+			for (size_type erased = last - first; erased != 0; --erased)
+			{
+				_storage.destroy(--_storage.size);
+			}
+			return first;
+		}
+
+		// swaps the common elements, then copies the extra ones of the longer vector over to the other
+		FT_CONSTEXPR14 void swap(static_vector& x)
+		{
+			static_vector& longer = size() < x.size() ? x : *this;
+			static_vector& shorter = size() < x.size() ? *this : x;
+			size_type common = shorter.size();
+			for (size_type i = 0; i < common; ++i)
+			{
+				swap_elements(data()[i], x.data()[i]);
+			}
+			for (size_type i = common; i < longer.size(); ++i)
+			{
+				shorter.push_back(longer[i]);
+			}
+			longer.erase(longer.begin() + common, longer.end());
+		}
+
+	private:
+		// input iterators are read once: the range is gathered first and only committed if it fits
+		template <class InputIterator>
+		FT_CONSTEXPR14 void assign_range(InputIterator first, InputIterator last, std::input_iterator_tag)
+		{
+			static_vector gathered;
+			for (; first != last; ++first)
+			{
+				gathered.push_back(*first);
+			}
+			*this = gathered;
+		}
+
+		template <class ForwardIterator>
+		FT_CONSTEXPR14 void assign_range(ForwardIterator first, ForwardIterator last, std::forward_iterator_tag)
+		{
+			check_room(range_length(first, last), 0, "in assign()");
+			clear();
+			for (; first != last; ++first)
+			{
+				push_back(*first);
+			}
+		}
+
+		template <class InputIterator>
+		FT_CONSTEXPR14 void insert_range(iterator position, InputIterator first, InputIterator last, std::input_iterator_tag)
+		{
+			static_vector gathered;
+			for (; first != last; ++first)
+			{
+				gathered.push_back(*first);
+			}
+			insert_range(position, gathered.begin(), gathered.end(), std::forward_iterator_tag());
+		}
+
+		// appended one by one, then rotated into place
+		template <class ForwardIterator>
+		FT_CONSTEXPR14 void insert_range(iterator position, ForwardIterator first, ForwardIterator last, std::forward_iterator_tag)
+		{
+			check_room(size(), range_length(first, last), "in insert()");
+			size_type pos = position - begin();
+			size_type old_size = size();
+			for (; first != last; ++first)
+			{
+				push_back(*first);
+			}
+			reverse_elements(data() + pos, data() + old_size);
+			reverse_elements(data() + old_size, end());
+			reverse_elements(data() + pos, end());
+		}
+
+		// std::distance isn't constexpr before C++17
+		template <class ForwardIterator>
+		static FT_CONSTEXPR14 size_type range_length(ForwardIterator first, ForwardIterator last)
+		{
+			size_type n = 0;
+			for (; first != last; ++first)
+			{
+				++n;
+			}
+			return n;
+		}
+
+		FT_CONSTEXPR14 void check_room(size_type count, size_type more, const char* where) const
+		{
+			if (more > N || count > N - more)
+			{
+				throw std::length_error(where);
+			}
+		}
+
+		static FT_CONSTEXPR14 void swap_elements(value_type& a, value_type& b)
+		{
+			value_type tmp(a);
+			a = b;
+			b = tmp;
+		}
+
+		static FT_CONSTEXPR14 void reverse_elements(pointer first, pointer last)
+		{
+			while (first != last && first != --last)
+			{
+				swap_elements(*first, *last);
+				++first;
+			}
+		}
+	};
+
+	// NON_MEMBER OVERLOADS:
+	template <class T, size_t N>
+	FT_CONSTEXPR14 void swap(static_vector<T, N>& x, static_vector<T, N>& y)
+	{
+		x.swap(y);
+	}
+
+	template <class T, size_t N>
+	bool operator==(const static_vector<T, N>& lhs, const static_vector<T, N>& rhs)
+	{
+		return lhs.size() == rhs.size() && ft::equal(lhs.begin(), lhs.end(), rhs.begin());
+	}
+
+	template <class T, size_t N>
+	bool operator!=(const static_vector<T, N>& lhs, const static_vector<T, N>& rhs)
+	{
+		return !(lhs == rhs);
+	}
+
+	template <class T, size_t N>
+	bool operator<(const static_vector<T, N>& lhs, const static_vector<T, N>& rhs)
+	{
+		return ft::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+	}
+
+	template <class T, size_t N>
+	bool operator<=(const static_vector<T, N>& lhs, const static_vector<T, N>& rhs)
+	{
+		return !(rhs < lhs);
+	}
+
+	template <class T, size_t N>
+	bool operator>(const static_vector<T, N>& lhs, const static_vector<T, N>& rhs)
+	{
+		return rhs < lhs;
+	}
+
+	template <class T, size_t N>
+	bool operator>=(const static_vector<T, N>& lhs, const static_vector<T, N>& rhs)
+	{
+		return !(lhs < rhs);
+	}
+}
+
+#endif
@@ -0,0 +1,488 @@
+#ifndef TL_POOL_ALLOCATOR_HPP
+#define TL_POOL_ALLOCATOR_HPP
+
+#if __cplusplus < 201103L
+# error "tl_pool_allocator.hpp requires C++11 (thread_local, std::atomic)"
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace ft
+{
+	// what the pool of the calling thread has done since the thread took it
+	struct tl_pool_stats
+	{
+		size_t	allocations;		// small blocks handed out
+		size_t	deallocations;		// small blocks given back by this thread, to its pool or to another one
+		size_t	remote_frees;		// of which belonged to the pool of another thread
+		size_t	remote_received;	// blocks other threads gave back to this pool
+		size_t	spans;				// spans taken from the system
+
+		tl_pool_stats() : allocations(0), deallocations(0), remote_frees(0), remote_received(0), spans(0) {}
+	};
+
+	namespace detail
+	{
+		// The pools behind tl_pool_allocator, one heap per thread, shared by every T.
+		// A heap cuts 64 KiB spans (aligned on their size) into blocks of one size class (16 to 256 bytes by steps of 16)
+		// and keeps one free list per class: allocate and deallocate on the owning thread touch nothing shared.
+		// A block finds its span by masking its address, and the span its owner. A block freed by another thread is
+		// batched by that thread per owner, then pushed to the owner's remote list with one CAS; the owner takes the
+		// whole list at once when a free list runs empty. Heaps and spans are never given back to the system:
+		// the heap of an exiting thread is left to the next new thread, with its free lists and remote list.
+		class tl_pool
+		{
+		public:
+			enum
+			{
+				span_size = 1 << 16,
+				granularity = 16,
+				max_small = 256,
+				class_count = max_small / granularity,
+				batch_size = 32,		// blocks sent to another thread at once
+				batch_slots = 8			// threads a thread batches blocks for at the same time
+			};
+
+			// the rest goes to operator new
+			static bool is_small(size_t bytes, size_t alignment)
+			{
+				return bytes != 0 && bytes <= max_small && alignment <= granularity;
+			}
+
+			static void* allocate(size_t bytes)
+			{
+				heap* h = local_heap();
+				if (h == NULL)
+				{
+					return allocate_while_exiting(class_of(bytes));
+				}
+				return allocate_from(*h, class_of(bytes));
+			}
+
+			static void deallocate(void* p)
+			{
+				block* b = static_cast<block*>(p);
+				heap* owner = span_of(p)->owner;
+				heap* h = local_heap();
+				if (h == owner)
+				{
+					size_class& list = h->classes[span_of(p)->size_class];
+					b->next = list.free;
+					list.free = b;
+					++h->stats.deallocations;
+				}
+				else if (h == NULL)
+				{
+					push_remote(*owner, b, b);
+				}
+				else
+				{
+					++h->stats.deallocations;
+					++h->stats.remote_frees;
+					batch_remote(*h, *owner, b);
+				}
+			}
+
+			static tl_pool_stats thread_stats()
+			{
+				heap* h = local_heap();
+				return h != NULL ? h->stats : tl_pool_stats();
+			}
+
+			// sends the batched blocks of other threads now
+			static void flush_remote_frees()
+			{
+				heap* h = local_heap();
+				if (h != NULL)
+				{
+					flush_batches(*h);
+				}
+			}
+
+		private:
+			struct heap;
+
+			struct block
+			{
+				block*	next;
+			};
+
+			// the header of a span, a cache line
+			struct alignas(64) span
+			{
+				heap*	owner;
+				span*	next;
+				size_t	size_class;
+			};
+
+			struct size_class
+			{
+				block*	free;
+				char*	cursor;		// the part of the newest span not handed out yet
+				char*	end;
+			};
+
+			struct remote_batch
+			{
+				heap*	owner;
+				block*	head;
+				block*	tail;
+				size_t	count;
+			};
+
+			struct heap
+			{
+				alignas(64) std::atomic<block*>	remote;		// written by the other threads, on its own line
+				alignas(64) size_class			classes[class_count];
+				remote_batch					batches[batch_slots];
+				size_t							next_victim;
+				span*							spans;
+				tl_pool_stats					stats;
+				heap*							next_orphan;
+			};
+
+			// trivially destructible, so it can still be read while the thread's destructors run
+			struct thread_state
+			{
+				heap*	current;
+				bool	exited;
+			};
+
+			struct thread_guard
+			{
+				~thread_guard()
+				{
+					thread_state& s = state();
+					heap* h = s.current;
+					s.current = NULL;
+					s.exited = true;
+					abandon(*h);
+				}
+			};
+
+			static thread_state& state()
+			{
+				static thread_local thread_state s;
+				return s;
+			}
+
+			// NULL once the thread is running its thread_local destructors
+			static heap* local_heap()
+			{
+				thread_state& s = state();
+				if (s.current == NULL && !s.exited)
+				{
+					s.current = acquire_heap();
+					static thread_local thread_guard guard;
+					(void)guard;
+				}
+				return s.current;
+			}
+
+			static size_t class_of(size_t bytes)
+			{
+				return (bytes - 1) / granularity;
+			}
+
+			static size_t block_size(size_t size_class)
+			{
+				return (size_class + 1) * granularity;
+			}
+
+			static span* span_of(void* p)
+			{
+				return reinterpret_cast<span*>(reinterpret_cast<uintptr_t>(p) & ~(uintptr_t(span_size) - 1));
+			}
+
+			static void* allocate_from(heap& h, size_t c)
+			{
+				size_class& list = h.classes[c];
+				if (list.free == NULL)
+				{
+					collect_remote(h);
+				}
+				++h.stats.allocations;
+				if (list.free != NULL)
+				{
+					block* b = list.free;
+					list.free = b->next;
+					return b;
+				}
+				if (list.cursor == list.end)
+				{
+					new_span(h, c);
+				}
+				void* p = list.cursor;
+				list.cursor += block_size(c);
+				return p;
+			}
+
+			static void new_span(heap& h, size_t c)
+			{
+				void* memory = NULL;
+				if (posix_memalign(&memory, span_size, span_size) != 0)
+				{
+					throw std::bad_alloc();
+				}
+				span* s = ::new (memory) span;
+				s->owner = &h;
+				s->size_class = c;
+				s->next = h.spans;
+				h.spans = s;
+				size_t blocks = (span_size - sizeof(span)) / block_size(c);
+				h.classes[c].cursor = reinterpret_cast<char*>(s) + sizeof(span);
+				h.classes[c].end = h.classes[c].cursor + blocks * block_size(c);
+				++h.stats.spans;
+			}
+
+			// the blocks other threads gave back, all at once: no ABA, the list is never popped one by one
+			static void collect_remote(heap& h)
+			{
+				block* b = h.remote.exchange(NULL, std::memory_order_acquire);
+				while (b != NULL)
+				{
+					block* next = b->next;
+					size_class& list = h.classes[span_of(b)->size_class];
+					b->next = list.free;
+					list.free = b;
+					++h.stats.remote_received;
+					b = next;
+				}
+			}
+
+			static void push_remote(heap& owner, block* first, block* last)
+			{
+				block* head = owner.remote.load(std::memory_order_relaxed);
+				do
+				{
+					last->next = head;
+				} while (!owner.remote.compare_exchange_weak(head, first, std::memory_order_release, std::memory_order_relaxed));
+			}
+
+			static void batch_remote(heap& h, heap& owner, block* b)
+			{
+				remote_batch* slot = NULL;
+				for (size_t i = 0; i < batch_slots && slot == NULL; ++i)
+				{
+					if (h.batches[i].owner == &owner)
+					{
+						slot = &h.batches[i];
+					}
+				}
+				for (size_t i = 0; i < batch_slots && slot == NULL; ++i)
+				{
+					if (h.batches[i].owner == NULL)
+					{
+						slot = &h.batches[i];
+					}
+				}
+				if (slot == NULL)
+				{
+					slot = &h.batches[h.next_victim++ % batch_slots];
+					flush_batch(*slot);
+				}
+				if (slot->owner == NULL)
+				{
+					slot->owner = &owner;
+					slot->tail = b;
+					slot->count = 0;
+					b->next = NULL;
+				}
+				else
+				{
+					b->next = slot->head;
+				}
+				slot->head = b;
+				if (++slot->count >= batch_size)
+				{
+					flush_batch(*slot);
+				}
+			}
+
+			static void flush_batch(remote_batch& slot)
+			{
+				if (slot.owner != NULL)
+				{
+					push_remote(*slot.owner, slot.head, slot.tail);
+					slot.owner = NULL;
+				}
+			}
+
+			static void flush_batches(heap& h)
+			{
+				for (size_t i = 0; i < batch_slots; ++i)
+				{
+					flush_batch(h.batches[i]);
+				}
+			}
+
+			// ORPHANS: the heaps of exited threads
+			static std::mutex& orphan_mutex()
+			{
+				static std::mutex mutex;
+				return mutex;
+			}
+
+			static heap*& orphans()
+			{
+				static heap* head = NULL;
+				return head;
+			}
+
+			static heap* take_orphan_or_create()
+			{
+				heap* h = orphans();
+				if (h != NULL)
+				{
+					orphans() = h->next_orphan;
+					return h;
+				}
+				void* memory = NULL;
+				if (posix_memalign(&memory, alignof(heap), sizeof(heap)) != 0)
+				{
+					throw std::bad_alloc();
+				}
+				h = ::new (memory) heap();
+				h->remote.store(NULL, std::memory_order_relaxed);
+				return h;
+			}
+
+			static heap* acquire_heap()
+			{
+				std::lock_guard<std::mutex> lock(orphan_mutex());
+				heap* h = take_orphan_or_create();
+				h->stats = tl_pool_stats();
+				return h;
+			}
+
+			static void abandon(heap& h)
+			{
+				flush_batches(h);
+				std::lock_guard<std::mutex> lock(orphan_mutex());
+				h.next_orphan = orphans();
+				orphans() = &h;
+			}
+
+			// a destructor of a thread_local that runs after the heap was left: an orphan lends a block
+			static void* allocate_while_exiting(size_t c)
+			{
+				std::lock_guard<std::mutex> lock(orphan_mutex());
+				heap* h = take_orphan_or_create();
+				void* p = allocate_from(*h, c);
+				h->next_orphan = orphans();
+				orphans() = h;
+				return p;
+			}
+		};
+	}
+
+	// An allocator for node-based containers used from many threads: ft::map / ft::set nodes (it rebinds like
+	// std::allocator) come from size-class free lists of the calling thread, so building and destroying
+	// short-lived containers on many threads doesn't contend on malloc. Memory may be freed on another thread
+	// than the one that allocated it. Blocks above 256 bytes (or aligned above 16) go to operator new.
+	// Stateless: all instances are equal.
+	template <class T>
+	class tl_pool_allocator
+	{
+	public:
+		typedef T					value_type;
+		typedef T*					pointer;
+		typedef const T*			const_pointer;
+		typedef T&					reference;
+		typedef const T&			const_reference;
+		typedef size_t				size_type;
+		typedef std::ptrdiff_t		difference_type;
+
+		template <class U>
+		struct rebind
+		{
+			typedef tl_pool_allocator<U> other;
+		};
+
+		tl_pool_allocator() {}
+
+		template <class U>
+		tl_pool_allocator(const tl_pool_allocator<U>&) {}
+
+		pointer allocate(size_type n, const void* = 0)
+		{
+			if (n > max_size())
+			{
+				throw std::bad_alloc();
+			}
+			if (detail::tl_pool::is_small(n * sizeof(T), alignof(T)))
+			{
+				return static_cast<pointer>(detail::tl_pool::allocate(n * sizeof(T)));
+			}
+			return static_cast<pointer>(::operator new(n * sizeof(T)));
+		}
+
+		void deallocate(pointer p, size_type n)
+		{
+			if (detail::tl_pool::is_small(n * sizeof(T), alignof(T)))
+			{
+				detail::tl_pool::deallocate(p);
+			}
+			else
+			{
+				::operator delete(p);
+			}
+		}
+
+		void construct(pointer p, const T& value)
+		{
+			::new (static_cast<void*>(p)) T(value);
+		}
+
+		void destroy(pointer p)
+		{
+			p->~T();
+		}
+
+		size_type max_size() const
+		{
+			return static_cast<size_type>(-1) / sizeof(T);
+		}
+
+		pointer address(reference x) const
+		{
+			return &x;
+		}
+
+		const_pointer address(const_reference x) const
+		{
+			return &x;
+		}
+
+		// of the calling thread
+		static tl_pool_stats thread_stats()
+		{
+			return detail::tl_pool::thread_stats();
+		}
+
+		// blocks of other threads are sent by batches: this sends the pending ones (a thread exiting sends them too)
+		static void flush_remote_frees()
+		{
+			detail::tl_pool::flush_remote_frees();
+		}
+	};
+
+	template <class T, class U>
+	bool operator==(const tl_pool_allocator<T>&, const tl_pool_allocator<U>&)
+	{
+		return true;
+	}
+
+	template <class T, class U>
+	bool operator!=(const tl_pool_allocator<T>&, const tl_pool_allocator<U>&)
+	{
+		return false;
+	}
+}
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef ALLOCATOR_PROPAGATION_HPP
+#define ALLOCATOR_PROPAGATION_HPP
+
+#include "true_type.hpp"
+
+namespace ft
+{
+	// Whether a container hands its allocator over on copy-assignment and swap, and which allocator a copy starts
+	// with (the propagate_on_* and select_on_container_copy_construction of C++11 allocator_traits, for C++98).
+	// By default the allocator goes with the contents, as the containers always did. polymorphic_allocator
+	// specializes it: the memory resource stays with the container, a copy starts on the default resource.
+	template <typename Alloc>
+	struct allocator_propagation
+	{
+		typedef ft::true_type	propagate_on_copy_assignment;
+		typedef ft::true_type	propagate_on_swap;
+
+		static Alloc select_on_copy_construction(const Alloc& alloc)
+		{
+			return alloc;
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef CONSTEXPR_HPP
+#define CONSTEXPR_HPP
+
+// FT_CONSTEXPR marks what can be constexpr from C++11 on (const members that are a single return statement),
+// FT_CONSTEXPR14 what needs the relaxed rules of C++14 (loops, assignments, non-const members).
+// Both are empty in C++98, where the same headers still compile.
+
+#if __cplusplus >= 201103L
+# define FT_CONSTEXPR constexpr
+#else
+# define FT_CONSTEXPR
+#endif
+
+#if __cplusplus >= 201402L
+# define FT_CONSTEXPR14 constexpr
+#else
+# define FT_CONSTEXPR14
+#endif
+
+#endif
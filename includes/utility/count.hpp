@@ -0,0 +1,49 @@
+#ifndef COUNT_HPP
+#define COUNT_HPP
+
+#include <cstddef>
+#include <iterator>
+#include "../iterator/iterator_traits.hpp"
+#include "enable_if.hpp"
+#include "is_integral.hpp"
+#include "remove_cv.hpp"
+#include "simd_search.hpp"
+
+namespace ft
+{
+	namespace detail
+	{
+		template <class InputIterator, class T>
+		typename ft::iterator_traits<InputIterator>::difference_type
+		count_elements(InputIterator first, InputIterator last, const T& value)
+		{
+			typename ft::iterator_traits<InputIterator>::difference_type count = 0;
+			for (; first != last; ++first)
+			{
+				if (*first == value)
+				{
+					++count;
+				}
+			}
+			return count;
+		}
+
+		// contiguous integers counted against a value of their own type, as in find_element
+		template <class T>
+		typename ft::enable_if<ft::is_integral<T>::value, std::ptrdiff_t>::type
+		count_elements(T* first, T* last, const typename ft::remove_cv<T>::type& value)
+		{
+			return count_equal<typename ft::remove_cv<T>::type>(first, last - first, value);
+		}
+	}
+
+	// Returns the number of elements in the range [first,last) that compare equal to value
+	template <class InputIterator, class T>
+	typename ft::iterator_traits<InputIterator>::difference_type
+	count(InputIterator first, InputIterator last, const T& value)
+	{
+		return detail::count_elements(first, last, value);
+	}
+}
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef EBO_STORAGE_HPP
+#define EBO_STORAGE_HPP
+
+#include "is_empty.hpp"
+
+namespace ft
+{
+	// Holds an object of type T. If T is an empty class it is stored as a base class instead of a member,
+	// so that it takes no space at all in the derived class (empty base optimization).
+	// std::less<> and std::allocator<> are empty, storing them as members costs a padded word each.
+	template <typename T, bool = ft::is_empty<T>::value>
+	class ebo_storage
+	{
+	private:
+		T	_value;
+
+	public:
+		ebo_storage(const T& value) : _value(value) {}
+
+		T& get()
+		{
+			return _value;
+		}
+
+		const T& get() const
+		{
+			return _value;
+		}
+	};
+
+	template <typename T>
+	class ebo_storage<T, true> : private T
+	{
+	public:
+		ebo_storage(const T& value) : T(value) {}
+
+		T& get()
+		{
+			return *this;
+		}
+
+		const T& get() const
+		{
+			return *this;
+		}
+	};
+}
+
+#endif
@@ -1,22 +1,43 @@
 #ifndef EQUAL_HPP
 #define EQUAL_HPP
 
+#include <cstring>
+#include "enable_if.hpp"
+#include "is_integral.hpp"
+
 namespace ft
 {
-	// equality (1)
-	template <class InputIterator1, class InputIterator2>
-	bool equal(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2)
+	namespace detail
 	{
-		while (first1!=last1)
+		template <class InputIterator1, class InputIterator2>
+		bool equal_elements(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2)
 		{
-			if (!(*first1 == *first2))
+			while (first1!=last1)
 			{
-				return false;
+				if (!(*first1 == *first2))
+				{
+					return false;
+				}
+				first1++; 
+				first2++;
 			}
-			first1++; 
-			first2++;
+			return true;
 		}
-		return true;
+
+		// integers are equal when their bytes are, and the C library's memcmp is already vectorized
+		template <class T>
+		typename ft::enable_if<ft::is_integral<T>::value, bool>::type
+		equal_elements(T* first1, T* last1, T* first2)
+		{
+			return first1 == last1 || std::memcmp(first1, first2, (last1 - first1) * sizeof(T)) == 0;
+		}
+	}
+
+	// equality (1)
+	template <class InputIterator1, class InputIterator2>
+	bool equal(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2)
+	{
+		return detail::equal_elements(first1, last1, first2);
 	}
 
 	// predicate (2)
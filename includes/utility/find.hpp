@@ -0,0 +1,42 @@
+#ifndef FIND_HPP
+#define FIND_HPP
+
+#include "enable_if.hpp"
+#include "is_integral.hpp"
+#include "remove_cv.hpp"
+#include "simd_search.hpp"
+
+namespace ft
+{
+	namespace detail
+	{
+		template <class InputIterator, class T>
+		InputIterator find_element(InputIterator first, InputIterator last, const T& value)
+		{
+			while (first != last && !(*first == value))
+			{
+				++first;
+			}
+			return first;
+		}
+
+		// contiguous integers searched for a value of their own type (a value of another type keeps the loop,
+		// which compares it without narrowing it first)
+		template <class T>
+		typename ft::enable_if<ft::is_integral<T>::value, T*>::type
+		find_element(T* first, T* last, const typename ft::remove_cv<T>::type& value)
+		{
+			return first + find_equal<typename ft::remove_cv<T>::type>(first, last - first, value);
+		}
+	}
+
+	// Returns an iterator to the first element in the range [first,last) that compares equal to value,
+	// or last if there is none
+	template <class InputIterator, class T>
+	InputIterator find(InputIterator first, InputIterator last, const T& value)
+	{
+		return detail::find_element(first, last, value);
+	}
+}
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef IS_EMPTY_HPP
+#define IS_EMPTY_HPP
+
+#include "false_type.hpp"
+
+namespace ft
+{
+	// only class types can have members, so "int C::*" is a valid type only for them (SFINAE)
+	template <typename T>
+	struct is_class
+	{
+	private:
+		typedef char	yes;
+		struct			no { char c[2]; };
+
+		template <typename C>
+		static yes test(int C::*);
+		template <typename C>
+		static no test(...);
+
+	public:
+		static const bool value = (sizeof(test<T>(0)) == sizeof(yes));
+	};
+
+	// A class is empty if deriving from it adds no size: in that case the empty base optimization
+	// lets the derived class store it for free (used for stateless comparators and allocators)
+	template <typename T, bool = ft::is_class<T>::value>
+	struct is_empty : ft::false_type {};
+
+	template <typename T>
+	struct is_empty<T, true>
+	{
+	private:
+		struct derived : T { int x; };
+		struct plain { int x; };
+
+	public:
+		static const bool value = (sizeof(derived) == sizeof(plain));
+	};
+}
+
+#endif
@@ -17,6 +17,15 @@ namespace ft
     template<> struct is_integral_helper<long> : ft::true_type {};
     template<> struct is_integral_helper<char> : ft::true_type {};
     template<> struct is_integral_helper<wchar_t> : ft::true_type {};
+    template<> struct is_integral_helper<signed char> : ft::true_type {};
+    template<> struct is_integral_helper<unsigned char> : ft::true_type {};
+    template<> struct is_integral_helper<unsigned short> : ft::true_type {};
+    template<> struct is_integral_helper<unsigned int> : ft::true_type {};
+    template<> struct is_integral_helper<unsigned long> : ft::true_type {};
+#if __cplusplus >= 201103L
+    template<> struct is_integral_helper<long long> : ft::true_type {};
+    template<> struct is_integral_helper<unsigned long long> : ft::true_type {};
+#endif
 
     template<typename T>
     struct is_integral: public is_integral_helper<typename ft::remove_cv<T>::type >{};
@@ -0,0 +1,15 @@
+#ifndef IS_MONOTONIC_ALLOCATOR_HPP
+#define IS_MONOTONIC_ALLOCATOR_HPP
+
+#include "false_type.hpp"
+
+namespace ft
+{
+	// An allocator whose deallocate() does nothing: the memory comes back all at once when its source is reset
+	// (arena_allocator). A container may then drop its elements without visiting them, when they are trivially
+	// destructible. Allocators opt in by specializing it.
+	template <typename Alloc>
+	struct is_monotonic_allocator : ft::false_type {};
+}
+
+#endif
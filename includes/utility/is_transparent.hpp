@@ -0,0 +1,27 @@
+#ifndef IS_TRANSPARENT_HPP
+#define IS_TRANSPARENT_HPP
+
+// Detects the is_transparent member type of a comparator (std::less<void> in C++14 has it).
+// When it is present map and set accept any key type comparable with key_type in their lookups
+// (heterogeneous lookup), so no temporary key_type needs to be constructed.
+// The sizeof() trick is used as SFINAE detection works in c++98 as well.
+namespace ft
+{
+	template <typename Compare>
+	struct is_transparent
+	{
+	private:
+		typedef char	yes;
+		struct			no { char c[2]; };
+
+		template <typename C>
+		static yes test(typename C::is_transparent*);
+		template <typename C>
+		static no test(...);
+
+	public:
+		static const bool value = (sizeof(test<Compare>(0)) == sizeof(yes));
+	};
+}
+
+#endif
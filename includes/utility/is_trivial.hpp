@@ -0,0 +1,18 @@
+#ifndef IS_TRIVIAL_HPP
+#define IS_TRIVIAL_HPP
+
+namespace ft
+{
+	// true if T is trivially copyable and its default constructor does nothing: it can live in a plain array that
+	// needs no construction or destruction calls. Like is_trivially_copyable, it comes from the compilers' builtin
+	template <typename T>
+	struct is_trivial
+	{
+		static const bool value = __is_trivial(T);
+	};
+
+	template <typename T>
+	const bool is_trivial<T>::value;
+}
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef IS_TRIVIALLY_COPYABLE_HPP
+#define IS_TRIVIALLY_COPYABLE_HPP
+
+namespace ft
+{
+	// true if a T can be copied, moved and destroyed as its bytes (memcpy, memmove, memset) without calling
+	// any of its members. Like is_trivially_destructible, it comes from the compilers' builtin
+	template <typename T>
+	struct is_trivially_copyable
+	{
+		static const bool value = __is_trivially_copyable(T);
+	};
+
+	template <typename T>
+	const bool is_trivially_copyable<T>::value;
+}
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef IS_TRIVIALLY_DESTRUCTIBLE_HPP
+#define IS_TRIVIALLY_DESTRUCTIBLE_HPP
+
+namespace ft
+{
+	// true if destroying a T does nothing, so its destructor calls can be skipped.
+	// C++98 can't tell it from the language, the compilers expose it as a builtin (GCC, Clang and MSVC all have this one)
+	template <typename T>
+	struct is_trivially_destructible
+	{
+		static const bool value = __has_trivial_destructor(T);
+	};
+
+	template <typename T>
+	const bool is_trivially_destructible<T>::value;
+}
+
+#endif
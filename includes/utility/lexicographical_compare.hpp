@@ -1,6 +1,11 @@
 #ifndef LEXICOGRAPHICAL_COMPARE_HPP
 #define LEXICOGRAPHICAL_COMPARE_HPP
 
+#include <cstring>
+#include "enable_if.hpp"
+#include "is_integral.hpp"
+#include "simd_compare.hpp"
+
 namespace ft
 {
 	// Returns true if the range [first1,last1) compares lexicographically less than the range [first2,last2).
@@ -10,24 +15,66 @@ namespace ft
 	// The result of comparing these first non-matching elements is the result of the lexicographical comparison.
 	//If both sequences compare equal until one of them ends, the shorter sequence is lexicographically less than the longer one.
 
-	template <class InputIterator1, class InputIterator2>
-	bool lexicographical_compare(InputIterator1 first1, InputIterator1 last1,
-                                InputIterator2 first2, InputIterator2 last2)
+	namespace detail
 	{
-		while (first1 != last1)
+		template <class InputIterator1, class InputIterator2>
+		bool lexicographical_elements(InputIterator1 first1, InputIterator1 last1,
+									InputIterator2 first2, InputIterator2 last2)
 		{
-			if (first2 == last2 || *first2 < *first1) 
+			while (first1 != last1)
 			{
-				return false;
+				if (first2 == last2 || *first2 < *first1) 
+				{
+					return false;
+				}
+				else if (*first1 < *first2) 
+				{
+					return true;
+				}
+				first1++;
+				first2++;
 			}
-			else if (*first1 < *first2) 
+			return (first2!=last2);
+		}
+
+		// Contiguous integers: unsigned bytes compare like memcmp; wider or signed types look for the first
+		// differing byte with mismatch_bytes and compare the element that holds it.
+		template <class T>
+		typename ft::enable_if<ft::is_integral<T>::value, bool>::type
+		lexicographical_elements(T* first1, T* last1, T* first2, T* last2)
+		{
+			std::size_t n1 = last1 - first1;
+			std::size_t n2 = last2 - first2;
+			std::size_t n = n1 < n2 ? n1 : n2;
+			if (n != 0)
 			{
-				return true;
+				if (is_byte_ordered<T>::value)
+				{
+					int order = std::memcmp(first1, first2, n * sizeof(T));
+					if (order != 0)
+					{
+						return order < 0;
+					}
+				}
+				else
+				{
+					std::size_t byte = mismatch_bytes(reinterpret_cast<const unsigned char*>(first1),
+						reinterpret_cast<const unsigned char*>(first2), n * sizeof(T));
+					if (byte != n * sizeof(T))
+					{
+						return first1[byte / sizeof(T)] < first2[byte / sizeof(T)];
+					}
+				}
 			}
-			first1++;
-			first2++;
+			return n1 < n2;
 		}
-		return (first2!=last2);
+	}
+
+	template <class InputIterator1, class InputIterator2>
+	bool lexicographical_compare(InputIterator1 first1, InputIterator1 last1,
+                                InputIterator2 first2, InputIterator2 last2)
+	{
+		return detail::lexicographical_elements(first1, last1, first2, last2);
 	}
 // custom comparator(2)
 	template <class InputIterator1, class InputIterator2, class Compare>
@@ -1,7 +1,30 @@
 #ifndef PAIR_HPP
 #define PAIR_HPP
 
+#include "ft_swap.hpp"
+#include "enable_if.hpp"
+
 namespace ft{
+    namespace detail
+    {
+        // true if a From converts implicitly to a To (the C++98 sizeof trick)
+        template <class From, class To>
+        struct is_convertible_to
+        {
+            typedef char                yes;
+            typedef struct { char c[2]; } no;
+
+            static yes test(const To&);
+            static no test(...);
+            static const From& make();
+
+            static const bool value = sizeof(test(make())) == sizeof(yes);
+        };
+    }
+
+    // selects the key-only pair constructor
+    struct pair_key_only_tag {};
+
     template <class T1, class T2> 
     struct pair {
 
@@ -23,6 +46,18 @@ namespace ft{
         // initialization (3)	
         pair (const first_type& a, const second_type& b) : first(a), second(b) {}
 
+        // key only: second is value-initialized in place (used by map::operator[], which would copy a temporary)
+        pair (const first_type& a, pair_key_only_tag) : first(a), second() {}
+
+        // converting initialization: members are constructed directly from a and b, no temporaries (used by map::try_emplace).
+        // Only for arguments that convert to the member types: (NULL, 0) for a pointer member is not a const char* but
+        // a null pointer constant, which only the initialization (3) above accepts
+        template<class U, class V>
+        pair (const U& a, const V& b,
+            typename ft::enable_if<detail::is_convertible_to<U, T1>::value
+                && detail::is_convertible_to<V, T2>::value>::type* = 0)
+            : first(a), second(b) {}
+
 
         pair& operator=( const pair& other )
         {
@@ -39,6 +74,15 @@ namespace ft{
     pair<T1,T2> make_pair(T1 x, T2 y){
         return pair<T1,T2>(x,y);
     }
+
+    // more specialized than both ft::swap(D&, D&) and std::swap(T&, T&): std algorithms swapping ft::pairs
+    // (std::sort on an ft::vector of pairs) find both through ADL and would be ambiguous without it
+    template <class T1, class T2>
+    void swap(pair<T1,T2>& lhs, pair<T1,T2>& rhs)
+    {
+        ft::swap(lhs.first, rhs.first);
+        ft::swap(lhs.second, rhs.second);
+    }
     
     template <class T1, class T2>
     bool
@@ -0,0 +1,18 @@
+#ifndef PREFETCH_HPP
+#define PREFETCH_HPP
+
+namespace ft
+{
+	// asks the CPU to start loading the cache line of address, a no-op on compilers without the builtin.
+	// Prefetching NULL is harmless, so callers don't need to check their pointers.
+	inline void prefetch(const void* address)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		__builtin_prefetch(address);
+#else
+		(void)address;
+#endif
+	}
+}
+
+#endif
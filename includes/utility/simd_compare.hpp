@@ -0,0 +1,115 @@
+#ifndef SIMD_COMPARE_HPP
+#define SIMD_COMPARE_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <climits>
+#include "false_type.hpp"
+#include "true_type.hpp"
+#include "remove_cv.hpp"
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+# define FT_SIMD_COMPARE_X86 1
+# include <immintrin.h>
+#endif
+
+// Kernels behind the contiguous overloads of ft::equal and ft::lexicographical_compare.
+// mismatch_bytes(a, b, n) returns the offset of the first byte where a and b differ, or n when they are equal:
+// 32 bytes per step with AVX2 (picked at run time, the first call asks the CPU), 16 with SSE2 (always there on
+// x86-64), 8 with plain word compares elsewhere.
+
+namespace ft
+{
+	namespace detail
+	{
+		// LAYOUT: types whose order is the order of their bytes, so memcmp's sign is the comparison
+		template <typename T> struct is_byte_ordered_helper : ft::false_type {};
+
+		template <> struct is_byte_ordered_helper<bool> : ft::true_type {};
+		template <> struct is_byte_ordered_helper<unsigned char> : ft::true_type {};
+#if CHAR_MIN == 0
+		template <> struct is_byte_ordered_helper<char> : ft::true_type {};
+#endif
+
+		template <typename T>
+		struct is_byte_ordered : public is_byte_ordered_helper<typename ft::remove_cv<T>::type> {};
+
+		// KERNELS:
+		inline std::size_t mismatch_bytes_scalar(const unsigned char* a, const unsigned char* b, std::size_t n)
+		{
+			std::size_t i = 0;
+			for (; i + sizeof(unsigned long) <= n; i += sizeof(unsigned long))
+			{
+				unsigned long x;
+				unsigned long y;
+				std::memcpy(&x, a + i, sizeof(x));
+				std::memcpy(&y, b + i, sizeof(y));
+				if (x != y)
+				{
+					break;
+				}
+			}
+			while (i < n && a[i] == b[i])
+			{
+				++i;
+			}
+			return i;
+		}
+
+#ifdef FT_SIMD_COMPARE_X86
+		inline std::size_t mismatch_bytes_sse2(const unsigned char* a, const unsigned char* b, std::size_t n)
+		{
+			std::size_t i = 0;
+			for (; i + 16 <= n; i += 16)
+			{
+				__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+				__m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+				unsigned int equal = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)));
+				if (equal != 0xffffu)
+				{
+					return i + __builtin_ctz(~equal);
+				}
+			}
+			return i + mismatch_bytes_scalar(a + i, b + i, n - i);
+		}
+
+		__attribute__((target("avx2")))
+		inline std::size_t mismatch_bytes_avx2(const unsigned char* a, const unsigned char* b, std::size_t n)
+		{
+			std::size_t i = 0;
+			for (; i + 32 <= n; i += 32)
+			{
+				__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+				__m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+				unsigned int equal = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+				if (equal != 0xffffffffu)
+				{
+					return i + __builtin_ctz(~equal);
+				}
+			}
+			return i + mismatch_bytes_sse2(a + i, b + i, n - i);
+		}
+
+		inline bool cpu_has_avx2()
+		{
+			static const bool has = (__builtin_cpu_init(), __builtin_cpu_supports("avx2") != 0);
+			return has;
+		}
+#endif
+
+		inline std::size_t mismatch_bytes(const unsigned char* a, const unsigned char* b, std::size_t n)
+		{
+#ifdef FT_SIMD_COMPARE_X86
+			if (n >= 32 && cpu_has_avx2())
+			{
+				return mismatch_bytes_avx2(a, b, n);
+			}
+			return mismatch_bytes_sse2(a, b, n);
+#else
+			return mismatch_bytes_scalar(a, b, n);
+#endif
+		}
+	}
+}
+
+#endif
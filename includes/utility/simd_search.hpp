@@ -0,0 +1,195 @@
+#ifndef SIMD_SEARCH_HPP
+#define SIMD_SEARCH_HPP
+
+#include <cstddef>
+#include "simd_compare.hpp"
+
+// Kernels behind the contiguous overloads of ft::find and ft::count, for integers of 1, 2, 4 or 8 bytes.
+// A block of elements is compared with the value broadcast to every lane, and the byte mask of the result
+// (movemask) gives the first match (its lowest bit / sizeof(T)) or the number of matches (its popcount / sizeof(T)).
+// 32 bytes per step with AVX2 when the CPU has it, 16 with SSE2 on x86-64, one element at a time elsewhere.
+
+namespace ft
+{
+	namespace detail
+	{
+		template <typename T>
+		std::size_t find_equal_scalar(const T* first, std::size_t n, T value)
+		{
+			std::size_t i = 0;
+			while (i < n && !(first[i] == value))
+			{
+				++i;
+			}
+			return i;
+		}
+
+		template <typename T>
+		std::size_t count_equal_scalar(const T* first, std::size_t n, T value)
+		{
+			std::size_t count = 0;
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				count += (first[i] == value);
+			}
+			return count;
+		}
+
+#ifdef FT_SIMD_COMPARE_X86
+		// LANES: equality of the lanes of one width, all the bytes of a lane set when it matches
+		template <std::size_t Size> struct simd_lanes;
+
+		template <> struct simd_lanes<1>
+		{
+			static __m128i equal(__m128i x, __m128i y) { return _mm_cmpeq_epi8(x, y); }
+			__attribute__((target("avx2")))
+			static __m256i equal(__m256i x, __m256i y) { return _mm256_cmpeq_epi8(x, y); }
+		};
+
+		template <> struct simd_lanes<2>
+		{
+			static __m128i equal(__m128i x, __m128i y) { return _mm_cmpeq_epi16(x, y); }
+			__attribute__((target("avx2")))
+			static __m256i equal(__m256i x, __m256i y) { return _mm256_cmpeq_epi16(x, y); }
+		};
+
+		template <> struct simd_lanes<4>
+		{
+			static __m128i equal(__m128i x, __m128i y) { return _mm_cmpeq_epi32(x, y); }
+			__attribute__((target("avx2")))
+			static __m256i equal(__m256i x, __m256i y) { return _mm256_cmpeq_epi32(x, y); }
+		};
+
+		template <> struct simd_lanes<8>
+		{
+			// SSE2 has no 64-bit compare: both 32-bit halves have to match
+			static __m128i equal(__m128i x, __m128i y)
+			{
+				__m128i halves = _mm_cmpeq_epi32(x, y);
+				return _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+			}
+			__attribute__((target("avx2")))
+			static __m256i equal(__m256i x, __m256i y) { return _mm256_cmpeq_epi64(x, y); }
+		};
+
+		// 32 bytes of value, copied lane by lane: the broadcast for any width
+		template <typename T>
+		struct simd_splat
+		{
+			T lanes[32 / sizeof(T)];
+
+			explicit simd_splat(T value)
+			{
+				for (std::size_t i = 0; i < 32 / sizeof(T); ++i)
+				{
+					lanes[i] = value;
+				}
+			}
+		};
+
+		template <typename T>
+		std::size_t find_equal_sse2(const T* first, std::size_t n, T value)
+		{
+			const std::size_t step = 16 / sizeof(T);
+			simd_splat<T> splat(value);
+			__m128i needle = _mm_loadu_si128(reinterpret_cast<const __m128i*>(splat.lanes));
+			std::size_t i = 0;
+			for (; i + step <= n; i += step)
+			{
+				__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i));
+				unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(simd_lanes<sizeof(T)>::equal(block, needle)));
+				if (mask != 0)
+				{
+					return i + __builtin_ctz(mask) / sizeof(T);
+				}
+			}
+			return i + find_equal_scalar(first + i, n - i, value);
+		}
+
+		template <typename T>
+		__attribute__((target("avx2")))
+		std::size_t find_equal_avx2(const T* first, std::size_t n, T value)
+		{
+			const std::size_t step = 32 / sizeof(T);
+			simd_splat<T> splat(value);
+			__m256i needle = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(splat.lanes));
+			std::size_t i = 0;
+			for (; i + step <= n; i += step)
+			{
+				__m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + i));
+				unsigned int mask = static_cast<unsigned int>(_mm256_movemask_epi8(simd_lanes<sizeof(T)>::equal(block, needle)));
+				if (mask != 0)
+				{
+					return i + __builtin_ctz(mask) / sizeof(T);
+				}
+			}
+			return i + find_equal_scalar(first + i, n - i, value);
+		}
+
+		template <typename T>
+		std::size_t count_equal_sse2(const T* first, std::size_t n, T value)
+		{
+			const std::size_t step = 16 / sizeof(T);
+			simd_splat<T> splat(value);
+			__m128i needle = _mm_loadu_si128(reinterpret_cast<const __m128i*>(splat.lanes));
+			std::size_t bytes = 0;
+			std::size_t i = 0;
+			for (; i + step <= n; i += step)
+			{
+				__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i));
+				bytes += __builtin_popcount(_mm_movemask_epi8(simd_lanes<sizeof(T)>::equal(block, needle)));
+			}
+			return bytes / sizeof(T) + count_equal_scalar(first + i, n - i, value);
+		}
+
+		template <typename T>
+		__attribute__((target("avx2")))
+		std::size_t count_equal_avx2(const T* first, std::size_t n, T value)
+		{
+			const std::size_t step = 32 / sizeof(T);
+			simd_splat<T> splat(value);
+			__m256i needle = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(splat.lanes));
+			std::size_t bytes = 0;
+			std::size_t i = 0;
+			for (; i + step <= n; i += step)
+			{
+				__m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + i));
+				bytes += __builtin_popcount(static_cast<unsigned int>(
+					_mm256_movemask_epi8(simd_lanes<sizeof(T)>::equal(block, needle))));
+			}
+			return bytes / sizeof(T) + count_equal_scalar(first + i, n - i, value);
+		}
+#endif
+
+		// offset of the first element equal to value, or n
+		template <typename T>
+		std::size_t find_equal(const T* first, std::size_t n, T value)
+		{
+#ifdef FT_SIMD_COMPARE_X86
+			if (n >= 32 / sizeof(T) && cpu_has_avx2())
+			{
+				return find_equal_avx2(first, n, value);
+			}
+			return find_equal_sse2(first, n, value);
+#else
+			return find_equal_scalar(first, n, value);
+#endif
+		}
+
+		template <typename T>
+		std::size_t count_equal(const T* first, std::size_t n, T value)
+		{
+#ifdef FT_SIMD_COMPARE_X86
+			if (n >= 32 / sizeof(T) && cpu_has_avx2())
+			{
+				return count_equal_avx2(first, n, value);
+			}
+			return count_equal_sse2(first, n, value);
+#else
+			return count_equal_scalar(first, n, value);
+#endif
+		}
+	}
+}
+
+#endif
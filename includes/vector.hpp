@@ -5,6 +5,7 @@
 #include <iostream>
 #include <cmath>
 #include <iterator> // for std::distance
+#include <cstring>
 
 #include "iterator/reverse_iterator.hpp"
 
@@ -13,6 +14,12 @@
 #include "utility/lexicographical_compare.hpp"
 #include "utility/equal.hpp"
 #include "utility/ft_swap.hpp"
+#include "utility/allocator_propagation.hpp"
+#include "utility/false_type.hpp"
+#include "utility/true_type.hpp"
+#include "utility/is_trivially_copyable.hpp"
+#include "utility/find.hpp"
+#include "utility/count.hpp"
 
 namespace ft
 {
@@ -44,6 +51,8 @@ namespace ft
         size_type       _capacity;
         allocator_type  _alloc;
 
+        typedef ft::allocator_propagation<Alloc>        propagation;
+
     public:
         //default constructor(1):
         explicit vector<T, Alloc>(const allocator_type &alloc = allocator_type())
@@ -80,23 +89,35 @@ namespace ft
         }
 
         // copy (4)
-        vector (const vector& x) : _elements(NULL),  _size(0), _capacity(0), _alloc() { *this = x; }
+        vector (const vector& x)
+            : _elements(NULL),  _size(0), _capacity(0), _alloc(propagation::select_on_copy_construction(x._alloc))
+        {
+            assign(x.begin(), x.end());
+        }
+
+        // copy on another allocator (a pmr::vector copied onto a given memory resource)
+        vector (const vector& x, const allocator_type& alloc)
+            : _elements(NULL),  _size(0), _capacity(0), _alloc(alloc)
+        {
+            assign(x.begin(), x.end());
+        }
 
         ~vector() { destroy_elements(); }
 
-        vector& operator=( const vector& other ) // check if it works correctly!!! do we need to clear twice?
+        // the storage is kept when the allocator stays (or is an equal one): assign() reallocates only if it's too small.
+        // When a different allocator is taken over, the old storage goes back to the allocator it came from first
+        vector& operator=( const vector& other )
         {
             if (this == &other)
                 return *this;
-            if (!empty())
-            {
-                clear();
-            }
-            if (other._size > _capacity)
+            clear();
+            if (propagation::propagate_on_copy_assignment::value && !(_alloc == other._alloc))
             {
-                _alloc.deallocate(_elements, _capacity);
+                destroy_elements();
+                _elements = NULL;
+                _capacity = 0;
+                _alloc = other._alloc;
             }
-			_alloc = other._alloc;
 			assign(other.begin(), other.end());
 			return *this;
         }
@@ -286,42 +307,40 @@ namespace ft
         // the assignment operator of T is called the number of times equal to the number of elements in the vector after the erased elements
         iterator erase(iterator position)
         {
-            size_type offset = position - begin();
-            iterator it_end = end();
-            _alloc.destroy(_elements + offset);
-            if (position != it_end - 1)
-            {
-                for (iterator it = position; it + 1 !=it_end; ++it)
-                {
-                    *it = *(it + 1);
-                }
-            }
-            _size--;
-            return position;
+            return erase(position, position + 1);
         }
 
+        // the elements after the range are assigned over it (one memmove for trivially copyable ones),
+        // then the moved-from ones left at the end are destroyed
         iterator erase(iterator first, iterator last)
         {
             if (first == last)
             {
                 return first;
             }
-            difference_type offset = first - begin();
             difference_type num_to_erase = last - first;
-            destroy_range(_elements + offset, _elements + offset + num_to_erase);
             iterator it_end = end();
-            for (iterator iter = first; iter + num_to_erase != it_end; ++iter)
+            if (ft::is_trivially_copyable<T>::value)
             {
-                *iter = *(iter + num_to_erase);
+                move_bytes(first, last, it_end - last);
+            }
+            else
+            {
+                for (iterator iter = first; iter + num_to_erase != it_end; ++iter)
+                {
+                    *iter = *(iter + num_to_erase);
+                }
             }
+            destroy_range(it_end - num_to_erase, it_end);
             _size -= num_to_erase;
             return first;
         }
 
         iterator insert(iterator position, const value_type& val)
         {
+            const value_type copy(val); // as in insert(position, n, val)
             pointer start = move_elements_forward(position, 1);
-            uninitialized_fill(start, start + 1, val);
+            uninitialized_fill(start, start + 1, copy);
             _size++;
             return iterator(start);
         }
@@ -330,8 +349,9 @@ namespace ft
         // fill (2)	//  (return: Iterator pointing to the first element inserted, or pos if count==0) how is it possible if return type is void?
         void insert(iterator position, size_type n, const value_type& val)
         {
+            const value_type copy(val); // val may be one of the elements that are about to move
             pointer start = move_elements_forward(position, n);
-            uninitialized_fill(start, start + n, val);
+            uninitialized_fill(start, start + n, copy);
             _size += n;
         }
 
@@ -363,15 +383,14 @@ namespace ft
         }
         // Using resize() on a vector is very similar to using the C standard library function realloc() on a C array allocated on the free store.
         // Resizes the container so that it contains n elements.
+        // Growing reserves once and fills the new elements in one pass (a memset for trivially copyable zeroes).
         void resize(size_type n, value_type val = value_type())
         {
             if (n > _size)
             {
                 reserve(n);
-                while (n > _size)
-                {
-                    push_back(val);
-                }
+                uninitialized_fill(_elements + _size, _elements + n, val);
+                _size = n;
             }
             else
             {
@@ -384,17 +403,49 @@ namespace ft
     //swap, overloading that algorithm with an optimization that behaves like this member function.
         
         void swap (vector& x) // partial specialization for vector swap function
+        {
+            swap(x, typename propagation::propagate_on_swap());
+        }
+
+    private:
+        void swap(vector& x, ft::true_type)
+        {
+            swap_storage(x);
+        }
+
+        // an allocator that doesn't propagate (polymorphic_allocator) stays with its vector: unless the two can free
+        // each other's memory, the elements are copied into storage of the side they go to
+        void swap(vector& x, ft::false_type)
+        {
+            if (_alloc == x._alloc)
+            {
+                swap_storage(x);
+                return;
+            }
+            vector to_this(_alloc);
+            to_this.assign(x.begin(), x.end());
+            vector to_x(x._alloc);
+            to_x.assign(begin(), end());
+            swap_storage(to_this);
+            x.swap_storage(to_x);
+        }
+
+        void swap_storage(vector& x)
         {
             ft::swap(x._elements, _elements);
             ft::swap(x._size, _size);
             ft::swap(x._capacity, _capacity);
             ft::swap(x._alloc, _alloc);
-        };
+        }
 
-    private:
 
         void uninitialized_fill(pointer start, pointer end, const value_type& val)
         {
+            if (ft::is_trivially_copyable<T>::value)
+            {
+                fill_bytes(start, end, val);
+                return;
+            }
             pointer ptr, ptr1; // ptr1 for destructing if construction fails
             try
             {
@@ -416,6 +467,11 @@ namespace ft
 
         void uninitialized_copy(pointer dest, pointer src)
         {
+            if (ft::is_trivially_copyable<T>::value)
+            {
+                copy_bytes(dest, src, _size);
+                return;
+            }
             pointer dest_ptr = dest, src_ptr = src;
             for (; dest_ptr != dest + _size; ++src_ptr, ++dest_ptr)
             {
@@ -455,6 +511,71 @@ namespace ft
             }
         }
 
+        // a range of another vector or of an array of T: one memcpy for trivially copyable elements
+        void uninitialized_copy(pointer dest, const_pointer src_first, const_pointer src_last)
+        {
+            if (ft::is_trivially_copyable<T>::value)
+            {
+                copy_bytes(dest, src_first, src_last - src_first);
+                return;
+            }
+            uninitialized_copy<const_pointer>(dest, src_first, src_last);
+        }
+
+        void uninitialized_copy(pointer dest, pointer src_first, pointer src_last)
+        {
+            uninitialized_copy(dest, const_pointer(src_first), const_pointer(src_last));
+        }
+
+        // BULK KERNELS: trivially copyable elements are filled, copied and shifted as bytes, without construct()
+        // or the assignment operator. Fill is a memset when all the bytes of val are the same (zeroes, or any
+        // 1-byte type); otherwise the first block of 1 KiB is filled element by element and copied over the rest
+        void fill_bytes(pointer start, pointer end, const value_type& val)
+        {
+            const size_type n = end - start;
+            if (n == 0)
+            {
+                return;
+            }
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&val);
+            size_type same = 1;
+            while (same < sizeof(value_type) && bytes[same] == bytes[0])
+            {
+                ++same;
+            }
+            if (same == sizeof(value_type))
+            {
+                std::memset(static_cast<void*>(start), bytes[0], n * sizeof(value_type));
+                return;
+            }
+            size_type block = sizeof(value_type) < 1024 ? 1024 / sizeof(value_type) : 1;
+            block = block < n ? block : n;
+            for (size_type i = 0; i < block; ++i)
+            {
+                std::memcpy(static_cast<void*>(start + i), bytes, sizeof(value_type));
+            }
+            for (size_type done = block; done < n; done += block)
+            {
+                copy_bytes(start + done, start, n - done < block ? n - done : block);
+            }
+        }
+
+        void copy_bytes(pointer dest, const_pointer src, size_type n)
+        {
+            if (n != 0)
+            {
+                std::memcpy(static_cast<void*>(dest), static_cast<const void*>(src), n * sizeof(value_type));
+            }
+        }
+
+        void move_bytes(pointer dest, const_pointer src, size_type n)
+        {
+            if (n != 0)
+            {
+                std::memmove(static_cast<void*>(dest), static_cast<const void*>(src), n * sizeof(value_type));
+            }
+        }
+
         // returns the pointer to the poaition that will be filled with the new value
         pointer move_elements_forward(iterator position, size_type n)
         {
@@ -466,13 +587,24 @@ namespace ft
                 position = begin() + distance;
             }
             iterator it = position;
-            if (!empty())
+            if (ft::is_trivially_copyable<T>::value)
             {
-                it = end() - 1;
-                for (; it != (position - 1); --it) // moving from the last element to the position(included)
+                move_bytes(position + n, position, end() - position);
+            }
+            else if (position != end())
+            {
+                // the elements that land past the end are constructed there, the others assigned from the last
+                // to the position, then the n slots from position are destroyed for the caller to construct into
+                iterator old_end = end();
+                size_type tail = old_end - position;
+                iterator constructed = tail > n ? old_end - n : position;
+                uninitialized_copy(constructed + n, constructed, old_end);
+                for (it = constructed; it != position; )
                 {
-                    *(it + n) = *(it);
+                    --it;
+                    *(it + n) = *it;
                 }
+                destroy_range(position, position + (tail < n ? tail : n));
             }
             pointer start = _elements + distance;
             return start;
@@ -504,14 +636,17 @@ namespace ft
             {
                 _alloc.destroy(ptr); // Calls the destructor of the object
             }
-            _alloc.deallocate(_elements, _size); // Deallocates the storage referenced by the pointer p, which must be a pointer obtained by an earlier call to allocate()
+            if (_elements != NULL)
+            {
+                _alloc.deallocate(_elements, _capacity); // Deallocates the storage referenced by the pointer p, which must be a pointer obtained by an earlier call to allocate()
+            }
         }
     
     };
 
     // NON_MEMBER OVERLOADS:
-    template< class T>
-    void swap (vector<T>& x, vector<T>& y)
+    template <class T, class Alloc>
+    void swap (vector<T, Alloc>& x, vector<T, Alloc>& y)
     {
         x.swap(y);
     }
@@ -0,0 +1,208 @@
+#ifndef WS_DEQUE_HPP
+#define WS_DEQUE_HPP
+
+#if __cplusplus < 201103L
+# error "ws_deque.hpp requires C++11 (std::atomic)"
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+#include "vector.hpp"
+
+namespace ft
+{
+	// Work-stealing deque (Chase-Lev, with the C11 memory orders of Le, Pop, Cohen and Zappa Nardelli).
+	// One owner thread push()es and pop()s at the bottom, like a stack: the common path has no CAS and no lock.
+	// Any thread may steal() the oldest element from the top with one CAS; the owner only races with the thieves
+	// for the very last element. The storage is a circular buffer of a power of two slots that the owner doubles
+	// when it is full. Thieves may still be reading the old buffer, so it is kept (in _retired) until the deque dies.
+	// Elements are copied in and out of atomic slots: T must be trivially copyable (usually a task pointer).
+	template <class T, class Alloc = ::std::allocator<T> >
+	class ws_deque
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "ws_deque elements are read by thieves while the owner overwrites them");
+
+	public:
+		typedef T			value_type;
+		typedef Alloc		allocator_type;
+		typedef size_t		size_type;
+
+		explicit ws_deque(size_type capacity = 64, const allocator_type& alloc = allocator_type())
+			: _top(0), _bottom(0), _alloc(alloc)
+		{
+			size_type slots = 2;
+			while (slots < capacity)
+			{
+				slots *= 2;
+			}
+			_buffer.store(new_buffer(slots), std::memory_order_relaxed);
+		}
+
+		// no other thread may use the deque anymore
+		~ws_deque()
+		{
+			delete_buffer(_buffer.load(std::memory_order_relaxed));
+			for (size_type i = 0; i < _retired.size(); ++i)
+			{
+				delete_buffer(_retired[i]);
+			}
+		}
+
+		allocator_type get_allocator() const
+		{
+			return _alloc;
+		}
+
+		// approximate when other threads are stealing
+		bool empty() const
+		{
+			return size() == 0;
+		}
+
+		size_type size() const
+		{
+			ptrdiff_t bottom = _bottom.load(std::memory_order_relaxed);
+			ptrdiff_t top = _top.load(std::memory_order_relaxed);
+			return bottom > top ? static_cast<size_type>(bottom - top) : 0;
+		}
+
+		// owner only
+		size_type capacity() const
+		{
+			return _buffer.load(std::memory_order_relaxed)->mask + 1;
+		}
+
+		// owner only
+		void push(const value_type& val)
+		{
+			ptrdiff_t bottom = _bottom.load(std::memory_order_relaxed);
+			ptrdiff_t top = _top.load(std::memory_order_acquire);
+			buffer* current = _buffer.load(std::memory_order_relaxed);
+			if (static_cast<size_type>(bottom - top) > current->mask)
+			{
+				current = grow(current, top, bottom);
+			}
+			current->slot(bottom).store(val, std::memory_order_relaxed);
+			_bottom.store(bottom + 1, std::memory_order_release); // publishes the element to the thieves
+		}
+
+		// owner only: the newest element, false if the deque was empty (or a thief took the last element)
+		bool pop(value_type& val)
+		{
+			ptrdiff_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+			buffer* current = _buffer.load(std::memory_order_relaxed);
+			// reserving the bottom element must be visible before top is read, or a thief could take it too
+			_bottom.store(bottom, std::memory_order_seq_cst);
+			ptrdiff_t top = _top.load(std::memory_order_seq_cst);
+			if (top > bottom)
+			{
+				_bottom.store(bottom + 1, std::memory_order_relaxed);
+				return false;
+			}
+			val = current->slot(bottom).load(std::memory_order_relaxed);
+			if (top == bottom)
+			{
+				// the last element: whoever moves top first gets it
+				bool won = _top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+				_bottom.store(bottom + 1, std::memory_order_relaxed);
+				return won;
+			}
+			return true;
+		}
+
+		// any thread: the oldest element, false if the deque was empty or another thread got it first
+		bool steal(value_type& val)
+		{
+			ptrdiff_t top = _top.load(std::memory_order_seq_cst);
+			ptrdiff_t bottom = _bottom.load(std::memory_order_seq_cst);
+			if (top >= bottom)
+			{
+				return false;
+			}
+			buffer* current = _buffer.load(std::memory_order_acquire);
+			value_type stolen = current->slot(top).load(std::memory_order_relaxed);
+			if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			{
+				return false;
+			}
+			val = stolen;
+			return true;
+		}
+
+	private:
+		ws_deque(const ws_deque&);
+		ws_deque& operator=(const ws_deque&);
+
+		typedef std::atomic<value_type> atomic_value;
+
+		struct buffer
+		{
+			size_type		mask;	// slots - 1, the slots are a power of two
+			atomic_value*	slots;
+
+			atomic_value& slot(ptrdiff_t index)
+			{
+				return slots[static_cast<size_type>(index) & mask];
+			}
+		};
+
+		typedef typename std::allocator_traits<allocator_type>::template rebind_alloc<atomic_value>	slot_allocator;
+		typedef typename std::allocator_traits<allocator_type>::template rebind_alloc<buffer>		buffer_allocator;
+
+		// top and bottom are written by different threads: they don't share a cache line
+		alignas(64) std::atomic<ptrdiff_t>	_top;
+		alignas(64) std::atomic<ptrdiff_t>	_bottom;
+		std::atomic<buffer*>				_buffer;
+		ft::vector<buffer*>					_retired; // owner only
+		allocator_type						_alloc;
+
+		buffer* new_buffer(size_type slots)
+		{
+			slot_allocator slot_alloc(_alloc);
+			buffer_allocator buffer_alloc(_alloc);
+			buffer* created = buffer_alloc.allocate(1);
+			try
+			{
+				created->slots = slot_alloc.allocate(slots);
+			}
+			catch (...)
+			{
+				buffer_alloc.deallocate(created, 1);
+				throw;
+			}
+			created->mask = slots - 1;
+			for (size_type i = 0; i < slots; ++i)
+			{
+				new (created->slots + i) atomic_value();
+			}
+			return created;
+		}
+
+		void delete_buffer(buffer* old_buffer)
+		{
+			slot_allocator slot_alloc(_alloc);
+			buffer_allocator buffer_alloc(_alloc);
+			slot_alloc.deallocate(old_buffer->slots, old_buffer->mask + 1);
+			buffer_alloc.deallocate(old_buffer, 1);
+		}
+
+		// copies [top, bottom) to a buffer twice as large; the indexes don't change, only the slots they map to
+		buffer* grow(buffer* old_buffer, ptrdiff_t top, ptrdiff_t bottom)
+		{
+			_retired.reserve(_retired.size() + 1); // can't throw once the new buffer is published
+			buffer* grown = new_buffer(2 * (old_buffer->mask + 1));
+			for (ptrdiff_t i = top; i < bottom; ++i)
+			{
+				grown->slot(i).store(old_buffer->slot(i).load(std::memory_order_relaxed), std::memory_order_relaxed);
+			}
+			_buffer.store(grown, std::memory_order_release);
+			_retired.push_back(old_buffer);
+			return grown;
+		}
+	};
+}
+
+#endif
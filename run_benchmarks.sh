@@ -0,0 +1,7 @@
+#!/bin/bash
+green=`tput setaf 2`
+reset=`tput sgr0`
+echo "${green}Compiling benchmarks ${reset}"
+make -s bench
+echo "${green}Running benchmarks ${reset}"
+./build/containers_benchmarks "$@"
@@ -0,0 +1,78 @@
+#include "include/bench.hpp"
+
+#include "arena.hpp"
+#include "map.hpp"
+#include "vector.hpp"
+#include <functional>
+
+// A request-scoped workload repeated n / 64 times: a scratch ft::vector of 256 ints and an ft::map of 64 entries
+// built, looked up 64 times and destroyed. With std::allocator (every node and every vector growth hits the heap,
+// every node is freed on destruction) against arena_allocator on an arena reset after each request (one chunk reused).
+// ops are requests.
+
+namespace
+{
+	// kept out of line like a real request handler: inlined into the timing loop, the compiler can see through
+	// the paired operator new / delete of std::allocator and drop work it can't drop in an application
+	template <class Alloc, class PairAlloc>
+	__attribute__((noinline)) long request(const Alloc& alloc, const PairAlloc& pair_alloc, int seed)
+	{
+		ft::vector<int, Alloc> scratch(alloc);
+		for (int i = 0; i < 256; ++i)
+		{
+			scratch.push_back(i ^ seed);
+		}
+		ft::map<int, int, std::less<int>, PairAlloc> lookup(std::less<int>(), pair_alloc);
+		for (int i = 0; i < 64; ++i)
+		{
+			lookup[scratch[i * 4]] = i;
+		}
+		long found = 0;
+		for (int i = 0; i < 64; ++i)
+		{
+			found += lookup.count(scratch[i * 3]);
+		}
+		return found;
+	}
+
+	void arena_requests(const bench::options& opts)
+	{
+		const size_t requests = opts.n / 64 + 1;
+		double seconds = bench::best_of(opts, [&]() {
+			long found = 0;
+			for (size_t r = 0; r < requests; ++r)
+			{
+				found += request(std::allocator<int>(), std::allocator<ft::pair<const int, int> >(), static_cast<int>(r));
+			}
+			bench::do_not_optimize(found);
+		});
+		bench::report("arena/request", "std::allocator", requests, seconds);
+
+		ft::arena a;
+		seconds = bench::best_of(opts, [&]() {
+			long found = 0;
+			for (size_t r = 0; r < requests; ++r)
+			{
+				found += request(ft::arena_allocator<int>(a), ft::arena_allocator<ft::pair<const int, int> >(a), static_cast<int>(r));
+				a.reset();
+			}
+			bench::do_not_optimize(found);
+		});
+		bench::report("arena/request", "arena_allocator + reset", requests, seconds);
+
+		char buffer[32768];
+		ft::arena on_stack(buffer, sizeof(buffer));
+		seconds = bench::best_of(opts, [&]() {
+			long found = 0;
+			for (size_t r = 0; r < requests; ++r)
+			{
+				found += request(ft::arena_allocator<int>(on_stack), ft::arena_allocator<ft::pair<const int, int> >(on_stack), static_cast<int>(r));
+				on_stack.reset();
+			}
+			bench::do_not_optimize(found);
+		});
+		bench::report("arena/request", "arena on a stack buffer", requests, seconds);
+	}
+}
+
+BENCH_CASE("arena", arena_requests);
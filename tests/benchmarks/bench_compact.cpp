@@ -0,0 +1,73 @@
+#include "include/bench.hpp"
+
+#include "map.hpp"
+#include <algorithm>
+#include <random>
+
+// An ft::map of n keys after a churn of random erases and inserts (with other allocations in between, so the
+// nodes end up scattered over the heap): an in-order scan, compact(), the same scan again, then a full pass of
+// compact_step(1024) and the scan after it.
+
+namespace
+{
+	typedef ft::map<int, long>	map_type;
+
+	double scan(const bench::options& opts, const map_type& m)
+	{
+		return bench::best_of(opts, [&m]() {
+			long sum = 0;
+			for (map_type::const_iterator it = m.begin(); it != m.end(); ++it)
+			{
+				sum += it->second;
+			}
+			bench::do_not_optimize(sum);
+		});
+	}
+
+	void churn(map_type& m, std::vector<long*>& noise, std::mt19937& rng, size_t n)
+	{
+		for (size_t i = 0; i < 2 * n; ++i)
+		{
+			int key = static_cast<int>(rng() % (2 * n));
+			m.erase(key);
+			noise.push_back(new long(key));
+			m.insert(map_type::value_type(static_cast<int>(rng() % (2 * n)), key));
+		}
+	}
+
+	void compact(const bench::options& opts)
+	{
+		std::mt19937 rng(42);
+		map_type m;
+		for (size_t i = 0; i < opts.n; ++i)
+		{
+			m.insert(map_type::value_type(static_cast<int>(rng() % (2 * opts.n)), static_cast<long>(i)));
+		}
+		std::vector<long*> noise;
+		churn(m, noise, rng, opts.n);
+		bench::report("compact/scan", "after churn", m.size(), scan(opts, m));
+		bench::timer t;
+		m.compact();
+		bench::report("compact/compact()", "whole map", m.size(), t.seconds());
+		bench::report("compact/scan", "after compact()", m.size(), scan(opts, m));
+
+		churn(m, noise, rng, opts.n);
+		bench::report("compact/scan", "after churn again", m.size(), scan(opts, m));
+		t.restart();
+		size_t steps = 1;
+		while (!m.compact_step(1024))
+		{
+			++steps;
+		}
+		double seconds = t.seconds();
+		bench::report("compact/compact_step(1024)", "whole pass", m.size(), seconds);
+		bench::report("compact/compact_step(1024)", "one step", 1, seconds / steps);
+		bench::report("compact/scan", "after compact_step()", m.size(), scan(opts, m));
+		for (size_t i = 0; i < noise.size(); ++i)
+		{
+			delete noise[i];
+		}
+	}
+}
+
+BENCH_CASE("compact", compact);
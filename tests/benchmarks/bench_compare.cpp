@@ -0,0 +1,110 @@
+#include "include/bench.hpp"
+
+#include "vector.hpp"
+#include <algorithm>
+#include <random>
+#include <stdint.h>
+
+// n pairs of ft::vector<uint8_t> fingerprints (32 bytes, most pairs equal, the others differing at a random
+// byte) and of ft::vector<int> rows (256 ints), compared with operator== and operator<, against the
+// element-by-element loop that ft::equal and ft::lexicographical_compare used to run.
+
+namespace
+{
+	template <typename T>
+	bool loop_equal(const ft::vector<T>& a, const ft::vector<T>& b)
+	{
+		if (a.size() != b.size())
+		{
+			return false;
+		}
+		for (size_t i = 0; i < a.size(); ++i)
+		{
+			if (!(a[i] == b[i]))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template <typename T>
+	bool loop_less(const ft::vector<T>& a, const ft::vector<T>& b)
+	{
+		size_t n = std::min(a.size(), b.size());
+		for (size_t i = 0; i < n; ++i)
+		{
+			if (a[i] < b[i])
+			{
+				return true;
+			}
+			if (b[i] < a[i])
+			{
+				return false;
+			}
+		}
+		return a.size() < b.size();
+	}
+
+	template <typename T>
+	void run(const bench::options& opts, const char* name, size_t length)
+	{
+		std::mt19937 rng(42);
+		std::vector<ft::vector<T> > lhs(opts.n);
+		std::vector<ft::vector<T> > rhs(opts.n);
+		for (size_t i = 0; i < opts.n; ++i)
+		{
+			for (size_t j = 0; j < length; ++j)
+			{
+				lhs[i].push_back(static_cast<T>(rng()));
+			}
+			rhs[i] = lhs[i];
+			if (rng() % 4 == 0)
+			{
+				rhs[i][rng() % length] ^= 1;
+			}
+		}
+		std::string eq = std::string(name) + "/operator==";
+		std::string lt = std::string(name) + "/operator<";
+		bench::report(eq.c_str(), "element loop", opts.n, bench::best_of(opts, [&]() {
+			size_t hits = 0;
+			for (size_t i = 0; i < opts.n; ++i)
+			{
+				hits += loop_equal(lhs[i], rhs[i]);
+			}
+			bench::do_not_optimize(hits);
+		}));
+		bench::report(eq.c_str(), "ft::vector", opts.n, bench::best_of(opts, [&]() {
+			size_t hits = 0;
+			for (size_t i = 0; i < opts.n; ++i)
+			{
+				hits += (lhs[i] == rhs[i]);
+			}
+			bench::do_not_optimize(hits);
+		}));
+		bench::report(lt.c_str(), "element loop", opts.n, bench::best_of(opts, [&]() {
+			size_t hits = 0;
+			for (size_t i = 0; i < opts.n; ++i)
+			{
+				hits += loop_less(lhs[i], rhs[i]);
+			}
+			bench::do_not_optimize(hits);
+		}));
+		bench::report(lt.c_str(), "ft::vector", opts.n, bench::best_of(opts, [&]() {
+			size_t hits = 0;
+			for (size_t i = 0; i < opts.n; ++i)
+			{
+				hits += (lhs[i] < rhs[i]);
+			}
+			bench::do_not_optimize(hits);
+		}));
+	}
+
+	void compare(const bench::options& opts)
+	{
+		run<uint8_t>(opts, "compare/fingerprint", 32);
+		run<int>(opts, "compare/int row", 256);
+	}
+}
+
+BENCH_CASE("compare", compare);
@@ -0,0 +1,87 @@
+#include "include/bench.hpp"
+
+#include "concurrent_stack.hpp"
+#include "stack.hpp"
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Contention: 1..threads threads each doing push/pop pairs on one shared stack,
+// the lock-free concurrent_stack against an ft::stack behind a mutex.
+
+namespace
+{
+	struct locked_stack
+	{
+		std::mutex			mutex;
+		ft::stack<long>		stack;
+
+		void push(long value)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stack.push(value);
+		}
+
+		bool try_pop(long& value)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (stack.empty())
+			{
+				return false;
+			}
+			value = stack.top();
+			stack.pop();
+			return true;
+		}
+	};
+
+	template <typename Stack>
+	void push_pop_pairs(Stack& stack, int threads, size_t pairs_per_thread)
+	{
+		std::vector<std::thread> workers;
+		for (int t = 0; t < threads; ++t)
+		{
+			workers.push_back(std::thread([&stack, pairs_per_thread]() {
+				long value = 0;
+				long sum = 0;
+				for (size_t i = 0; i < pairs_per_thread; ++i)
+				{
+					stack.push(static_cast<long>(i));
+					if (stack.try_pop(value))
+					{
+						sum += value;
+					}
+				}
+				bench::do_not_optimize(sum);
+			}));
+		}
+		for (size_t t = 0; t < workers.size(); ++t)
+		{
+			workers[t].join();
+		}
+	}
+
+	void stack_contention(const bench::options& opts)
+	{
+		std::vector<int> sweep;
+		for (int threads = 1; threads < opts.threads; threads *= 2)
+		{
+			sweep.push_back(threads);
+		}
+		sweep.push_back(opts.threads);
+		for (size_t s = 0; s < sweep.size(); ++s)
+		{
+			const int threads = sweep[s];
+			const size_t operations = 2 * opts.n * threads;
+			std::string variant = std::to_string(threads) + " threads";
+			ft::concurrent_stack<long> lock_free;
+			double seconds = bench::best_of(opts, [&]() { push_pop_pairs(lock_free, threads, opts.n); });
+			bench::report("stack/push_pop", (variant + ", lock-free").c_str(), operations, seconds);
+			locked_stack locked;
+			seconds = bench::best_of(opts, [&]() { push_pop_pairs(locked, threads, opts.n); });
+			bench::report("stack/push_pop", (variant + ", mutex").c_str(), operations, seconds);
+		}
+	}
+}
+
+BENCH_CASE("stack", stack_contention);
@@ -0,0 +1,83 @@
+#include "include/bench.hpp"
+
+#include "map.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <random>
+#include <string>
+
+// A batch of n random probes (half of them hits) against an ft::map of n keys inserted in random order:
+// one find() per key, find_many() with interleaved descents, contains_many() into a bitmap, then ft::parallel::find_many with 1..threads workers,
+// with the probes as given and sorted first.
+
+namespace
+{
+	typedef ft::map<int, int>	map_type;
+
+	void find_many(const bench::options& opts)
+	{
+		std::mt19937 rng(42);
+		std::vector<int> keys(opts.n);
+		for (size_t i = 0; i < opts.n; ++i)
+		{
+			keys[i] = static_cast<int>(2 * i);
+		}
+		std::shuffle(keys.begin(), keys.end(), rng);
+		map_type m;
+		for (size_t i = 0; i < keys.size(); ++i)
+		{
+			m.insert(map_type::value_type(keys[i], keys[i]));
+		}
+		ft::vector<int> probes;
+		for (size_t i = 0; i < opts.n; ++i)
+		{
+			probes.push_back(static_cast<int>(rng() % (2 * opts.n)));
+		}
+		const map_type& const_map = m;
+		std::vector<map_type::const_iterator> found(opts.n);
+
+		double seconds = bench::best_of(opts, [&]() {
+			for (size_t i = 0; i < probes.size(); ++i)
+			{
+				found[i] = const_map.find(probes[i]);
+			}
+			bench::do_not_optimize(found[opts.n / 2]);
+		});
+		bench::report("find_many", "find() one at a time", opts.n, seconds);
+		seconds = bench::best_of(opts, [&]() {
+			const_map.find_many(probes.begin(), probes.end(), found.begin());
+			bench::do_not_optimize(found[opts.n / 2]);
+		});
+		bench::report("find_many", "find_many, interleaved", opts.n, seconds);
+		std::vector<uint64_t> bitmap((opts.n + 63) / 64);
+		seconds = bench::best_of(opts, [&]() {
+			const_map.contains_many(probes.begin(), probes.end(), &bitmap[0]);
+			bench::do_not_optimize(bitmap[0]);
+		});
+		bench::report("find_many", "contains_many, bitmap", opts.n, seconds);
+
+		std::vector<int> sweep;
+		for (int threads = 1; threads < opts.threads; threads *= 2)
+		{
+			sweep.push_back(threads);
+		}
+		sweep.push_back(opts.threads);
+		for (size_t s = 0; s < sweep.size(); ++s)
+		{
+			ft::fork_join_pool pool(sweep[s]);
+			std::string variant = "parallel, " + std::to_string(sweep[s]) + " threads";
+			seconds = bench::best_of(opts, [&]() {
+				ft::parallel::find_many(pool, const_map, probes.begin(), probes.end(), found.begin(), ft::parallel::probe_as_given);
+				bench::do_not_optimize(found[opts.n / 2]);
+			});
+			bench::report("find_many", (variant + ", as given").c_str(), opts.n, seconds);
+			seconds = bench::best_of(opts, [&]() {
+				ft::parallel::find_many(pool, const_map, probes.begin(), probes.end(), found.begin(), ft::parallel::probe_sorted);
+				bench::do_not_optimize(found[opts.n / 2]);
+			});
+			bench::report("find_many", (variant + ", sorted").c_str(), opts.n, seconds);
+		}
+	}
+}
+
+BENCH_CASE("find_many", find_many);
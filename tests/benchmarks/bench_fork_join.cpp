@@ -0,0 +1,149 @@
+#include "include/bench.hpp"
+
+#include "concurrency/fork_join_pool.hpp"
+#include "map.hpp"
+#include "stack.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+
+// Parallel tree sum over an ft::map: the key range is split in halves down to leaves of `grain` keys,
+// each leaf is summed with for_each_range. The fork-join pool on work-stealing deques against the same
+// recursion scheduled through one ft::stack of tasks behind a global lock.
+
+namespace
+{
+	typedef ft::map<int, long>		map_type;
+	typedef map_type::value_type	value_type;
+
+	const int grain = 2048;
+
+	long sum_leaf(const map_type& m, int lo, int hi)
+	{
+		long sum = 0;
+		m.for_each_range(lo, hi, [&sum](const value_type& value) { sum += value.second; });
+		return sum;
+	}
+
+	long fork_join_sum(ft::fork_join_pool& pool, const map_type& m, int lo, int hi)
+	{
+		if (hi - lo <= grain)
+		{
+			return sum_leaf(m, lo, hi);
+		}
+		int mid = lo + (hi - lo) / 2;
+		long left = 0;
+		long right = 0;
+		pool.fork_join([&]() { left = fork_join_sum(pool, m, lo, mid); }, [&]() { right = fork_join_sum(pool, m, mid, hi); });
+		return left + right;
+	}
+
+	// the global lock design: every split pushes both halves to the shared stack
+	class locked_stack_pool
+	{
+	public:
+		long sum(const map_type& m, int lo, int hi, int threads)
+		{
+			_total = 0;
+			_pending = 1;
+			_tasks.push(range(lo, hi));
+			std::vector<std::thread> workers;
+			for (int t = 0; t < threads; ++t)
+			{
+				workers.push_back(std::thread([this, &m]() { work(m); }));
+			}
+			for (size_t t = 0; t < workers.size(); ++t)
+			{
+				workers[t].join();
+			}
+			return _total;
+		}
+
+	private:
+		typedef std::pair<int, int> range;
+
+		std::mutex					_mutex;
+		std::condition_variable		_changed;
+		ft::stack<range>			_tasks;
+		size_t						_pending; // pushed and not finished yet
+		long						_total;
+
+		void work(const map_type& m)
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			while (true)
+			{
+				_changed.wait(lock, [this]() { return !_tasks.empty() || _pending == 0; });
+				if (_pending == 0)
+				{
+					return;
+				}
+				range task = _tasks.top();
+				_tasks.pop();
+				if (task.second - task.first > grain)
+				{
+					int mid = task.first + (task.second - task.first) / 2;
+					_tasks.push(range(task.first, mid));
+					_tasks.push(range(mid, task.second));
+					++_pending;
+					_changed.notify_all();
+					continue;
+				}
+				lock.unlock();
+				long sum = sum_leaf(m, task.first, task.second);
+				lock.lock();
+				_total += sum;
+				if (--_pending == 0)
+				{
+					_changed.notify_all();
+				}
+			}
+		}
+	};
+
+	void tree_sum(const bench::options& opts)
+	{
+		std::vector<int> keys(opts.n);
+		for (size_t i = 0; i < opts.n; ++i)
+		{
+			keys[i] = static_cast<int>(i);
+		}
+		std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+		map_type m;
+		for (size_t i = 0; i < keys.size(); ++i)
+		{
+			m.insert(value_type(keys[i], keys[i]));
+		}
+		const int hi = static_cast<int>(opts.n);
+
+		double seconds = bench::best_of(opts, [&]() { bench::do_not_optimize(sum_leaf(m, 0, hi)); });
+		bench::report("tree_sum", "sequential for_each_range", opts.n, seconds);
+
+		std::vector<int> sweep;
+		for (int threads = 1; threads < opts.threads; threads *= 2)
+		{
+			sweep.push_back(threads);
+		}
+		sweep.push_back(opts.threads);
+		for (size_t s = 0; s < sweep.size(); ++s)
+		{
+			const int threads = sweep[s];
+			std::string variant = std::to_string(threads) + " threads";
+			ft::fork_join_pool pool(threads);
+			seconds = bench::best_of(opts, [&]() {
+				long sum = 0;
+				pool.run([&]() { sum = fork_join_sum(pool, m, 0, hi); });
+				bench::do_not_optimize(sum);
+			});
+			bench::report("tree_sum", (variant + ", fork-join pool").c_str(), opts.n, seconds);
+			locked_stack_pool locked;
+			seconds = bench::best_of(opts, [&]() { bench::do_not_optimize(locked.sum(m, 0, hi, threads)); });
+			bench::report("tree_sum", (variant + ", locked ft::stack").c_str(), opts.n, seconds);
+		}
+	}
+}
+
+BENCH_CASE("tree_sum", tree_sum);
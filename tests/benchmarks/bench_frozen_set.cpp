@@ -0,0 +1,81 @@
+#include "include/bench.hpp"
+
+#include "frozen_map.hpp"
+#include "set.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <stdint.h>
+
+// Random lookups (half of them hits) in n keys, for n = 1e3, 1e4, ... up to -n: ft::set::find, std::lower_bound on
+// the sorted array and ft::frozen_set::find (Eytzinger order). The ft::set is only built up to 1e7 keys (32 bytes
+// a node); -n 1000000000 compares the sorted array and the frozen set at 1e9 keys (4 GB each).
+
+namespace
+{
+	enum { max_tree_keys = 10000000 };
+
+	void lookups(const bench::options& opts, size_t n, const std::vector<uint32_t>& probes)
+	{
+		std::vector<uint32_t> sorted(n);
+		for (size_t i = 0; i < n; ++i)
+		{
+			sorted[i] = static_cast<uint32_t>(2 * i);
+		}
+		char name[64];
+		std::snprintf(name, sizeof(name), "frozen_set/find n=%zu", n);
+		double seconds;
+		if (n <= max_tree_keys)
+		{
+			ft::set<uint32_t> tree;
+			tree.assign_sorted_unique(sorted.begin(), sorted.end());
+			seconds = bench::best_of(opts, [&]() {
+				size_t hits = 0;
+				for (size_t i = 0; i < probes.size(); ++i)
+				{
+					hits += tree.find(probes[i] % (2 * n)) != tree.end();
+				}
+				bench::do_not_optimize(hits);
+			});
+			bench::report(name, "ft::set", probes.size(), seconds);
+		}
+		seconds = bench::best_of(opts, [&]() {
+			size_t hits = 0;
+			for (size_t i = 0; i < probes.size(); ++i)
+			{
+				uint32_t key = static_cast<uint32_t>(probes[i] % (2 * n));
+				std::vector<uint32_t>::const_iterator it = std::lower_bound(sorted.begin(), sorted.end(), key);
+				hits += it != sorted.end() && *it == key;
+			}
+			bench::do_not_optimize(hits);
+		});
+		bench::report(name, "sorted array, std::lower_bound", probes.size(), seconds);
+		ft::frozen_set<uint32_t> frozen(sorted.begin(), sorted.end());
+		std::vector<uint32_t>().swap(sorted);
+		seconds = bench::best_of(opts, [&]() {
+			size_t hits = 0;
+			for (size_t i = 0; i < probes.size(); ++i)
+			{
+				hits += frozen.find(static_cast<uint32_t>(probes[i] % (2 * n))) != frozen.end();
+			}
+			bench::do_not_optimize(hits);
+		});
+		bench::report(name, "ft::frozen_set", probes.size(), seconds);
+	}
+
+	void frozen_set(const bench::options& opts)
+	{
+		std::mt19937 rng(42);
+		std::vector<uint32_t> probes(1000000);
+		for (size_t i = 0; i < probes.size(); ++i)
+		{
+			probes[i] = static_cast<uint32_t>(rng());
+		}
+		for (size_t n = 1000; n <= opts.n; n *= 10)
+		{
+			lookups(opts, n, probes);
+		}
+	}
+}
+
+BENCH_CASE("frozen_set", frozen_set);
@@ -0,0 +1,110 @@
+#include "include/bench.hpp"
+
+#include "huge_page_allocator.hpp"
+#include "vector.hpp"
+#include <random>
+#include <stdint.h>
+
+// A TLB-miss-heavy column: a vector of 16 * n uint64 (128 MB for n = 1M) read at random, as a dependent chain
+// (each element is the index of the next one, a single random cycle, so every step waits for its translation)
+// and as n independent random gathers. On std::allocator (4 KiB pages) against huge_page_allocator with normal
+// pages, transparent huge pages and reserved huge pages (which fall back to transparent ones when none are
+// reserved). Also the time to allocate and fill the column, with and without prefault.
+
+namespace
+{
+	template <class Column>
+	void fill_cycle(Column& column, size_t size)
+	{
+		// Sattolo's shuffle: one cycle through every element
+		std::mt19937_64 rng(42);
+		column.resize(size);
+		for (size_t i = 0; i < size; ++i)
+		{
+			column[i] = i;
+		}
+		for (size_t i = size - 1; i > 0; --i)
+		{
+			size_t j = rng() % i;
+			uint64_t tmp = column[i];
+			column[i] = column[j];
+			column[j] = tmp;
+		}
+	}
+
+	template <class Column>
+	void random_access(const bench::options& opts, const char* variant, const Column& column)
+	{
+		double seconds = bench::best_of(opts, [&]() {
+			uint64_t at = 0;
+			for (size_t i = 0; i < opts.n; ++i)
+			{
+				at = column[at];
+			}
+			bench::do_not_optimize(at);
+		});
+		bench::report("huge_pages/dependent chain", variant, opts.n, seconds);
+
+		seconds = bench::best_of(opts, [&]() {
+			uint64_t sum = 0;
+			uint64_t x = 88172645463325252ULL;
+			for (size_t i = 0; i < opts.n; ++i)
+			{
+				x ^= x << 13;
+				x ^= x >> 7;
+				x ^= x << 17;
+				sum += column[x % column.size()];
+			}
+			bench::do_not_optimize(sum);
+		});
+		bench::report("huge_pages/random gather", variant, opts.n, seconds);
+	}
+
+	typedef ft::huge_page_allocator<uint64_t>	huge_alloc;
+	typedef ft::vector<uint64_t, huge_alloc>	huge_column;
+
+	void run_huge(const bench::options& opts, const char* variant, ft::huge_page_options::page_mode pages)
+	{
+		ft::huge_page_options huge;
+		huge.pages = pages;
+		huge_column column(huge);
+		fill_cycle(column, opts.n * 16);
+		random_access(opts, variant, column);
+	}
+
+	void huge_pages(const bench::options& opts)
+	{
+		const size_t size = opts.n * 16;
+		{
+			ft::vector<uint64_t> column;
+			fill_cycle(column, size);
+			random_access(opts, "std::allocator", column);
+		}
+		run_huge(opts, "huge_page_allocator, normal pages", ft::huge_page_options::huge_pages_none);
+		run_huge(opts, "huge_page_allocator, transparent", ft::huge_page_options::huge_pages_transparent);
+		run_huge(opts, "huge_page_allocator, explicit", ft::huge_page_options::huge_pages_explicit);
+
+		// allocation and first write of the whole column: prefault moves the faults into allocate()
+		for (int prefault = 0; prefault < 2; ++prefault)
+		{
+			ft::huge_page_options huge;
+			huge.prefault = prefault != 0;
+			huge_alloc alloc(huge);
+			bench::timer t;
+			uint64_t* p = alloc.allocate(size);
+			double allocate_seconds = t.seconds();
+			t.restart();
+			for (size_t i = 0; i < size; ++i)
+			{
+				p[i] = i;
+			}
+			double fill_seconds = t.seconds();
+			bench::do_not_optimize(p[size / 2]);
+			alloc.deallocate(p, size);
+			bench::report("huge_pages/allocate", prefault ? "transparent, prefault" : "transparent", size, allocate_seconds);
+			bench::report("huge_pages/first fill", prefault ? "transparent, prefault" : "transparent", size, fill_seconds);
+		}
+	}
+}
+
+BENCH_CASE("huge_pages", huge_pages);
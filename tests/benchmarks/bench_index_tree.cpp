@@ -0,0 +1,126 @@
+#include "include/bench.hpp"
+
+#include "set.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <set>
+#include <stdint.h>
+
+// An ft::set<uint32_t> of n keys inserted in random order, with the compact layout (pointer links, one allocation
+// per node) and with the index layout (uint32_t links, nodes in the segments of a slab): insertion, random find(),
+// a full scan, then erasing and re-inserting half of the keys (the slots come back from the free list).
+// The bytes allocated per element are printed after the timings.
+
+namespace
+{
+	size_t g_allocated = 0;
+
+	// std::allocator that counts the bytes currently allocated by all its instances
+	template <class T>
+	struct counting_allocator : public std::allocator<T>
+	{
+		template <class U>
+		struct rebind
+		{
+			typedef counting_allocator<U> other;
+		};
+
+		counting_allocator() {}
+
+		template <class U>
+		counting_allocator(const counting_allocator<U>&) {}
+
+		T* allocate(size_t n, const void* = 0)
+		{
+			g_allocated += n * sizeof(T);
+			return std::allocator<T>::allocate(n);
+		}
+
+		void deallocate(T* p, size_t n)
+		{
+			g_allocated -= n * sizeof(T);
+			std::allocator<T>::deallocate(p, n);
+		}
+	};
+
+	typedef ft::set<uint32_t, std::less<uint32_t>, counting_allocator<uint32_t> >	compact_set;
+	typedef ft::set<uint32_t, std::less<uint32_t>, counting_allocator<uint32_t>,
+		ft::rbtree_index_layout>													index_set;
+
+	template <typename Set>
+	void run(const bench::options& opts, const char* variant, const std::vector<uint32_t>& keys,
+		const std::vector<uint32_t>& probes)
+	{
+		size_t before = g_allocated;
+		size_t bytes = 0;
+		double seconds = bench::best_of(opts, [&]() {
+			Set s;
+			for (size_t i = 0; i < keys.size(); ++i)
+			{
+				s.insert(keys[i]);
+			}
+			bytes = g_allocated - before;
+			bench::do_not_optimize(s.size());
+		});
+		bench::report("index_tree/insert", variant, keys.size(), seconds);
+
+		Set s;
+		for (size_t i = 0; i < keys.size(); ++i)
+		{
+			s.insert(keys[i]);
+		}
+		seconds = bench::best_of(opts, [&]() {
+			size_t hits = 0;
+			for (size_t i = 0; i < probes.size(); ++i)
+			{
+				hits += (s.find(probes[i]) != s.end());
+			}
+			bench::do_not_optimize(hits);
+		});
+		bench::report("index_tree/find", variant, probes.size(), seconds);
+		seconds = bench::best_of(opts, [&]() {
+			uint64_t sum = 0;
+			for (typename Set::const_iterator it = s.begin(); it != s.end(); ++it)
+			{
+				sum += *it;
+			}
+			bench::do_not_optimize(sum);
+		});
+		bench::report("index_tree/scan", variant, s.size(), seconds);
+		seconds = bench::best_of(opts, [&]() {
+			for (size_t i = 0; i < keys.size(); i += 2)
+			{
+				s.erase(keys[i]);
+			}
+			for (size_t i = 0; i < keys.size(); i += 2)
+			{
+				s.insert(keys[i]);
+			}
+		});
+		bench::report("index_tree/erase+insert", variant, keys.size(), seconds);
+		std::printf("%-28s %-32s %10.1f bytes/element\n", "index_tree/memory", variant,
+			keys.empty() ? 0.0 : static_cast<double>(bytes) / keys.size());
+	}
+
+	void index_tree(const bench::options& opts)
+	{
+		std::mt19937 rng(42);
+		std::vector<uint32_t> keys(opts.n);
+		for (size_t i = 0; i < opts.n; ++i)
+		{
+			keys[i] = static_cast<uint32_t>(2 * i);
+		}
+		std::shuffle(keys.begin(), keys.end(), rng);
+		std::vector<uint32_t> probes(opts.n);
+		for (size_t i = 0; i < opts.n; ++i)
+		{
+			probes[i] = static_cast<uint32_t>(rng() % (2 * opts.n + 1));
+		}
+		run<compact_set>(opts, "ft::set (compact)", keys, probes);
+		run<index_set>(opts, "ft::set (index)", keys, probes);
+	}
+}
+
+BENCH_CASE("index_tree", index_tree);
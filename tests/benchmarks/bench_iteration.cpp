@@ -0,0 +1,66 @@
+#include "include/bench.hpp"
+
+#include "map.hpp"
+#include <algorithm>
+#include <map>
+#include <random>
+
+// Full in-order scans: parent-climbing iterators of the compact layout against the
+// successor links of the threaded layout and against std::map.
+// Keys are inserted in random order, so neighbouring keys live in unrelated nodes.
+
+namespace
+{
+	typedef ft::map<int, int>	compact_map;
+	typedef ft::map<int, int, std::less<int>, std::allocator<ft::pair<const int, int> >,
+		ft::rbtree_threaded_layout>	threaded_map;
+
+	std::vector<int> shuffled_keys(size_t n)
+	{
+		std::vector<int> keys(n);
+		for (size_t i = 0; i < n; ++i)
+		{
+			keys[i] = static_cast<int>(i);
+		}
+		std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+		return keys;
+	}
+
+	template <typename Map>
+	void scan(const bench::options& opts, const char* variant, const std::vector<int>& keys)
+	{
+		Map m;
+		for (size_t i = 0; i < keys.size(); ++i)
+		{
+			m.insert(typename Map::value_type(keys[i], keys[i]));
+		}
+		double forward = bench::best_of(opts, [&m]() {
+			long sum = 0;
+			for (typename Map::const_iterator it = m.begin(); it != m.end(); ++it)
+			{
+				sum += it->second;
+			}
+			bench::do_not_optimize(sum);
+		});
+		bench::report("iteration/forward", variant, m.size(), forward);
+		double backward = bench::best_of(opts, [&m]() {
+			long sum = 0;
+			for (typename Map::const_reverse_iterator it = m.rbegin(); it != m.rend(); ++it)
+			{
+				sum += it->second;
+			}
+			bench::do_not_optimize(sum);
+		});
+		bench::report("iteration/backward", variant, m.size(), backward);
+	}
+
+	void iteration(const bench::options& opts)
+	{
+		std::vector<int> keys = shuffled_keys(opts.n);
+		scan<compact_map>(opts, "ft::map (compact)", keys);
+		scan<threaded_map>(opts, "ft::map (threaded)", keys);
+		scan<std::map<int, int> >(opts, "std::map", keys);
+	}
+}
+
+BENCH_CASE("iteration", iteration);
@@ -0,0 +1,52 @@
+#include "include/bench.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+// usage: containers_benchmarks [-n elements] [-r repeats] [-t threads] [filter]
+int main(int argc, char** argv)
+{
+	bench::options opts;
+	opts.n = 1000000;
+	opts.repeats = 5;
+	opts.threads = static_cast<int>(std::thread::hardware_concurrency());
+	if (opts.threads < 1)
+	{
+		opts.threads = 1;
+	}
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+		{
+			opts.n = std::strtoul(argv[++i], NULL, 10);
+		}
+		else if (std::strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+		{
+			opts.repeats = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+		{
+			opts.threads = std::atoi(argv[++i]);
+		}
+		else
+		{
+			opts.filter = argv[i];
+		}
+	}
+	if (opts.repeats < 1)
+	{
+		opts.repeats = 1;
+	}
+	std::printf("n = %lu, best of %d, up to %d threads\n",
+		static_cast<unsigned long>(opts.n), opts.repeats, opts.threads);
+	const std::vector<bench::bench_case>& cases = bench::registry();
+	for (size_t i = 0; i < cases.size(); ++i)
+	{
+		if (opts.filter.empty() || std::strstr(cases[i].name, opts.filter.c_str()) != NULL)
+		{
+			cases[i].function(opts);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,90 @@
+#include "include/bench.hpp"
+
+#include "map_snapshot.hpp"
+#include <cstdio>
+#include <fstream>
+#include <random>
+
+// Restart of an index of n int -> int: re-read from an ofstream dump and inserted one by one (the old way),
+// against load_snapshot() (mapped file + linear bulk build into one arena) and opening a mapped_map view.
+// Then n random finds on the rebuilt ft::map against the same finds on the mapped_map (binary search in the file).
+
+namespace
+{
+	typedef ft::map<int, int>	map_type;
+
+	void map_snapshot_restart(const bench::options& opts)
+	{
+		const char* stream_path = "bench_index.stream";
+		const char* snapshot_path = "bench_index.snapshot";
+		std::mt19937 rng(42);
+		map_type m;
+		while (m.size() < opts.n)
+		{
+			int key = static_cast<int>(rng() % (4 * opts.n));
+			m[key] = key;
+		}
+		{
+			std::ofstream out(stream_path, std::ios::binary | std::ios::trunc);
+			for (map_type::const_iterator it = m.begin(); it != m.end(); ++it)
+			{
+				out.write(reinterpret_cast<const char*>(&it->first), sizeof(int));
+				out.write(reinterpret_cast<const char*>(&it->second), sizeof(int));
+			}
+		}
+		double seconds = bench::best_of(opts, [&]() { ft::save_snapshot(m, snapshot_path); });
+		bench::report("map_snapshot/save", "save_snapshot", opts.n, seconds);
+
+		seconds = bench::best_of(opts, [&]() {
+			std::ifstream in(stream_path, std::ios::binary);
+			map_type loaded;
+			int kv[2];
+			while (in.read(reinterpret_cast<char*>(kv), sizeof(kv)))
+			{
+				loaded.insert(map_type::value_type(kv[0], kv[1]));
+			}
+			bench::do_not_optimize(loaded.size());
+		});
+		bench::report("map_snapshot/load", "ifstream + insert one by one", opts.n, seconds);
+		seconds = bench::best_of(opts, [&]() {
+			map_type loaded;
+			ft::load_snapshot(loaded, snapshot_path);
+			bench::do_not_optimize(loaded.size());
+		});
+		bench::report("map_snapshot/load", "load_snapshot (bulk build)", opts.n, seconds);
+		seconds = bench::best_of(opts, [&]() {
+			ft::mapped_map<int, int> view(snapshot_path);
+			bench::do_not_optimize(view.size());
+		});
+		bench::report("map_snapshot/load", "mapped_map open", opts.n, seconds);
+
+		std::vector<int> probes(opts.n);
+		for (size_t i = 0; i < probes.size(); ++i)
+		{
+			probes[i] = static_cast<int>(rng() % (4 * opts.n));
+		}
+		seconds = bench::best_of(opts, [&]() {
+			long found = 0;
+			for (size_t i = 0; i < probes.size(); ++i)
+			{
+				found += m.find(probes[i]) != m.end();
+			}
+			bench::do_not_optimize(found);
+		});
+		bench::report("map_snapshot/find", "ft::map", opts.n, seconds);
+		ft::mapped_map<int, int> view(snapshot_path);
+		seconds = bench::best_of(opts, [&]() {
+			long found = 0;
+			for (size_t i = 0; i < probes.size(); ++i)
+			{
+				found += view.find(probes[i]) != view.end();
+			}
+			bench::do_not_optimize(found);
+		});
+		bench::report("map_snapshot/find", "mapped_map", opts.n, seconds);
+		std::remove(stream_path);
+		std::remove(snapshot_path);
+	}
+}
+
+BENCH_CASE("map_snapshot", map_snapshot_restart);
@@ -0,0 +1,72 @@
+#include "include/bench.hpp"
+
+#include "mapped_vector.hpp"
+#include "vector.hpp"
+#include <cstdio>
+#include <fstream>
+#include <stdint.h>
+
+// Persisting n uint64_t: written element by element through an ofstream and reloaded by push_back into an ft::vector,
+// against a mapped_vector filled by push_back and closed, then reopened (the open alone, and the open plus a sum of all
+// the elements, which reads the pages from the page cache). The files are in the current directory and removed afterwards.
+
+namespace
+{
+	typedef ft::mapped_vector<uint64_t>	column_type;
+
+	void mapped_vector_persist(const bench::options& opts)
+	{
+		const char* stream_path = "bench_column.stream";
+		const char* mapped_path = "bench_column.mapped";
+
+		double seconds = bench::best_of(opts, [&]() {
+			std::ofstream out(stream_path, std::ios::binary | std::ios::trunc);
+			for (uint64_t i = 0; i < opts.n; ++i)
+			{
+				out.write(reinterpret_cast<const char*>(&i), sizeof(i));
+			}
+		});
+		bench::report("mapped_vector/write", "ofstream, one write per element", opts.n, seconds);
+		seconds = bench::best_of(opts, [&]() {
+			column_type column(mapped_path, column_type::open_create);
+			for (uint64_t i = 0; i < opts.n; ++i)
+			{
+				column.push_back(i);
+			}
+		});
+		bench::report("mapped_vector/write", "mapped_vector push_back + close", opts.n, seconds);
+
+		seconds = bench::best_of(opts, [&]() {
+			std::ifstream in(stream_path, std::ios::binary);
+			ft::vector<uint64_t> v;
+			uint64_t value;
+			while (in.read(reinterpret_cast<char*>(&value), sizeof(value)))
+			{
+				v.push_back(value);
+			}
+			bench::do_not_optimize(v.size());
+		});
+		bench::report("mapped_vector/reload", "ifstream + ft::vector push_back", opts.n, seconds);
+		seconds = bench::best_of(opts, [&]() {
+			column_type column(mapped_path, column_type::open_read_only);
+			bench::do_not_optimize(column.size());
+		});
+		bench::report("mapped_vector/reload", "mapped_vector open", opts.n, seconds);
+		seconds = bench::best_of(opts, [&]() {
+			column_type column(mapped_path, column_type::open_read_only);
+			column.advise(column_type::advice_sequential);
+			const column_type& elements = column;
+			uint64_t sum = 0;
+			for (column_type::const_iterator it = elements.begin(); it != elements.end(); ++it)
+			{
+				sum += *it;
+			}
+			bench::do_not_optimize(sum);
+		});
+		bench::report("mapped_vector/reload", "mapped_vector open + sum", opts.n, seconds);
+		std::remove(stream_path);
+		std::remove(mapped_path);
+	}
+}
+
+BENCH_CASE("mapped_vector", mapped_vector_persist);
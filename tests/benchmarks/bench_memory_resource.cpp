@@ -0,0 +1,114 @@
+#include "include/bench.hpp"
+
+#include "memory_resource.hpp"
+#include <functional>
+
+// The request of bench_arena (a scratch vector of 256 ints, a map of 64 entries, 64 lookups) on pmr containers:
+// the same container types over the heap (new_delete_resource), a pool resource and a monotonic buffer on the
+// stack released after each request, against the std::allocator containers. ops are requests.
+
+namespace
+{
+	typedef ft::map<int, int>	std_map;
+
+	__attribute__((noinline)) long std_request(int seed)
+	{
+		ft::vector<int> scratch;
+		for (int i = 0; i < 256; ++i)
+		{
+			scratch.push_back(i ^ seed);
+		}
+		std_map lookup;
+		for (int i = 0; i < 64; ++i)
+		{
+			lookup[scratch[i * 4]] = i;
+		}
+		long found = 0;
+		for (int i = 0; i < 64; ++i)
+		{
+			found += lookup.count(scratch[i * 3]);
+		}
+		return found;
+	}
+
+	// one function for every resource: the container types don't change with the strategy
+	__attribute__((noinline)) long pmr_request(ft::memory_resource* resource, int seed)
+	{
+		ft::pmr::vector<int> scratch(resource);
+		for (int i = 0; i < 256; ++i)
+		{
+			scratch.push_back(i ^ seed);
+		}
+		ft::pmr::map<int, int> lookup(std::less<int>(), resource);
+		for (int i = 0; i < 64; ++i)
+		{
+			lookup[scratch[i * 4]] = i;
+		}
+		long found = 0;
+		for (int i = 0; i < 64; ++i)
+		{
+			found += lookup.count(scratch[i * 3]);
+		}
+		return found;
+	}
+
+	void memory_resource_requests(const bench::options& opts)
+	{
+		const size_t requests = opts.n / 64 + 1;
+		double seconds = bench::best_of(opts, [&]() {
+			long found = 0;
+			for (size_t r = 0; r < requests; ++r)
+			{
+				found += std_request(static_cast<int>(r));
+			}
+			bench::do_not_optimize(found);
+		});
+		bench::report("memory_resource/request", "std::allocator", requests, seconds);
+
+		seconds = bench::best_of(opts, [&]() {
+			long found = 0;
+			for (size_t r = 0; r < requests; ++r)
+			{
+				found += pmr_request(ft::new_delete_resource(), static_cast<int>(r));
+			}
+			bench::do_not_optimize(found);
+		});
+		bench::report("memory_resource/request", "pmr new_delete_resource", requests, seconds);
+
+		ft::unsynchronized_pool_resource pools;
+		seconds = bench::best_of(opts, [&]() {
+			long found = 0;
+			for (size_t r = 0; r < requests; ++r)
+			{
+				found += pmr_request(&pools, static_cast<int>(r));
+			}
+			bench::do_not_optimize(found);
+		});
+		bench::report("memory_resource/request", "pmr unsynchronized_pool_resource", requests, seconds);
+
+		ft::synchronized_pool_resource shared_pools;
+		seconds = bench::best_of(opts, [&]() {
+			long found = 0;
+			for (size_t r = 0; r < requests; ++r)
+			{
+				found += pmr_request(&shared_pools, static_cast<int>(r));
+			}
+			bench::do_not_optimize(found);
+		});
+		bench::report("memory_resource/request", "pmr synchronized_pool_resource", requests, seconds);
+
+		char buffer[32768];
+		seconds = bench::best_of(opts, [&]() {
+			long found = 0;
+			for (size_t r = 0; r < requests; ++r)
+			{
+				ft::monotonic_buffer_resource local(buffer, sizeof(buffer));
+				found += pmr_request(&local, static_cast<int>(r));
+			}
+			bench::do_not_optimize(found);
+		});
+		bench::report("memory_resource/request", "pmr monotonic buffer on the stack", requests, seconds);
+	}
+}
+
+BENCH_CASE("memory_resource", memory_resource_requests);
@@ -0,0 +1,137 @@
+#include "include/bench.hpp"
+
+#include "parallel.hpp"
+#include "set.hpp"
+#include "vector.hpp"
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <string>
+
+// Scaling of the ft::parallel algorithms over an ft::vector of n elements, from 1 thread up to -t threads
+// (run with -t 64 on a 64 core machine), against the sequential std algorithm on the same data.
+// The sorts are timed without the copy of the unsorted input.
+// parallel_build: an ft::set built from the same unsorted vector by insertion, by ft::parallel::build with 1..threads
+// workers (sort, dedup, one arena, bottom up linking), and the time to destroy the built set.
+
+namespace
+{
+	typedef ft::vector<int>	vector_type;
+
+	template <typename Sort>
+	double best_sort(const bench::options& opts, const vector_type& input, Sort sort)
+	{
+		double best = 0;
+		for (int i = 0; i < opts.repeats; ++i)
+		{
+			vector_type v(input);
+			bench::timer t;
+			sort(v);
+			double elapsed = t.seconds();
+			bench::do_not_optimize(v[v.size() / 2]);
+			if (i == 0 || elapsed < best)
+			{
+				best = elapsed;
+			}
+		}
+		return best;
+	}
+
+	void parallel_algorithms(const bench::options& opts)
+	{
+		vector_type input;
+		std::mt19937 rng(42);
+		for (size_t i = 0; i < opts.n; ++i)
+		{
+			input.push_back(static_cast<int>(rng() % 1000000));
+		}
+		vector_type out(opts.n, 0);
+
+		double seconds = best_sort(opts, input, [](vector_type& v) { std::sort(v.begin(), v.end()); });
+		bench::report("parallel/sort", "std::sort", opts.n, seconds);
+		seconds = best_sort(opts, input, [](vector_type& v) { std::stable_sort(v.begin(), v.end()); });
+		bench::report("parallel/stable_sort", "std::stable_sort", opts.n, seconds);
+		seconds = bench::best_of(opts, [&]() { std::transform(input.begin(), input.end(), out.begin(), [](int x) { return x * 3 + 1; }); });
+		bench::report("parallel/transform", "std::transform", opts.n, seconds);
+		seconds = bench::best_of(opts, [&]() { bench::do_not_optimize(std::accumulate(input.begin(), input.end(), 0L)); });
+		bench::report("parallel/reduce", "std::accumulate", opts.n, seconds);
+		seconds = bench::best_of(opts, [&]() { std::partial_sum(input.begin(), input.end(), out.begin()); });
+		bench::report("parallel/inclusive_scan", "std::partial_sum", opts.n, seconds);
+
+		std::vector<int> sweep;
+		for (int threads = 1; threads < opts.threads; threads *= 2)
+		{
+			sweep.push_back(threads);
+		}
+		sweep.push_back(opts.threads);
+		for (size_t s = 0; s < sweep.size(); ++s)
+		{
+			ft::fork_join_pool pool(sweep[s]);
+			std::string variant = "ft::parallel, " + std::to_string(sweep[s]) + " threads";
+			seconds = best_sort(opts, input, [&pool](vector_type& v) { ft::parallel::sort(pool, v.begin(), v.end(), std::less<int>()); });
+			bench::report("parallel/sort", variant.c_str(), opts.n, seconds);
+			seconds = best_sort(opts, input, [&pool](vector_type& v) { ft::parallel::stable_sort(pool, v.begin(), v.end(), std::less<int>()); });
+			bench::report("parallel/stable_sort", variant.c_str(), opts.n, seconds);
+			seconds = bench::best_of(opts, [&]() {
+				ft::parallel::transform(pool, input.begin(), input.end(), out.begin(), [](int x) { return x * 3 + 1; });
+			});
+			bench::report("parallel/transform", variant.c_str(), opts.n, seconds);
+			seconds = bench::best_of(opts, [&]() {
+				bench::do_not_optimize(ft::parallel::reduce(pool, input.begin(), input.end(), 0L, std::plus<long>()));
+			});
+			bench::report("parallel/reduce", variant.c_str(), opts.n, seconds);
+			seconds = bench::best_of(opts, [&]() {
+				ft::parallel::inclusive_scan(pool, input.begin(), input.end(), out.begin(), std::plus<int>());
+			});
+			bench::report("parallel/inclusive_scan", variant.c_str(), opts.n, seconds);
+		}
+	}
+
+	void parallel_build(const bench::options& opts)
+	{
+		vector_type input;
+		std::mt19937 rng(42);
+		for (size_t i = 0; i < opts.n; ++i)
+		{
+			input.push_back(static_cast<int>(rng() % (opts.n * 2)));
+		}
+		double seconds = bench::best_of(opts, [&]() {
+			ft::set<int> built(input.begin(), input.end());
+			bench::do_not_optimize(built.size());
+		});
+		bench::report("parallel_build/set", "insert one by one + destroy", opts.n, seconds);
+
+		std::vector<int> sweep;
+		for (int threads = 1; threads < opts.threads; threads *= 2)
+		{
+			sweep.push_back(threads);
+		}
+		sweep.push_back(opts.threads);
+		for (size_t s = 0; s < sweep.size(); ++s)
+		{
+			ft::fork_join_pool pool(sweep[s]);
+			std::string variant = "ft::parallel::build, " + std::to_string(sweep[s]) + " threads";
+			double build_best = 0;
+			double destroy_best = 0;
+			for (int i = 0; i < opts.repeats; ++i)
+			{
+				vector_type v(input);
+				bench::timer t;
+				{
+					ft::set<int> built;
+					ft::parallel::build(pool, built, v.begin(), v.end());
+					double elapsed = t.seconds();
+					build_best = (i == 0 || elapsed < build_best) ? elapsed : build_best;
+					t.restart();
+				}
+				double elapsed = t.seconds();
+				destroy_best = (i == 0 || elapsed < destroy_best) ? elapsed : destroy_best;
+			}
+			bench::report("parallel_build/set", variant.c_str(), opts.n, build_best);
+			bench::report("parallel_build/set", "  destroy the built set", opts.n, destroy_best);
+		}
+	}
+}
+
+BENCH_CASE("parallel", parallel_algorithms);
+BENCH_CASE("parallel_build", parallel_build);
@@ -0,0 +1,52 @@
+#include "include/bench.hpp"
+
+#include "map.hpp"
+#include "pmap.hpp"
+#include <random>
+
+// Keeping a version history: every update of a pmap is a new version sharing the untouched nodes,
+// against copying an ft::map before each update. The copies are limited to a few versions.
+
+namespace
+{
+	void persistent_versions(const bench::options& opts)
+	{
+		const size_t versions = 10000;
+		ft::pmap<int, int> base;
+		ft::map<int, int> base_map;
+		for (size_t i = 0; i < opts.n; ++i)
+		{
+			base = base.insert(ft::make_pair(static_cast<int>(i), static_cast<int>(i)));
+			base_map.insert(ft::make_pair(static_cast<int>(i), static_cast<int>(i)));
+		}
+		double seconds = bench::best_of(opts, [&]() {
+			std::vector<ft::pmap<int, int> > history;
+			history.reserve(versions);
+			history.push_back(base);
+			std::mt19937 rng(1);
+			for (size_t v = 1; v < versions; ++v)
+			{
+				history.push_back(history.back().insert_or_assign(static_cast<int>(rng() % opts.n), static_cast<int>(v)));
+			}
+			bench::do_not_optimize(history.back().size());
+		});
+		bench::report("persistent/version", "ft::pmap insert_or_assign", versions, seconds);
+
+		const size_t copies = 10;
+		seconds = bench::best_of(opts, [&]() {
+			std::vector<ft::map<int, int> > history;
+			history.reserve(copies);
+			history.push_back(base_map);
+			std::mt19937 rng(1);
+			for (size_t v = 1; v < copies; ++v)
+			{
+				history.push_back(history.back());
+				history.back()[static_cast<int>(rng() % opts.n)] = static_cast<int>(v);
+			}
+			bench::do_not_optimize(history.back().size());
+		});
+		bench::report("persistent/version", "ft::map copy + operator[]", copies, seconds);
+	}
+}
+
+BENCH_CASE("persistent", persistent_versions);
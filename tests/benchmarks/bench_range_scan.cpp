@@ -0,0 +1,78 @@
+#include "include/bench.hpp"
+
+#include "map.hpp"
+#include <algorithm>
+#include <map>
+#include <random>
+
+// Range scans over the middle half of the keys: an iterator loop from lower_bound(lo) to lower_bound(hi)
+// against for_each_range and for_each_range_batch. Keys are inserted in random order.
+
+namespace
+{
+	typedef ft::map<int, int>		map_type;
+	typedef map_type::value_type	value_type;
+
+	void range_scan(const bench::options& opts)
+	{
+		std::vector<int> keys(opts.n);
+		for (size_t i = 0; i < opts.n; ++i)
+		{
+			keys[i] = static_cast<int>(i);
+		}
+		std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+		map_type m;
+		std::map<int, int> std_map;
+		for (size_t i = 0; i < keys.size(); ++i)
+		{
+			m.insert(value_type(keys[i], keys[i]));
+			std_map.insert(std::make_pair(keys[i], keys[i]));
+		}
+		const int lo = static_cast<int>(opts.n / 4);
+		const int hi = static_cast<int>(opts.n - opts.n / 4);
+		const size_t count = static_cast<size_t>(hi - lo);
+
+		double seconds = bench::best_of(opts, [&]() {
+			long sum = 0;
+			map_type::const_iterator last = m.lower_bound(hi);
+			for (map_type::const_iterator it = m.lower_bound(lo); it != last; ++it)
+			{
+				sum += it->second;
+			}
+			bench::do_not_optimize(sum);
+		});
+		bench::report("range_scan", "ft::map iterator", count, seconds);
+
+		seconds = bench::best_of(opts, [&]() {
+			long sum = 0;
+			m.for_each_range(lo, hi, [&sum](const value_type& value) { sum += value.second; });
+			bench::do_not_optimize(sum);
+		});
+		bench::report("range_scan", "ft::map for_each_range", count, seconds);
+
+		seconds = bench::best_of(opts, [&]() {
+			long sum = 0;
+			m.for_each_range_batch(lo, hi, [&sum](const value_type* const* values, size_t n) {
+				for (size_t i = 0; i < n; ++i)
+				{
+					sum += values[i]->second;
+				}
+			});
+			bench::do_not_optimize(sum);
+		});
+		bench::report("range_scan", "ft::map for_each_range_batch", count, seconds);
+
+		seconds = bench::best_of(opts, [&]() {
+			long sum = 0;
+			std::map<int, int>::const_iterator last = std_map.lower_bound(hi);
+			for (std::map<int, int>::const_iterator it = std_map.lower_bound(lo); it != last; ++it)
+			{
+				sum += it->second;
+			}
+			bench::do_not_optimize(sum);
+		});
+		bench::report("range_scan", "std::map iterator", count, seconds);
+	}
+}
+
+BENCH_CASE("range_scan", range_scan);
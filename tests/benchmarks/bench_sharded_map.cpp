@@ -0,0 +1,144 @@
+#include "include/bench.hpp"
+
+#include "sharded_map.hpp"
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+
+// Session table throughput: 1..threads threads doing a 50/50 mix of finds and writes (insert_or_assign or erase)
+// on random keys of a table of n / 4 keys, an ft::map behind one mutex against sharded_map with 1, 4, 16 and 64 shards.
+// The time is the wall time of all the threads for n operations in total, so ns/op going down means the mix scales.
+
+namespace
+{
+	typedef ft::map<int, int>	map_type;
+
+	struct locked_map
+	{
+		std::mutex	mutex;
+		map_type	map;
+
+		bool find(int key, int& value)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			map_type::const_iterator it = map.find(key);
+			if (it == map.end())
+			{
+				return false;
+			}
+			value = it->second;
+			return true;
+		}
+
+		void insert_or_assign(int key, int value)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			map.insert_or_assign(key, value);
+		}
+
+		void erase(int key)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			map.erase(key);
+		}
+	};
+
+	template <typename Map>
+	double run_mix(const bench::options& opts, Map& m, int key_count, int threads)
+	{
+		for (int key = 0; key < key_count; key += 2)
+		{
+			m.insert_or_assign(key, key);
+		}
+		const size_t ops_per_thread = opts.n / threads;
+		bench::timer t;
+		std::vector<std::thread> workers;
+		for (int w = 0; w < threads; ++w)
+		{
+			workers.push_back(std::thread([&m, key_count, ops_per_thread, w]() {
+				std::mt19937 rng(w + 1);
+				long found = 0;
+				int value = 0;
+				for (size_t i = 0; i < ops_per_thread; ++i)
+				{
+					unsigned r = rng();
+					int key = static_cast<int>((r >> 2) % key_count);
+					switch (r & 3)
+					{
+						case 0:
+						case 1:
+							found += m.find(key, value);
+							break;
+						case 2:
+							m.insert_or_assign(key, static_cast<int>(i));
+							break;
+						default:
+							m.erase(key);
+					}
+				}
+				bench::do_not_optimize(found);
+			}));
+		}
+		for (size_t w = 0; w < workers.size(); ++w)
+		{
+			workers[w].join();
+		}
+		return t.seconds();
+	}
+
+	template <typename Make>
+	double best_mix(const bench::options& opts, int key_count, int threads, Make make)
+	{
+		double best = 0;
+		for (int i = 0; i < opts.repeats; ++i)
+		{
+			typename Make::result_type m(make());
+			double elapsed = run_mix(opts, *m, key_count, threads);
+			if (i == 0 || elapsed < best)
+			{
+				best = elapsed;
+			}
+		}
+		return best;
+	}
+
+	template <typename Map>
+	struct make_map
+	{
+		typedef std::unique_ptr<Map>	result_type;
+
+		result_type operator()() const
+		{
+			return result_type(new Map());
+		}
+	};
+
+	void sharded_map_mix(const bench::options& opts)
+	{
+		const int key_count = static_cast<int>(opts.n / 4) + 1;
+		std::vector<int> sweep;
+		for (int threads = 1; threads < opts.threads; threads *= 2)
+		{
+			sweep.push_back(threads);
+		}
+		sweep.push_back(opts.threads);
+		for (size_t s = 0; s < sweep.size(); ++s)
+		{
+			const int threads = sweep[s];
+			std::string variant = std::to_string(threads) + " threads, ";
+			double seconds = best_mix(opts, key_count, threads, make_map<locked_map>());
+			bench::report("sharded_map", (variant + "ft::map + mutex").c_str(), opts.n, seconds);
+			seconds = best_mix(opts, key_count, threads, make_map<ft::sharded_map<int, int, 1> >());
+			bench::report("sharded_map", (variant + "1 shard").c_str(), opts.n, seconds);
+			seconds = best_mix(opts, key_count, threads, make_map<ft::sharded_map<int, int, 4> >());
+			bench::report("sharded_map", (variant + "4 shards").c_str(), opts.n, seconds);
+			seconds = best_mix(opts, key_count, threads, make_map<ft::sharded_map<int, int, 16> >());
+			bench::report("sharded_map", (variant + "16 shards").c_str(), opts.n, seconds);
+			seconds = best_mix(opts, key_count, threads, make_map<ft::sharded_map<int, int, 64> >());
+			bench::report("sharded_map", (variant + "64 shards").c_str(), opts.n, seconds);
+		}
+	}
+}
+
+BENCH_CASE("sharded_map", sharded_map_mix);
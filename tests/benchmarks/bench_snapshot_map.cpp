@@ -0,0 +1,114 @@
+#include "include/bench.hpp"
+
+#include "concurrent_snapshot_map.hpp"
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+
+// Read scalability: 1..threads readers doing random finds while one writer publishes a change every millisecond,
+// concurrent_snapshot_map against an ft::map behind a mutex. The time is the wall time of all the readers,
+// so ns/op going down with more threads means the reads scale.
+
+namespace
+{
+	typedef ft::concurrent_snapshot_map<int, int>	snapshot_map;
+	typedef snapshot_map::map_type					map_type;
+
+	struct locked_map
+	{
+		std::mutex	mutex;
+		map_type	map;
+
+		bool find(int key, int& value)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			map_type::const_iterator it = map.find(key);
+			if (it == map.end())
+			{
+				return false;
+			}
+			value = it->second;
+			return true;
+		}
+
+		void insert_or_assign(int key, int value)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			map.insert_or_assign(key, value);
+		}
+	};
+
+	template <typename Map>
+	void run_readers(Map& m, int key_count, int readers, size_t reads_per_reader)
+	{
+		std::atomic<bool> done(false);
+		std::thread writer([&]() {
+			int version = 0;
+			while (!done.load(std::memory_order_relaxed))
+			{
+				m.insert_or_assign(version % key_count, version);
+				++version;
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+		});
+		std::vector<std::thread> threads;
+		for (int r = 0; r < readers; ++r)
+		{
+			threads.push_back(std::thread([&m, key_count, reads_per_reader, r]() {
+				std::mt19937 rng(r + 1);
+				long found = 0;
+				int value = 0;
+				for (size_t i = 0; i < reads_per_reader; ++i)
+				{
+					found += m.find(static_cast<int>(rng() % key_count), value);
+				}
+				bench::do_not_optimize(found);
+			}));
+		}
+		for (size_t i = 0; i < threads.size(); ++i)
+		{
+			threads[i].join();
+		}
+		done = true;
+		writer.join();
+	}
+
+	void snapshot_map_readers(const bench::options& opts)
+	{
+		// the writer copies the whole snapshot map on every change, so the table is kept smaller than n
+		const int key_count = static_cast<int>(opts.n < 100000 ? opts.n : 100000);
+		const size_t reads_per_reader = opts.n;
+		snapshot_map snapshots;
+		locked_map locked;
+		snapshots.update([key_count](map_type& m) {
+			for (int i = 0; i < key_count; ++i)
+			{
+				m[i] = i;
+			}
+		});
+		for (int i = 0; i < key_count; ++i)
+		{
+			locked.map[i] = i;
+		}
+		std::vector<int> sweep;
+		for (int readers = 1; readers < opts.threads; readers *= 2)
+		{
+			sweep.push_back(readers);
+		}
+		sweep.push_back(opts.threads); // the sweep always ends with all the threads
+		for (size_t s = 0; s < sweep.size(); ++s)
+		{
+			const int readers = sweep[s];
+			std::string variant = std::to_string(readers) + " readers";
+			size_t reads = reads_per_reader * readers;
+			double seconds = bench::best_of(opts, [&]() { run_readers(snapshots, key_count, readers, reads_per_reader); });
+			bench::report("snapshot_map/find", (variant + ", snapshot").c_str(), reads, seconds);
+			seconds = bench::best_of(opts, [&]() { run_readers(locked, key_count, readers, reads_per_reader); });
+			bench::report("snapshot_map/find", (variant + ", mutex").c_str(), reads, seconds);
+		}
+	}
+}
+
+BENCH_CASE("snapshot_map", snapshot_map_readers);
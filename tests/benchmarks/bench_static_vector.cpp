@@ -0,0 +1,71 @@
+#include "include/bench.hpp"
+
+#include "stack.hpp"
+#include "static_vector.hpp"
+#include "vector.hpp"
+#include <vector>
+
+// n protocol frames of 1 to 64 int fields, each built in a fresh container, summed and dropped: ft::vector,
+// std::vector with reserve(64) and ft::static_vector<int, 64>. Then n pushes and pops on a bounded ft::stack over
+// ft::vector and over ft::static_vector.
+
+namespace
+{
+	template <typename Frame>
+	double frames(const bench::options& opts, bool reserve)
+	{
+		return bench::best_of(opts, [&]() {
+			long sum = 0;
+			for (size_t i = 0; i < opts.n; ++i)
+			{
+				Frame frame;
+				if (reserve)
+				{
+					frame.reserve(64);
+				}
+				size_t fields = 1 + i % 64;
+				for (size_t f = 0; f < fields; ++f)
+				{
+					frame.push_back(static_cast<int>(i + f));
+				}
+				sum += frame.back() + static_cast<long>(frame.size());
+			}
+			bench::do_not_optimize(sum);
+		});
+	}
+
+	template <typename Stack>
+	double stack_churn(const bench::options& opts)
+	{
+		return bench::best_of(opts, [&]() {
+			Stack s;
+			long sum = 0;
+			for (size_t i = 0; i < opts.n; ++i)
+			{
+				if (s.size() == 64)
+				{
+					while (!s.empty())
+					{
+						sum += s.top();
+						s.pop();
+					}
+				}
+				s.push(static_cast<int>(i));
+			}
+			bench::do_not_optimize(sum);
+		});
+	}
+
+	void static_vector(const bench::options& opts)
+	{
+		bench::report("static_vector/frames", "ft::vector", opts.n, frames<ft::vector<int> >(opts, false));
+		bench::report("static_vector/frames", "std::vector + reserve(64)", opts.n, frames<std::vector<int> >(opts, true));
+		bench::report("static_vector/frames", "ft::static_vector<int, 64>", opts.n,
+			frames<ft::static_vector<int, 64> >(opts, false));
+		bench::report("static_vector/stack", "ft::stack<ft::vector>", opts.n, stack_churn<ft::stack<int> >(opts));
+		bench::report("static_vector/stack", "ft::stack<ft::static_vector>", opts.n,
+			stack_churn<ft::stack<int, ft::static_vector<int, 64> > >(opts));
+	}
+}
+
+BENCH_CASE("static_vector", static_vector);
@@ -0,0 +1,104 @@
+#include "include/bench.hpp"
+
+#include "map.hpp"
+#include "tl_pool_allocator.hpp"
+#include <functional>
+#include <string>
+#include <thread>
+
+// Map churn of a multi-threaded service: 1..threads threads each build a short-lived ft::map<int, int> of 64 entries,
+// look it up and destroy it, over and over; one map in eight is left in the next thread's slot when that is empty,
+// and each thread destroys whatever its own slot holds (memory freed on another thread than the one that allocated
+// it, once there are two threads or more). std::allocator against tl_pool_allocator.
+// ops are maps, n / 64 in total, so ns/op going down means the churn scales.
+
+namespace
+{
+	template <class Alloc>
+	struct churn
+	{
+		typedef ft::map<int, int, std::less<int>, Alloc>	map_type;
+
+		static double run(const bench::options& opts, int threads)
+		{
+			const size_t maps_per_thread = opts.n / 64 / threads + 1;
+			std::vector<std::atomic<map_type*> > handoff(threads);
+			for (int w = 0; w < threads; ++w)
+			{
+				handoff[w].store(NULL);
+			}
+			bench::timer t;
+			std::vector<std::thread> workers;
+			for (int w = 0; w < threads; ++w)
+			{
+				workers.push_back(std::thread([&handoff, maps_per_thread, threads, w]() {
+					long found = 0;
+					for (size_t r = 0; r < maps_per_thread; ++r)
+					{
+						map_type* m = new map_type();
+						for (int i = 0; i < 64; ++i)
+						{
+							(*m)[static_cast<int>(r) * 7 + i * 13] = i;
+						}
+						for (int i = 0; i < 64; ++i)
+						{
+							found += m->count(i * 11);
+						}
+						map_type* empty = NULL;
+						if (r % 8 != 0 || !handoff[(w + 1) % threads].compare_exchange_strong(empty, m))
+						{
+							delete m;
+						}
+						delete handoff[w].exchange(NULL);
+					}
+					bench::do_not_optimize(found);
+				}));
+			}
+			for (size_t w = 0; w < workers.size(); ++w)
+			{
+				workers[w].join();
+			}
+			for (int w = 0; w < threads; ++w)
+			{
+				delete handoff[w].load();
+			}
+			return t.seconds();
+		}
+
+		static double best(const bench::options& opts, int threads)
+		{
+			double best = 0;
+			for (int i = 0; i < opts.repeats; ++i)
+			{
+				double elapsed = run(opts, threads);
+				if (i == 0 || elapsed < best)
+				{
+					best = elapsed;
+				}
+			}
+			return best;
+		}
+	};
+
+	void tl_pool_churn(const bench::options& opts)
+	{
+		const size_t maps = opts.n / 64 + 1;
+		std::vector<int> sweep;
+		for (int threads = 1; threads < opts.threads; threads *= 2)
+		{
+			sweep.push_back(threads);
+		}
+		sweep.push_back(opts.threads);
+		for (size_t s = 0; s < sweep.size(); ++s)
+		{
+			const int threads = sweep[s];
+			std::string variant = std::to_string(threads) + " threads, ";
+			double seconds = churn<std::allocator<ft::pair<const int, int> > >::best(opts, threads);
+			bench::report("tl_pool/map churn", (variant + "std::allocator").c_str(), maps, seconds);
+			seconds = churn<ft::tl_pool_allocator<ft::pair<const int, int> > >::best(opts, threads);
+			bench::report("tl_pool/map churn", (variant + "tl_pool_allocator").c_str(), maps, seconds);
+		}
+	}
+}
+
+BENCH_CASE("tl_pool", tl_pool_churn);
@@ -0,0 +1,57 @@
+#include "include/bench.hpp"
+
+#include "vector.hpp"
+#include <algorithm>
+#include <vector>
+
+// Column initialization and edits on n ints, ft::vector against std::vector: resize(n, 0) and resize(n, 7) of an
+// empty vector, insert(begin, 1000, 7) and erase of the first 1000 elements (the whole column shifts each time),
+// then find() of a value near the end and count() of it over the column.
+
+namespace
+{
+	template <typename Vector, typename Find, typename Count>
+	void run(const bench::options& opts, const char* variant, Find find, Count count)
+	{
+		bench::report("vector_kernels/resize(n, 0)", variant, opts.n, bench::best_of(opts, [&]() {
+			Vector v;
+			v.resize(opts.n, 0);
+			bench::do_not_optimize(v.back());
+		}));
+		bench::report("vector_kernels/resize(n, 7)", variant, opts.n, bench::best_of(opts, [&]() {
+			Vector v;
+			v.resize(opts.n, 7);
+			bench::do_not_optimize(v.back());
+		}));
+
+		Vector v(opts.n, 0);
+		bench::report("vector_kernels/insert+erase 1000", variant, opts.n, bench::best_of(opts, [&]() {
+			v.insert(v.begin(), 1000, 7);
+			v.erase(v.begin(), v.begin() + 1000);
+			bench::do_not_optimize(v.front());
+		}));
+		v.back() = 7;
+		bench::report("vector_kernels/find", variant, opts.n, bench::best_of(opts, [&]() {
+			bench::do_not_optimize(find(v.begin(), v.end(), 7) - v.begin());
+		}));
+		bench::report("vector_kernels/count", variant, opts.n, bench::best_of(opts, [&]() {
+			bench::do_not_optimize(count(v.begin(), v.end(), 7));
+		}));
+	}
+
+	void vector_kernels(const bench::options& opts)
+	{
+		run<std::vector<int> >(opts, "std::vector",
+			[](std::vector<int>::iterator first, std::vector<int>::iterator last, int value) {
+				return std::find(first, last, value);
+			},
+			[](std::vector<int>::iterator first, std::vector<int>::iterator last, int value) {
+				return std::count(first, last, value);
+			});
+		run<ft::vector<int> >(opts, "ft::vector",
+			[](int* first, int* last, int value) { return ft::find(first, last, value); },
+			[](int* first, int* last, int value) { return ft::count(first, last, value); });
+	}
+}
+
+BENCH_CASE("vector_kernels", vector_kernels);
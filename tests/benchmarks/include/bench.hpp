@@ -0,0 +1,102 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+// Minimal benchmark harness: every benchmark file registers its cases with BENCH_CASE,
+// bench_main.cpp runs the ones matching the filter and prints one line per measurement.
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace bench
+{
+	struct options
+	{
+		size_t		n;			// number of elements in the benchmarked container
+		int			repeats;	// the best of the repeats is reported
+		int			threads;	// upper bound for the multi-threaded benchmarks
+		std::string	filter;		// runs the cases whose name contains it
+	};
+
+	typedef void (*case_function)(const options&);
+
+	struct bench_case
+	{
+		const char*		name;
+		case_function	function;
+	};
+
+	inline std::vector<bench_case>& registry()
+	{
+		static std::vector<bench_case> cases;
+		return cases;
+	}
+
+	struct registrar
+	{
+		registrar(const char* name, case_function function)
+		{
+			bench_case c = { name, function };
+			registry().push_back(c);
+		}
+	};
+
+	class timer
+	{
+	public:
+		timer() : _start(clock::now()) {}
+
+		void restart()
+		{
+			_start = clock::now();
+		}
+
+		double seconds() const
+		{
+			return std::chrono::duration<double>(clock::now() - _start).count();
+		}
+
+	private:
+		typedef std::chrono::steady_clock clock;
+		clock::time_point _start;
+	};
+
+	// keeps the compiler from dropping a computation whose result is otherwise unused
+	template <typename T>
+	inline void do_not_optimize(const T& value)
+	{
+		asm volatile("" : : "r,m"(value) : "memory");
+	}
+
+	// runs f() opts.repeats times and returns the fastest run in seconds
+	template <typename F>
+	double best_of(const options& opts, F f)
+	{
+		double best = 0;
+		for (int i = 0; i < opts.repeats; ++i)
+		{
+			timer t;
+			f();
+			double elapsed = t.seconds();
+			if (i == 0 || elapsed < best)
+			{
+				best = elapsed;
+			}
+		}
+		return best;
+	}
+
+	inline void report(const char* name, const char* variant, size_t operations, double seconds)
+	{
+		std::printf("%-28s %-32s %10.3f ms %9.2f ns/op\n", name, variant, seconds * 1e3,
+			operations ? seconds * 1e9 / operations : 0.0);
+	}
+}
+
+#define BENCH_CONCAT_IMPL(a, b) a##b
+#define BENCH_CONCAT(a, b) BENCH_CONCAT_IMPL(a, b)
+#define BENCH_CASE(name, function) \
+	static bench::registrar BENCH_CONCAT(bench_registrar_, __LINE__)(name, function)
+
+#endif
@@ -0,0 +1,570 @@
+#include "include/catch.hpp"
+
+#include "arena.hpp"
+#include "map.hpp"
+#include "memory_resource.hpp"
+#include "set.hpp"
+#include "tl_pool_allocator.hpp"
+#include "vector.hpp"
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	struct counted
+	{
+		static int	alive;
+
+		explicit counted(int v = 0) : value(v) { ++alive; }
+		counted(const counted& other) : value(other.value) { ++alive; }
+		~counted() { --alive; }
+
+		int	value;
+	};
+
+	int counted::alive = 0;
+
+	// an instrumented resource: counts what goes through it and checks that every block is given back with the
+	// size and alignment it was allocated with
+	class counting_resource : public ft::memory_resource
+	{
+	public:
+		explicit counting_resource(ft::memory_resource* upstream = ft::new_delete_resource())
+			: allocations(0), deallocations(0), bytes_outstanding(0), mismatches(0), _upstream(upstream) {}
+
+		size_t	allocations;
+		size_t	deallocations;
+		size_t	bytes_outstanding;
+		size_t	mismatches;
+
+	private:
+		struct block
+		{
+			void*	p;
+			size_t	bytes;
+			size_t	alignment;
+		};
+
+		virtual void* do_allocate(size_t bytes, size_t alignment)
+		{
+			void* p = _upstream->allocate(bytes, alignment);
+			if (reinterpret_cast<uintptr_t>(p) % alignment != 0)
+			{
+				++mismatches;
+			}
+			block b = { p, bytes, alignment };
+			_blocks.push_back(b);
+			++allocations;
+			bytes_outstanding += bytes;
+			return p;
+		}
+
+		virtual void do_deallocate(void* p, size_t bytes, size_t alignment)
+		{
+			size_t i = 0;
+			while (i < _blocks.size() && _blocks[i].p != p)
+			{
+				++i;
+			}
+			if (i == _blocks.size() || _blocks[i].bytes != bytes || _blocks[i].alignment != alignment)
+			{
+				++mismatches;
+				return;
+			}
+			_blocks.erase(_blocks.begin() + i);
+			++deallocations;
+			bytes_outstanding -= bytes;
+			_upstream->deallocate(p, bytes, alignment);
+		}
+
+		virtual bool do_is_equal(const ft::memory_resource& other) const
+		{
+			return this == &other;
+		}
+
+		ft::memory_resource*	_upstream;
+		ft::vector<block>		_blocks;
+	};
+}
+
+TEST_CASE("Arena and arena_allocator", "[allocator]")
+{
+	SECTION("Allocations are aligned, bump allocated and given back by reset")
+	{
+		ft::arena a(256);
+		char* first = static_cast<char*>(a.allocate(3, 1));
+		char* second = static_cast<char*>(a.allocate(8, 8));
+		CHECK(second >= first + 3);
+		CHECK(reinterpret_cast<uintptr_t>(second) % 8 == 0);
+		CHECK(reinterpret_cast<uintptr_t>(a.allocate(1, 64)) % 64 == 0);
+		void* big = a.allocate(100000);
+		CHECK(big != NULL);
+		CHECK(a.bytes_used() == 3 + 8 + 1 + 100000);
+		size_t reserved = a.bytes_reserved();
+		a.reset();
+		CHECK(a.bytes_used() == 0);
+		CHECK(a.bytes_reserved() <= reserved);
+		CHECK(a.bytes_reserved() >= 100000); // the biggest chunk is kept
+		a.release();
+		CHECK(a.bytes_reserved() == 0);
+	}
+
+	SECTION("A request too big for any chunk throws bad_alloc without reserving one")
+	{
+		ft::arena a;
+		CHECK_THROWS_AS(a.allocate(static_cast<size_t>(-1) - 8), std::bad_alloc);
+		CHECK_THROWS_AS(a.allocate(static_cast<size_t>(-1) - 64, 64), std::bad_alloc);
+		CHECK(a.bytes_reserved() == 0);
+	}
+
+	SECTION("A buffer of the caller is used before the heap")
+	{
+		char buffer[1024];
+		ft::arena a(buffer, sizeof(buffer));
+		void* p = a.allocate(100);
+		CHECK(p >= static_cast<void*>(buffer));
+		CHECK(p < static_cast<void*>(buffer + sizeof(buffer)));
+		CHECK(a.bytes_reserved() == sizeof(buffer));
+		a.allocate(2000);
+		CHECK(a.bytes_reserved() > sizeof(buffer));
+	}
+
+	SECTION("Created objects are destroyed by reset, trivial ones cost no record")
+	{
+		ft::arena a;
+		counted* c = a.create<counted>(7);
+		a.create<counted>();
+		a.create<std::string>("a string longer than the small string buffer");
+		CHECK(c->value == 7);
+		CHECK(counted::alive == 2);
+		size_t used = a.bytes_used();
+		a.create<int>(3);
+		CHECK(a.bytes_used() == used + sizeof(int));
+		a.reset();
+		CHECK(counted::alive == 0);
+	}
+
+	SECTION("Containers allocate from the arena")
+	{
+		ft::arena a;
+		{
+			ft::vector<int, ft::arena_allocator<int> > v(a);
+			for (int i = 0; i < 1000; ++i)
+			{
+				v.push_back(i);
+			}
+			ft::vector<int, ft::arena_allocator<int> > copy(v);
+			CHECK(copy == v);
+			CHECK(copy.get_allocator() == v.get_allocator());
+
+			typedef ft::map<int, std::string, std::less<int>, ft::arena_allocator<ft::pair<const int, std::string> > > string_map;
+			string_map names(std::less<int>(), a);
+			names[1] = "one";
+			names[2] = "a value too long for the small string optimization";
+			names.erase(1);
+			CHECK(names.size() == 1);
+
+			typedef ft::set<int, std::less<int>, ft::arena_allocator<int> > int_set;
+			size_t before = a.bytes_used();
+			int_set s(std::less<int>(), a);
+			for (int i = 0; i < 100; ++i)
+			{
+				s.insert(i);
+			}
+			CHECK(a.bytes_used() > before);
+			s.clear(); // trivially destructible nodes: dropped without a walk
+			CHECK(s.empty());
+			s.insert(5);
+			CHECK(*s.begin() == 5);
+			int_set bulk(std::less<int>(), a);
+			bulk.assign_sorted_unique(v.begin(), v.end());
+			CHECK(bulk.size() == 1000);
+		}
+		a.reset();
+		CHECK(a.bytes_used() == 0);
+		ft::arena_allocator<int> no_arena;
+		CHECK_THROWS_AS(no_arena.allocate(1), std::bad_alloc);
+	}
+}
+
+TEST_CASE("Vector assignment to a smaller vector", "[allocator]")
+{
+	// used to give the old storage back twice
+	ft::vector<int> small(10, 1);
+	ft::vector<int> big(20, 2);
+	small = big;
+	CHECK(small == big);
+	ft::vector<int> empty;
+	big = empty;
+	CHECK(big.empty());
+}
+
+TEST_CASE("Polymorphic memory resources", "[allocator]")
+{
+	SECTION("The containers and their node rebinds allocate from the resource, and give back what they took")
+	{
+		counting_resource counter;
+		{
+			ft::pmr::vector<std::string> v(&counter);
+			for (int i = 0; i < 100; ++i)
+			{
+				v.push_back("a string long enough to be allocated by std::string");
+			}
+			v.resize(10);
+			v.reserve(500);
+			ft::pmr::map<int, int> m(std::less<int>(), &counter);
+			ft::pmr::set<int> s(std::less<int>(), &counter);
+			for (int i = 0; i < 1000; ++i)
+			{
+				m[i] = i;
+				s.insert(i);
+			}
+			m.erase(500);
+			s.erase(s.begin(), s.find(100));
+			CHECK(m.get_allocator().resource() == &counter);
+			CHECK(s.get_allocator().resource() == &counter);
+			CHECK(counter.allocations > 3);
+			CHECK(counter.bytes_outstanding > 0);
+		}
+		CHECK(counter.mismatches == 0);
+		CHECK(counter.bytes_outstanding == 0);
+		CHECK(counter.allocations == counter.deallocations);
+	}
+
+	SECTION("The null resource proves a code path allocates nothing")
+	{
+		ft::pmr::set<int> s(std::less<int>(), ft::null_memory_resource());
+		ft::pmr::vector<int> v(ft::null_memory_resource());
+		CHECK(s.find(3) == s.end());
+		CHECK(s.count(3) == 0);
+		CHECK(v.empty());
+		CHECK_THROWS_AS(s.insert(3), std::bad_alloc);
+		CHECK_THROWS_AS(v.push_back(3), std::bad_alloc);
+
+		// everything fits in the buffer: the null upstream is never asked
+		char buffer[16384];
+		ft::monotonic_buffer_resource local(buffer, sizeof(buffer), ft::null_memory_resource());
+		ft::pmr::map<int, int> m(std::less<int>(), &local);
+		for (int i = 0; i < 100; ++i)
+		{
+			m[i] = i * i;
+		}
+		CHECK(m[9] == 81);
+		CHECK_THROWS_AS(local.allocate(sizeof(buffer)), std::bad_alloc);
+	}
+
+	SECTION("The monotonic buffer bumps, aligns and releases to its upstream")
+	{
+		counting_resource counter;
+		{
+			ft::monotonic_buffer_resource mono(64, &counter);
+			char* a = static_cast<char*>(mono.allocate(10, 1));
+			char* b = static_cast<char*>(mono.allocate(10, 1));
+			CHECK(b == a + 10);
+			void* c = mono.allocate(8, 64);
+			CHECK(reinterpret_cast<uintptr_t>(c) % 64 == 0);
+			mono.deallocate(a, 10, 1); // does nothing
+			for (int i = 0; i < 100; ++i)
+			{
+				mono.allocate(100);
+			}
+			size_t taken = counter.allocations;
+			CHECK(taken > 1);
+			CHECK(taken < 12); // geometric growth
+			mono.release();
+			CHECK(counter.bytes_outstanding == 0);
+			mono.allocate(10);
+		}
+		CHECK(counter.bytes_outstanding == 0);
+		CHECK(counter.mismatches == 0);
+	}
+
+	SECTION("Pools reuse freed blocks and give everything back on release")
+	{
+		counting_resource counter;
+		ft::pool_options opts;
+		opts.max_blocks_per_chunk = 256;
+		opts.largest_required_pool_block = 1000;
+		ft::unsynchronized_pool_resource pools(opts, &counter);
+		CHECK(pools.options().largest_required_pool_block == 1024);
+		CHECK(pools.upstream_resource() == &counter);
+
+		void* a = pools.allocate(24, 8);
+		pools.deallocate(a, 24, 8);
+		CHECK(pools.allocate(24, 8) == a);
+		void* aligned = pools.allocate(40, 64);
+		CHECK(reinterpret_cast<uintptr_t>(aligned) % 64 == 0);
+		void* over_aligned = pools.allocate(40, 256);
+		CHECK(reinterpret_cast<uintptr_t>(over_aligned) % 256 == 0);
+		void* big = pools.allocate(5000);
+		size_t before = counter.allocations;
+		pools.deallocate(big, 5000);
+		pools.deallocate(over_aligned, 40, 256);
+		CHECK(counter.deallocations == 2);
+		for (int i = 0; i < 1000; ++i)
+		{
+			pools.allocate(16);
+		}
+		CHECK(counter.allocations - before < 15); // chunks of up to 256 blocks
+		{
+			ft::pmr::map<int, std::string> m(std::less<int>(), &pools);
+			for (int i = 0; i < 500; ++i)
+			{
+				m[i] = "value";
+			}
+		}
+		pools.release();
+		CHECK(counter.bytes_outstanding == 0);
+		CHECK(counter.mismatches == 0);
+	}
+
+	SECTION("The synchronized pools are shared between threads")
+	{
+		counting_resource counter;
+		{
+			ft::synchronized_pool_resource shared(&counter);
+			std::vector<std::thread> threads;
+			size_t sizes[4] = { 0, 0, 0, 0 };
+			for (int t = 0; t < 4; ++t)
+			{
+				threads.push_back(std::thread([&shared, &sizes, t]() {
+					ft::pmr::set<int> s(std::less<int>(), &shared);
+					for (int i = 0; i < 2000; ++i)
+					{
+						s.insert(i * 4 + t);
+						if (i % 3 == 0)
+						{
+							s.erase(i * 4 + t);
+						}
+					}
+					sizes[t] = s.size();
+				}));
+			}
+			for (size_t t = 0; t < threads.size(); ++t)
+			{
+				threads[t].join();
+			}
+			for (int t = 0; t < 4; ++t)
+			{
+				CHECK(sizes[t] == 1333);
+			}
+		}
+		CHECK(counter.bytes_outstanding == 0);
+	}
+
+	SECTION("The resource stays with its container on copy, copy-assignment and swap")
+	{
+		counting_resource left_resource;
+		counting_resource right_resource;
+		{
+			ft::pmr::map<int, int> left(std::less<int>(), &left_resource);
+			ft::pmr::map<int, int> right(std::less<int>(), &right_resource);
+			for (int i = 0; i < 10; ++i)
+			{
+				left[i] = i;
+				right[i + 100] = i;
+			}
+			ft::pmr::map<int, int> copy(left);
+			CHECK(copy == left);
+			CHECK(copy.get_allocator().resource() == ft::get_default_resource());
+
+			size_t right_before = right_resource.allocations;
+			right = left;
+			CHECK(right == left);
+			CHECK(right.get_allocator().resource() == &right_resource);
+			CHECK(right_resource.allocations > right_before);
+
+			right[1000] = 0;
+			left.swap(right);
+			CHECK(left.size() == 11);
+			CHECK(left.count(1000) == 1);
+			CHECK(right.size() == 10);
+			CHECK(left.get_allocator().resource() == &left_resource);
+			CHECK(right.get_allocator().resource() == &right_resource);
+
+			ft::pmr::map<int, int> same(std::less<int>(), &left_resource);
+			same[7] = 7;
+			const int* node_value = &same.find(7)->second;
+			left.swap(same); // same resource: the nodes are exchanged
+			CHECK(&left.find(7)->second == node_value);
+
+			ft::pmr::vector<int> a(&left_resource);
+			ft::pmr::vector<int> b(&right_resource);
+			a.push_back(1);
+			b.push_back(2);
+			b.push_back(3);
+			ft::swap(a, b);
+			CHECK(a.size() == 2);
+			CHECK(b[0] == 1);
+			CHECK(a.get_allocator().resource() == &left_resource);
+			a = b;
+			CHECK(a.size() == 1);
+			CHECK(a.get_allocator().resource() == &left_resource);
+			ft::pmr::vector<int> onto(b, &right_resource);
+			CHECK(onto.get_allocator().resource() == &right_resource);
+		}
+		CHECK(left_resource.bytes_outstanding == 0);
+		CHECK(right_resource.bytes_outstanding == 0);
+		CHECK(left_resource.mismatches == 0);
+		CHECK(right_resource.mismatches == 0);
+	}
+
+	SECTION("Requests whose padded size would wrap around throw bad_alloc")
+	{
+		const size_t huge = static_cast<size_t>(-1) - 8;
+		counting_resource counter;
+		ft::monotonic_buffer_resource mono(&counter);
+		CHECK_THROWS_AS(mono.allocate(huge, 16), std::bad_alloc);
+		ft::unsynchronized_pool_resource pools(&counter);
+		CHECK_THROWS_AS(pools.allocate(huge, 16), std::bad_alloc);
+		CHECK(counter.allocations == 0);
+		CHECK_THROWS_AS(ft::new_delete_resource()->allocate(static_cast<size_t>(-1) - 64, 64), std::bad_alloc);
+
+		ft::pmr::vector<char> v(&mono);
+		CHECK_THROWS_AS(v.reserve(huge), std::bad_alloc);
+		v.push_back('a'); // the resource still works
+		CHECK(v.back() == 'a');
+	}
+
+	SECTION("pmr::stack and the default resource")
+	{
+		counting_resource counter;
+		ft::pmr::stack<int> on_counter(&counter);
+		on_counter.push(1);
+		CHECK(counter.allocations == 1);
+
+		ft::memory_resource* previous = ft::set_default_resource(&counter);
+		CHECK(previous == ft::new_delete_resource());
+		{
+			ft::pmr::stack<int> s;
+			s.push(1);
+			s.push(2);
+			CHECK(s.top() == 2);
+			ft::pmr::set<int> defaulted;
+			defaulted.insert(1);
+			CHECK(defaulted.get_allocator().resource() == &counter);
+		}
+		CHECK(ft::set_default_resource(NULL) == &counter);
+		CHECK(ft::get_default_resource() == ft::new_delete_resource());
+		on_counter.pop();
+	}
+}
+
+TEST_CASE("Thread-local pool allocator", "[allocator]")
+{
+	typedef ft::map<int, std::string, std::less<int>, ft::tl_pool_allocator<ft::pair<const int, std::string> > > pool_map;
+	typedef ft::set<int, std::less<int>, ft::tl_pool_allocator<int> > pool_set;
+
+	SECTION("Freed blocks are reused by their thread")
+	{
+		ft::tl_pool_allocator<double> alloc;
+		double* a = alloc.allocate(3);
+		alloc.deallocate(a, 3);
+		CHECK(alloc.allocate(3) == a);
+		alloc.deallocate(a, 3);
+		ft::tl_pool_allocator<int> rebound(alloc);
+		CHECK(rebound == alloc);
+		int* big = rebound.allocate(1000); // above the size classes: operator new
+		rebound.deallocate(big, 1000);
+
+		ft::tl_pool_stats before = ft::tl_pool_allocator<int>::thread_stats();
+		{
+			pool_map m;
+			for (int i = 0; i < 1000; ++i)
+			{
+				m[i] = "node";
+			}
+			m.erase(m.find(10), m.find(990));
+			CHECK(m.size() == 20);
+			pool_set s;
+			for (int i = 0; i < 1000; ++i)
+			{
+				s.insert(i);
+			}
+			pool_set copy(s);
+			CHECK(copy == s);
+			ft::vector<int, ft::tl_pool_allocator<int> > v;
+			for (int i = 0; i < 100; ++i)
+			{
+				v.push_back(i);
+			}
+		}
+		ft::tl_pool_stats after = ft::tl_pool_allocator<int>::thread_stats();
+		CHECK(after.allocations - before.allocations >= 3000);
+		CHECK(after.allocations - before.allocations == after.deallocations - before.deallocations);
+		CHECK(after.remote_frees == before.remote_frees);
+	}
+
+	SECTION("Blocks freed on another thread go back to their owner")
+	{
+		pool_set* built = NULL;
+		std::thread producer([&built]() {
+			built = new pool_set();
+			for (int i = 0; i < 1000; ++i)
+			{
+				built->insert(i);
+			}
+		});
+		producer.join();
+		// the producer's heap is left for the next thread, the nodes are freed here
+		ft::tl_pool_stats before = ft::tl_pool_allocator<int>::thread_stats();
+		delete built;
+		ft::tl_pool_allocator<int>::flush_remote_frees();
+		CHECK(ft::tl_pool_allocator<int>::thread_stats().remote_frees - before.remote_frees == 1000);
+
+		ft::tl_pool_stats adopter;
+		std::thread next([&adopter]() {
+			pool_set s;
+			for (int i = 0; i < 1000; ++i)
+			{
+				s.insert(i);
+			}
+			adopter = ft::tl_pool_allocator<int>::thread_stats();
+		});
+		next.join();
+		CHECK(adopter.remote_received == 1000);
+		CHECK(adopter.spans == 0);
+	}
+
+	SECTION("Containers churn on many threads and are handed between them")
+	{
+		std::vector<pool_map*> handed(8, NULL);
+		std::vector<std::thread> threads;
+		for (int t = 0; t < 8; ++t)
+		{
+			threads.push_back(std::thread([&handed, t]() {
+				for (int round = 0; round < 50; ++round)
+				{
+					pool_map local;
+					for (int i = 0; i < 100; ++i)
+					{
+						local[i * 8 + t] = "churn";
+					}
+					local.erase(t);
+				}
+				handed[t] = new pool_map();
+				for (int i = 0; i < 500; ++i)
+				{
+					(*handed[t])[i] = "handed";
+				}
+			}));
+		}
+		for (size_t t = 0; t < threads.size(); ++t)
+		{
+			threads[t].join();
+		}
+		threads.clear();
+		for (int t = 0; t < 8; ++t)
+		{
+			threads.push_back(std::thread([&handed, t]() {
+				delete handed[(t + 1) % 8];
+			}));
+		}
+		for (size_t t = 0; t < threads.size(); ++t)
+		{
+			threads[t].join();
+		}
+	}
+}
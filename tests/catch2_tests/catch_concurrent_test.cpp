@@ -0,0 +1,505 @@
+#include "include/catch.hpp"
+
+#include "concurrent_snapshot_map.hpp"
+#include "concurrent_stack.hpp"
+#include "concurrency/fork_join_pool.hpp"
+#include "sharded_map.hpp"
+#include "ws_deque.hpp"
+#include <atomic>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Concurrent snapshot map", "[concurrent]")
+{
+	typedef ft::concurrent_snapshot_map<int, int> snapshot_map;
+
+	SECTION("Single threaded reads see the published writes")
+	{
+		snapshot_map m;
+		m.insert_or_assign(1, 10);
+		m.insert_or_assign(2, 20);
+		m.insert_or_assign(1, 11);
+		int value = 0;
+		CHECK(m.find(1, value));
+		CHECK(value == 11);
+		CHECK(!m.find(3, value));
+		CHECK(m.size() == 2);
+		CHECK(m.erase(2) == 1);
+		CHECK(m.erase(2) == 0);
+		CHECK(!m.contains(2));
+	}
+
+	SECTION("A snapshot keeps its version while writers publish new ones")
+	{
+		snapshot_map m;
+		m.update([](snapshot_map::map_type& map) {
+			for (int i = 0; i < 100; ++i)
+			{
+				map[i] = i;
+			}
+		});
+		snapshot_map::snapshot old_version = m.read();
+		m.clear();
+		CHECK(m.size() == 0);
+		CHECK(old_version->size() == 100);
+		CHECK(old_version->find(42)->second == 42);
+	}
+
+	SECTION("Readers never see a half applied batch")
+	{
+		// every batch rewrites all the values with the same version number
+		const int keys = 64;
+		snapshot_map m;
+		m.update([](snapshot_map::map_type& map) {
+			for (int i = 0; i < keys; ++i)
+			{
+				map[i] = 0;
+			}
+		});
+		std::atomic<bool> done(false);
+		std::atomic<int> torn(0);
+		std::atomic<long> reads(0);
+		std::vector<std::thread> readers;
+		for (int t = 0; t < 4; ++t)
+		{
+			readers.push_back(std::thread([&]() {
+				while (!done.load())
+				{
+					snapshot_map::snapshot version = m.read();
+					int first = version->begin()->second;
+					for (snapshot_map::map_type::const_iterator it = version->begin(); it != version->end(); ++it)
+					{
+						if (it->second != first)
+						{
+							++torn;
+						}
+					}
+					++reads;
+				}
+			}));
+		}
+		for (int v = 1; v <= 300; ++v)
+		{
+			m.update([v](snapshot_map::map_type& map) {
+				for (int i = 0; i < keys; ++i)
+				{
+					map[i] = v;
+				}
+			});
+		}
+		while (reads.load() < 100)
+		{
+			std::this_thread::yield();
+		}
+		done = true;
+		for (size_t t = 0; t < readers.size(); ++t)
+		{
+			readers[t].join();
+		}
+		CHECK(torn.load() == 0);
+		int value = 0;
+		CHECK(m.find(keys - 1, value));
+		CHECK(value == 300);
+	}
+
+	SECTION("Retired versions are deleted once no reader is pinned")
+	{
+		snapshot_map m;
+		for (int i = 0; i < 10; ++i)
+		{
+			m.insert_or_assign(i, i);
+		}
+		ft::epoch_domain& domain = ft::epoch_domain::instance();
+		for (int i = 0; i < 4 && domain.pending() != 0; ++i)
+		{
+			domain.reclaim();
+		}
+		CHECK(domain.pending() == 0);
+		{
+			snapshot_map::snapshot pinned = m.read();
+			m.insert_or_assign(100, 100);
+			domain.reclaim();
+			domain.reclaim();
+			domain.reclaim();
+			CHECK(domain.pending() == 1); // the epoch can't move on two steps while this thread is pinned
+		}
+		domain.reclaim();
+		domain.reclaim();
+		CHECK(domain.pending() == 0);
+	}
+}
+
+TEST_CASE("Lock-free concurrent stack", "[concurrent]")
+{
+	SECTION("Single threaded it is a LIFO")
+	{
+		ft::concurrent_stack<std::string> stack;
+		CHECK(stack.empty());
+		stack.push("one");
+		stack.push("two");
+		stack.push("three");
+		CHECK(stack.size() == 3);
+		std::string value;
+		CHECK(stack.try_pop(value));
+		CHECK(value == "three");
+		CHECK(stack.pop());
+		CHECK(stack.try_pop(value));
+		CHECK(value == "one");
+		CHECK(!stack.try_pop(value));
+		CHECK(!stack.pop());
+		CHECK(stack.empty());
+		stack.push("left for the destructor");
+	}
+
+	SECTION("Every pushed value is popped exactly once")
+	{
+		const int threads = 4;
+		const int per_thread = 20000;
+		ft::concurrent_stack<int> stack;
+		std::vector<std::atomic<int> > seen(threads * per_thread);
+		for (size_t i = 0; i < seen.size(); ++i)
+		{
+			seen[i] = 0;
+		}
+		std::vector<std::thread> workers;
+		for (int t = 0; t < threads; ++t)
+		{
+			workers.push_back(std::thread([&stack, &seen, t, per_thread]() {
+				int value;
+				for (int i = 0; i < per_thread; ++i)
+				{
+					stack.push(t * per_thread + i);
+					if (i % 2 && stack.try_pop(value))
+					{
+						++seen[value];
+					}
+				}
+				while (stack.try_pop(value))
+				{
+					++seen[value];
+				}
+			}));
+		}
+		for (int t = 0; t < threads; ++t)
+		{
+			workers[t].join();
+		}
+		int wrong = 0;
+		for (size_t i = 0; i < seen.size(); ++i)
+		{
+			wrong += (seen[i] != 1);
+		}
+		CHECK(wrong == 0);
+		CHECK(stack.empty());
+		CHECK(stack.size() == 0);
+	}
+
+	SECTION("Nodes are recycled: a steady state allocates nothing")
+	{
+		ft::concurrent_stack<long> stack;
+		for (int i = 0; i < 1000; ++i)
+		{
+			stack.push(i);
+		}
+		while (stack.pop())
+		{
+		}
+		size_t chunks = ft::recycling_pool<ft::concurrent_stack<long>::node_type>::chunks_allocated();
+		for (int round = 0; round < 10; ++round)
+		{
+			for (int i = 0; i < 1000; ++i)
+			{
+				stack.push(i);
+			}
+			while (stack.pop())
+			{
+			}
+		}
+		CHECK(ft::recycling_pool<ft::concurrent_stack<long>::node_type>::chunks_allocated() == chunks);
+	}
+}
+
+TEST_CASE("Work-stealing deque", "[concurrent]")
+{
+	SECTION("The owner pops the newest element, thieves steal the oldest")
+	{
+		ft::ws_deque<int> deque;
+		int value = 0;
+		CHECK(!deque.pop(value));
+		CHECK(!deque.steal(value));
+		for (int i = 0; i < 5; ++i)
+		{
+			deque.push(i);
+		}
+		CHECK(deque.size() == 5);
+		CHECK(deque.pop(value));
+		CHECK(value == 4);
+		CHECK(deque.steal(value));
+		CHECK(value == 0);
+		CHECK(deque.steal(value));
+		CHECK(value == 1);
+		CHECK(deque.pop(value));
+		CHECK(value == 3);
+		CHECK(deque.pop(value));
+		CHECK(value == 2);
+		CHECK(deque.empty());
+	}
+
+	SECTION("The buffer grows and keeps the elements in order")
+	{
+		ft::ws_deque<int> deque(4);
+		CHECK(deque.capacity() == 4);
+		int value = 0;
+		for (int i = 0; i < 3; ++i)
+		{
+			deque.push(i);
+		}
+		CHECK(deque.steal(value)); // top is no longer slot 0
+		for (int i = 3; i < 100; ++i)
+		{
+			deque.push(i);
+		}
+		CHECK(deque.capacity() >= 99);
+		for (int i = 1; i < 50; ++i)
+		{
+			CHECK(deque.steal(value));
+			CHECK(value == i);
+		}
+		for (int i = 99; i >= 50; --i)
+		{
+			CHECK(deque.pop(value));
+			CHECK(value == i);
+		}
+		CHECK(!deque.pop(value));
+	}
+
+	SECTION("Every pushed value is taken exactly once by the owner or a thief")
+	{
+		const int thieves = 3;
+		const int values = 100000;
+		ft::ws_deque<int> deque(8);
+		std::vector<std::atomic<int> > seen(values);
+		for (size_t i = 0; i < seen.size(); ++i)
+		{
+			seen[i] = 0;
+		}
+		std::atomic<bool> done(false);
+		std::vector<std::thread> workers;
+		for (int t = 0; t < thieves; ++t)
+		{
+			workers.push_back(std::thread([&deque, &seen, &done]() {
+				int value;
+				while (!done.load())
+				{
+					if (deque.steal(value))
+					{
+						++seen[value];
+					}
+				}
+				while (deque.steal(value))
+				{
+					++seen[value];
+				}
+			}));
+		}
+		int value;
+		for (int i = 0; i < values; ++i)
+		{
+			deque.push(i);
+			if (i % 3 == 0 && deque.pop(value))
+			{
+				++seen[value];
+			}
+		}
+		while (deque.pop(value))
+		{
+			++seen[value];
+		}
+		done = true;
+		for (int t = 0; t < thieves; ++t)
+		{
+			workers[t].join();
+		}
+		int wrong = 0;
+		for (size_t i = 0; i < seen.size(); ++i)
+		{
+			wrong += (seen[i] != 1);
+		}
+		CHECK(wrong == 0);
+	}
+}
+
+namespace
+{
+	long parallel_fib(ft::fork_join_pool& pool, int n)
+	{
+		if (n < 2)
+		{
+			return n;
+		}
+		long left = 0;
+		long right = 0;
+		pool.fork_join([&]() { left = parallel_fib(pool, n - 1); }, [&]() { right = parallel_fib(pool, n - 2); });
+		return left + right;
+	}
+}
+
+TEST_CASE("Fork-join pool", "[concurrent]")
+{
+	ft::fork_join_pool pool(4);
+	CHECK(pool.size() == 4);
+
+	SECTION("Recursive fork_join computes the same result as the sequential code")
+	{
+		long result = 0;
+		pool.run([&]() { result = parallel_fib(pool, 22); });
+		CHECK(result == 17711);
+	}
+
+	SECTION("Several threads can submit runs to the same pool")
+	{
+		std::vector<long> results(4, 0);
+		std::vector<std::thread> clients;
+		for (size_t c = 0; c < results.size(); ++c)
+		{
+			clients.push_back(std::thread([&pool, &results, c]() {
+				pool.run([&]() { results[c] = parallel_fib(pool, 18 + static_cast<int>(c)); });
+			}));
+		}
+		for (size_t c = 0; c < clients.size(); ++c)
+		{
+			clients[c].join();
+		}
+		CHECK(results[0] == 2584);
+		CHECK(results[3] == 10946);
+	}
+
+	SECTION("An exception thrown by a forked job reaches the caller of run")
+	{
+		int finished = 0;
+		CHECK_THROWS_AS(pool.run([&]() {
+			pool.fork_join([&]() { finished = 1; }, []() { throw std::runtime_error("forked"); });
+		}), std::runtime_error);
+		CHECK(finished == 1);
+		long result = 0;
+		pool.run([&]() { result = parallel_fib(pool, 10); });
+		CHECK(result == 55);
+	}
+}
+
+TEST_CASE("Sharded map", "[concurrent]")
+{
+	typedef ft::sharded_map<int, int, 8> sharded;
+
+	SECTION("Single threaded it behaves like a map")
+	{
+		sharded m;
+		CHECK(m.empty());
+		CHECK(m.insert(ft::make_pair(1, 10)));
+		CHECK(!m.insert(ft::make_pair(1, 12)));
+		CHECK(m.insert_or_assign(2, 20));
+		CHECK(!m.insert_or_assign(2, 21));
+		int value = 0;
+		CHECK(m.find(1, value));
+		CHECK(value == 10);
+		CHECK(m.find(2, value));
+		CHECK(value == 21);
+		CHECK(m.update(2, [](int& v) { v *= 2; }));
+		CHECK(!m.update(3, [](int& v) { v *= 2; }));
+		CHECK(m.find(2, value));
+		CHECK(value == 42);
+		CHECK(m.size() == 2);
+		CHECK(m.erase(1) == 1);
+		CHECK(m.erase(1) == 0);
+		CHECK(!m.contains(1));
+		m.clear();
+		CHECK(m.size() == 0);
+	}
+
+	SECTION("The ordered view merges the shards in key order")
+	{
+		sharded m;
+		std::map<int, int> expected;
+		for (int i = 0; i < 5000; ++i)
+		{
+			int key = (i * 7919) % 10007;
+			m.insert_or_assign(key, i);
+			expected[key] = i;
+		}
+		size_t used_shards = 0;
+		for (size_t shard = 0; shard < sharded::shard_count; ++shard)
+		{
+			used_shards += m.shard_size(shard) != 0;
+		}
+		CHECK(used_shards == sharded::shard_count);
+		sharded::ordered_view view = m.read();
+		CHECK(view.size() == expected.size());
+		std::map<int, int>::const_iterator e = expected.begin();
+		int wrong = 0;
+		for (sharded::const_iterator it = view.begin(); it != view.end(); ++it, ++e)
+		{
+			wrong += it->first != e->first || it->second != e->second;
+		}
+		CHECK(wrong == 0);
+		CHECK(e == expected.end());
+		sharded empty;
+		CHECK(empty.read().begin() == empty.read().end());
+	}
+
+	SECTION("Concurrent readers and writers keep every shard consistent")
+	{
+		sharded m;
+		const int threads = 4;
+		const int keys_per_thread = 2000;
+		std::atomic<bool> stop(false);
+		std::atomic<int> unordered(0);
+		std::thread scanner([&]() {
+			while (!stop.load())
+			{
+				sharded::ordered_view view = m.read();
+				int previous = -1;
+				size_t seen = 0;
+				for (sharded::const_iterator it = view.begin(); it != view.end(); ++it, ++seen)
+				{
+					unordered += it->first <= previous;
+					previous = it->first;
+				}
+				unordered += seen != view.size(); // the counters match the trees while the view lives
+			}
+		});
+		std::vector<std::thread> writers;
+		for (int t = 0; t < threads; ++t)
+		{
+			writers.push_back(std::thread([&m, t, keys_per_thread]() {
+				int value = 0;
+				for (int i = 0; i < keys_per_thread; ++i)
+				{
+					int key = i * threads + t; // every thread its own keys, spread over all the shards
+					m.insert(ft::make_pair(key, key));
+					m.find(key, value);
+					if (i % 2 == 1)
+					{
+						m.erase(key);
+					}
+				}
+			}));
+		}
+		for (size_t t = 0; t < writers.size(); ++t)
+		{
+			writers[t].join();
+		}
+		stop = true;
+		scanner.join();
+		CHECK(unordered.load() == 0);
+		CHECK(m.size() == static_cast<size_t>(threads * keys_per_thread / 2));
+		int missing = 0;
+		for (int key = 0; key < threads * keys_per_thread; ++key)
+		{
+			missing += m.contains(key) != ((key / threads) % 2 == 0);
+		}
+		CHECK(missing == 0);
+	}
+}
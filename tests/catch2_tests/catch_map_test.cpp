@@ -1,8 +1,14 @@
 #include "include/catch.hpp"
 
 #include "map.hpp"
+#include "map_snapshot.hpp"
 #include "vector.hpp"
+#include <cstdio>
+#include <iterator>
 #include <map>
+#include <new>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 namespace ft {
@@ -76,7 +82,82 @@ namespace ft {
 		FatDummy(): _fat_data(){}
 		~FatDummy() {}
 	};
-	
+
+	struct CountingDummy
+	{
+		static int constructed;
+		static int copied;
+		int value;
+		CountingDummy() : value(0) { constructed++; }
+		CountingDummy(int v) : value(v) { constructed++; }
+		CountingDummy(const CountingDummy& other) : value(other.value) { copied++; }
+		CountingDummy& operator=(const CountingDummy& other) { value = other.value; return *this; }
+		static void reset() { constructed = 0; copied = 0; }
+	};
+
+	int CountingDummy::constructed = 0;
+	int CountingDummy::copied = 0;
+
+	// key type counting its constructions, to prove that heterogeneous lookups build no temporary key
+	struct CountingKey
+	{
+		static int constructed;
+		int id;
+		CountingKey(int i) : id(i) { constructed++; }
+		CountingKey(const CountingKey& other) : id(other.id) { constructed++; }
+	};
+
+	int CountingKey::constructed = 0;
+
+	struct TransparentKeyLess
+	{
+		typedef void is_transparent;
+		bool operator()(const CountingKey& lhs, const CountingKey& rhs) const { return lhs.id < rhs.id; }
+		bool operator()(const CountingKey& lhs, int rhs) const { return lhs.id < rhs; }
+		bool operator()(int lhs, const CountingKey& rhs) const { return lhs < rhs.id; }
+	};
+
+	struct TransparentStringLess
+	{
+		typedef void is_transparent;
+		bool operator()(const std::string& lhs, const std::string& rhs) const { return lhs < rhs; }
+		bool operator()(const std::string& lhs, const char* rhs) const { return lhs.compare(rhs) < 0; }
+		bool operator()(const char* lhs, const std::string& rhs) const { return rhs.compare(lhs) > 0; }
+	};
+
+	// allocator with an identity, so two of them compare unequal, that can be told to fail (all its rebinds at once)
+	bool allocations_fail = false;
+
+	template <class T>
+	struct FailingAllocator : public std::allocator<T>
+	{
+		int id;
+
+		template <class U>
+		struct rebind
+		{
+			typedef FailingAllocator<U> other;
+		};
+
+		explicit FailingAllocator(int i = 0) : id(i) {}
+		template <class U>
+		FailingAllocator(const FailingAllocator<U>& other) : std::allocator<T>(), id(other.id) {}
+
+		T* allocate(size_t n, const void* = 0)
+		{
+			if (allocations_fail)
+			{
+				throw std::bad_alloc();
+			}
+			return std::allocator<T>::allocate(n);
+		}
+	};
+
+	template <class T, class U>
+	bool operator==(const FailingAllocator<T>& lhs, const FailingAllocator<U>& rhs) { return lhs.id == rhs.id; }
+
+	template <class T, class U>
+	bool operator!=(const FailingAllocator<T>& lhs, const FailingAllocator<U>& rhs) { return !(lhs == rhs); }
 }
 
 TEST_CASE("Constructing and manipulating elements in the map with int keys", "[integer keys]")
@@ -446,3 +527,545 @@ TEST_CASE("Testing the sentinel node", "[sentinel]")
 		CHECK(stl_map == my_map);
 	}
 }
+
+TEST_CASE("try_emplace, insert_or_assign and operator[] don't build the value for an existing key", "[try_emplace]")
+{
+	ft::map<int, ft::CountingDummy> my_map;
+
+	SECTION("operator[] on a missing key constructs the value once, in the node")
+	{
+		ft::CountingDummy::reset();
+		my_map[1].value = 10;
+		CHECK(ft::CountingDummy::constructed == 1);
+		CHECK(ft::CountingDummy::copied == 0);
+		CHECK(my_map.size() == 1);
+
+		SECTION("operator[] on an existing key constructs nothing")
+		{
+			ft::CountingDummy::reset();
+			my_map[1].value++;
+			CHECK(my_map[1].value == 11);
+			CHECK(ft::CountingDummy::constructed == 0);
+			CHECK(ft::CountingDummy::copied == 0);
+		}
+	}
+
+	SECTION("try_emplace constructs the mapped value from the argument only on a miss")
+	{
+		ft::CountingDummy::reset();
+		ft::pair<ft::map<int, ft::CountingDummy>::iterator, bool> res = my_map.try_emplace(5, 50);
+		CHECK(res.second);
+		CHECK(res.first->first == 5);
+		CHECK(res.first->second.value == 50);
+		CHECK(ft::CountingDummy::constructed == 1);
+		CHECK(ft::CountingDummy::copied == 0);
+
+		ft::CountingDummy::reset();
+		res = my_map.try_emplace(5, 60);
+		CHECK(!res.second);
+		CHECK(res.first->second.value == 50);
+		CHECK(ft::CountingDummy::constructed == 0);
+		CHECK(ft::CountingDummy::copied == 0);
+		CHECK(my_map.size() == 1);
+
+		ft::map<int, ft::CountingDummy>::iterator it = my_map.try_emplace(my_map.end(), 7);
+		CHECK(it->first == 7);
+		CHECK(it->second.value == 0);
+		CHECK(my_map.size() == 2);
+	}
+
+	SECTION("The converting pair constructor leaves null pointer constants to the plain one")
+	{
+		ft::pair<const char*, int> name(NULL, 0);
+		ft::pair<int*, int> slot(0, 0);
+		CHECK(name.first == NULL);
+		CHECK(slot.first == NULL);
+	}
+
+	SECTION("insert_or_assign inserts a missing key and assigns an existing one")
+	{
+		ft::pair<ft::map<int, ft::CountingDummy>::iterator, bool> res = my_map.insert_or_assign(3, ft::CountingDummy(30));
+		CHECK(res.second);
+		CHECK(res.first->second.value == 30);
+
+		ft::CountingDummy::reset();
+		res = my_map.insert_or_assign(3, ft::CountingDummy(31));
+		CHECK(!res.second);
+		CHECK(res.first->second.value == 31);
+		CHECK(ft::CountingDummy::copied == 0);
+		CHECK(my_map.size() == 1);
+	}
+
+	SECTION("counters map: operator[] increments match std::map")
+	{
+		std::map<int, int> stl_counters;
+		ft::map<int, int> my_counters;
+		for (int i = 0; i < 1000; ++i)
+		{
+			stl_counters[i % 37]++;
+			my_counters[i % 37]++;
+		}
+		CHECK(stl_counters == my_counters);
+		CHECK(stl_counters[36] == my_counters[36]);
+	}
+}
+
+TEST_CASE("Heterogeneous lookup with a transparent comparator", "[transparent]")
+{
+	SECTION("is_transparent is detected only on comparators declaring it")
+	{
+		CHECK(ft::is_transparent<ft::TransparentKeyLess>::value);
+		CHECK(!ft::is_transparent<std::less<int> >::value);
+		CHECK(!ft::is_transparent<bool (*)(int, int)>::value);
+	}
+
+	SECTION("lookups by int build no temporary key")
+	{
+		ft::map<ft::CountingKey, int, ft::TransparentKeyLess> my_map;
+		for (int i = 0; i < 20; i += 2)
+		{
+			my_map.insert(ft::make_pair(ft::CountingKey(i), i * 10));
+		}
+		ft::CountingKey::constructed = 0;
+		CHECK(my_map.find(4)->second == 40);
+		CHECK(my_map.find(5) == my_map.end());
+		CHECK(my_map.count(6) == 1);
+		CHECK(my_map.count(7) == 0);
+		CHECK(my_map.lower_bound(7)->first.id == 8);
+		CHECK(my_map.upper_bound(8)->first.id == 10);
+		CHECK(my_map.upper_bound(18) == my_map.end());
+		CHECK(my_map.equal_range(12).first->first.id == 12);
+		CHECK(my_map.equal_range(12).second->first.id == 14);
+		const ft::map<ft::CountingKey, int, ft::TransparentKeyLess>& const_map = my_map;
+		CHECK(const_map.find(2)->second == 20);
+		CHECK(const_map.lower_bound(3)->first.id == 4);
+		CHECK(const_map.upper_bound(18) == const_map.end());
+		CHECK(my_map.erase(10) == 1);
+		CHECK(my_map.erase(11) == 0);
+		CHECK(my_map.size() == 9);
+		CHECK(ft::CountingKey::constructed == 0);
+	}
+
+	SECTION("string keys can be looked up with a const char*")
+	{
+		ft::map<std::string, int, ft::TransparentStringLess> my_map;
+		my_map["route/a"] = 1;
+		my_map["route/b"] = 2;
+		const char* key = "route/b";
+		CHECK(my_map.find(key)->second == 2);
+		CHECK(my_map.count("route/c") == 0);
+		CHECK(my_map.erase("route/a") == 1);
+		CHECK(my_map.size() == 1);
+	}
+}
+
+TEST_CASE("Threaded map iterates like the compact one", "[layout]")
+{
+	typedef ft::map<int, int, std::less<int>, std::allocator<ft::pair<const int, int> >, ft::rbtree_threaded_layout> threaded_map;
+
+	std::map<int, int> stl_map;
+	ft::map<int, int> compact_map;
+	threaded_map my_map;
+	srand(11);
+	for (int i = 0; i < 5000; ++i)
+	{
+		int key = rand() % 700;
+		if (rand() % 4)
+		{
+			stl_map[key] = i;
+			compact_map[key] = i;
+			my_map[key] = i;
+		}
+		else
+		{
+			stl_map.erase(key);
+			compact_map.erase(key);
+			my_map.erase(key);
+		}
+	}
+	REQUIRE(my_map.size() == stl_map.size());
+	CHECK(compact_map == stl_map);
+	threaded_map::const_iterator it = my_map.begin();
+	std::map<int, int>::const_iterator stl_it = stl_map.begin();
+	int mismatches = 0;
+	for (; it != my_map.end(); ++it, ++stl_it)
+	{
+		mismatches += (it->first != stl_it->first || it->second != stl_it->second);
+	}
+	CHECK(mismatches == 0);
+	threaded_map::reverse_iterator rit = my_map.rbegin();
+	std::map<int, int>::reverse_iterator stl_rit = stl_map.rbegin();
+	for (; rit != my_map.rend(); ++rit, ++stl_rit)
+	{
+		mismatches += (rit->first != stl_rit->first);
+	}
+	CHECK(mismatches == 0);
+	CHECK(my_map.lower_bound(350)->first == stl_map.lower_bound(350)->first);
+}
+
+TEST_CASE("Index map with string values matches std::map", "[layout]")
+{
+	typedef ft::map<int, std::string, std::less<int>, std::allocator<ft::pair<const int, std::string> >, ft::rbtree_index_layout> index_map;
+
+	std::map<int, std::string> stl_map;
+	index_map my_map;
+	srand(13);
+	for (int i = 0; i < 5000; ++i)
+	{
+		int key = rand() % 700;
+		if (rand() % 4)
+		{
+			stl_map[key] = std::string(i % 40, 'x');
+			my_map[key] = std::string(i % 40, 'x');
+		}
+		else
+		{
+			stl_map.erase(key);
+			my_map.erase(key);
+		}
+	}
+	REQUIRE(my_map.size() == stl_map.size());
+	index_map::const_iterator it = my_map.begin();
+	std::map<int, std::string>::const_iterator stl_it = stl_map.begin();
+	int mismatches = 0;
+	for (; it != my_map.end(); ++it, ++stl_it)
+	{
+		mismatches += (it->first != stl_it->first || it->second != stl_it->second);
+	}
+	CHECK(mismatches == 0);
+	CHECK(my_map.try_emplace(1000, "new").second);
+	CHECK(!my_map.try_emplace(1000, "again").second);
+	CHECK(my_map[1000] == "new");
+	index_map copy;
+	copy = my_map;
+	CHECK(copy.size() == my_map.size());
+	CHECK(copy.rbegin()->first == 1000);
+}
+
+TEST_CASE("Index map assignment from a map with another allocator survives a failing allocation", "[layout]")
+{
+	typedef ft::pair<const int, std::string> value_type;
+	typedef ft::map<int, std::string, std::less<int>, ft::FailingAllocator<value_type>, ft::rbtree_index_layout> index_map;
+
+	index_map source((std::less<int>()), ft::FailingAllocator<value_type>(1));
+	for (int i = 0; i < 100; ++i)
+	{
+		source[i] = "value";
+	}
+	index_map target((std::less<int>()), ft::FailingAllocator<value_type>(2));
+	target[-1] = "old";
+	ft::allocations_fail = true;
+	CHECK_THROWS_AS(target = source, std::bad_alloc);
+	ft::allocations_fail = false;
+	CHECK(target.empty());
+	target[-1] = "usable";
+	CHECK(target.size() == 1);
+	target = source;
+	CHECK(target.size() == 100);
+	CHECK(target.get_allocator().id == 1);
+}
+
+template <typename Map>
+static bool same_contents(const Map& my_map, const std::map<int, std::string>& stl_map)
+{
+	if (my_map.size() != stl_map.size())
+	{
+		return false;
+	}
+	typename Map::const_iterator it = my_map.begin();
+	for (std::map<int, std::string>::const_iterator stl_it = stl_map.begin(); stl_it != stl_map.end(); ++stl_it, ++it)
+	{
+		if (it->first != stl_it->first || it->second != stl_it->second)
+		{
+			return false;
+		}
+	}
+	typename Map::const_reverse_iterator rit = my_map.rbegin();
+	return my_map.empty() || rit->first == stl_map.rbegin()->first;
+}
+
+template <typename Map>
+static void churn(Map& my_map, std::map<int, std::string>& stl_map, int rounds)
+{
+	for (int i = 0; i < rounds; ++i)
+	{
+		int key = rand() % 2000;
+		if (rand() % 3)
+		{
+			my_map[key] = std::string(key % 30, 'c');
+			stl_map[key] = std::string(key % 30, 'c');
+		}
+		else
+		{
+			my_map.erase(key);
+			stl_map.erase(key);
+		}
+	}
+}
+
+TEST_CASE("Compaction relocates the nodes in key order", "[compact]")
+{
+	typedef ft::map<int, std::string, std::less<int>, std::allocator<ft::pair<const int, std::string> >, ft::rbtree_threaded_layout> threaded_map;
+	typedef ft::map<int, std::string, std::less<int>, std::allocator<ft::pair<const int, std::string> >, ft::rbtree_index_layout> index_map;
+	srand(17);
+
+	SECTION("compact() lays the elements out in order and keeps a valid tree")
+	{
+		ft::map<int, std::string> my_map;
+		std::map<int, std::string> stl_map;
+		churn(my_map, stl_map, 20000);
+		my_map.compact();
+		REQUIRE(same_contents(my_map, stl_map));
+		int out_of_order = 0;
+		const ft::pair<const int, std::string>* previous = NULL;
+		for (ft::map<int, std::string>::iterator it = my_map.begin(); it != my_map.end(); ++it)
+		{
+			out_of_order += (previous != NULL && &*it < previous);
+			previous = &*it;
+		}
+		CHECK(out_of_order == 0);
+		churn(my_map, stl_map, 5000);
+		CHECK(same_contents(my_map, stl_map));
+		my_map.compact();
+		CHECK(same_contents(my_map, stl_map));
+	}
+
+	SECTION("compact_step() moves bounded batches while the map keeps changing")
+	{
+		threaded_map my_map;
+		std::map<int, std::string> stl_map;
+		churn(my_map, stl_map, 20000);
+		int passes = 0;
+		int steps = 0;
+		while (passes < 3 && steps < 100000)
+		{
+			passes += my_map.compact_step(50);
+			++steps;
+			churn(my_map, stl_map, 10);
+		}
+		CHECK(passes == 3);
+		CHECK(same_contents(my_map, stl_map));
+		my_map.clear();
+		stl_map.clear();
+		CHECK(my_map.compact_step(10));
+		churn(my_map, stl_map, 300);
+		CHECK(!my_map.compact_step(1));
+		threaded_map other;
+		other.swap(my_map);
+		while (!other.compact_step(7))
+		{
+		}
+		CHECK(same_contents(other, stl_map));
+	}
+
+	SECTION("The index layout compacts into a new slab")
+	{
+		index_map my_map;
+		std::map<int, std::string> stl_map;
+		churn(my_map, stl_map, 20000);
+		my_map.compact();
+		CHECK(same_contents(my_map, stl_map));
+		churn(my_map, stl_map, 1000);
+		CHECK(same_contents(my_map, stl_map));
+	}
+}
+
+TEST_CASE("for_each_range visits the same elements as the lower_bound loop", "[range]")
+{
+	std::map<int, int> stl_map;
+	ft::map<int, int> my_map;
+	srand(3);
+	for (int i = 0; i < 3000; ++i)
+	{
+		int key = rand() % 10000;
+		stl_map[key] = i;
+		my_map[key] = i;
+	}
+
+	SECTION("Single elements, for several ranges including empty and reversed ones")
+	{
+		const int bounds[][2] = { {0, 10000}, {-5, 20000}, {2500, 2600}, {700, 700}, {900, 100}, {9999, 10000}, {-10, 0} };
+		for (size_t b = 0; b < sizeof(bounds) / sizeof(bounds[0]); ++b)
+		{
+			int lo = bounds[b][0];
+			int hi = bounds[b][1];
+			std::vector<int> expected;
+			if (lo <= hi)
+			{
+				for (std::map<int, int>::iterator it = stl_map.lower_bound(lo); it != stl_map.lower_bound(hi); ++it)
+				{
+					expected.push_back(it->first);
+				}
+			}
+			std::vector<int> visited;
+			my_map.for_each_range(lo, hi, [&visited](ft::pair<const int, int>& value) { visited.push_back(value.first); });
+			CHECK(visited == expected);
+		}
+	}
+
+	SECTION("Batches are full except the last one and the mapped values can be changed")
+	{
+		size_t visited = 0;
+		bool full_batches = true;
+		size_t last_batch = 0;
+		my_map.for_each_range_batch(100, 9000, [&](ft::pair<const int, int>* const* values, size_t count) {
+			full_batches = full_batches && (last_batch == 0 || last_batch == ft::map<int, int>::range_batch_size);
+			for (size_t i = 0; i < count; ++i)
+			{
+				values[i]->second = -values[i]->first;
+			}
+			visited += count;
+			last_batch = count;
+		});
+		CHECK(full_batches);
+		CHECK(last_batch <= ft::map<int, int>::range_batch_size);
+		CHECK(visited == static_cast<size_t>(std::distance(stl_map.lower_bound(100), stl_map.lower_bound(9000))));
+		CHECK(my_map.lower_bound(100)->second == -my_map.lower_bound(100)->first);
+		CHECK(my_map.lower_bound(9000)->second != -my_map.lower_bound(9000)->first);
+
+		const ft::map<int, int>& const_map = my_map;
+		long sum = 0;
+		const_map.for_each_range_batch(0, 100, [&sum](const ft::pair<const int, int>* const* values, size_t count) {
+			for (size_t i = 0; i < count; ++i)
+			{
+				sum += values[i]->first;
+			}
+		});
+		long expected_sum = 0;
+		for (std::map<int, int>::iterator it = stl_map.begin(); it != stl_map.lower_bound(100); ++it)
+		{
+			expected_sum += it->first;
+		}
+		CHECK(sum == expected_sum);
+	}
+}
+
+TEST_CASE("find_many and contains_many give the results of find", "[batched]")
+{
+	ft::map<int, int> my_map;
+	for (int i = 0; i < 1000; i += 3)
+	{
+		my_map[i] = -i;
+	}
+	std::vector<int> keys;
+	for (int i = 0; i < 203; ++i) // not a multiple of the lanes nor of 64
+	{
+		keys.push_back((i * 37) % 1100 - 50);
+	}
+
+	SECTION("find_many")
+	{
+		std::vector<ft::map<int, int>::iterator> found(keys.size());
+		CHECK(my_map.find_many(keys.begin(), keys.end(), found.begin()) == found.end());
+		int wrong = 0;
+		for (size_t i = 0; i < keys.size(); ++i)
+		{
+			wrong += found[i] != my_map.find(keys[i]);
+		}
+		CHECK(wrong == 0);
+		CHECK(keys[2] == 24);
+		found[2]->second = 1; // non const iterators
+		CHECK(my_map[24] == 1);
+		const ft::map<int, int>& const_map = my_map;
+		std::vector<ft::map<int, int>::const_iterator> const_found;
+		const_map.find_many(keys.begin(), keys.end(), std::back_inserter(const_found));
+		CHECK(const_found.size() == keys.size());
+		CHECK(const_found[5] == const_map.find(keys[5]));
+	}
+
+	SECTION("contains_many")
+	{
+		std::vector<uint64_t> bitmap((keys.size() + 63) / 64, ~uint64_t(0));
+		my_map.contains_many(keys.begin(), keys.end(), &bitmap[0]);
+		int wrong = 0;
+		for (size_t i = 0; i < keys.size(); ++i)
+		{
+			wrong += ((bitmap[i / 64] >> (i % 64)) & 1) != my_map.count(keys[i]);
+		}
+		CHECK(wrong == 0);
+		CHECK((bitmap.back() >> (keys.size() % 64)) == 0);
+	}
+
+	SECTION("An empty map or an empty batch")
+	{
+		ft::map<int, int> empty;
+		std::vector<ft::map<int, int>::iterator> found(keys.size());
+		empty.find_many(keys.begin(), keys.end(), found.begin());
+		CHECK(found[0] == empty.end());
+		CHECK(my_map.find_many(keys.begin(), keys.begin(), found.begin()) == found.begin());
+	}
+}
+
+TEST_CASE("Binary snapshots of map and set", "[map][snapshot]")
+{
+	const char* path = "map_snapshot_test.bin";
+	ft::map<int, double> my_map;
+	for (int i = 0; i < 20000; ++i)
+	{
+		my_map[(i * 7919) % 20011] = i * 0.5;
+	}
+
+	SECTION("A map saved and loaded back is equal, and stays a working map")
+	{
+		ft::save_snapshot(my_map, path);
+		ft::map<int, double> loaded;
+		loaded[-1] = 1; // replaced by the load
+		ft::load_snapshot(loaded, path, ft::mapped_vector<int>::open_verify);
+		CHECK(loaded == my_map);
+		loaded.erase(loaded.begin());
+		loaded[100000] = 2;
+		CHECK(loaded.size() == my_map.size());
+		CHECK(loaded.rbegin()->first == 100000);
+	}
+
+	SECTION("The mapped view answers lookups from the file")
+	{
+		ft::save_snapshot(my_map, path);
+		ft::mapped_map<int, double> view(path, ft::mapped_map<int, double>::open_verify);
+		view.advise(ft::mapped_vector<ft::snapshot_entry<int, double> >::advice_random);
+		CHECK(view.size() == my_map.size());
+		int wrong = 0;
+		for (int key = -5; key < 20020; ++key)
+		{
+			ft::map<int, double>::const_iterator expected = my_map.find(key);
+			ft::mapped_map<int, double>::const_iterator found = view.find(key);
+			wrong += (expected == my_map.end()) != (found == view.end());
+			wrong += found != view.end() && found->second != expected->second;
+			wrong += view.count(key) != my_map.count(key);
+			wrong += (view.lower_bound(key) == view.end() ? -1 : view.lower_bound(key)->first)
+				!= (my_map.lower_bound(key) == my_map.end() ? -1 : my_map.lower_bound(key)->first);
+			wrong += (view.upper_bound(key) - view.begin()) != std::distance(my_map.begin(), my_map.upper_bound(key));
+		}
+		CHECK(wrong == 0);
+		CHECK(view.at(7919 % 20011) == 0.5);
+		CHECK_THROWS_AS(view.at(-5), std::out_of_range);
+		CHECK(view.equal_range(3).second - view.equal_range(3).first == 1);
+		CHECK(view.rbegin()->first == my_map.rbegin()->first);
+	}
+
+	SECTION("Sets, and snapshots read with another order")
+	{
+		ft::set<std::size_t> my_set;
+		for (std::size_t i = 0; i < 1000; ++i)
+		{
+			my_set.insert(i * 3);
+		}
+		ft::save_snapshot(my_set, path);
+		ft::set<std::size_t> loaded;
+		ft::load_snapshot(loaded, path);
+		CHECK(loaded == my_set);
+		ft::mapped_set<std::size_t> view(path);
+		CHECK(view.contains(2997));
+		CHECK(!view.contains(2998));
+		CHECK(*view.lower_bound(2995) == 2997);
+		CHECK(view.lower_bound(2998) == view.end());
+		ft::set<std::size_t, std::greater<std::size_t> > reversed;
+		CHECK_THROWS_AS(ft::load_snapshot(reversed, path), std::runtime_error);
+		typedef ft::mapped_set<std::size_t, std::greater<std::size_t> > reversed_view;
+		CHECK_THROWS_AS(reversed_view(path, reversed_view::open_verify), std::runtime_error);
+		ft::save_snapshot(ft::set<std::size_t>(), path);
+		ft::load_snapshot(loaded, path);
+		CHECK(loaded.empty());
+	}
+	std::remove(path);
+}
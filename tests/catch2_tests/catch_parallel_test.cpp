@@ -0,0 +1,232 @@
+#include "include/catch.hpp"
+
+#include "parallel.hpp"
+#include "vector.hpp"
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace
+{
+	// big enough to go past the sequential threshold and be split in many leaves
+	const size_t big = 200000;
+
+	ft::vector<int> random_ints(size_t n, int range)
+	{
+		std::mt19937 rng(7);
+		ft::vector<int> v;
+		for (size_t i = 0; i < n; ++i)
+		{
+			v.push_back(static_cast<int>(rng() % range));
+		}
+		return v;
+	}
+
+	struct keyed
+	{
+		int	key;
+		int	position;
+	};
+
+	struct by_key
+	{
+		bool operator()(const keyed& a, const keyed& b) const
+		{
+			return a.key < b.key;
+		}
+	};
+}
+
+TEST_CASE("Parallel algorithms", "[parallel]")
+{
+	ft::fork_join_pool pool(4);
+
+	SECTION("sort gives the same order as std::sort")
+	{
+		ft::vector<int> v = random_ints(big, 1000000);
+		std::vector<int> expected(v.begin(), v.end());
+		std::sort(expected.begin(), expected.end());
+		ft::parallel::sort(pool, v.begin(), v.end(), std::less<int>());
+		CHECK(std::equal(v.begin(), v.end(), expected.begin()));
+
+		ft::parallel::sort(v.begin(), v.end(), std::greater<int>()); // default pool
+		CHECK(std::is_sorted(v.begin(), v.end(), std::greater<int>()));
+
+		ft::vector<std::string> small;
+		small.push_back("b");
+		small.push_back("c");
+		small.push_back("a");
+		ft::parallel::sort(small.begin(), small.end());
+		CHECK(small[0] == "a");
+		CHECK(small[2] == "c");
+	}
+
+	SECTION("stable_sort keeps the order of equal elements")
+	{
+		ft::vector<int> keys = random_ints(big, 100); // many duplicates
+		ft::vector<keyed> v;
+		for (size_t i = 0; i < keys.size(); ++i)
+		{
+			keyed k = { keys[i], static_cast<int>(i) };
+			v.push_back(k);
+		}
+		ft::parallel::stable_sort(pool, v.begin(), v.end(), by_key());
+		int unstable = 0;
+		for (size_t i = 1; i < v.size(); ++i)
+		{
+			unstable += v[i - 1].key > v[i].key || (v[i - 1].key == v[i].key && v[i - 1].position > v[i].position);
+		}
+		CHECK(unstable == 0);
+	}
+
+	SECTION("for_each and transform visit every element once")
+	{
+		ft::vector<int> v(big, 1);
+		ft::parallel::for_each(pool, v.begin(), v.end(), [](int& x) { x += 1; });
+		CHECK(std::count(v.begin(), v.end(), 2) == static_cast<long>(big));
+
+		ft::vector<long> squares(big, 0);
+		ft::vector<int> in = random_ints(big, 1000);
+		CHECK(ft::parallel::transform(pool, in.begin(), in.end(), squares.begin(), [](int x) { return static_cast<long>(x) * x; })
+			== squares.end());
+		int wrong = 0;
+		for (size_t i = 0; i < big; ++i)
+		{
+			wrong += squares[i] != static_cast<long>(in[i]) * in[i];
+		}
+		CHECK(wrong == 0);
+	}
+
+	SECTION("reduce matches std::accumulate, with and without the pool")
+	{
+		ft::vector<int> v = random_ints(big, 1000);
+		long expected = std::accumulate(v.begin(), v.end(), 5L);
+		CHECK(ft::parallel::reduce(pool, v.begin(), v.end(), 5L, std::plus<long>()) == expected);
+		CHECK(ft::parallel::reduce(v.begin(), v.begin() + 100, 0) == std::accumulate(v.begin(), v.begin() + 100, 0));
+		CHECK(ft::parallel::reduce(v.begin(), v.begin(), 42) == 42);
+		// associative but not commutative: the order of the operands must be kept
+		ft::vector<std::string> letters(30000, "a");
+		letters[0] = "x";
+		letters[29999] = "z";
+		std::string joined = ft::parallel::reduce(pool, letters.begin(), letters.end(), std::string(">"), std::plus<std::string>());
+		CHECK(joined.size() == 30001);
+		CHECK(joined.substr(0, 2) == ">x");
+		CHECK(joined[30000] == 'z');
+	}
+
+	SECTION("inclusive_scan matches std::partial_sum, also in place")
+	{
+		ft::vector<int> v = random_ints(big, 1000);
+		std::vector<long> expected(big);
+		std::partial_sum(v.begin(), v.end(), expected.begin());
+		ft::vector<long> out(big, 0);
+		ft::vector<long> in(v.begin(), v.end());
+		CHECK(ft::parallel::inclusive_scan(pool, in.begin(), in.end(), out.begin(), std::plus<long>()) == out.end());
+		CHECK(std::equal(out.begin(), out.end(), expected.begin()));
+		ft::parallel::inclusive_scan(in.begin(), in.end(), in.begin());
+		CHECK(std::equal(in.begin(), in.end(), expected.begin()));
+	}
+}
+
+TEST_CASE("Parallel construction of map and set", "[parallel]")
+{
+	ft::fork_join_pool pool(4);
+
+	SECTION("A set built from unsorted input with duplicates equals the inserted one")
+	{
+		ft::vector<int> input = random_ints(big, 50000);
+		std::set<int> expected(input.begin(), input.end());
+		ft::set<int> my_set;
+		ft::parallel::build(pool, my_set, input.begin(), input.end());
+		CHECK(my_set.size() == expected.size());
+		CHECK(std::equal(my_set.begin(), my_set.end(), expected.begin()));
+		for (int i = 0; i < 1000; ++i)
+		{
+			my_set.erase(i);
+			expected.erase(i);
+			my_set.insert(100000 + i);
+			expected.insert(100000 + i);
+		}
+		CHECK(std::equal(my_set.rbegin(), my_set.rend(), expected.rbegin()));
+	}
+
+	SECTION("A map keeps the first value of every key, as insert does")
+	{
+		ft::vector<int> keys = random_ints(big, 30000);
+		ft::vector<ft::pair<int, int> > input;
+		std::map<int, int> expected;
+		for (size_t i = 0; i < keys.size(); ++i)
+		{
+			input.push_back(ft::make_pair(keys[i], static_cast<int>(i)));
+			expected.insert(std::make_pair(keys[i], static_cast<int>(i)));
+		}
+		ft::map<int, int> my_map;
+		ft::parallel::build(pool, my_map, input.begin(), input.end());
+		CHECK(my_map.size() == expected.size());
+		int wrong = 0;
+		for (std::map<int, int>::const_iterator it = expected.begin(); it != expected.end(); ++it)
+		{
+			wrong += my_map[it->first] != it->second;
+		}
+		CHECK(wrong == 0);
+	}
+
+	SECTION("Small and duplicate free inputs take the shortcuts")
+	{
+		ft::vector<std::string> words;
+		words.push_back("pear");
+		words.push_back("apple");
+		words.push_back("pear");
+		ft::set<std::string, std::greater<std::string> > reversed;
+		ft::parallel::build(reversed, words.begin(), words.end());
+		CHECK(reversed.size() == 2);
+		CHECK(*reversed.begin() == "pear");
+
+		ft::vector<int> shuffled;
+		for (int i = 0; i < static_cast<int>(big); ++i)
+		{
+			shuffled.push_back(i);
+		}
+		std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(3));
+		ft::set<int> my_set;
+		ft::parallel::build(pool, my_set, shuffled.begin(), shuffled.end());
+		CHECK(my_set.size() == big);
+		CHECK(*my_set.rbegin() == static_cast<int>(big) - 1);
+	}
+}
+
+TEST_CASE("Parallel batched lookups", "[parallel]")
+{
+	ft::fork_join_pool pool(4);
+	ft::map<int, int> my_map;
+	for (int i = 0; i < 100000; i += 2)
+	{
+		my_map[i] = i;
+	}
+	ft::vector<int> keys = random_ints(50001, 110000);
+	ft::parallel::probe_order orders[] = { ft::parallel::probe_auto, ft::parallel::probe_as_given, ft::parallel::probe_sorted };
+
+	for (int o = 0; o < 3; ++o)
+	{
+		std::vector<ft::map<int, int>::iterator> found(keys.size());
+		ft::parallel::find_many(pool, my_map, keys.begin(), keys.end(), found.begin(), orders[o]);
+		std::vector<uint64_t> bitmap((keys.size() + 63) / 64, 0);
+		ft::parallel::contains_many(pool, my_map, keys.begin(), keys.end(), &bitmap[0], orders[o]);
+		int wrong = 0;
+		for (size_t i = 0; i < keys.size(); ++i)
+		{
+			wrong += found[i] != my_map.find(keys[i]);
+			wrong += ((bitmap[i / 64] >> (i % 64)) & 1) != my_map.count(keys[i]);
+		}
+		CHECK(wrong == 0);
+	}
+
+	const ft::set<int> my_set(keys.begin(), keys.end());
+	std::vector<ft::set<int>::const_iterator> found(keys.size());
+	ft::parallel::find_many(my_set, keys.begin(), keys.end(), found.begin(), ft::parallel::probe_sorted);
+	CHECK(found[123] == my_set.find(keys[123]));
+}
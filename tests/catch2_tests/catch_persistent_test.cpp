@@ -0,0 +1,217 @@
+#include "include/catch.hpp"
+
+#include "pmap.hpp"
+#include "pset.hpp"
+#include <map>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace ft {
+	// counts the nodes alive, to check what the versions share
+	static long live_nodes = 0;
+
+	template <typename T>
+	struct CountingAllocator : public std::allocator<T>
+	{
+		template <typename U>
+		struct rebind
+		{
+			typedef CountingAllocator<U> other;
+		};
+
+		CountingAllocator() {}
+		template <typename U>
+		CountingAllocator(const CountingAllocator<U>&) {}
+
+		T* allocate(size_t n)
+		{
+			live_nodes += n;
+			return std::allocator<T>::allocate(n);
+		}
+		void deallocate(T* p, size_t n)
+		{
+			live_nodes -= n;
+			std::allocator<T>::deallocate(p, n);
+		}
+	};
+
+	template <typename Key, typename T, typename Compare, typename Alloc>
+	bool operator==(const ft::pmap<Key, T, Compare, Alloc>& my_map, const std::map<Key, T>& stl_map)
+	{
+		if (my_map.size() != stl_map.size())
+		{
+			return false;
+		}
+		typename std::map<Key, T>::const_iterator stl_it = stl_map.begin();
+		for (typename ft::pmap<Key, T, Compare, Alloc>::const_iterator it = my_map.begin(); it != my_map.end(); ++it, ++stl_it)
+		{
+			if (it->first != stl_it->first || it->second != stl_it->second)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+TEST_CASE("Persistent map", "[persistent]")
+{
+	typedef ft::pmap<int, int, std::less<int>, ft::CountingAllocator<ft::pair<const int, int> > > pmap_type;
+
+	SECTION("Updates return a new version and leave the old one unchanged")
+	{
+		pmap_type v0;
+		pmap_type v1 = v0.insert(ft::make_pair(1, 10));
+		pmap_type v2 = v1.insert_or_assign(1, 11).insert(ft::make_pair(2, 20));
+		pmap_type v3 = v2.erase(1);
+		CHECK(v0.empty());
+		CHECK(v1.size() == 1);
+		CHECK(v1.find(1)->second == 10);
+		CHECK(v2.size() == 2);
+		CHECK(v2.find(1)->second == 11);
+		CHECK(v3.size() == 1);
+		CHECK(v3.count(1) == 0);
+		CHECK(v3.find(2)->second == 20);
+		CHECK(v1.insert(ft::make_pair(1, 99)).find(1)->second == 10);
+		CHECK(v3.erase(42) == v3);
+		CHECK(v2.clear().empty());
+	}
+
+	SECTION("Random updates match std::map for every kept version")
+	{
+		std::vector<pmap_type> versions;
+		std::vector<std::map<int, int> > expected;
+		pmap_type current;
+		std::map<int, int> stl_map;
+		srand(5);
+		for (int i = 0; i < 6000; ++i)
+		{
+			int key = rand() % 500;
+			int op = rand() % 3;
+			if (op == 0)
+			{
+				current = current.erase(key);
+				stl_map.erase(key);
+			}
+			else if (op == 1)
+			{
+				current = current.insert_or_assign(key, i);
+				stl_map[key] = i;
+			}
+			else
+			{
+				current = current.insert(ft::make_pair(key, i));
+				stl_map.insert(std::make_pair(key, i));
+			}
+			if (i % 50 == 0)
+			{
+				versions.push_back(current);
+				expected.push_back(stl_map);
+			}
+		}
+		int mismatches = 0;
+		for (size_t v = 0; v < versions.size(); ++v)
+		{
+			mismatches += !(versions[v] == expected[v]);
+		}
+		CHECK(mismatches == 0);
+		CHECK(current == stl_map);
+
+		std::vector<int> backwards;
+		for (pmap_type::const_reverse_iterator it = current.rbegin(); it != current.rend(); ++it)
+		{
+			backwards.push_back(it->first);
+		}
+		CHECK(std::equal(backwards.begin(), backwards.end(), stl_map.rbegin(), [](int key, const std::pair<const int, int>& p) { return key == p.first; }));
+		CHECK((--current.end())->first == stl_map.rbegin()->first);
+		CHECK(current.lower_bound(250)->first == stl_map.lower_bound(250)->first);
+		CHECK(current.upper_bound(250)->first == stl_map.upper_bound(250)->first);
+		CHECK(current.lower_bound(100000) == current.end());
+	}
+
+	SECTION("An update copies only a path: O(log n) new nodes, every node is freed with the last version")
+	{
+		{
+			const int n = 4096;
+			pmap_type big;
+			for (int i = 0; i < n; ++i)
+			{
+				big = big.insert(ft::make_pair(i * 2, i));
+			}
+			CHECK(ft::live_nodes == n);
+			long most_new_nodes = 0;
+			std::vector<pmap_type> history;
+			for (int i = 0; i < 200; ++i)
+			{
+				long before = ft::live_nodes;
+				history.push_back(i % 2 ? big.erase(i * 20) : big.insert(ft::make_pair(i * 20 + 1, i)));
+				most_new_nodes = std::max(most_new_nodes, ft::live_nodes - before);
+			}
+			// a red-black tree of 4096 nodes is at most 24 high, a full copy would be 4096 nodes
+			CHECK(most_new_nodes <= 2 * 24 + 4);
+			CHECK(history[1].size() == n - 1);
+			CHECK(history[2].size() == n + 1);
+			CHECK(big.size() == n);
+			pmap_type copy = big;
+			CHECK(ft::live_nodes <= n + 200 * (2 * 24 + 4));
+			CHECK(copy.root_use_count() == 2);
+		}
+		CHECK(ft::live_nodes == 0);
+	}
+	SECTION("Versions sharing nodes are updated and dropped on several threads at once")
+	{
+		typedef ft::pmap<int, int> shared_map;
+		shared_map base;
+		for (int i = 0; i < 1000; ++i)
+		{
+			base = base.insert(ft::make_pair(i * 2, i));
+		}
+		std::vector<std::thread> threads;
+		std::vector<int> mismatches(4, 0);
+		for (int t = 0; t < 4; ++t)
+		{
+			threads.push_back(std::thread([&base, &mismatches, t]() {
+				for (int i = 0; i < 2000; ++i)
+				{
+					shared_map copy = base; // every thread acquires and releases the same nodes
+					shared_map grown = copy.insert(ft::make_pair(i * 2 + 1, t));
+					shared_map shrunk = grown.erase((i % 1000) * 2);
+					if (grown.size() != 1001 || shrunk.size() != 1000 || shrunk.count(i * 2 + 1) != 1)
+					{
+						++mismatches[t];
+					}
+				}
+			}));
+		}
+		for (size_t t = 0; t < threads.size(); ++t)
+		{
+			threads[t].join();
+		}
+		CHECK(mismatches == std::vector<int>(4, 0));
+		CHECK(base.root_use_count() == 1);
+		CHECK(base.size() == 1000);
+	}
+}
+
+TEST_CASE("Persistent set", "[persistent]")
+{
+	ft::pset<int> empty;
+	ft::pset<int> odd;
+	for (int i = 1; i < 100; i += 2)
+	{
+		odd = odd.insert(i);
+	}
+	ft::pset<int> without_small = odd.erase(1).erase(3).erase(4);
+	CHECK(empty.size() == 0);
+	CHECK(odd.size() == 50);
+	CHECK(*odd.begin() == 1);
+	CHECK(without_small.size() == 48);
+	CHECK(*without_small.begin() == 5);
+	CHECK(*without_small.rbegin() == 99);
+	CHECK(odd != without_small);
+	CHECK(odd < without_small);
+	CHECK(odd.find(4) == odd.end());
+	CHECK(*odd.equal_range(5).first == 5);
+	CHECK(*odd.equal_range(6).second == 7);
+}
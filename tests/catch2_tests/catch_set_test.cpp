@@ -1,7 +1,10 @@
 #include "include/catch.hpp"
 
 #include "set.hpp"
+#include "frozen_map.hpp"
 #include <set>
+#include <algorithm>
+#include <vector>
 
 namespace ft {
 	template <typename T>
@@ -44,6 +47,14 @@ namespace ft {
 	{
 		return !(my_set == st_set);
 	}
+
+	struct TransparentStringLess
+	{
+		typedef void is_transparent;
+		bool operator()(const std::string& lhs, const std::string& rhs) const { return lhs < rhs; }
+		bool operator()(const std::string& lhs, const char* rhs) const { return lhs.compare(rhs) < 0; }
+		bool operator()(const char* lhs, const std::string& rhs) const { return rhs.compare(lhs) > 0; }
+	};
 }
 
 TEST_CASE("Constructing and manipulating elements in the set with int keys", "[integer keys]")
@@ -308,3 +319,453 @@ TEST_CASE("Set instances and iterators values comparison", "[string keys, string
 		}
 	}
 }
+
+TEST_CASE("Set heterogeneous lookup with a transparent comparator", "[transparent]")
+{
+	ft::set<std::string, ft::TransparentStringLess> my_set;
+	my_set.insert("gray");
+	my_set.insert("green");
+	my_set.insert("orange");
+
+	CHECK(*my_set.find("green") == "green");
+	CHECK(my_set.find("blue") == my_set.end());
+	CHECK(my_set.count("orange") == 1);
+	CHECK(*my_set.lower_bound("h") == "orange");
+	CHECK(*my_set.upper_bound("gray") == "green");
+	CHECK(my_set.upper_bound("orange") == my_set.end());
+	CHECK(my_set.erase("gray") == 1);
+	CHECK(my_set.erase("gray") == 0);
+	CHECK(my_set.size() == 2);
+}
+
+TEST_CASE("Compact node layout", "[layout]")
+{
+	SECTION("The color is packed into the parent pointer: a node base is 3 pointers")
+	{
+		CHECK(sizeof(ft::rbtree_node_base) == 3 * sizeof(void*));
+	}
+
+	SECTION("Stateless comparator and allocator take no space and the sentinel is embedded")
+	{
+		CHECK(ft::is_empty<std::less<int> >::value);
+		CHECK(!ft::is_empty<int>::value);
+		CHECK(sizeof(ft::set<int>) == sizeof(ft::rbtree_node_base) + sizeof(size_t) + sizeof(void*));
+	}
+
+	SECTION("Colors and parents don't overwrite each other")
+	{
+		ft::rbtree_node_base sentinel;
+		ft::rbtree_node_base node(&sentinel);
+		CHECK(node.parent() == &sentinel);
+		CHECK(node.color() == RED);
+		CHECK(!node.is_sentinel());
+		CHECK(sentinel.is_sentinel());
+		node.set_color(BLACK);
+		CHECK(node.parent() == &sentinel);
+		node.set_parent(NULL);
+		CHECK(node.color() == BLACK);
+		CHECK(node.parent() == NULL);
+	}
+
+	SECTION("Random insertions and erasures match std::set, swap keeps both sets valid")
+	{
+		std::set<int> st_set;
+		ft::set<int> my_set;
+		int mismatches = 0;
+		srand(42);
+		for (int i = 0; i < 20000; ++i)
+		{
+			int key = rand() % 1000;
+			if (rand() % 3)
+			{
+				mismatches += (st_set.insert(key).second != my_set.insert(key).second);
+			}
+			else
+			{
+				mismatches += (st_set.erase(key) != my_set.erase(key));
+			}
+		}
+		CHECK(mismatches == 0);
+		CHECK(std::equal(my_set.begin(), my_set.end(), st_set.begin()));
+		CHECK(*(--my_set.end()) == *st_set.rbegin());
+
+		ft::set<int> other;
+		other.insert(-1);
+		other.swap(my_set);
+		CHECK(my_set.size() == 1);
+		CHECK(*my_set.begin() == -1);
+		CHECK(other.size() == st_set.size());
+		CHECK(std::equal(other.begin(), other.end(), st_set.begin()));
+		CHECK(*(--other.end()) == *st_set.rbegin());
+		other.insert(100000);
+		CHECK(*other.rbegin() == 100000);
+	}
+}
+
+TEST_CASE("Threaded node layout", "[layout]")
+{
+	typedef ft::set<int, std::less<int>, std::allocator<int>, ft::rbtree_threaded_layout> threaded_set;
+
+	SECTION("A threaded node base keeps 2 more pointers")
+	{
+		CHECK(sizeof(ft::rbtree_threaded_node_base) == 5 * sizeof(void*));
+	}
+
+	SECTION("An empty threaded set iterates over nothing")
+	{
+		threaded_set my_set;
+		CHECK(my_set.begin() == my_set.end());
+		CHECK(my_set.rbegin() == my_set.rend());
+	}
+
+	SECTION("Random insertions and erasures match std::set in both directions")
+	{
+		std::set<int> st_set;
+		threaded_set my_set;
+		int mismatches = 0;
+		srand(7);
+		for (int i = 0; i < 20000; ++i)
+		{
+			int key = rand() % 1000;
+			if (rand() % 3)
+			{
+				mismatches += (st_set.insert(key).second != my_set.insert(key).second);
+			}
+			else
+			{
+				mismatches += (st_set.erase(key) != my_set.erase(key));
+			}
+		}
+		CHECK(mismatches == 0);
+		CHECK(my_set.size() == st_set.size());
+		CHECK(std::equal(my_set.begin(), my_set.end(), st_set.begin()));
+		CHECK(std::equal(my_set.rbegin(), my_set.rend(), st_set.rbegin()));
+		CHECK(*(--my_set.end()) == *st_set.rbegin());
+		CHECK(*(--my_set.rend()) == *st_set.begin());
+
+		threaded_set::iterator it = my_set.find(*st_set.begin());
+		CHECK(it == my_set.begin());
+		my_set.erase(my_set.begin(), my_set.find(500));
+		st_set.erase(st_set.begin(), st_set.find(500));
+		CHECK(std::equal(my_set.begin(), my_set.end(), st_set.begin()));
+	}
+
+	SECTION("Swap and clear keep the successor links consistent")
+	{
+		threaded_set my_set;
+		threaded_set other;
+		for (int i = 0; i < 100; ++i)
+		{
+			my_set.insert(i);
+		}
+		other.swap(my_set);
+		CHECK(my_set.begin() == my_set.end());
+		CHECK(other.size() == 100);
+		CHECK(*other.begin() == 0);
+		CHECK(*other.rbegin() == 99);
+		my_set.insert(5);
+		CHECK(*my_set.begin() == 5);
+		CHECK(++my_set.begin() == my_set.end());
+		other.clear();
+		CHECK(other.begin() == other.end());
+		other.insert(3);
+		other.insert(1);
+		other.insert(2);
+		threaded_set copy(other);
+		CHECK(copy == other);
+		CHECK(*copy.begin() == 1);
+		CHECK(*(--copy.end()) == 3);
+	}
+}
+
+TEST_CASE("Index node layout", "[layout]")
+{
+	typedef ft::set<uint32_t, std::less<uint32_t>, std::allocator<uint32_t>, ft::rbtree_index_layout> index_set;
+
+	SECTION("Links are 32-bit indexes")
+	{
+		CHECK(sizeof(ft::rbtree_index_node_base) == 12);
+		CHECK(sizeof(ft::rbtree_node_for_set<uint32_t, ft::rbtree_index_node_base>) == 16);
+		CHECK(sizeof(index_set) == sizeof(void*));
+	}
+
+	SECTION("An empty index set iterates over nothing")
+	{
+		index_set my_set;
+		CHECK(my_set.begin() == my_set.end());
+		CHECK(my_set.rbegin() == my_set.rend());
+		CHECK(my_set.find(3) == my_set.end());
+	}
+
+	SECTION("Random insertions and erasures match std::set in both directions")
+	{
+		std::set<uint32_t> st_set;
+		index_set my_set;
+		int mismatches = 0;
+		srand(11);
+		for (int i = 0; i < 20000; ++i)
+		{
+			uint32_t key = rand() % 1000;
+			if (rand() % 3)
+			{
+				mismatches += (st_set.insert(key).second != my_set.insert(key).second);
+			}
+			else
+			{
+				mismatches += (st_set.erase(key) != my_set.erase(key));
+			}
+		}
+		CHECK(mismatches == 0);
+		CHECK(my_set.size() == st_set.size());
+		CHECK(std::equal(my_set.begin(), my_set.end(), st_set.begin()));
+		CHECK(std::equal(my_set.rbegin(), my_set.rend(), st_set.rbegin()));
+		CHECK(*my_set.lower_bound(500) == *st_set.lower_bound(500));
+		CHECK(*my_set.upper_bound(500) == *st_set.upper_bound(500));
+		my_set.erase(my_set.begin(), my_set.find(*st_set.lower_bound(500)));
+		st_set.erase(st_set.begin(), st_set.lower_bound(500));
+		CHECK(std::equal(my_set.begin(), my_set.end(), st_set.begin()));
+	}
+
+	SECTION("References stay valid while the slab grows and iterators follow their elements on swap")
+	{
+		index_set my_set;
+		my_set.insert(7);
+		const uint32_t& seven = *my_set.begin();
+		index_set::iterator it = my_set.begin();
+		for (uint32_t i = 100; i < 100000; ++i)
+		{
+			my_set.insert(i);
+		}
+		CHECK(&seven == &*my_set.find(7));
+		index_set other;
+		other.insert(1);
+		other.swap(my_set);
+		CHECK(*it == 7);
+		CHECK(++it != other.end());
+		CHECK(*it == 100);
+		CHECK(*(--other.end()) == 99999);
+		CHECK(my_set.size() == 1);
+	}
+
+	SECTION("Freed slots are reused")
+	{
+		index_set my_set;
+		for (uint32_t i = 0; i < 16; ++i)
+		{
+			my_set.insert(i);
+		}
+		const uint32_t* slot = &*my_set.find(5);
+		my_set.erase(5);
+		my_set.insert(42);
+		CHECK(&*my_set.find(42) == slot);
+	}
+
+	SECTION("Bulk build, batched lookups and range scans")
+	{
+		std::vector<uint32_t> sorted;
+		for (uint32_t i = 0; i < 5000; ++i)
+		{
+			sorted.push_back(3 * i);
+		}
+		index_set my_set;
+		my_set.insert(1);
+		my_set.assign_sorted_unique(sorted.begin(), sorted.end());
+		CHECK(my_set.size() == 5000);
+		CHECK(std::equal(my_set.begin(), my_set.end(), sorted.begin()));
+		CHECK(std::equal(my_set.rbegin(), my_set.rend(), sorted.rbegin()));
+		for (uint32_t i = 0; i < 3000; ++i)
+		{
+			my_set.erase(3 * i);
+			my_set.insert(3 * i + 1);
+		}
+		std::set<uint32_t> st_set(my_set.begin(), my_set.end());
+		CHECK(st_set.size() == 5000);
+		std::vector<uint32_t> keys;
+		for (uint32_t i = 0; i < 100; ++i)
+		{
+			keys.push_back(i);
+		}
+		std::vector<index_set::const_iterator> found(keys.size());
+		my_set.find_many(keys.begin(), keys.end(), found.begin());
+		int mismatches = 0;
+		for (size_t i = 0; i < keys.size(); ++i)
+		{
+			mismatches += (found[i] != my_set.find(keys[i]));
+		}
+		CHECK(mismatches == 0);
+		std::vector<uint32_t> expected(st_set.lower_bound(100), st_set.lower_bound(9000));
+		std::vector<uint32_t> visited;
+		my_set.for_each_range(100u, 9000u, [&visited](const uint32_t& value) { visited.push_back(value); });
+		CHECK(visited == expected);
+		index_set copy(my_set);
+		CHECK(std::equal(copy.begin(), copy.end(), my_set.begin()));
+		copy.clear();
+		CHECK(copy.empty());
+		copy.insert(4);
+		CHECK(*copy.begin() == 4);
+	}
+}
+
+TEST_CASE("Set range scans", "[range]")
+{
+	std::set<int> st_set;
+	ft::set<int, std::less<int>, std::allocator<int>, ft::rbtree_threaded_layout> my_set;
+	for (int i = 0; i < 1000; ++i)
+	{
+		st_set.insert(i * 7 % 1009);
+		my_set.insert(i * 7 % 1009);
+	}
+	std::vector<int> expected(st_set.lower_bound(13), st_set.lower_bound(800));
+	std::vector<int> visited;
+	my_set.for_each_range(13, 800, [&visited](const int& value) { visited.push_back(value); });
+	CHECK(visited == expected);
+	std::vector<int> batched;
+	my_set.for_each_range_batch(13, 800, [&batched](const int* const* values, size_t count) {
+		for (size_t i = 0; i < count; ++i)
+		{
+			batched.push_back(*values[i]);
+		}
+	});
+	CHECK(batched == expected);
+}
+
+TEST_CASE("Bulk build from a sorted range", "[bulk]")
+{
+	SECTION("The tree is balanced and stays a valid set after updates")
+	{
+		for (int n = 0; n < 40; ++n)
+		{
+			std::vector<int> sorted;
+			for (int i = 0; i < n; ++i)
+			{
+				sorted.push_back(2 * i);
+			}
+			ft::set<int> my_set;
+			my_set.insert(-5); // replaced
+			my_set.assign_sorted_unique(sorted.begin(), sorted.end());
+			CHECK(my_set.size() == sorted.size());
+			CHECK(std::equal(my_set.begin(), my_set.end(), sorted.begin()));
+			CHECK(std::equal(my_set.rbegin(), my_set.rend(), sorted.rbegin()));
+			std::set<int> st_set(sorted.begin(), sorted.end());
+			for (int i = 0; i < 3 * n; ++i)
+			{
+				my_set.insert(i);
+				st_set.insert(i);
+				my_set.erase(2 * i);
+				st_set.erase(2 * i);
+			}
+			CHECK(std::equal(my_set.begin(), my_set.end(), st_set.begin()));
+		}
+	}
+
+	SECTION("Arena nodes can be erased, swapped and cleared in any order")
+	{
+		typedef ft::set<int, std::less<int>, std::allocator<int>, ft::rbtree_threaded_layout> threaded_set;
+		std::vector<int> sorted;
+		for (int i = 0; i < 10000; ++i)
+		{
+			sorted.push_back(i);
+		}
+		threaded_set my_set;
+		my_set.assign_sorted_unique(sorted.begin(), sorted.end());
+		CHECK(*(--my_set.end()) == 9999);
+		my_set.erase(my_set.find(5000), my_set.end());
+		threaded_set other;
+		other.insert(-1);
+		other.swap(my_set);
+		CHECK(other.size() == 5000);
+		CHECK(*other.rbegin() == 4999);
+		other.assign_sorted_unique(sorted.begin(), sorted.begin() + 10); // the first arena is freed with its nodes
+		CHECK(other.size() == 10);
+		CHECK(std::equal(other.begin(), other.end(), sorted.begin()));
+		CHECK(my_set.size() == 1);
+	}
+}
+
+TEST_CASE("Frozen set and map in Eytzinger order", "[frozen]")
+{
+	SECTION("Lookups and iteration match the sorted input for every size")
+	{
+		int mismatches = 0;
+		for (int n = 0; n < 70; ++n)
+		{
+			std::vector<int> sorted;
+			for (int i = 0; i < n; ++i)
+			{
+				sorted.push_back(2 * i);
+			}
+			ft::frozen_set<int> frozen(sorted.begin(), sorted.end());
+			mismatches += !(frozen.size() == sorted.size() && std::equal(frozen.begin(), frozen.end(), sorted.begin()));
+			mismatches += !std::equal(frozen.rbegin(), frozen.rend(), sorted.rbegin());
+			for (int key = -1; key <= 2 * n; ++key)
+			{
+				std::vector<int>::iterator lo = std::lower_bound(sorted.begin(), sorted.end(), key);
+				std::vector<int>::iterator hi = std::upper_bound(sorted.begin(), sorted.end(), key);
+				ft::frozen_set<int>::const_iterator frozen_lo = frozen.lower_bound(key);
+				ft::frozen_set<int>::const_iterator frozen_hi = frozen.upper_bound(key);
+				mismatches += (lo == sorted.end()) != (frozen_lo == frozen.end()) || (lo != sorted.end() && *lo != *frozen_lo);
+				mismatches += (hi == sorted.end()) != (frozen_hi == frozen.end()) || (hi != sorted.end() && *hi != *frozen_hi);
+				mismatches += frozen.count(key) != static_cast<size_t>(hi - lo);
+				mismatches += std::distance(frozen.equal_range(key).first, frozen.equal_range(key).second) != hi - lo;
+			}
+		}
+		CHECK(mismatches == 0);
+	}
+
+	SECTION("The slots start on a cache line, so the prefetched descendants share one")
+	{
+		for (size_t n = 1; n < 70; n += 7)
+		{
+			std::vector<uint32_t> sorted;
+			for (size_t i = 0; i < n; ++i)
+			{
+				sorted.push_back(static_cast<uint32_t>(i));
+			}
+			ft::frozen_set<uint32_t> frozen(sorted.begin(), sorted.end());
+			size_t leftmost = 1; // the slot of the smallest element: the deepest left turn
+			while (2 * leftmost <= n)
+			{
+				leftmost *= 2;
+			}
+			const uint32_t* slots = &*frozen.begin() - leftmost;
+			CHECK(reinterpret_cast<uintptr_t>(slots) % 64 == 0);
+		}
+	}
+
+	SECTION("Built from an ft::set or an ft::map")
+	{
+		ft::set<std::string> words;
+		words.insert("pear");
+		words.insert("apple");
+		words.insert("fig");
+		ft::frozen_set<std::string> frozen(words);
+		CHECK(std::equal(frozen.begin(), frozen.end(), words.begin()));
+		CHECK(frozen.contains("fig"));
+		CHECK(frozen.find("kiwi") == frozen.end());
+
+		ft::map<int, std::string> m;
+		for (int i = 0; i < 1000; ++i)
+		{
+			m[i * 7 % 1009] = std::string(i % 20, 'v');
+		}
+		ft::frozen_map<int, std::string> frozen_map(m);
+		CHECK(frozen_map.size() == m.size());
+		CHECK(frozen_map.at(7) == m[7]);
+		CHECK(frozen_map.lower_bound(1008)->first == m.lower_bound(1008)->first);
+		CHECK_THROWS_AS(frozen_map.at(-1), std::out_of_range);
+		ft::frozen_map<int, std::string> copy;
+		copy = frozen_map;
+		swap(copy, frozen_map);
+		CHECK(copy.size() == 1000);
+		CHECK((--copy.end())->first == m.rbegin()->first);
+	}
+
+	SECTION("Unsorted or duplicate input is rejected")
+	{
+		std::vector<int> unsorted;
+		unsorted.push_back(1);
+		unsorted.push_back(3);
+		unsorted.push_back(3);
+		CHECK_THROWS_AS(ft::frozen_set<int>(unsorted.begin(), unsorted.end()), std::invalid_argument);
+	}
+}
@@ -1,6 +1,7 @@
 #include "include/catch.hpp"
 
 #include "stack.hpp"
+#include "static_vector.hpp"
 #include "vector.hpp"
 #include <stack>
 #include <vector>
@@ -57,3 +58,23 @@ TEST_CASE("Constructing a stack and manipulating elements in it", "[string keys]
     }
 }
 
+
+TEST_CASE("Bounded stack on a static_vector", "[no allocation]")
+{
+    ft::stack<int, ft::static_vector<int, 64> > frames;
+    for (int i = 0; i < 64; ++i)
+    {
+        frames.push(i);
+    }
+    CHECK(frames.size() == 64);
+    CHECK(frames.top() == 63);
+    CHECK_THROWS_AS(frames.push(64), std::length_error);
+
+    ft::stack<int, ft::static_vector<int, 64> > copy(frames);
+    copy.pop();
+    CHECK(copy.top() == 62);
+    CHECK(copy < frames);
+    CHECK(copy != frames);
+    copy = frames;
+    CHECK(copy == frames);
+}
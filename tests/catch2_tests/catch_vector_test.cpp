@@ -1,8 +1,21 @@
 #include "include/catch.hpp"
 
 #include "vector.hpp"
+#include "huge_page_allocator.hpp"
 #include "map.hpp"
+#include "mapped_vector.hpp"
+#include "static_vector.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
 #include <map>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <type_traits>
 #include <vector>
 
 namespace ft {
@@ -378,4 +391,446 @@ TEST_CASE("Comparing vectors", "[small and big containers]")
 	CHECK(big != small);
 	CHECK(big > small);
 	CHECK(small < big);
-}
\ No newline at end of file
+}
+
+namespace
+{
+	// changes one element of b at every position (up and down, across the sign for signed types) and checks
+	// ==, < and > against the std algorithms, for every length up to a few SIMD blocks
+	template <typename T>
+	size_t compare_like_std(T low, T high)
+	{
+		size_t wrong = 0;
+		for (size_t n = 0; n < 80; ++n)
+		{
+			ft::vector<T> a;
+			for (size_t i = 0; i < n; ++i)
+			{
+				a.push_back(static_cast<T>(i % 7));
+			}
+			for (size_t p = 0; p <= n; ++p)
+			{
+				for (int change = 0; change < 3; ++change)
+				{
+					ft::vector<T> b(a);
+					if (p == n)
+					{
+						b.push_back(change == 0 ? low : high); // a is a prefix of b
+					}
+					else if (change != 2)
+					{
+						b[p] = change == 0 ? low : high;
+					}
+					bool eq = a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+					bool lt = std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end());
+					bool gt = std::lexicographical_compare(b.begin(), b.end(), a.begin(), a.end());
+					wrong += ((a == b) != eq) + ((a < b) != lt) + ((a > b) != gt);
+				}
+			}
+		}
+		return wrong;
+	}
+}
+
+TEST_CASE("Comparing integer vectors byte-wise", "[memcmp and SIMD kernels]")
+{
+	CHECK(compare_like_std<uint8_t>(0, 255) == 0);
+	CHECK(compare_like_std<char>(-100, 100) == 0);
+	CHECK(compare_like_std<signed char>(-100, 100) == 0);
+	CHECK(compare_like_std<short>(-30000, 30000) == 0);
+	CHECK(compare_like_std<int>(-1, 1 << 20) == 0);
+	CHECK(compare_like_std<uint32_t>(0, 0xffffff00u) == 0);
+	CHECK(compare_like_std<long>(-(1L << 40), 1L << 40) == 0);
+	CHECK(compare_like_std<bool>(false, true) == 0);
+	CHECK(compare_like_std<double>(-0.5, 1e9) == 0);
+
+	unsigned char x[100];
+	unsigned char y[100];
+	for (size_t i = 0; i < 100; ++i)
+	{
+		x[i] = y[i] = static_cast<unsigned char>(i);
+	}
+	CHECK(ft::detail::mismatch_bytes(x, y, 100) == 100);
+	for (size_t p = 0; p < 100; ++p)
+	{
+		y[p] ^= 0x80;
+		CHECK(ft::detail::mismatch_bytes_scalar(x, y, 100) == p);
+		CHECK(ft::detail::mismatch_bytes(x, y, 100) == p);
+		CHECK(ft::detail::mismatch_bytes(x, y, p) == p);
+		y[p] ^= 0x80;
+	}
+}
+namespace
+{
+	struct rgb
+	{
+		unsigned char r, g, b;
+
+		bool operator==(const rgb& other) const { return r == other.r && g == other.g && b == other.b; }
+	};
+
+	rgb make_rgb(int x) { rgb c = { static_cast<unsigned char>(x), 7, static_cast<unsigned char>(3 * x) }; return c; }
+	int make_int(int x) { return x * 1000003; }
+	long make_long(int x) { return static_cast<long>(x) << 33; }
+	char make_char(int x) { return static_cast<char>(x - 5); }
+	std::string make_string(int x) { return std::string(x, 'a'); }
+
+	// random resize / insert (of n values, of one of its own elements, of a range) / erase up to limit elements,
+	// checked against std::vector after every step, with find() and count() of the value
+	template <typename T, typename Vector>
+	size_t edit_like_std(T (*make)(int), Vector my_v, size_t limit)
+	{
+		std::mt19937 rng(42);
+		std::vector<T> stl_v;
+		size_t wrong = 0;
+		for (int round = 0; round < 2000; ++round)
+		{
+			size_t n = rng() % 50 % (limit / 8 + 1);
+			T value = make(static_cast<int>(rng() % 10));
+			size_t pos = my_v.empty() ? 0 : rng() % my_v.size();
+			switch (rng() % 5)
+			{
+			case 0:
+				my_v.resize(std::min(3 * n, limit), value);
+				stl_v.resize(std::min(3 * n, limit), value);
+				break;
+			case 1:
+				if (my_v.size() + n <= limit)
+				{
+					my_v.insert(my_v.begin() + pos, n, value);
+					stl_v.insert(stl_v.begin() + pos, n, value);
+				}
+				break;
+			case 2:
+				if (my_v.size() + 2 > limit)
+				{
+					break;
+				}
+				my_v.push_back(value);
+				stl_v.push_back(value);
+				my_v.insert(my_v.begin() + pos, my_v.back());
+				stl_v.insert(stl_v.begin() + pos, stl_v.back());
+				break;
+			case 3:
+				if (!my_v.empty())
+				{
+					size_t last = pos + rng() % (my_v.size() - pos + 1);
+					my_v.erase(my_v.begin() + pos, my_v.begin() + last);
+					stl_v.erase(stl_v.begin() + pos, stl_v.begin() + last);
+					if (!my_v.empty())
+					{
+						my_v.erase(my_v.begin());
+						stl_v.erase(stl_v.begin());
+					}
+				}
+				break;
+			default:
+				if (my_v.size() + my_v.size() / 2 <= limit)
+				{
+					Vector half(my_v.begin(), my_v.begin() + my_v.size() / 2);
+					std::vector<T> stl_half(stl_v.begin(), stl_v.begin() + stl_v.size() / 2);
+					my_v.insert(my_v.begin() + pos / 2, half.begin(), half.end());
+					stl_v.insert(stl_v.begin() + pos / 2, stl_half.begin(), stl_half.end());
+				}
+			}
+			wrong += !(my_v.size() == stl_v.size() && std::equal(stl_v.begin(), stl_v.end(), my_v.begin()));
+			wrong += (ft::find(my_v.begin(), my_v.end(), value) - my_v.begin())
+				!= (std::find(stl_v.begin(), stl_v.end(), value) - stl_v.begin());
+			wrong += ft::count(my_v.begin(), my_v.end(), value) != std::count(stl_v.begin(), stl_v.end(), value);
+		}
+		return wrong;
+	}
+}
+
+TEST_CASE("Bulk fill, shift, find and count", "[trivially copyable kernels]")
+{
+	CHECK(edit_like_std(make_int, ft::vector<int>(), size_t(-1)) == 0);
+	CHECK(edit_like_std(make_long, ft::vector<long>(), size_t(-1)) == 0);
+	CHECK(edit_like_std(make_char, ft::vector<char>(), size_t(-1)) == 0);
+	CHECK(edit_like_std(make_rgb, ft::vector<rgb>(), size_t(-1)) == 0);
+	CHECK(edit_like_std(make_string, ft::vector<std::string>(), size_t(-1)) == 0);
+
+	ft::vector<int> column;
+	column.resize(100000, 0);
+	CHECK(ft::count(column.begin(), column.end(), 0) == 100000);
+	column.resize(200000, 0x01020304);
+	CHECK(ft::find(column.begin(), column.end(), 0x01020304) == column.begin() + 100000);
+	CHECK(ft::count(column.begin(), column.end(), 0x01020304) == 100000);
+	CHECK(column.back() == 0x01020304);
+
+	ft::vector<char> letters(10, 'a');
+	CHECK(ft::find(letters.begin(), letters.end(), 'a' + 256) == letters.end()); // an int is not narrowed to char
+	CHECK(ft::count(letters.begin(), letters.end(), 'a') == 10);
+}
+
+namespace
+{
+	// built and edited at compile time: 2 2 2 then 10 pushed, 5 5 inserted at 1, the first 2 erased
+	constexpr int constexpr_frame_sum()
+	{
+#if __cplusplus >= 201402L
+		ft::static_vector<int, 8> frame(3, 2);
+		frame.push_back(10);
+		frame.insert(frame.begin() + 1, 2, 5);
+		frame.erase(frame.begin());
+		int sum = 0;
+		for (const int* it = frame.begin(); it != frame.end(); ++it)
+		{
+			sum += *it;
+		}
+		return sum;
+#else
+		return 24;
+#endif
+	}
+
+	constexpr ft::static_vector<int, 16> empty_frame;
+}
+
+TEST_CASE("Static vector", "[static_vector]")
+{
+	static_assert(empty_frame.empty() && empty_frame.capacity() == 16, "the observers are constexpr");
+	static_assert(constexpr_frame_sum() == 24, "trivial elements are constexpr in C++14");
+	static_assert(std::is_trivially_copyable<ft::static_vector<int, 16> >::value, "an int frame is its bytes");
+
+	SECTION("Same contents as std::vector, with no allocation")
+	{
+		CHECK(edit_like_std(make_int, ft::static_vector<int, 64>(), 64) == 0);
+		CHECK(edit_like_std(make_string, ft::static_vector<std::string, 64>(), 64) == 0);
+		CHECK(edit_like_std(make_rgb, ft::static_vector<rgb, 5>(), 5) == 0);
+	}
+
+	SECTION("Growing past the capacity throws length_error")
+	{
+		ft::static_vector<std::string, 3> names(3, "x");
+		CHECK_THROWS_AS(names.push_back("y"), std::length_error);
+		CHECK_THROWS_AS(names.insert(names.begin(), "y"), std::length_error);
+		CHECK_THROWS_AS(names.resize(4), std::length_error);
+		CHECK_THROWS_AS(names.reserve(4), std::length_error);
+		CHECK_THROWS_AS(names.at(3), std::out_of_range);
+		CHECK(names.size() == 3);
+		CHECK(names.max_size() == 3);
+
+		// a range that doesn't fit leaves the vector as it was
+		ft::static_vector<int, 4> small;
+		small.push_back(1);
+		small.push_back(2);
+		const int more[] = {7, 8, 9, 10, 11};
+		CHECK_THROWS_AS(small.insert(small.begin(), more, more + 3), std::length_error);
+		CHECK_THROWS_AS(small.assign(more, more + 5), std::length_error);
+		std::istringstream three("7 8 9");
+		CHECK_THROWS_AS(small.insert(small.begin(), std::istream_iterator<int>(three), std::istream_iterator<int>()),
+			std::length_error);
+		std::istringstream five("7 8 9 10 11");
+		CHECK_THROWS_AS(small.assign(std::istream_iterator<int>(five), std::istream_iterator<int>()), std::length_error);
+		CHECK(small.size() == 2);
+		CHECK(small[0] == 1);
+		CHECK(small[1] == 2);
+		std::istringstream two("7 8");
+		small.insert(small.begin() + 1, std::istream_iterator<int>(two), std::istream_iterator<int>());
+		CHECK(small[1] == 7);
+		CHECK(small[2] == 8);
+		CHECK(small.back() == 2);
+	}
+
+	SECTION("Swap and the relational operators")
+	{
+		ft::static_vector<std::string, 8> a(2, "a");
+		ft::static_vector<std::string, 8> b(5, "b");
+		ft::swap(a, b);
+		CHECK(a.size() == 5);
+		CHECK(b.size() == 2);
+		CHECK(a.back() == "b");
+		CHECK(b.front() == "a");
+		CHECK(b < a);
+		CHECK(a > b);
+		CHECK(a != b);
+		b = a;
+		CHECK(b == a);
+		CHECK(*b.rbegin() == "b");
+	}
+}
+
+namespace
+{
+	struct sample
+	{
+		uint32_t	id;
+		float		weight;
+		char		tag[8];
+	};
+}
+
+TEST_CASE("Memory-mapped vector", "[mapped_vector]")
+{
+	const char* path = "mapped_vector_test.bin";
+
+	SECTION("Elements written through the mapping are read back after reopening")
+	{
+		{
+			ft::mapped_vector<uint64_t> column(path, ft::mapped_vector<uint64_t>::open_create);
+			for (uint64_t i = 0; i < 100000; ++i)
+			{
+				column.push_back(i * i);
+			}
+			CHECK(column.size() == 100000);
+			CHECK(column.capacity() >= column.size());
+			column[7] = 7;
+		}
+		ft::mapped_vector<uint64_t> column(path, ft::mapped_vector<uint64_t>::open_read_only | ft::mapped_vector<uint64_t>::open_verify);
+		const ft::mapped_vector<uint64_t>& elements = column; // read only: the non-const accessors would assert
+		CHECK(column.size() == 100000);
+		CHECK(column.capacity() == column.size()); // close() gave the slack back
+		CHECK(elements[7] == 7);
+		CHECK(elements.back() == 99999ULL * 99999ULL);
+		CHECK(*(elements.rbegin() + 1) == 99998ULL * 99998ULL);
+		CHECK(column.stored_checksum() == column.checksum());
+		column.advise(ft::mapped_vector<uint64_t>::advice_sequential);
+		column.advise(10, 1000, ft::mapped_vector<uint64_t>::advice_will_need);
+		CHECK_THROWS_AS(column.push_back(1), std::logic_error);
+		CHECK_THROWS_AS(elements.at(100000), std::out_of_range);
+	}
+
+	SECTION("Appending to an existing file grows it and keeps the old elements")
+	{
+		{
+			ft::mapped_vector<sample> rows(path, ft::mapped_vector<sample>::open_create);
+			sample s = { 1, 0.5f, "first" };
+			rows.push_back(s);
+		}
+		{
+			ft::mapped_vector<sample> rows(path);
+			CHECK(rows.size() == 1);
+			ft::vector<sample> more;
+			for (uint32_t i = 2; i <= 5000; ++i)
+			{
+				sample s = { i, i * 0.5f, "more" };
+				more.push_back(s);
+			}
+			rows.append(more.begin(), more.end());
+			rows.append(rows.begin(), rows.begin() + 2); // from itself, across a remap
+			CHECK(rows.size() == 5002);
+			CHECK(rows[5001].id == 2);
+		}
+		const ft::mapped_vector<sample> rows(path, ft::mapped_vector<sample>::open_read_only);
+		CHECK(rows.size() == 5002);
+		CHECK(std::string(rows.front().tag) == "first");
+		CHECK(rows[4999].id == 5000);
+		CHECK(rows[4999].weight == 2500.0f);
+	}
+
+	SECTION("A read-only view of a file with spare capacity can't be modified")
+	{
+		ft::mapped_vector<int> writer(path, ft::mapped_vector<int>::open_create);
+		for (int i = 0; i < 10; ++i)
+		{
+			writer.push_back(i);
+		}
+		writer.sync(); // the file keeps its slack until close()
+		ft::mapped_vector<int> reader(path, ft::mapped_vector<int>::open_read_only);
+		REQUIRE(reader.size() == 10);
+		REQUIRE(reader.capacity() > reader.size());
+		int more[] = { 10, 11 };
+		CHECK_THROWS_AS(reader.push_back(1), std::logic_error);
+		CHECK_THROWS_AS(reader.append(more, more + 2), std::logic_error);
+		CHECK_THROWS_AS(reader.assign(more, more + 2), std::logic_error);
+		CHECK_THROWS_AS(reader.pop_back(), std::logic_error);
+		CHECK_THROWS_AS(reader.clear(), std::logic_error);
+		CHECK(reader.size() == 10);
+		CHECK(static_cast<const ft::mapped_vector<int>&>(reader).back() == 9);
+	}
+
+	SECTION("Files of another type, or damaged ones, are rejected")
+	{
+		{
+			ft::mapped_vector<uint64_t> column(path, ft::mapped_vector<uint64_t>::open_create);
+			column.resize(1000, 3);
+		}
+		CHECK_THROWS_AS(ft::mapped_vector<uint32_t>(path, ft::mapped_vector<uint32_t>::open_read_only), std::runtime_error);
+		{
+			std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+			file.seekp(64 + 8 * 500);
+			file.put('x');
+		}
+		ft::mapped_vector<uint64_t> unchecked(path, ft::mapped_vector<uint64_t>::open_read_only);
+		CHECK(unchecked.size() == 1000);
+		CHECK(unchecked.checksum() != unchecked.stored_checksum());
+		CHECK_THROWS_AS(ft::mapped_vector<uint64_t>(path, ft::mapped_vector<uint64_t>::open_verify), std::runtime_error);
+		{
+			std::ofstream file(path, std::ios::binary | std::ios::trunc);
+			file << "not a column";
+		}
+		CHECK_THROWS_AS(ft::mapped_vector<uint64_t>(path, ft::mapped_vector<uint64_t>::open_read_only), std::runtime_error);
+		CHECK_THROWS_AS(ft::mapped_vector<uint64_t>("no/such/dir/file.bin"), std::system_error);
+	}
+	std::remove(path);
+}
+
+TEST_CASE("Huge page allocator", "[huge_page_allocator]")
+{
+	typedef ft::huge_page_allocator<long> alloc_type;
+	typedef ft::vector<long, alloc_type> column;
+
+	SECTION("Small buffers come from operator new, big ones are mapped on 2 MiB boundaries")
+	{
+		ft::huge_page_options opts;
+		opts.threshold = 1 << 20;
+		size_t mappings = alloc_type::stats().mappings;
+		column v(opts);
+		for (long i = 0; i < 1000; ++i)
+		{
+			v.push_back(i);
+		}
+		CHECK(alloc_type::stats().mappings == mappings);
+		v.reserve(300000); // 2.4 MB
+		CHECK(alloc_type::stats().mappings == mappings + 1);
+		CHECK(reinterpret_cast<uintptr_t>(&v[0]) % (2 << 20) == 0);
+		for (long i = 1000; i < 300000; ++i)
+		{
+			v.push_back(i);
+		}
+		CHECK(v[299999] == 299999);
+		column copy(v);
+		CHECK(copy == v);
+		CHECK(copy.get_allocator() == v.get_allocator());
+		v.resize(10);
+		v.swap(copy);
+		CHECK(copy.size() == 10);
+	}
+
+	SECTION("Requests whose page-rounded mapping would wrap around throw bad_alloc")
+	{
+		ft::huge_page_allocator<char> bytes;
+		CHECK_THROWS_AS(bytes.allocate(static_cast<size_t>(-1) - 100), std::bad_alloc);
+		CHECK_THROWS_AS(bytes.allocate(static_cast<size_t>(-1) - (4 << 20) + 1), std::bad_alloc);
+	}
+
+	SECTION("Explicit huge pages, NUMA placement and prefault fall back gracefully")
+	{
+		ft::huge_page_options opts;
+		opts.threshold = 0;
+		opts.pages = ft::huge_page_options::huge_pages_explicit;
+		opts.numa = ft::huge_page_options::numa_interleave;
+		opts.node_mask = 1;
+		opts.prefault = true;
+		alloc_type alloc(opts);
+		ft::huge_page_stats before = alloc_type::stats();
+		long* p = alloc.allocate(1 << 18);
+		p[0] = 1;
+		p[(1 << 18) - 1] = 2;
+		alloc.prefault(p, 1 << 18);
+		alloc.deallocate(p, 1 << 18);
+		ft::huge_page_stats after = alloc_type::stats();
+		CHECK(after.mappings == before.mappings + 1);
+		if (!alloc_type::numa_available())
+		{
+			CHECK(after.numa_fallbacks == before.numa_fallbacks + 1);
+		}
+		opts.numa = ft::huge_page_options::numa_bind;
+		opts.node_mask = 1UL << 60; // no such node: mbind fails, the memory is still usable
+		ft::vector<char, ft::huge_page_allocator<char> > bound(1 << 21, 'x', opts);
+		CHECK(bound[(1 << 21) - 1] == 'x');
+		CHECK(alloc_type::stats().numa_fallbacks > after.numa_fallbacks);
+		CHECK(alloc_type(opts) != ft::huge_page_allocator<char>());
+	}
+}